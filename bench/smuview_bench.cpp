@@ -0,0 +1,645 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * smuview_bench runs the core data pipeline of SmuView with synthetic
+ * signals, without GUI and without hardware, and prints the results as JSON.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QString>
+
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include "config.h"
+#include "src/session.hpp"
+#include "src/channels/hardwarechannel.hpp"
+#include "src/channels/multiplysfchannel.hpp"
+#include "src/channels/multiplysschannel.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/csvexport.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/decimator.hpp"
+#include "src/data/histogramaccumulator.hpp"
+#include "src/data/memorymanager.hpp"
+#include "src/data/resampler.hpp"
+#include "src/data/spectrumanalyzer.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::make_shared;
+using std::ostringstream;
+using std::set;
+using std::shared_ptr;
+using std::static_pointer_cast;
+using std::string;
+using std::vector;
+using sv::data::AnalogTimeSignal;
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+namespace {
+
+struct BenchResult
+{
+	string name;
+	size_t samples;
+	double ns_per_sample;
+	double bytes_per_sample;
+};
+
+const size_t block_size = 1000;
+const uint64_t samplerate = 1000;
+
+bool verbose = false;
+
+void message_handler(QtMsgType type, const QMessageLogContext &context,
+	const QString &msg)
+{
+	(void)type;
+	(void)context;
+	if (verbose)
+		std::cerr << msg.toStdString() << std::endl;
+}
+
+void usage()
+{
+	fprintf(stdout,
+		"Usage:\n"
+		"  %s [OPTION...]\n"
+		"\n"
+		"Help Options:\n"
+		"  -h, -?, --help             Show help option\n"
+		"\n"
+		"Benchmark Options:\n"
+		"  -n, --samples              Number of samples per signal\n"
+		"                             (default 1000000)\n"
+		"  -c, --csv-samples          Number of samples per signal for the CSV\n"
+		"                             export (default 100000)\n"
+		"  -s, --csv-signals          Number of signals for the CSV export\n"
+		"                             (default 4)\n"
+		"  -o, --output               Write the JSON results to a file\n"
+		"  -v, --verbose              Show the log output of SmuView\n",
+		"smuview_bench");
+}
+
+double elapsed_ns(bench_clock_t::time_point start)
+{
+	return std::chrono::duration<double, std::nano>(
+		bench_clock_t::now() - start).count();
+}
+
+shared_ptr<AnalogTimeSignal> create_signal(
+	shared_ptr<sv::devices::UserDevice> device, const string &name,
+	sv::data::Quantity quantity, sv::data::Unit unit)
+{
+	auto channel = device->add_user_channel(name, "");
+	return static_pointer_cast<AnalogTimeSignal>(
+		channel->add_signal(quantity, set<sv::data::QuantityFlag>(), unit));
+}
+
+/**
+ * Fill the signal with a sine wave. The timestamps start at start_timestamp.
+ */
+void fill_signal(shared_ptr<AnalogTimeSignal> signal, size_t samples,
+	double start_timestamp)
+{
+	vector<double> timestamps;
+	vector<double> values;
+	timestamps.reserve(block_size);
+	values.reserve(block_size);
+	for (size_t pos = 0; pos < samples; ++pos) {
+		timestamps.push_back(start_timestamp + pos / (double)samplerate);
+		values.push_back(std::sin(pos / 100.));
+		if (timestamps.size() == block_size || pos == samples - 1) {
+			signal->push_samples(timestamps, values, 7, 3);
+			timestamps.clear();
+			values.clear();
+		}
+	}
+}
+
+/**
+ * Push float samples to a signal and read them back. With native precision
+ * the signal stores the values as floats and widens them when read.
+ */
+vector<BenchResult> bench_push_samples(
+	shared_ptr<sv::devices::UserDevice> device, size_t samples,
+	bool native_precision)
+{
+	vector<BenchResult> results;
+	string suffix = native_precision ? "" : "_double";
+
+	auto &memory_manager = sv::data::MemoryManager::instance();
+	bool native_precision_enabled =
+		memory_manager.is_native_precision_enabled();
+	memory_manager.set_native_precision_enabled(native_precision);
+	auto signal = create_signal(device, "push_samples" + suffix,
+		sv::data::Quantity::Voltage, sv::data::Unit::Volt);
+
+	vector<float> data(block_size);
+	for (size_t i = 0; i < block_size; ++i)
+		data[i] = (float)std::sin(i / 100.);
+
+	auto start = bench_clock_t::now();
+	double timestamp = 0.;
+	for (size_t pos = 0; pos < samples; pos += block_size) {
+		size_t count = std::min(block_size, samples - pos);
+		signal->push_samples(data.data(), count, timestamp, samplerate,
+			sizeof(float), 7, 3);
+		timestamp += count / (double)samplerate;
+	}
+	double ns = elapsed_ns(start);
+	memory_manager.set_native_precision_enabled(native_precision_enabled);
+	results.push_back({ "push_samples" + suffix, samples, ns / samples,
+		signal->memory_size() / (double)signal->sample_count() });
+
+	vector<double> timestamps(block_size);
+	vector<double> values(block_size);
+	volatile double sum = 0.;
+	start = bench_clock_t::now();
+	for (size_t pos = 0; pos < samples; pos += block_size) {
+		size_t count = signal->get_samples(
+			pos, block_size, timestamps.data(), values.data());
+		sum = sum + values[count - 1];
+	}
+	ns = elapsed_ns(start);
+	results.push_back({ "get_samples" + suffix, samples, ns / samples, 0. });
+
+	return results;
+}
+
+BenchResult bench_push_interleaved_samples(
+	shared_ptr<sv::devices::UserDevice> device, size_t samples)
+{
+	// Two channels in one packet, so the samples must be deinterleaved.
+	const size_t stride = 2;
+	auto sr_udev = static_pointer_cast<sigrok::UserDevice>(
+		device->sr_device());
+	auto sr_channel1 = sr_udev->add_channel(device->next_channel_index(),
+		sigrok::ChannelType::ANALOG, "interleaved1");
+	auto sr_channel2 = sr_udev->add_channel(device->next_channel_index(),
+		sigrok::ChannelType::ANALOG, "interleaved2");
+	auto channel = make_shared<sv::channels::HardwareChannel>(
+		sr_channel1, device, set<string> { "" }, 0.);
+
+	vector<float> data(block_size * stride);
+	for (size_t i = 0; i < data.size(); ++i)
+		data[i] = (float)std::sin(i / 100.);
+	auto sr_packet = sv::Session::sr_context->create_analog_packet(
+		{ sr_channel1, sr_channel2 }, data.data(), block_size,
+		sigrok::Quantity::VOLTAGE, sigrok::Unit::VOLT,
+		{ sigrok::QuantityFlag::DC });
+	auto sr_analog = dynamic_pointer_cast<sigrok::Analog>(
+		sr_packet->payload());
+
+	auto start = bench_clock_t::now();
+	double timestamp = 0.;
+	for (size_t pos = 0; pos < samples; pos += block_size) {
+		size_t count = std::min(block_size, samples - pos);
+		channel->push_interleaved_samples(data.data(), count, stride,
+			timestamp, samplerate, sr_analog);
+		timestamp += count / (double)samplerate;
+	}
+	double ns = elapsed_ns(start);
+
+	auto signal = static_pointer_cast<AnalogTimeSignal>(
+		channel->actual_signal());
+	return { "push_interleaved_samples", samples, ns / samples,
+		signal->memory_size() / (double)signal->sample_count() };
+}
+
+BenchResult bench_combine_signals(
+	shared_ptr<AnalogTimeSignal> signal1,
+	shared_ptr<AnalogTimeSignal> signal2)
+{
+	auto time_vector = make_shared<vector<double>>();
+	auto data1_vector = make_shared<vector<double>>();
+	auto data2_vector = make_shared<vector<double>>();
+	size_t signal1_pos = 0;
+	size_t signal2_pos = 0;
+
+	auto start = bench_clock_t::now();
+	AnalogTimeSignal::combine_signals(
+		signal1, signal1_pos, signal2, signal2_pos,
+		time_vector, data1_vector, data2_vector);
+	double ns = elapsed_ns(start);
+
+	size_t samples = time_vector->size();
+	double bytes = (time_vector->capacity() + data1_vector->capacity() +
+		data2_vector->capacity()) * sizeof(double);
+	return { "combine_signals", samples, ns / samples, bytes / samples };
+}
+
+vector<BenchResult> bench_resampler(
+	shared_ptr<AnalogTimeSignal> signal1,
+	shared_ptr<AnalogTimeSignal> signal2)
+{
+	vector<BenchResult> results;
+	const vector<std::pair<sv::data::ResampleMode, string>> modes = {
+		{ sv::data::ResampleMode::ZeroOrderHold, "resample_zoh" },
+		{ sv::data::ResampleMode::Linear, "resample_linear" },
+		{ sv::data::ResampleMode::BoxAverage, "resample_box_average" },
+	};
+	for (const auto &mode : modes) {
+		vector<double> time;
+		vector<vector<double>> values;
+
+		// Same grid density as the signals, to compare with combine_signals.
+		auto start = bench_clock_t::now();
+		sv::data::Resampler::resample({ signal1, signal2 }, mode.first,
+			1. / samplerate, time, values);
+		double ns = elapsed_ns(start);
+
+		size_t samples = time.size();
+		double bytes = time.capacity() * sizeof(double);
+		for (const auto &signal_values : values)
+			bytes += signal_values.capacity() * sizeof(double);
+		results.push_back({ mode.second, samples, ns / samples,
+			bytes / samples });
+	}
+	return results;
+}
+
+BenchResult bench_get_value_at_timestamp(
+	shared_ptr<AnalogTimeSignal> signal, size_t lookups)
+{
+	double first_ts = signal->first_timestamp(false);
+	double last_ts = signal->last_timestamp(false);
+	std::mt19937 generator(42);
+	std::uniform_real_distribution<double> distribution(first_ts, last_ts);
+	vector<double> timestamps(lookups);
+	for (auto &timestamp : timestamps)
+		timestamp = distribution(generator);
+
+	volatile double sum = 0.;
+	auto start = bench_clock_t::now();
+	for (const auto &timestamp : timestamps) {
+		double value;
+		if (signal->get_value_at_timestamp(timestamp, value, false))
+			sum = sum + value;
+	}
+	double ns = elapsed_ns(start);
+
+	return { "get_value_at_timestamp", lookups, ns / lookups, 0. };
+}
+
+BenchResult bench_histogram(shared_ptr<AnalogTimeSignal> signal)
+{
+	sv::data::HistogramAccumulator accumulator(signal);
+	auto start = bench_clock_t::now();
+	accumulator.update();
+	double ns = elapsed_ns(start);
+
+	size_t samples = accumulator.count();
+	return { "histogram", samples, ns / samples, 0. };
+}
+
+BenchResult bench_spectrum(shared_ptr<AnalogTimeSignal> signal)
+{
+	// The same calculation as the worker of the spectrum view: Hann
+	// windowed frames with 50% overlap.
+	const size_t fft_size = 4096;
+	const size_t hop = fft_size / 2;
+	size_t count = signal->sample_count();
+	vector<double> timestamps(count);
+	vector<double> values(count);
+	signal->get_samples(0, count, timestamps.data(), values.data());
+
+	size_t frames = 0;
+	volatile double sum = 0.;
+	vector<double> frame(fft_size);
+	auto start = bench_clock_t::now();
+	for (size_t pos = 0; pos + fft_size <= count; pos += hop) {
+		std::copy(values.begin() + pos, values.begin() + pos + fft_size,
+			frame.begin());
+		auto magnitudes = sv::data::SpectrumAnalyzer::amplitude_spectrum(
+			frame, sv::data::SpectrumWindow::Hann);
+		sum = sum + magnitudes[1];
+		++frames;
+	}
+	double ns = elapsed_ns(start);
+
+	size_t samples = frames * hop;
+	return { "spectrum_fft4096", samples, ns / samples, 0. };
+}
+
+/**
+ * Wait until the math channel has calculated the given number of samples.
+ */
+bool wait_for_samples(shared_ptr<AnalogTimeSignal> signal, size_t samples)
+{
+	auto last_progress = bench_clock_t::now();
+	size_t last_count = signal->sample_count();
+	while (signal->sample_count() < samples) {
+		std::this_thread::sleep_for(std::chrono::microseconds(100));
+		size_t count = signal->sample_count();
+		if (count != last_count) {
+			last_count = count;
+			last_progress = bench_clock_t::now();
+		}
+		else if (bench_clock_t::now() - last_progress >
+				std::chrono::seconds(10)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+vector<BenchResult> bench_math_channels(
+	shared_ptr<sv::devices::UserDevice> device,
+	shared_ptr<AnalogTimeSignal> voltage_signal,
+	shared_ptr<AnalogTimeSignal> current_signal, size_t combined_samples)
+{
+	vector<BenchResult> results;
+
+	// Signal x signal, calculated by the math scheduler
+	auto start = bench_clock_t::now();
+	auto power_channel = make_shared<sv::channels::MultiplySSChannel>(
+		sv::data::Quantity::Power, set<sv::data::QuantityFlag>(),
+		sv::data::Unit::Watt, voltage_signal, current_signal,
+		device, set<string> { "" }, "P", 0.);
+	device->add_math_channel(power_channel, "");
+	auto power_signal = static_pointer_cast<AnalogTimeSignal>(
+		power_channel->actual_signal());
+	if (!wait_for_samples(power_signal, combined_samples)) {
+		std::cerr << "math_multiply_ss: Only " <<
+			power_signal->sample_count() << " of " << combined_samples <<
+			" samples calculated" << std::endl;
+	}
+	double ns = elapsed_ns(start);
+	results.push_back({ "math_multiply_ss", power_signal->sample_count(),
+		ns / power_signal->sample_count(),
+		power_signal->memory_size() /
+			(double)power_signal->sample_count() });
+
+	// Signal x factor, a view of the input signal
+	start = bench_clock_t::now();
+	auto scaled_channel = make_shared<sv::channels::MultiplySFChannel>(
+		sv::data::Quantity::Voltage, set<sv::data::QuantityFlag>(),
+		sv::data::Unit::Volt, voltage_signal, 10.,
+		device, set<string> { "" }, "V x 10", 0.);
+	device->add_math_channel(scaled_channel, "");
+	auto scaled_signal = static_pointer_cast<AnalogTimeSignal>(
+		scaled_channel->actual_signal());
+	wait_for_samples(scaled_signal, voltage_signal->sample_count());
+	ns = elapsed_ns(start);
+	results.push_back({ "math_multiply_sf", scaled_signal->sample_count(),
+		ns / scaled_signal->sample_count(),
+		scaled_signal->memory_size() /
+			(double)scaled_signal->sample_count() });
+
+	return results;
+}
+
+vector<BenchResult> bench_csv_export(
+	shared_ptr<sv::devices::UserDevice> device,
+	size_t signal_count, size_t samples)
+{
+	vector<BenchResult> results;
+
+	vector<shared_ptr<sv::data::BaseSignal>> signals;
+	for (size_t i = 0; i < signal_count; ++i) {
+		auto signal = create_signal(device, "csv" + std::to_string(i),
+			sv::data::Quantity::Voltage, sv::data::Unit::Volt);
+		// Shift the timestamps, so the combined export has to merge them.
+		fill_signal(signal, samples, i / (double)(samplerate * signal_count));
+		signals.push_back(signal);
+	}
+	size_t total_samples = signal_count * samples;
+
+	QString file_name = QDir::temp().filePath("smuview_bench.csv");
+
+	auto start = bench_clock_t::now();
+	sv::data::csvexport::save(file_name.toStdString(), signals, true, ",");
+	double ns = elapsed_ns(start);
+	results.push_back({ "csv_export", total_samples, ns / total_samples,
+		QFile(file_name).size() / (double)total_samples });
+
+	start = bench_clock_t::now();
+	sv::data::csvexport::save_combined(
+		file_name.toStdString(), signals, true, ",");
+	ns = elapsed_ns(start);
+	results.push_back({ "csv_export_combined", total_samples,
+		ns / total_samples,
+		QFile(file_name).size() / (double)total_samples });
+
+	const vector<std::pair<sv::data::DecimationMode, string>> modes = {
+		{ sv::data::DecimationMode::LTTB, "csv_export_lttb" },
+		{ sv::data::DecimationMode::MinMaxMean, "csv_export_min_max_mean" },
+	};
+	for (const auto &mode : modes) {
+		start = bench_clock_t::now();
+		sv::data::csvexport::save_decimated(
+			file_name.toStdString(), signals, true, ",", mode.first, 10000, 0.);
+		ns = elapsed_ns(start);
+		results.push_back({ mode.second, total_samples, ns / total_samples,
+			QFile(file_name).size() / (double)total_samples });
+	}
+
+	QFile::remove(file_name);
+
+	return results;
+}
+
+vector<BenchResult> bench_spill(
+	shared_ptr<sv::devices::UserDevice> device, size_t samples)
+{
+	vector<BenchResult> results;
+
+	// All signals share the budget, so the signals of the other benchmarks
+	// are moved to the disk, too.
+	auto &memory_manager = sv::data::MemoryManager::instance();
+	memory_manager.set_budget(16 * 1024 * 1024);
+
+	auto signal = create_signal(device, "spill",
+		sv::data::Quantity::Voltage, sv::data::Unit::Volt);
+	auto start = bench_clock_t::now();
+	fill_signal(signal, samples, 0.);
+	double ns = elapsed_ns(start);
+	results.push_back({ "spill_push_samples", samples, ns / samples,
+		signal->memory_size() / (double)signal->sample_count() });
+
+	// The samples are read in order, so every chunk is paged in once.
+	vector<double> timestamps(block_size);
+	vector<double> values(block_size);
+	volatile double sum = 0.;
+	start = bench_clock_t::now();
+	for (size_t pos = 0; pos < samples; pos += block_size) {
+		size_t count = signal->get_samples(
+			pos, block_size, timestamps.data(), values.data());
+		for (size_t i = 0; i < count; ++i)
+			sum = sum + values[i];
+	}
+	ns = elapsed_ns(start);
+	results.push_back({ "spill_read_samples", samples, ns / samples,
+		signal->spilled_size() / (double)signal->sample_count() });
+
+	memory_manager.set_budget(0);
+
+	return results;
+}
+
+string to_json(const vector<BenchResult> &results)
+{
+	ostringstream json;
+	json << "{\n";
+	json << "  \"version\": \"" << SV_VERSION_STRING << "\",\n";
+	json << "  \"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const auto &result = results[i];
+		json << "    { \"name\": \"" << result.name << "\", " <<
+			"\"samples\": " << result.samples << ", " <<
+			"\"ns_per_sample\": " << result.ns_per_sample << ", " <<
+			"\"bytes_per_sample\": " << result.bytes_per_sample << " }";
+		if (i < results.size() - 1)
+			json << ",";
+		json << "\n";
+	}
+	json << "  ]\n";
+	json << "}\n";
+	return json.str();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	size_t samples = 1000000;
+	size_t csv_samples = 100000;
+	size_t csv_signals = 4;
+	string output_file;
+
+	QCoreApplication app(argc, argv);
+
+	// Parse arguments
+	while (true) {
+		static const struct option long_options[] = {
+			{ "help", no_argument, nullptr, 'h' },
+			{ "samples", required_argument, nullptr, 'n' },
+			{ "csv-samples", required_argument, nullptr, 'c' },
+			{ "csv-signals", required_argument, nullptr, 's' },
+			{ "output", required_argument, nullptr, 'o' },
+			{ "verbose", no_argument, nullptr, 'v' },
+			{ nullptr, 0, nullptr, 0 }
+		};
+
+		const int c = getopt_long(argc, argv,
+			"h?n:c:s:o:v", long_options, nullptr);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case 'n':
+			samples = std::strtoull(optarg, nullptr, 10);
+			break;
+		case 'c':
+			csv_samples = std::strtoull(optarg, nullptr, 10);
+			break;
+		case 's':
+			csv_signals = std::strtoull(optarg, nullptr, 10);
+			break;
+		case 'o':
+			output_file = optarg;
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		case 'h':
+		case '?':
+		default:
+			usage();
+			return 0;
+		}
+	}
+	if (samples < 2 || csv_samples < 2 || csv_signals < 1) {
+		usage();
+		return 1;
+	}
+
+	qInstallMessageHandler(message_handler);
+
+	sv::Session::sr_context = sigrok::Context::create();
+	sv::Session::session_start_timestamp = 0.;
+	auto device = make_shared<sv::devices::UserDevice>(
+		sv::Session::sr_context, "SmuView", "Benchmark", SV_VERSION_STRING);
+
+	vector<BenchResult> results;
+	for (const auto &result : bench_push_samples(device, samples, true))
+		results.push_back(result);
+	for (const auto &result : bench_push_samples(device, samples, false))
+		results.push_back(result);
+	results.push_back(bench_push_interleaved_samples(device, samples));
+
+	// The current signal is sampled between the voltage samples, so
+	// combine_signals() has to interpolate.
+	auto voltage_signal = create_signal(device, "V",
+		sv::data::Quantity::Voltage, sv::data::Unit::Volt);
+	fill_signal(voltage_signal, samples, 0.);
+	auto current_signal = create_signal(device, "I",
+		sv::data::Quantity::Current, sv::data::Unit::Ampere);
+	fill_signal(current_signal, samples, 0.5 / samplerate);
+
+	results.push_back(bench_combine_signals(voltage_signal, current_signal));
+	size_t combined_samples = results.back().samples;
+	for (const auto &result : bench_resampler(voltage_signal, current_signal))
+		results.push_back(result);
+	results.push_back(bench_get_value_at_timestamp(voltage_signal, samples));
+	results.push_back(bench_histogram(voltage_signal));
+	results.push_back(bench_spectrum(voltage_signal));
+	for (const auto &result : bench_math_channels(
+			device, voltage_signal, current_signal, combined_samples))
+		results.push_back(result);
+	for (const auto &result :
+			bench_csv_export(device, csv_signals, csv_samples))
+		results.push_back(result);
+	for (const auto &result : bench_spill(device, samples))
+		results.push_back(result);
+
+	string json = to_json(results);
+	if (output_file.empty()) {
+		std::cout << json;
+	}
+	else {
+		std::ofstream output(output_file);
+		output << json;
+	}
+
+	return 0;
+}
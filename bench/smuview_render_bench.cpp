@@ -0,0 +1,568 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * smuview_render_bench renders the plots and the panel views of SmuView with
+ * synthetic signals on an offscreen surface and prints the frame times as
+ * JSON. Per default the Qt platform plugin "offscreen" is used, so no display
+ * is needed.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <getopt.h>
+#include <iostream>
+#include <memory>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <QApplication>
+#include <QString>
+#include <QWidget>
+
+#include <libsigrokcxx/libsigrokcxx.hpp>
+
+#include "config.h"
+#include "src/devicemanager.hpp"
+#include "src/session.hpp"
+#include "src/util.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/devices/userdevice.hpp"
+#include "src/ui/framescheduler.hpp"
+#include "src/ui/views/powerpanelview.hpp"
+#include "src/ui/views/valuepanelview.hpp"
+#include "src/ui/widgets/plot/plot.hpp"
+#include "src/ui/widgets/plot/timecurvedata.hpp"
+#include "src/ui/widgets/plot/xycurvedata.hpp"
+
+using std::make_shared;
+using std::ostringstream;
+using std::set;
+using std::shared_ptr;
+using std::static_pointer_cast;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+using sv::data::AnalogTimeSignal;
+using sv::ui::widgets::plot::Plot;
+using sv::ui::widgets::plot::PlotUpdateMode;
+using sv::ui::widgets::plot::XYRenderMode;
+
+typedef std::chrono::steady_clock bench_clock_t;
+
+namespace {
+
+struct BenchResult
+{
+	string name;
+	size_t points;
+	size_t curves;
+	vector<double> frame_ms;
+};
+
+const size_t block_size = 1000;
+const uint64_t samplerate = 1000;
+const int plot_width = 1280;
+const int plot_height = 720;
+
+bool verbose = false;
+
+void message_handler(QtMsgType type, const QMessageLogContext &context,
+	const QString &msg)
+{
+	(void)type;
+	(void)context;
+	if (verbose)
+		std::cerr << msg.toStdString() << std::endl;
+}
+
+void usage()
+{
+	fprintf(stdout,
+		"Usage:\n"
+		"  %s [OPTION...]\n"
+		"\n"
+		"Help Options:\n"
+		"  -h, -?, --help             Show help option\n"
+		"\n"
+		"Benchmark Options:\n"
+		"  -n, --points               Comma separated list of the number of\n"
+		"                             points per curve (default 1000,100000)\n"
+		"  -c, --curves               Comma separated list of the number of\n"
+		"                             curves per plot (default 1,8)\n"
+		"  -f, --frames               Number of frames per benchmark\n"
+		"                             (default 50)\n"
+		"  -a, --append               Number of samples per curve, appended\n"
+		"                             between two frames (default 200)\n"
+		"  -o, --output               Write the JSON results to a file\n"
+		"  -v, --verbose              Show the log output of SmuView\n",
+		"smuview_render_bench");
+}
+
+double elapsed_ms(bench_clock_t::time_point start)
+{
+	return std::chrono::duration<double, std::milli>(
+		bench_clock_t::now() - start).count();
+}
+
+bool parse_list(const string &text, vector<size_t> &list)
+{
+	list.clear();
+	for (const auto &item : sv::util::split_string(text, ",")) {
+		size_t value = std::strtoull(item.c_str(), nullptr, 10);
+		if (value < 1)
+			return false;
+		list.push_back(value);
+	}
+	return !list.empty();
+}
+
+/**
+ * Append samples of a sine wave to the signal, continuing at the last
+ * timestamp of the signal. The phase differs for every curve.
+ */
+void append_samples(shared_ptr<AnalogTimeSignal> signal, size_t samples,
+	size_t curve)
+{
+	size_t start_pos = signal->sample_count();
+	vector<double> timestamps;
+	vector<double> values;
+	timestamps.reserve(block_size);
+	values.reserve(block_size);
+	for (size_t i = 0; i < samples; ++i) {
+		size_t pos = start_pos + i;
+		timestamps.push_back(pos / (double)samplerate);
+		values.push_back(std::sin(pos / 100. + curve) + curve);
+		if (timestamps.size() == block_size || i == samples - 1) {
+			signal->push_samples(timestamps, values, 7, 3);
+			timestamps.clear();
+			values.clear();
+		}
+	}
+}
+
+/**
+ * Create the voltage and current signals for all curves. Both signals of a
+ * curve are filled with the given number of samples.
+ */
+void create_signals(shared_ptr<sv::devices::UserDevice> device,
+	size_t points, size_t curves,
+	vector<shared_ptr<AnalogTimeSignal>> &voltage_signals,
+	vector<shared_ptr<AnalogTimeSignal>> &current_signals)
+{
+	voltage_signals.clear();
+	current_signals.clear();
+	for (size_t i = 0; i < curves; ++i) {
+		string suffix = std::to_string(i);
+		auto v_channel = device->add_user_channel("V" + suffix, "");
+		auto v_signal = static_pointer_cast<AnalogTimeSignal>(
+			v_channel->add_signal(sv::data::Quantity::Voltage,
+				set<sv::data::QuantityFlag>(), sv::data::Unit::Volt));
+		append_samples(v_signal, points, i);
+		voltage_signals.push_back(v_signal);
+
+		auto i_channel = device->add_user_channel("I" + suffix, "");
+		auto i_signal = static_pointer_cast<AnalogTimeSignal>(
+			i_channel->add_signal(sv::data::Quantity::Current,
+				set<sv::data::QuantityFlag>(), sv::data::Unit::Ampere));
+		append_samples(i_signal, points, i);
+		current_signals.push_back(i_signal);
+	}
+}
+
+/**
+ * Create a plot with one time curve per signal. The plot is not added to the
+ * frame scheduler, all frames are triggered by the benchmarks.
+ */
+Plot *create_time_plot(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+	PlotUpdateMode update_mode)
+{
+	Plot *plot = new Plot();
+	plot->set_update_mode(update_mode);
+	if (update_mode == PlotUpdateMode::Rolling)
+		plot->set_time_span(
+			signals.front()->sample_count() / (double)samplerate);
+	for (const auto &signal : signals)
+		plot->add_curve(new sv::ui::widgets::plot::TimeCurveData(signal));
+	plot->resize(plot_width, plot_height);
+	plot->show();
+	QApplication::processEvents();
+	return plot;
+}
+
+Plot *create_xy_plot(const vector<shared_ptr<AnalogTimeSignal>> &x_signals,
+	const vector<shared_ptr<AnalogTimeSignal>> &y_signals)
+{
+	Plot *plot = new Plot();
+	plot->set_update_mode(PlotUpdateMode::Additive);
+	for (size_t i = 0; i < x_signals.size(); ++i) {
+		plot->add_curve(new sv::ui::widgets::plot::XYCurveData(
+			x_signals[i], y_signals[i]));
+	}
+	plot->resize(plot_width, plot_height);
+	plot->show();
+	QApplication::processEvents();
+	return plot;
+}
+
+/**
+ * Full repaint of the plot, e.g. after an axis has been changed.
+ */
+BenchResult bench_replot(const string &name, Plot *plot,
+	size_t points, size_t curves, size_t frames)
+{
+	BenchResult result { name, points, curves, {} };
+	for (size_t frame = 0; frame < frames; ++frame) {
+		auto start = bench_clock_t::now();
+		plot->replot();
+		result.frame_ms.push_back(elapsed_ms(start));
+	}
+	return result;
+}
+
+/**
+ * A frame of the plot: New samples are appended to the signals and the
+ * plot paints the new points. Appending the samples is not timed.
+ */
+BenchResult bench_update(const string &name, Plot *plot,
+	const vector<shared_ptr<AnalogTimeSignal>> &signals,
+	size_t points, size_t frames, size_t append_samples_count)
+{
+	BenchResult result { name, points, signals.size(), {} };
+	for (size_t frame = 0; frame < frames; ++frame) {
+		for (size_t i = 0; i < signals.size(); ++i)
+			append_samples(signals[i], append_samples_count, i);
+
+		auto start = bench_clock_t::now();
+		plot->update_plot();
+		result.frame_ms.push_back(elapsed_ms(start));
+	}
+	return result;
+}
+
+/**
+ * A frame of a plot in the xy density mode: The new points are counted and
+ * the canvas is repainted (which is only scheduled by the plot).
+ */
+BenchResult bench_density_update(const string &name, Plot *plot,
+	const vector<shared_ptr<AnalogTimeSignal>> &signals,
+	size_t points, size_t frames, size_t append_samples_count)
+{
+	BenchResult result { name, points, signals.size() / 2, {} };
+	for (size_t frame = 0; frame < frames; ++frame) {
+		for (size_t i = 0; i < signals.size(); ++i)
+			append_samples(signals[i], append_samples_count, i);
+
+		auto start = bench_clock_t::now();
+		plot->update_plot();
+		QApplication::processEvents();
+		result.frame_ms.push_back(elapsed_ms(start));
+	}
+	return result;
+}
+
+/**
+ * Zoom into the plot and pan the zoomed window over the whole signal, like
+ * the mouse wheel and the plot panner do.
+ */
+BenchResult bench_zoom_pan(Plot *plot, size_t points, size_t curves,
+	size_t frames)
+{
+	BenchResult result { "plot_zoom_pan", points, curves, {} };
+	double total_time = points / (double)samplerate;
+	for (size_t frame = 0; frame < frames; ++frame) {
+		// Alternate between zooming in (10% .. 100%) and panning.
+		double width = total_time *
+			(0.1 + 0.9 * (frames - frame) / (double)frames);
+		double min = (total_time - width) * frame / (double)frames;
+
+		auto start = bench_clock_t::now();
+		plot->setAxisScale(QwtPlot::xBottom, min, min + width);
+		plot->replot();
+		result.frame_ms.push_back(elapsed_ms(start));
+	}
+	return result;
+}
+
+/**
+ * A frame of all value panels. New samples are appended between the frames.
+ */
+BenchResult bench_panel_tick(const string &name,
+	const vector<QWidget *> &views,
+	const vector<shared_ptr<AnalogTimeSignal>> &signals,
+	size_t points, size_t frames, size_t append_samples_count)
+{
+	BenchResult result { name, points, views.size(), {} };
+	for (size_t frame = 0; frame < frames; ++frame) {
+		for (size_t i = 0; i < signals.size(); ++i)
+			append_samples(signals[i], append_samples_count, i % views.size());
+
+		auto start = bench_clock_t::now();
+		for (auto &view : views) {
+			dynamic_cast<sv::ui::FrameClient *>(view)->update_frame();
+			view->repaint();
+		}
+		result.frame_ms.push_back(elapsed_ms(start));
+	}
+	return result;
+}
+
+vector<BenchResult> bench_views(sv::Session &session,
+	shared_ptr<sv::devices::UserDevice> device, size_t points, size_t curves,
+	size_t frames, size_t append_samples_count)
+{
+	vector<BenchResult> results;
+	vector<shared_ptr<AnalogTimeSignal>> voltage_signals;
+	vector<shared_ptr<AnalogTimeSignal>> current_signals;
+
+	// Time plot
+	create_signals(device, points, curves, voltage_signals, current_signals);
+	unique_ptr<Plot> plot(
+		create_time_plot(voltage_signals, PlotUpdateMode::Additive));
+	results.push_back(bench_replot(
+		"plot_replot", plot.get(), points, curves, frames));
+	results.push_back(bench_zoom_pan(plot.get(), points, curves, frames));
+	plot->replot();
+	results.push_back(bench_update("plot_update_additive", plot.get(),
+		voltage_signals, points, frames, append_samples_count));
+	plot.reset();
+
+	plot.reset(create_time_plot(voltage_signals, PlotUpdateMode::Rolling));
+	results.push_back(bench_update("plot_update_rolling", plot.get(),
+		voltage_signals, points, frames, append_samples_count));
+	plot->set_scroll_cache_enabled(false);
+	results.push_back(bench_update("plot_update_rolling_uncached",
+		plot.get(), voltage_signals, points, frames, append_samples_count));
+	plot.reset();
+
+	// XY plot
+	create_signals(device, points, curves, voltage_signals, current_signals);
+	plot.reset(create_xy_plot(voltage_signals, current_signals));
+	results.push_back(bench_replot(
+		"xy_plot_replot", plot.get(), points, curves, frames));
+	vector<shared_ptr<AnalogTimeSignal>> xy_signals;
+	for (size_t i = 0; i < curves; ++i) {
+		xy_signals.push_back(voltage_signals[i]);
+		xy_signals.push_back(current_signals[i]);
+	}
+	results.push_back(bench_update("xy_plot_update", plot.get(),
+		xy_signals, points, frames, append_samples_count));
+	plot->set_xy_render_mode(XYRenderMode::Density);
+	results.push_back(bench_replot(
+		"xy_density_replot", plot.get(), points, curves, frames));
+	plot->replot();
+	results.push_back(bench_density_update("xy_density_update", plot.get(),
+		xy_signals, points, frames, append_samples_count));
+	plot.reset();
+
+	// Value panels, one per curve
+	vector<QWidget *> views;
+	for (const auto &signal : voltage_signals) {
+		views.push_back(new sv::ui::views::ValuePanelView(session, signal));
+		views.back()->show();
+	}
+	QApplication::processEvents();
+	results.push_back(bench_panel_tick("value_panel_tick", views,
+		voltage_signals, points, frames, append_samples_count));
+	for (auto &view : views)
+		delete view;
+	views.clear();
+
+	// Power panels, one per curve
+	for (size_t i = 0; i < curves; ++i) {
+		views.push_back(new sv::ui::views::PowerPanelView(
+			session, voltage_signals[i], current_signals[i]));
+		views.back()->show();
+	}
+	QApplication::processEvents();
+	results.push_back(bench_panel_tick("power_panel_tick", views,
+		xy_signals, points, frames, append_samples_count));
+	for (auto &view : views)
+		delete view;
+
+	return results;
+}
+
+/**
+ * Return the percentile of the sorted frame times, nearest rank method.
+ */
+double percentile(const vector<double> &sorted_ms, double percent)
+{
+	if (sorted_ms.empty())
+		return 0.;
+	size_t rank = (size_t)std::ceil(percent / 100. * sorted_ms.size());
+	if (rank < 1)
+		rank = 1;
+	return sorted_ms[rank - 1];
+}
+
+string to_json(const vector<BenchResult> &results)
+{
+	ostringstream json;
+	json << "{\n";
+	json << "  \"version\": \"" << SV_VERSION_STRING << "\",\n";
+	json << "  \"platform\": \"" <<
+		QApplication::platformName().toStdString() << "\",\n";
+	json << "  \"width\": " << plot_width << ",\n";
+	json << "  \"height\": " << plot_height << ",\n";
+	json << "  \"benchmarks\": [\n";
+	for (size_t i = 0; i < results.size(); ++i) {
+		const auto &result = results[i];
+		vector<double> sorted_ms = result.frame_ms;
+		std::sort(sorted_ms.begin(), sorted_ms.end());
+		double sum = 0.;
+		for (const auto &ms : sorted_ms)
+			sum += ms;
+		double mean = sorted_ms.empty() ? 0. : sum / sorted_ms.size();
+		double max = sorted_ms.empty() ? 0. : sorted_ms.back();
+
+		json << "    { \"name\": \"" << result.name << "\", " <<
+			"\"points\": " << result.points << ", " <<
+			"\"curves\": " << result.curves << ", " <<
+			"\"frames\": " << sorted_ms.size() << ", " <<
+			"\"mean_ms\": " << mean << ", " <<
+			"\"p50_ms\": " << percentile(sorted_ms, 50.) << ", " <<
+			"\"p90_ms\": " << percentile(sorted_ms, 90.) << ", " <<
+			"\"p99_ms\": " << percentile(sorted_ms, 99.) << ", " <<
+			"\"max_ms\": " << max << " }";
+		if (i < results.size() - 1)
+			json << ",";
+		json << "\n";
+	}
+	json << "  ]\n";
+	json << "}\n";
+	return json.str();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+	vector<size_t> points_list { 1000, 100000 };
+	vector<size_t> curves_list { 1, 8 };
+	size_t frames = 50;
+	size_t append_samples_count = 200;
+	string output_file;
+
+	// Render offscreen, unless a platform is explicitly requested.
+	if (qgetenv("QT_QPA_PLATFORM").isEmpty())
+		qputenv("QT_QPA_PLATFORM", "offscreen");
+
+	QApplication app(argc, argv);
+
+	// Parse arguments
+	while (true) {
+		static const struct option long_options[] = {
+			{ "help", no_argument, nullptr, 'h' },
+			{ "points", required_argument, nullptr, 'n' },
+			{ "curves", required_argument, nullptr, 'c' },
+			{ "frames", required_argument, nullptr, 'f' },
+			{ "append", required_argument, nullptr, 'a' },
+			{ "output", required_argument, nullptr, 'o' },
+			{ "verbose", no_argument, nullptr, 'v' },
+			{ nullptr, 0, nullptr, 0 }
+		};
+
+		const int c = getopt_long(argc, argv,
+			"h?n:c:f:a:o:v", long_options, nullptr);
+		if (c == -1)
+			break;
+
+		switch (c) {
+		case 'n':
+			if (!parse_list(optarg, points_list)) {
+				usage();
+				return 1;
+			}
+			break;
+		case 'c':
+			if (!parse_list(optarg, curves_list)) {
+				usage();
+				return 1;
+			}
+			break;
+		case 'f':
+			frames = std::strtoull(optarg, nullptr, 10);
+			break;
+		case 'a':
+			append_samples_count = std::strtoull(optarg, nullptr, 10);
+			break;
+		case 'o':
+			output_file = optarg;
+			break;
+		case 'v':
+			verbose = true;
+			break;
+		case 'h':
+		case '?':
+		default:
+			usage();
+			return 0;
+		}
+	}
+	if (frames < 1 || append_samples_count < 1) {
+		usage();
+		return 1;
+	}
+	for (const auto &points : points_list) {
+		if (points < 2) {
+			usage();
+			return 1;
+		}
+	}
+
+	qInstallMessageHandler(message_handler);
+
+	auto context = sigrok::Context::create();
+	sv::Session::sr_context = context;
+	sv::Session::session_start_timestamp = 0.;
+	sv::DeviceManager device_manager(context, vector<string>(), false);
+	sv::Session session(device_manager, nullptr);
+
+	vector<BenchResult> results;
+	for (const auto &points : points_list) {
+		for (const auto &curves : curves_list) {
+			// A new device per run, so the signals of the previous run
+			// are freed.
+			auto device = make_shared<sv::devices::UserDevice>(
+				context, "SmuView", "Benchmark", SV_VERSION_STRING);
+			for (const auto &result : bench_views(session, device,
+					points, curves, frames, append_samples_count))
+				results.push_back(result);
+		}
+	}
+
+	string json = to_json(results);
+	if (output_file.empty()) {
+		std::cout << json;
+	}
+	else {
+		std::ofstream output(output_file);
+		output << json;
+	}
+
+	return 0;
+}
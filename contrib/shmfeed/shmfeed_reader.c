@@ -0,0 +1,215 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Example reader for the SmuView shared memory sample feed.
+ *
+ * List the published signals:
+ *   smuview_shmfeed_reader -c /run/user/1000/smuview-1234.sock
+ *
+ * Print the samples of a signal (-n stops after n samples):
+ *   smuview_shmfeed_reader -s /smuview-1234-0 [-n 1000] [-q]
+ *
+ * With -q, no samples are printed, only the sample rate and the number of
+ * overrun (lost) samples once per second.
+ */
+
+#include <fcntl.h>
+#include <getopt.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "src/data/shmfeedformat.h"
+
+static int usage(const char *name)
+{
+	fprintf(stderr, "Usage: %s -c <socket> | "
+		"-s <shm name> [-n <count>] [-q]\n", name);
+	return 1;
+}
+
+static int print_catalogue(const char *socket_path)
+{
+	struct sockaddr_un addr;
+	char buf[4096];
+	ssize_t n;
+	int fd;
+
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strncpy(addr.sun_path, socket_path, sizeof(addr.sun_path) - 1);
+
+	fd = socket(AF_UNIX, SOCK_STREAM, 0);
+	if (fd < 0 || connect(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0) {
+		perror("connect");
+		return 1;
+	}
+	while ((n = read(fd, buf, sizeof(buf))) > 0)
+		fwrite(buf, 1, n, stdout);
+	close(fd);
+
+	return 0;
+}
+
+static double now(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+static int read_samples(const char *shm_name, uint64_t max_count, int quiet)
+{
+	struct sv_shmfeed_header *header;
+	struct sv_shmfeed_sample *ring, *buf;
+	struct stat st;
+	uint64_t capacity, mask, read_index, write_index, first_valid, i;
+	uint64_t count = 0, rate_count = 0, lost = 0;
+	double rate_start;
+	void *addr;
+	int fd;
+
+	fd = shm_open(shm_name, O_RDONLY, 0);
+	if (fd < 0 || fstat(fd, &st) < 0) {
+		perror("shm_open");
+		return 1;
+	}
+	addr = mmap(NULL, st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (addr == MAP_FAILED) {
+		perror("mmap");
+		return 1;
+	}
+
+	header = addr;
+	if (__atomic_load_n(&header->magic, __ATOMIC_ACQUIRE) !=
+			SV_SHMFEED_MAGIC || header->version != SV_SHMFEED_VERSION) {
+		fprintf(stderr, "%s is not a SmuView feed (version %d)\n",
+			shm_name, SV_SHMFEED_VERSION);
+		return 1;
+	}
+	capacity = header->capacity;
+	mask = capacity - 1;
+	ring = (struct sv_shmfeed_sample *)((char *)addr + header->ring_offset);
+	buf = malloc(capacity * sizeof(*buf));
+	if (!buf)
+		return 1;
+
+	fprintf(stderr, "%s: %s %s [%s], %llu samples\n", shm_name,
+		header->device, header->name, header->unit,
+		(unsigned long long)capacity);
+
+	/* Start with the newest sample. */
+	read_index = __atomic_load_n(&header->write_count, __ATOMIC_ACQUIRE);
+	rate_start = now();
+	while (max_count == 0 || count < max_count) {
+		write_index = __atomic_load_n(&header->write_count, __ATOMIC_ACQUIRE);
+		if (write_index == read_index) {
+			usleep(1000);
+			continue;
+		}
+		if (write_index - read_index > capacity) {
+			lost += write_index - capacity - read_index;
+			read_index = write_index - capacity;
+		}
+
+		for (i = read_index; i < write_index; ++i)
+			buf[i - read_index] = ring[i & mask];
+
+		/*
+		 * Discard the samples, that were (or are being) overwritten while
+		 * copying. The fence keeps the copies before the load.
+		 */
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		first_valid = __atomic_load_n(&header->write_begin, __ATOMIC_RELAXED);
+		first_valid = first_valid > capacity ? first_valid - capacity : 0;
+		if (first_valid > read_index) {
+			lost += first_valid - read_index;
+			i = first_valid - read_index;
+		}
+		else {
+			i = 0;
+		}
+
+		for (; i < write_index - read_index; ++i) {
+			if (max_count > 0 && count >= max_count)
+				break;
+			if (!quiet)
+				printf("%.6f\t%.9g\n", buf[i].timestamp, buf[i].value);
+			++count;
+			++rate_count;
+		}
+		read_index = write_index;
+
+		if (quiet && now() - rate_start >= 1.) {
+			fprintf(stderr, "%.0f samples/s, %llu lost\n",
+				rate_count / (now() - rate_start),
+				(unsigned long long)lost);
+			rate_count = 0;
+			rate_start = now();
+		}
+	}
+
+	free(buf);
+	munmap(addr, st.st_size);
+
+	return 0;
+}
+
+int main(int argc, char *argv[])
+{
+	const char *socket_path = NULL, *shm_name = NULL;
+	uint64_t max_count = 0;
+	int quiet = 0;
+	int c;
+
+	while ((c = getopt(argc, argv, "c:s:n:qh")) != -1) {
+		switch (c) {
+		case 'c':
+			socket_path = optarg;
+			break;
+		case 's':
+			shm_name = optarg;
+			break;
+		case 'n':
+			max_count = strtoull(optarg, NULL, 10);
+			break;
+		case 'q':
+			quiet = 1;
+			break;
+		default:
+			return usage(argv[0]);
+		}
+	}
+
+	if (socket_path)
+		return print_catalogue(socket_path);
+	if (shm_name)
+		return read_samples(shm_name, max_count, quiet);
+
+	return usage(argv[0]);
+}
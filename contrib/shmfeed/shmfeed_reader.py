@@ -0,0 +1,182 @@
+#!/usr/bin/env python3
+##
+## This file is part of the SmuView project.
+##
+## Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+##
+## This program is free software: you can redistribute it and/or modify
+## it under the terms of the GNU General Public License as published by
+## the Free Software Foundation, either version 3 of the License, or
+## (at your option) any later version.
+##
+## This program is distributed in the hope that it will be useful,
+## but WITHOUT ANY WARRANTY; without even the implied warranty of
+## MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+## GNU General Public License for more details.
+##
+## You should have received a copy of the GNU General Public License
+## along with this program.  If not, see <http://www.gnu.org/licenses/>.
+##
+
+"""
+Example reader for the SmuView shared memory sample feed (Linux, Python 3).
+See src/data/shmfeedformat.h for the layout.
+
+List the published signals:
+    shmfeed_reader.py -c /run/user/1000/smuview-1234.sock
+
+Print the samples of a signal:
+    shmfeed_reader.py -s /smuview-1234-0 [-n 1000]
+
+Use as a module:
+    feed = ShmFeedReader("/smuview-1234-0")
+    for timestamp, value in feed.read():
+        ...
+"""
+
+import argparse
+import mmap
+import os
+import socket
+import struct
+import sys
+import time
+
+MAGIC = 0x46534d53
+VERSION = 2
+NAME_SIZE = 128
+UNIT_SIZE = 32
+
+# struct sv_shmfeed_header
+HEADER = struct.Struct("=IIQQQQd%ds%ds%ds%ds" % (
+    NAME_SIZE, NAME_SIZE, UNIT_SIZE, UNIT_SIZE))
+COUNTER = struct.Struct("=Q")
+WRITE_COUNT_OFFSET = 24
+WRITE_BEGIN_OFFSET = 32
+SAMPLE = struct.Struct("=dd")
+
+
+def read_catalogue(socket_path):
+    """Return the published signals as list of dicts."""
+    sock = socket.socket(socket.AF_UNIX, socket.SOCK_STREAM)
+    sock.connect(socket_path)
+    data = b""
+    while True:
+        chunk = sock.recv(4096)
+        if not chunk:
+            break
+        data += chunk
+    sock.close()
+
+    lines = data.decode().split("\n")
+    if not lines[0].startswith("smuview-shmfeed "):
+        raise ValueError("Not a SmuView feed socket")
+    signals = []
+    for line in lines[1:]:
+        if not line:
+            break
+        shm_name, capacity, quantity, unit, device, name = line.split("\t")
+        signals.append({"shm_name": shm_name, "capacity": int(capacity),
+                        "quantity": quantity, "unit": unit,
+                        "device": device, "name": name})
+    return signals
+
+
+class ShmFeedReader:
+    """Reads the samples of one published signal."""
+
+    def __init__(self, shm_name):
+        # POSIX shared memory objects are files in /dev/shm on Linux.
+        fd = os.open("/dev/shm/" + shm_name.lstrip("/"), os.O_RDONLY)
+        try:
+            self._mm = mmap.mmap(fd, 0, mmap.MAP_SHARED, mmap.PROT_READ)
+        finally:
+            os.close(fd)
+
+        (magic, version, self.capacity, self._ring_offset, _, _,
+         self.session_start_timestamp, device, name, quantity,
+         unit) = HEADER.unpack_from(self._mm, 0)
+        if magic != MAGIC or version != VERSION:
+            raise ValueError("%s is not a SmuView feed" % shm_name)
+        self.device = device.split(b"\0", 1)[0].decode()
+        self.name = name.split(b"\0", 1)[0].decode()
+        self.quantity = quantity.split(b"\0", 1)[0].decode()
+        self.unit = unit.split(b"\0", 1)[0].decode()
+        self._mask = self.capacity - 1
+        self.lost = 0
+        # Start with the newest sample.
+        self._read_index = self._write_count()
+
+    def _write_count(self):
+        # An aligned 8 byte load is atomic on x86-64 and aarch64.
+        return COUNTER.unpack_from(self._mm, WRITE_COUNT_OFFSET)[0]
+
+    def _write_begin(self):
+        return COUNTER.unpack_from(self._mm, WRITE_BEGIN_OFFSET)[0]
+
+    def read(self):
+        """Return the new samples as list of (timestamp, value) tuples."""
+        write_index = self._write_count()
+        read_index = self._read_index
+        if write_index - read_index > self.capacity:
+            self.lost += write_index - self.capacity - read_index
+            read_index = write_index - self.capacity
+
+        samples = []
+        for i in range(read_index, write_index):
+            offset = self._ring_offset + (i & self._mask) * SAMPLE.size
+            samples.append(SAMPLE.unpack_from(self._mm, offset))
+
+        # Discard the samples, that were (or are being) overwritten while
+        # copying. Python has no memory fences, this relies on the loads
+        # being done in program order (x86-64). On weakly ordered CPUs like
+        # aarch64, use the C reader.
+        first_valid = self._write_begin() - self.capacity
+        if first_valid > read_index:
+            self.lost += first_valid - read_index
+            samples = samples[first_valid - read_index:]
+
+        self._read_index = write_index
+        return samples
+
+    def close(self):
+        self._mm.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Read the SmuView shared memory sample feed.")
+    group = parser.add_mutually_exclusive_group(required=True)
+    group.add_argument("-c", "--catalogue", metavar="SOCKET",
+                       help="list the published signals")
+    group.add_argument("-s", "--shm", metavar="NAME",
+                       help="print the samples of a signal")
+    parser.add_argument("-n", "--count", type=int, default=0,
+                        help="stop after COUNT samples")
+    args = parser.parse_args()
+
+    if args.catalogue:
+        for signal in read_catalogue(args.catalogue):
+            print("%(shm_name)s\t%(device)s\t%(name)s [%(unit)s]" % signal)
+        return 0
+
+    reader = ShmFeedReader(args.shm)
+    print("%s: %s %s [%s], %d samples" % (args.shm, reader.device,
+          reader.name, reader.unit, reader.capacity), file=sys.stderr)
+    count = 0
+    while args.count == 0 or count < args.count:
+        samples = reader.read()
+        if not samples:
+            time.sleep(0.001)
+            continue
+        if args.count > 0:
+            samples = samples[:args.count - count]
+        for timestamp, value in samples:
+            print("%.6f\t%.9g" % (timestamp, value))
+        count += len(samples)
+    reader.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -18,7 +18,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstring>
 #include <getopt.h>
+#include <memory>
 #include <unistd.h>
 
 #include <libsigrokcxx/libsigrokcxx.hpp>
@@ -30,6 +32,7 @@
 #include "config.h"
 #include "src/application.hpp"
 #include "src/devicemanager.hpp"
+#include "src/headlessrunner.hpp"
 #include "src/session.hpp"
 #include "src/mainwindow.hpp"
 
@@ -46,6 +49,7 @@ Q_IMPORT_PLUGIN(QSvgPlugin)
 using std::exception;
 using std::shared_ptr;
 using std::string;
+using std::unique_ptr;
 using std::vector;
 
 void usage()
@@ -63,6 +67,11 @@ void usage()
 		"  -d, --driver               Specify the device driver(s) to use\n"
 		"  -D, --dont-scan            Don't auto-scan for devices, use -d spec only\n"
 		"  -s, --script               Specify the SmuScript to load and execute\n"
+		"  -H, --headless             Run without the graphical user interface\n"
+		"  -o, --output               Save all signals to a CSV file on exit\n"
+		"                             (headless mode only)\n"
+		"  -t, --duration             Acquisition time in seconds\n"
+		"                             (headless mode only)\n"
 		/* Disable cmd line options i, I and c
 		"  -i, --input-file           Load input from file\n"
 		"  -I, --input-format         Input format\n"
@@ -76,8 +85,11 @@ void usage()
 		"\n"
 		"  %s --driver voltcraft-k204:conn=/dev/ttyUSB0 \\\n"
 		"     --driver uni-t-ut61d:conn=1a86.e008 \\\n"
-		"     --driver uni-t-ut61e-ser:conn=/dev/ttyUSB1\n",
-		SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME);
+		"     --driver uni-t-ut61e-ser:conn=/dev/ttyUSB1\n"
+		"\n"
+		"  %s --headless --driver uni-t-ut61e:conn=1a86.e008 \\\n"
+		"     --duration 3600 --output log.csv\n",
+		SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME, SV_BIN_NAME);
 }
 
 int main(int argc, char *argv[])
@@ -89,8 +101,22 @@ int main(int argc, char *argv[])
 	bool restore_session = true;
 	bool do_scan = true;
 	string script_file;
+	bool headless = false;
+	string output_file;
+	double duration = 0;
+
+	// The application type must be known before the arguments are parsed.
+	for (int i = 1; i < argc; ++i) {
+		if (strcmp(argv[i], "-H") == 0 || strcmp(argv[i], "--headless") == 0)
+			headless = true;
+	}
 
-	Application app(argc, argv);
+	// No widgets and no window system in headless mode.
+	unique_ptr<QCoreApplication> app;
+	if (headless)
+		app.reset(new HeadlessApplication(argc, argv));
+	else
+		app.reset(new Application(argc, argv));
 
 	// Parse arguments
 	while (true) {
@@ -101,6 +127,9 @@ int main(int argc, char *argv[])
 			{ "driver", required_argument, nullptr, 'd' },
 			{ "dont-scan", no_argument, nullptr, 'D' },
 			{ "script", required_argument, nullptr, 's' },
+			{ "headless", no_argument, nullptr, 'H' },
+			{ "output", required_argument, nullptr, 'o' },
+			{ "duration", required_argument, nullptr, 't' },
 			/* Disable cmd line options i, I and c
 			{ "input-file", required_argument, nullptr, 'i' },
 			{ "input-format", required_argument, nullptr, 'I' },
@@ -114,7 +143,7 @@ int main(int argc, char *argv[])
 			"l:Vhc?d:i:I:", long_options, nullptr);
 		*/
 		const int c = getopt_long(argc, argv,
-			"h?VDl:d:s:", long_options, nullptr);
+			"h?VDl:d:s:Ho:t:", long_options, nullptr);
 
 		if (c == -1)
 			break;
@@ -155,6 +184,18 @@ int main(int argc, char *argv[])
 			script_file = optarg;
 			break;
 
+		case 'H':
+			// Already handled above
+			break;
+
+		case 'o':
+			output_file = optarg;
+			break;
+
+		case 't':
+			duration = atof(optarg);
+			break;
+
 		/* Disable cmd line options i, I and c
 		case 'i':
 			open_file = optarg;
@@ -193,6 +234,32 @@ int main(int argc, char *argv[])
 			// Create the device manager, initialise the drivers
 			sv::DeviceManager device_manager(context, drivers, do_scan);
 
+			if (headless) {
+				sv::HeadlessRunner runner(device_manager);
+				runner.set_duration(duration);
+				runner.set_output_file(output_file, ",");
+				runner.start(script_file);
+
+#ifdef ENABLE_SIGNALS
+				if (SignalHandler::prepare_signals()) {
+					SignalHandler *const handler =
+						new SignalHandler(&runner);
+					QObject::connect(handler,
+						SIGNAL(int_received()),
+						&runner, SLOT(quit()));
+					QObject::connect(handler,
+						SIGNAL(term_received()),
+						&runner, SLOT(quit()));
+				}
+				else {
+					qWarning() << "Could not prepare signal handler.";
+				}
+#endif
+
+				ret = app->exec();
+				break;
+			}
+
 			// TODO: Init session here!
 
 			// Initialise the main window
@@ -227,7 +294,7 @@ int main(int argc, char *argv[])
 #endif
 
 			// Run the application
-			ret = app.exec();
+			ret = app->exec();
 		}
 		catch (exception &e) {
 			 qCritical() << "main() failed: " << e.what();
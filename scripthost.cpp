@@ -0,0 +1,441 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * smuview-scripthost runs a SmuScript in its own process and talks to
+ * SmuView over the protocol in src/python/scripthostprotocol.hpp. The script
+ * gets the module "smuview_host" instead of the full "smuview" bindings.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#include <pybind11/stl.h>
+
+#include <QByteArray>
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLocalSocket>
+#include <QString>
+
+#include "src/data/shmfeedformat.h"
+#include "src/python/scripthostprotocol.hpp"
+
+using std::invalid_argument;
+using std::runtime_error;
+using std::string;
+using std::vector;
+
+namespace py = pybind11;
+
+/** A double array, that is converted from any sequence of numbers. */
+typedef py::array_t<double, py::array::c_style | py::array::forcecast>
+	double_array;
+
+namespace {
+
+/**
+ * The connection to the ScriptHostServer of SmuView. The requests are
+ * synchronous, the GIL is released while waiting for the reply.
+ *
+ * The connection is created in main() after the QCoreApplication and is
+ * destroyed before it, the bindings use it via instance().
+ */
+class HostConnection
+{
+public:
+	HostConnection() : last_id_(0)
+	{
+		current_ = this;
+	}
+
+	~HostConnection()
+	{
+		current_ = nullptr;
+	}
+
+	HostConnection(const HostConnection &) = delete;
+	HostConnection &operator=(const HostConnection &) = delete;
+
+	static HostConnection &instance()
+	{
+		if (!current_)
+			throw runtime_error("Not connected to SmuView");
+		return *current_;
+	}
+
+	void connect(const QString &server_name, const QString &token)
+	{
+		socket_.connectToServer(server_name);
+		if (!socket_.waitForConnected())
+			throw runtime_error("Can't connect to SmuView: " +
+				socket_.errorString().toStdString());
+
+		QJsonObject params;
+		params["token"] = token;
+		request("hello", params);
+	}
+
+	/** Send a request with an optional binary payload, wait for the reply. */
+	QJsonValue request(const QString &method,
+		const QJsonObject &params = QJsonObject(),
+		const QByteArray &payload = QByteArray())
+	{
+		QJsonObject request;
+		request["id"] = ++last_id_;
+		request["method"] = method;
+		request["params"] = params;
+		if (!payload.isEmpty())
+			request["payload"] = payload.size();
+
+		py::gil_scoped_release release;
+		socket_.write(
+			QJsonDocument(request).toJson(QJsonDocument::Compact) + '\n');
+		if (!payload.isEmpty())
+			socket_.write(payload);
+		if (!socket_.waitForBytesWritten())
+			throw runtime_error("Lost the connection to SmuView");
+
+		int pos;
+		while ((pos = buffer_.indexOf('\n')) < 0) {
+			if (!socket_.waitForReadyRead(-1))
+				throw runtime_error("Lost the connection to SmuView");
+			buffer_.append(socket_.readAll());
+		}
+		QJsonObject reply = QJsonDocument::fromJson(buffer_.left(pos)).
+			object();
+		buffer_.remove(0, pos + 1);
+
+		if (reply.contains("error"))
+			throw runtime_error(reply.value("error").toString().toStdString());
+		return reply.value("result");
+	}
+
+private:
+	static HostConnection *current_;
+
+	QLocalSocket socket_;
+	QByteArray buffer_;
+	int last_id_;
+};
+
+HostConnection *HostConnection::current_ = nullptr;
+
+py::object to_python(const QJsonValue &value)
+{
+	switch (value.type()) {
+	case QJsonValue::Bool:
+		return py::bool_(value.toBool());
+	case QJsonValue::Double:
+		return py::float_(value.toDouble());
+	case QJsonValue::String:
+		return py::str(value.toString().toStdString());
+	case QJsonValue::Array: {
+		py::list list;
+		for (const auto &item : value.toArray())
+			list.append(to_python(item));
+		return list;
+	}
+	case QJsonValue::Object: {
+		py::dict dict;
+		QJsonObject object = value.toObject();
+		for (auto it = object.begin(); it != object.end(); ++it)
+			dict[py::str(it.key().toStdString())] = to_python(it.value());
+		return dict;
+	}
+	default:
+		return py::none();
+	}
+}
+
+QJsonValue from_python(const py::handle &value)
+{
+	if (py::isinstance<py::bool_>(value))
+		return value.cast<bool>();
+	if (py::isinstance<py::int_>(value) || py::isinstance<py::float_>(value))
+		return value.cast<double>();
+	if (py::isinstance<py::str>(value))
+		return QString::fromStdString(value.cast<string>());
+	if (py::isinstance<py::list>(value) || py::isinstance<py::tuple>(value)) {
+		QJsonArray array;
+		for (const auto &item : value)
+			array.append(from_python(item));
+		return array;
+	}
+	throw runtime_error("Unsupported value type");
+}
+
+QJsonObject property_params(const string &device, const string &configurable,
+	const string &config_key)
+{
+	QJsonObject params;
+	params["device"] = QString::fromStdString(device);
+	params["configurable"] = QString::fromStdString(configurable);
+	params["config_key"] = QString::fromStdString(config_key);
+	return params;
+}
+
+/**
+ * Reads the samples of a signal from its shared memory ring (see
+ * shmfeedformat.h for the algorithm).
+ */
+class SignalReader
+{
+public:
+	SignalReader(const string &shm_name) :
+		shm_name_(shm_name),
+		addr_(MAP_FAILED),
+		map_size_(0),
+		lost_(0)
+	{
+		int fd = shm_open(shm_name.c_str(), O_RDONLY, 0);
+		struct stat st;
+		if (fd < 0 || fstat(fd, &st) < 0) {
+			if (fd >= 0)
+				close(fd);
+			throw runtime_error("Can't open the shared memory " + shm_name);
+		}
+		map_size_ = (size_t)st.st_size;
+		addr_ = mmap(nullptr, map_size_, PROT_READ, MAP_SHARED, fd, 0);
+		close(fd);
+		if (addr_ == MAP_FAILED)
+			throw runtime_error("Can't map the shared memory " + shm_name);
+
+		header_ = static_cast<const sv_shmfeed_header *>(addr_);
+		if (__atomic_load_n(&header_->magic, __ATOMIC_ACQUIRE) !=
+				SV_SHMFEED_MAGIC || header_->version != SV_SHMFEED_VERSION) {
+			munmap(addr_, map_size_);
+			throw runtime_error(shm_name + " is not a SmuView feed");
+		}
+		ring_ = reinterpret_cast<const sv_shmfeed_sample *>(
+			static_cast<const char *>(addr_) + header_->ring_offset);
+
+		// Start with the oldest sample, that is still in the ring.
+		uint64_t write_count = load_write_count();
+		read_index_ = write_count > header_->capacity ?
+			write_count - header_->capacity : 0;
+	}
+
+	~SignalReader()
+	{
+		if (addr_ != MAP_FAILED)
+			munmap(addr_, map_size_);
+	}
+
+	SignalReader(const SignalReader &) = delete;
+	SignalReader &operator=(const SignalReader &) = delete;
+
+	/**
+	 * Return the new samples since the last call as a tuple of two NumPy
+	 * arrays (time stamps, values).
+	 */
+	py::tuple read()
+	{
+		const uint64_t capacity = header_->capacity;
+		const uint64_t mask = capacity - 1;
+
+		uint64_t write_index = load_write_count();
+		if (write_index - read_index_ > capacity) {
+			lost_ += write_index - capacity - read_index_;
+			read_index_ = write_index - capacity;
+		}
+		buffer_.resize(write_index - read_index_);
+		for (uint64_t i = read_index_; i < write_index; ++i)
+			buffer_[i - read_index_] = ring_[i & mask];
+
+		// Discard the samples, that were (or are being) overwritten while
+		// copying. The fence keeps the copies before the load.
+		__atomic_thread_fence(__ATOMIC_ACQUIRE);
+		uint64_t first_valid =
+			__atomic_load_n(&header_->write_begin, __ATOMIC_RELAXED);
+		first_valid = first_valid > capacity ? first_valid - capacity : 0;
+		size_t first = 0;
+		if (first_valid > read_index_) {
+			lost_ += first_valid - read_index_;
+			first = first_valid - read_index_;
+		}
+		read_index_ = write_index;
+
+		const size_t count = buffer_.size() - first;
+		py::array_t<double> timestamps(count);
+		py::array_t<double> values(count);
+		double *timestamps_data = timestamps.mutable_data();
+		double *values_data = values.mutable_data();
+		for (size_t i = 0; i < count; ++i) {
+			timestamps_data[i] = buffer_[first + i].timestamp;
+			values_data[i] = buffer_[first + i].value;
+		}
+		return py::make_tuple(timestamps, values);
+	}
+
+	/** The number of samples, that were overwritten before they were read. */
+	uint64_t lost() const { return lost_; }
+	string device() const { return header_->device; }
+	string name() const { return header_->name; }
+	string quantity() const { return header_->quantity; }
+	string unit() const { return header_->unit; }
+
+private:
+	uint64_t load_write_count() const
+	{
+		return __atomic_load_n(&header_->write_count, __ATOMIC_ACQUIRE);
+	}
+
+	string shm_name_;
+	void *addr_;
+	size_t map_size_;
+	const sv_shmfeed_header *header_;
+	const sv_shmfeed_sample *ring_;
+	uint64_t read_index_;
+	uint64_t lost_;
+	vector<sv_shmfeed_sample> buffer_;
+};
+
+}
+
+PYBIND11_EMBEDDED_MODULE(smuview_host, m) {
+	m.doc() = "The SmuView API for scripts, that run in the script host.";
+
+	py::class_<SignalReader> py_signal_reader(m, "SignalReader");
+	py_signal_reader.doc() = "Reads the samples of a subscribed signal.";
+	py_signal_reader.def("read", &SignalReader::read,
+		"Return the new samples as tuple (timestamps, values).");
+	py_signal_reader.def_property_readonly("lost", &SignalReader::lost,
+		"The number of samples, that were overwritten before they were read.");
+	py_signal_reader.def_property_readonly("device", &SignalReader::device);
+	py_signal_reader.def_property_readonly("name", &SignalReader::name);
+	py_signal_reader.def_property_readonly("quantity", &SignalReader::quantity);
+	py_signal_reader.def_property_readonly("unit", &SignalReader::unit);
+
+	m.def("signals", []() {
+		return to_python(HostConnection::instance().request("signals"));
+	}, "Return a list with all analog signals of SmuView.");
+
+	m.def("open_signal", [](const string &device, const string &channel,
+			const string &signal, size_t capacity) {
+		QJsonObject params;
+		params["device"] = QString::fromStdString(device);
+		params["channel"] = QString::fromStdString(channel);
+		params["signal"] = QString::fromStdString(signal);
+		params["capacity"] = (double)capacity;
+		QJsonObject result = HostConnection::instance().request(
+			"subscribe", params).toObject();
+		return std::unique_ptr<SignalReader>(new SignalReader(
+			result.value("shm_name").toString().toStdString()));
+	}, py::arg("device"), py::arg("channel"), py::arg("signal"),
+		py::arg("capacity") = 0,
+		"Subscribe a signal and return a SignalReader for its samples.");
+
+	m.def("get_property", [](const string &device, const string &configurable,
+			const string &config_key) {
+		return to_python(HostConnection::instance().request("get_property",
+			property_params(device, configurable, config_key)));
+	}, py::arg("device"), py::arg("configurable"), py::arg("config_key"),
+		"Return the value of a property of a configurable.");
+
+	m.def("set_property", [](const string &device, const string &configurable,
+			const string &config_key, py::object value) {
+		QJsonObject params = property_params(device, configurable, config_key);
+		params["value"] = from_python(value);
+		HostConnection::instance().request("set_property", params);
+	}, py::arg("device"), py::arg("configurable"), py::arg("config_key"),
+		py::arg("value"), "Set the value of a property of a configurable.");
+
+	m.def("push_samples", [](const string &channel, const string &quantity,
+			const string &unit, const double_array &timestamps,
+			const double_array &values, int digits, int decimal_places) {
+		if (timestamps.ndim() != 1 || values.ndim() != 1 ||
+				timestamps.size() != values.size())
+			throw invalid_argument(
+				"timestamps and values must have the same length");
+
+		QJsonObject params;
+		params["channel"] = QString::fromStdString(channel);
+		params["quantity"] = QString::fromStdString(quantity);
+		params["unit"] = QString::fromStdString(unit);
+		params["count"] = (double)timestamps.size();
+		if (digits >= 0 && decimal_places >= 0) {
+			params["digits"] = digits;
+			params["decimal_places"] = decimal_places;
+		}
+
+		// The samples are sent as binary payload, see scripthostprotocol.hpp
+		const size_t size = timestamps.size() * sizeof(double);
+		QByteArray payload(2 * (int)size, Qt::Uninitialized);
+		std::memcpy(payload.data(), timestamps.data(), size);
+		std::memcpy(payload.data() + size, values.data(), size);
+		HostConnection::instance().request("push_samples", params, payload);
+	}, py::arg("channel"), py::arg("quantity"), py::arg("unit"),
+		py::arg("timestamps"), py::arg("values"), py::arg("digits") = -1,
+		py::arg("decimal_places") = -1,
+		"Add samples to a channel of the user device of this script. "
+		"digits and decimal_places are needed for a new channel.");
+}
+
+int main(int argc, char *argv[])
+{
+	QCoreApplication app(argc, argv);
+
+	if (argc != 2) {
+		fprintf(stderr, "Usage: %s SCRIPT\n", argv[0]);
+		return 2;
+	}
+	const char *server_name = getenv(SV_SCRIPTHOST_SOCKET_ENV);
+	const char *token = getenv(SV_SCRIPTHOST_TOKEN_ENV);
+	if (!server_name || !token) {
+		fprintf(stderr, "%s must be started by SmuView\n", argv[0]);
+		return 2;
+	}
+
+	// The interpreter is finalized before the connection and the connection
+	// is closed before the application is destroyed.
+	HostConnection connection;
+	py::scoped_interpreter guard{};
+	try {
+		connection.connect(
+			QString::fromLocal8Bit(server_name), QString::fromLocal8Bit(token));
+		py::eval_file(argv[1], py::globals());
+	}
+	catch (py::error_already_set &e) {
+		// Print the traceback to stderr, like the python interpreter does.
+		e.restore();
+		PyErr_Print();
+		return 1;
+	}
+	catch (const std::exception &e) {
+		fprintf(stderr, "%s\n", e.what());
+		return 1;
+	}
+
+	return 0;
+}
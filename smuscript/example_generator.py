@@ -0,0 +1,41 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2019-2020 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+import smuview
+import time
+
+# Add a generator device with 4 channels, 10 kS/s per channel in 100 packets
+# per second.
+gen_device = Session.add_generator_device(4, 10000, 100,
+    smuview.GeneratorWaveform.Sine, 5., 1.)
+
+# Show tab for the generator device and plot the first channel
+UiProxy.add_device_tab(gen_device)
+UiProxy.add_plot_view(gen_device.id(), smuview.DockArea.TopDockArea, gen_device.channels()["CH1"])
+
+# Print the acquisition statistics every 10 seconds
+while True:
+    time.sleep(10)
+    stats = gen_device.acquisition_stats()
+    print("%.0f samples/s, feed in p99 %.0f ns, %d late packets" % (
+        stats["sample_rate"], stats["feed_in_p99_ns"],
+        gen_device.late_packet_count()))
@@ -0,0 +1,49 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+
+import smuview_host
+import time
+
+# This script must be run with "Run in a separate process" checked.
+# It averages the first voltage signal, that is found in SmuView, and writes
+# the averages to the channel "Average" of a new user device.
+voltage_signals = [s for s in smuview_host.signals() if s["unit"] == "V"]
+if not voltage_signals:
+    raise RuntimeError("No voltage signal found")
+signal = voltage_signals[0]
+print("Averaging %s %s %s" %
+    (signal["device"], signal["channel"], signal["signal"]))
+
+reader = smuview_host.open_signal(signal["device"], signal["channel"],
+    signal["signal"], 1 << 16)
+while True:
+    time.sleep(1)
+    timestamps, values = reader.read()
+    if not values:
+        continue
+    average = sum(values) / len(values)
+    smuview_host.push_samples("Average", "Voltage", "V",
+        [timestamps[-1]], [average])
+    print("%d samples, average %f V, %d lost" %
+        (len(values), average, reader.lost))
@@ -0,0 +1,43 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+import smuview
+import time
+
+# Publish the signals of a generator device in the shared memory sample feed.
+# The samples can be read by other processes with the readers in
+# contrib/shmfeed/, e.g.:
+#   shmfeed_reader.py -c <socket path>
+#   shmfeed_reader.py -s <shared memory name>
+gen_device = Session.add_generator_device(2, 10000, 100,
+    smuview.GeneratorWaveform.Sine, 5., 1.)
+
+feed = Session.shm_feed()
+print("Control socket: %s" % feed.start())
+
+for name, channel in gen_device.channels().items():
+    shm_name = feed.publish(channel.actual_signal(), 1 << 20)
+    print("%s: %s" % (name, shm_name))
+
+while True:
+    time.sleep(1)
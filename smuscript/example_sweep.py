@@ -0,0 +1,62 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+import smuview
+import time
+
+# Connect the power supply and the DMM, that measures the current
+psu_dev = Session.connect_device("scpi-pps:conn=libgpib/hp6632b")[0]
+psu_conf = psu_dev.configurables()["1"]
+dmm_dev = Session.connect_device("hp-3478a:conn=libgpib/hp3478a")[0]
+
+psu_conf.set_config(smuview.ConfigKey.VoltageTarget, .0)
+psu_conf.set_config(smuview.ConfigKey.CurrentLimit, .1)
+psu_conf.set_config(smuview.ConfigKey.Enabled, True)
+
+# Sleep 1s to give the devices the chance to create signals
+time.sleep(1)
+
+# Sweep the voltage of the PSU from 0.1V to 10V in 50 logarithmic steps. Every
+# step waits 0.2s and then for 3 samples of the DMM within +/- 1uA, but max. 5s.
+i_sig = dmm_dev.channels()["P1"].actual_signal()
+sweep = Session.add_sweep(psu_conf, smuview.ConfigKey.VoltageTarget, [i_sig])
+sweep.set_steps(smuview.Sweep.generate_steps(
+    smuview.SweepType.Log, .1, 10., 50))
+sweep.set_settle(.2, 3, .000001, 5.)
+sweep.start()
+
+while not sweep.wait(1.):
+    print("Step %d" % sweep.step_index())
+print("Finished, %d steps not settled" % sweep.unsettled_count())
+
+# Plot the current over the voltage. The result device has a channel with the
+# set values (named after the config key) and one channel per measured signal
+# (named after the channel of the signal).
+result_dev = sweep.result_device()
+i_res_ch = result_dev.channels()["P1"]
+v_res_ch = [ch for name, ch in result_dev.channels().items() if name != "P1"][0]
+UiProxy.add_device_tab(result_dev)
+UiProxy.add_plot_view(result_dev.id(), smuview.DockArea.TopDockArea,
+    v_res_ch.actual_signal(), i_res_ch.actual_signal())
+
+# Set values to a save state
+psu_conf.set_config(smuview.ConfigKey.Enabled, False)
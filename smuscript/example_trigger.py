@@ -0,0 +1,65 @@
+# This file is part of the SmuView project.
+#
+# Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+#
+# Permission is hereby granted, free of charge, to any person obtaining a copy
+# of this software and associated documentation files (the "Software"), to deal
+# in the Software without restriction, including without limitation the rights
+# to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+# copies of the Software, and to permit persons to whom the Software is
+# furnished to do so, subject to the following conditions:
+#
+# The above copyright notice and this permission notice shall be included in all
+# copies or substantial portions of the Software.
+#
+# THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+# IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+# FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+# AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+# LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+# OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+# SOFTWARE.
+
+
+import smuview
+import time
+
+# Publish the signals of a generator device in the shared memory sample feed.
+# The samples can be read by other processes with the readers in
+# contrib/shmfeed/, e.g.:
+#   shmfeed_reader.py -c <socket path>
+
+# Detect events on a generator signal with the trigger engine. The triggers
+# are evaluated on every incoming sample, the callbacks are called by
+# TriggerEngine.dispatch() in this script thread and the events are shown as
+# markers in the plot of the signal.
+gen_device = Session.add_generator_device(1, 1000, 50,
+    smuview.GeneratorWaveform.Sine, 1., 2.)
+signal = gen_device.channels()["CH1"].actual_signal()
+UiProxy.add_device_tab(gen_device)
+UiProxy.add_plot_view(gen_device.id(), smuview.DockArea.BottomDockArea, signal)
+
+engine = Session.trigger_engine()
+
+# Rising edge through 1.5 V with 0.1 V hysteresis.
+edge = engine.add_trigger(signal, smuview.TriggerCondition.RisingEdge, 1.5,
+    hysteresis=0.1)
+edge.set_callback(
+    lambda event: print("Edge #%d at %.6f s" % (event.number, event.timestamp)))
+
+# Leaving the window [-1.9 V, 1.9 V], only once.
+window = engine.add_trigger(signal, smuview.TriggerCondition.OutsideWindow,
+    -1.9, level2=1.9, single_shot=True)
+window.set_callback(
+    lambda event: print("Out of window: %.3f V" % event.value))
+
+# For a real device, e.g. switch off the output of a power supply, when the
+# voltage of a battery falls below the cutoff voltage:
+#   cutoff = engine.add_trigger(voltage_signal,
+#       smuview.TriggerCondition.Below, 3.0, single_shot=True)
+#   cutoff.set_property_action(load_configurable,
+#       smuview.ConfigKey.Enabled, False)
+#   cutoff.set_stop_sequences_action(True)
+
+while True:
+    engine.dispatch(1.)
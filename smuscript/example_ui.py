@@ -59,6 +59,12 @@ plot_view_3 = UiProxy.add_plot_view(user_dev_id, smuview.DockArea.BottomDockArea
 # Add a power panel view to the device tab
 UiProxy.add_power_panel_view(user_dev_id, smuview.DockArea.BottomDockArea, demo_dev.channels()["A1"].actual_signal(), demo_dev.channels()["A2"].actual_signal())
 
+# Add a histogram view to the device tab
+UiProxy.add_histogram_view(user_dev_id, smuview.DockArea.BottomDockArea, demo_dev.channels()["A1"].actual_signal())
+
+# Add a spectrum view to the device tab
+UiProxy.add_spectrum_view(user_dev_id, smuview.DockArea.BottomDockArea, demo_dev.channels()["A1"].actual_signal())
+
 # Add a value panel view to the device tab
 UiProxy.add_value_panel_view(user_dev_id, smuview.DockArea.TopDockArea, demo_dev.channels()["A1"])
 
@@ -21,6 +21,7 @@
 
 #include <cassert>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <utility>
@@ -38,8 +39,10 @@
 #include "src/data/datautil.hpp"
 #include "src/devices/basedevice.hpp"
 
+using std::lock_guard;
 using std::make_pair;
 using std::make_shared;
+using std::mutex;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -61,7 +64,9 @@ BaseChannel::BaseChannel(
 	parent_device_(parent_device),
 	channel_group_names_(channel_group_names),
 	fixed_signal_(false),
-	actual_signal_(nullptr)
+	actual_signal_(nullptr),
+	signal_map_(make_shared<signal_map_t>()),
+	signals_(make_shared<signal_vector_t>())
 {
 	name_ = (sr_channel_) ? sr_channel_->name() : "";
 
@@ -150,7 +155,7 @@ void BaseChannel::add_channel_group_name(string channel_group_name)
 
 void BaseChannel::add_signal(shared_ptr<data::AnalogTimeSignal> signal)
 {
-	if (signal_map_.size() > 0 && fixed_signal_) {
+	if (signal_map()->size() > 0 && fixed_signal_) {
 		qWarning() << "Warning: Adding new signal " << signal->display_name() <<
 			"to fixed channel " << display_name();
 		// TODO: return, when the korad-kaxxxxp driver adds the missing flag!
@@ -162,12 +167,17 @@ void BaseChannel::add_signal(shared_ptr<data::AnalogTimeSignal> signal)
 
 	measured_quantity_t mq = make_pair(
 		signal->quantity(), signal->quantity_flags());
-	if (signal_map_.count(mq) > 0) {
-		signal_map_[mq].push_back(signal);
-	}
-	else {
-		signal_map_.insert(
-			make_pair(mq, vector<shared_ptr<data::BaseSignal>> { signal }));
+	{
+		// Copy on write, the published snapshots are never changed.
+		lock_guard<mutex> lock(signals_mutex_);
+		auto signal_map = make_shared<signal_map_t>(*signal_map_);
+		(*signal_map)[mq].push_back(signal);
+		auto signals = make_shared<signal_vector_t>(*signals_);
+		signals->push_back(signal);
+		std::atomic_store(&signal_map_,
+			shared_ptr<const signal_map_t>(signal_map));
+		std::atomic_store(&signals_,
+			shared_ptr<const signal_vector_t>(signals));
 	}
 
 	actual_signal_ = signal;
@@ -197,20 +207,14 @@ shared_ptr<data::BaseSignal> BaseChannel::actual_signal()
 	return actual_signal_;
 }
 
-map<measured_quantity_t, vector<shared_ptr<data::BaseSignal>>>
-	BaseChannel::signal_map()
+shared_ptr<const BaseChannel::signal_map_t> BaseChannel::signal_map() const
 {
-	return signal_map_;
+	return std::atomic_load(&signal_map_);
 }
 
-vector<shared_ptr<data::BaseSignal>> BaseChannel::signals()
+shared_ptr<const BaseChannel::signal_vector_t> BaseChannel::signals() const
 {
-	vector<shared_ptr<data::BaseSignal>> signals;
-	for (const auto &signal_pair : signal_map_) {
-		signals.insert(signals.end(),
-			signal_pair.second.begin(), signal_pair.second.end());
-	}
-	return signals;
+	return std::atomic_load(&signals_);
 }
 
 void BaseChannel::clear_signals()
@@ -23,6 +23,7 @@
 #define CHANNELS_BASECHANNEL_HPP
 
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -34,6 +35,7 @@
 #include "src/data/datautil.hpp"
 
 using std::map;
+using std::mutex;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -79,6 +81,10 @@ class BaseChannel :
 	Q_OBJECT
 
 public:
+	typedef map<measured_quantity_t, vector<shared_ptr<data::BaseSignal>>>
+		signal_map_t;
+	typedef vector<shared_ptr<data::BaseSignal>> signal_vector_t;
+
 	BaseChannel(
 		shared_ptr<sigrok::Channel> sr_channel,
 		shared_ptr<devices::BaseDevice> parent_device,
@@ -180,14 +186,19 @@ public:
 	 * Get all signals for this channel. Normaly a measurement quantity only
 	 * has one corresponding signal, but for user channels this can be
 	 * different.
+	 *
+	 * The signals may be added in the aquisition thread. Adding a signal
+	 * publishes a new map, so the returned snapshot is never changed and can
+	 * be iterated without copying or locking. Hold the returned pointer while
+	 * iterating.
 	 */
-	map<measured_quantity_t, vector<shared_ptr<data::BaseSignal>>> signal_map();
+	shared_ptr<const signal_map_t> signal_map() const;
 
 	/**
-	 * Get all signals for this channel.
-	 * This function is especially for the Python bindings.
+	 * Get all signals for this channel in the order they were added (a
+	 * snapshot, see signal_map()).
 	 */
-	vector<shared_ptr<data::BaseSignal>> signals();
+	shared_ptr<const signal_vector_t> signals() const;
 
 	/**
 	 * Delete all signals from this channel
@@ -211,7 +222,12 @@ protected:
 
 	bool fixed_signal_;
 	shared_ptr<data::BaseSignal> actual_signal_;
-	map<measured_quantity_t, vector<shared_ptr<data::BaseSignal>>> signal_map_;
+	/** Only replaced with std::atomic_store(), never changed in place. */
+	shared_ptr<const signal_map_t> signal_map_;
+	/** Only replaced with std::atomic_store(), never changed in place. */
+	shared_ptr<const signal_vector_t> signals_;
+	/** Serializes the threads, that add signals. Readers don't lock. */
+	mutable mutex signals_mutex_;
 
 public Q_SLOTS:
 	void on_aquisition_start_timestamp_changed(double);
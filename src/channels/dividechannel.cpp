@@ -19,7 +19,6 @@
 
 #include <cassert>
 #include <memory>
-#include <mutex>
 #include <set>
 #include <string>
 
@@ -32,9 +31,7 @@
 #include "src/data/datautil.hpp"
 #include "src/devices/basedevice.hpp"
 
-using std::lock_guard;
 using std::make_shared;
-using std::mutex;
 using std::set;
 using std::string;
 
@@ -71,17 +68,16 @@ DivideChannel::DivideChannel(
 		decimal_places_ = dividend_signal->decimal_places();
 	else
 		decimal_places_ = divisor_signal->decimal_places();
-
-	connect(dividend_signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
-	connect(divisor_signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
 }
 
-void DivideChannel::on_sample_appended()
+vector<shared_ptr<data::AnalogTimeSignal>>
+	DivideChannel::input_signals() const
 {
-	lock_guard<mutex> lock(sample_append_mutex_);
+	return { dividend_signal_, divisor_signal_ };
+}
 
+void DivideChannel::process_samples(size_t max_samples)
+{
 	shared_ptr<vector<double>> time = make_shared<vector<double>>();
 	shared_ptr<vector<double>> dividend_data = make_shared<vector<double>>();
 	shared_ptr<vector<double>> divisor_data = make_shared<vector<double>>();
@@ -89,7 +85,7 @@ void DivideChannel::on_sample_appended()
 	sv::data::AnalogTimeSignal::combine_signals(
 		dividend_signal_, dividend_signal_pos_,
 		divisor_signal_, divisor_signal_pos_,
-		time, dividend_data, divisor_data);
+		time, dividend_data, divisor_data, max_samples);
 
 	for (size_t i=0; i<time->size(); i++) {
 		// Division
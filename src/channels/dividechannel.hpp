@@ -21,9 +21,9 @@
 #define CHANNELS_DIVIDECHANNEL_HPP
 
 #include <memory>
-#include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QObject>
 
@@ -31,10 +31,10 @@
 #include "src/channels/mathchannel.hpp"
 #include "src/data/datautil.hpp"
 
-using std::mutex;
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 
@@ -64,15 +64,16 @@ public:
 		string channel_name,
 		double channel_start_timestamp);
 
+	vector<shared_ptr<data::AnalogTimeSignal>> input_signals() const override;
+
+protected:
+	void process_samples(size_t max_samples) override;
+
 private:
 	shared_ptr<data::AnalogTimeSignal> dividend_signal_;
 	shared_ptr<data::AnalogTimeSignal> divisor_signal_;
 	size_t dividend_signal_pos_;
 	size_t divisor_signal_pos_;
-	mutex sample_append_mutex_;
-
-private Q_SLOTS:
-	void on_sample_appended();
 
 };
 
@@ -85,7 +85,7 @@ void HardwareChannel::push_interleaved_samples(const float *data,
 
 		/* actual_signal_ not set or doesn't match the mq/mqf */
 		measured_quantity_t mq = make_pair(quantity, quantity_flags);
-		size_t signals_count = signal_map_.count(mq);
+		size_t signals_count = signal_map()->count(mq);
 		if (signals_count == 0) {
 			data::Unit unit = data::datautil::get_unit(sr_analog->unit());
 			add_signal(quantity, quantity_flags, unit);
@@ -97,7 +97,7 @@ void HardwareChannel::push_interleaved_samples(const float *data,
 			throw ("More than one signal found for " + name());
 		}
 
-		actual_signal_ = signal_map_[mq][0];
+		actual_signal_ = signal_map()->at(mq)[0];
 		Q_EMIT signal_changed(actual_signal_);
 	}
 
@@ -113,18 +113,24 @@ void HardwareChannel::push_interleaved_samples(const float *data,
 	else
 		digits = -1 * sr_analog->digits(); // TODO
 
-	// Deinterleave the samples and add them
-	unique_ptr<float[]> deint_data(new float[sample_count]);
-	float *deint_data_ptr = deint_data.get();
-	for (uint32_t i = 0; i < sample_count; i++) {
-		*deint_data_ptr = (float)(*data);
-		deint_data_ptr++;
-		data += stride;
+	// Deinterleave the samples and add them. The data is always delivered
+	// as floats, but the unit size tells the precision of the device, which
+	// is used by the signal to store the values.
+	auto signal = static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
+	if (sr_analog->unitsize() == sizeof(float)) {
+		unique_ptr<float[]> deint_data(new float[sample_count]);
+		for (size_t i = 0; i < sample_count; i++)
+			deint_data[i] = data[i * stride];
+		signal->push_samples(deint_data.get(), sample_count, timestamp,
+			samplerate, sizeof(float), digits, decimal_places);
+	}
+	else {
+		unique_ptr<double[]> deint_data(new double[sample_count]);
+		for (size_t i = 0; i < sample_count; i++)
+			deint_data[i] = data[i * stride];
+		signal->push_samples(deint_data.get(), sample_count, timestamp,
+			samplerate, sizeof(double), digits, decimal_places);
 	}
-
-	static_pointer_cast<data::AnalogTimeSignal>(actual_signal_)->push_samples(
-		deint_data.get(), sample_count, timestamp, samplerate,
-		sr_analog->unitsize(), digits, decimal_places);
 }
 
 } // namespace channels
@@ -51,7 +51,8 @@ IntegrateChannel::IntegrateChannel(
 		channel_start_timestamp),
 	int_signal_(int_signal),
 	next_int_signal_pos_(0),
-	last_timestamp_(channel_start_timestamp),
+	start_timestamp_(channel_start_timestamp),
+	last_timestamp_(-1.),
 	last_value_(0.)
 {
 	assert(int_signal_);
@@ -61,24 +62,34 @@ IntegrateChannel::IntegrateChannel(
 
 	connect(this, SIGNAL(channel_start_timestamp_changed(double)),
 		this, SLOT(on_channel_start_timestamp_changed(double)));
-	connect(int_signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
 }
 
 void IntegrateChannel::on_channel_start_timestamp_changed(double timestamp)
 {
-	// TODO: check if already started?
-	if (last_timestamp_ < 0)
-		last_timestamp_ = timestamp;
+	// The integration starts at this time stamp, if no sample has been
+	// integrated yet. See process_samples().
+	start_timestamp_ = timestamp;
 }
 
-void IntegrateChannel::on_sample_appended()
+vector<shared_ptr<data::AnalogTimeSignal>>
+	IntegrateChannel::input_signals() const
+{
+	return { int_signal_ };
+}
+
+void IntegrateChannel::process_samples(size_t max_samples)
 {
 	// Integrate
 	size_t int_signal_sample_count = int_signal_->sample_count();
+	if (int_signal_sample_count - next_int_signal_pos_ > max_samples)
+		int_signal_sample_count = next_int_signal_pos_ + max_samples;
 	while (next_int_signal_pos_ < int_signal_sample_count) {
 		auto sample = int_signal_->get_sample(next_int_signal_pos_, false);
 		double time = sample.first;
+		if (last_timestamp_ < 0) {
+			double start_timestamp = start_timestamp_;
+			last_timestamp_ = start_timestamp >= 0 ? start_timestamp : time;
+		}
 		double elapsed_time_hours = (time - last_timestamp_) / (double)3600;
 		double value = last_value_ + (sample.second * elapsed_time_hours);
 
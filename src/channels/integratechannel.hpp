@@ -20,9 +20,11 @@
 #ifndef CHANNELS_INTEGRATECHANNEL_HPP
 #define CHANNELS_INTEGRATECHANNEL_HPP
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QObject>
 
@@ -33,6 +35,7 @@
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 
@@ -61,15 +64,25 @@ public:
 		string channel_name,
 		double channel_start_timestamp);
 
+	vector<shared_ptr<data::AnalogTimeSignal>> input_signals() const override;
+
+protected:
+	void process_samples(size_t max_samples) override;
+
 private:
 	shared_ptr<data::AnalogTimeSignal> int_signal_;
 	size_t next_int_signal_pos_;
+	/**
+	 * The start time stamp of the channel. Set in the GUI thread and read by
+	 * process_samples() in the thread of the MathScheduler.
+	 */
+	std::atomic<double> start_timestamp_;
+	/** Only used in process_samples(). */
 	double last_timestamp_;
 	double last_value_;
 
 private Q_SLOTS:
 	void on_channel_start_timestamp_changed(double);
-	void on_sample_appended();
 
 };
 
@@ -26,6 +26,7 @@
 
 #include "mathchannel.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/channels/mathscheduler.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
@@ -55,7 +56,8 @@ MathChannel::MathChannel(
 	decimal_places_(-1),
 	quantity_(quantity),
 	quantity_flags_(quantity_flags),
-	unit_(unit)
+	unit_(unit),
+	backfill_progress_(100)
 {
 	name_ = channel_name;
 	channel_type_ = ChannelType::MathChannel;
@@ -78,6 +80,11 @@ MathChannel::MathChannel(
 	 */
 }
 
+MathChannel::~MathChannel()
+{
+	MathScheduler::instance().remove_channel(this);
+}
+
 data::Quantity MathChannel::quantity()
 {
 	return quantity_;
@@ -93,11 +100,64 @@ data::Unit MathChannel::unit()
 	return unit_;
 }
 
-void MathChannel::push_sample(double sample, double timestamp)
+bool MathChannel::init_signal()
+{
+	return true;
+}
+
+bool MathChannel::update()
 {
+	process_samples(chunk_size);
+
+	bool has_more_samples = time_buffer_.size() >= chunk_size;
+	update_backfill_progress(has_more_samples);
+
+	if (time_buffer_.empty())
+		return false;
+
 	auto signal = static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
-	signal->push_sample(&sample, timestamp,
-		size_of_double_, digits_, decimal_places_);
+	signal->push_samples(time_buffer_, value_buffer_,
+		digits_, decimal_places_);
+
+	time_buffer_.clear();
+	value_buffer_.clear();
+
+	return has_more_samples;
+}
+
+int MathChannel::backfill_progress() const
+{
+	return backfill_progress_;
+}
+
+void MathChannel::update_backfill_progress(bool has_more_samples)
+{
+	int progress = 100;
+	if (has_more_samples) {
+		// Estimate the progress by the timestamps of the (first) input signal
+		auto input_signal = input_signals().front();
+		double first_ts = input_signal->first_timestamp(false);
+		double last_ts = input_signal->last_timestamp(false);
+		if (last_ts > first_ts) {
+			progress = (int)(100 *
+				(time_buffer_.back() - first_ts) / (last_ts - first_ts));
+		}
+		if (progress > 99)
+			progress = 99;
+		else if (progress < 0)
+			progress = 0;
+	}
+
+	if (progress != backfill_progress_) {
+		backfill_progress_ = progress;
+		Q_EMIT backfill_progress_changed(progress);
+	}
+}
+
+void MathChannel::push_sample(double sample, double timestamp)
+{
+	time_buffer_.push_back(timestamp);
+	value_buffer_.push_back(sample);
 }
 
 } // namespace devices
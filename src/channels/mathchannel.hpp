@@ -20,6 +20,7 @@
 #ifndef CHANNELS_MATHCHANNEL_HPP
 #define CHANNELS_MATHCHANNEL_HPP
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <string>
@@ -38,6 +39,7 @@ using std::vector;
 namespace sv {
 
 namespace data {
+class AnalogTimeSignal;
 class BaseSignal;
 }
 
@@ -60,6 +62,7 @@ public:
 		set<string> channel_group_names,
 		string channel_name,
 		double channel_start_timestamp);
+	virtual ~MathChannel();
 
 	/**
 	 * Get the quantity of the math channel.
@@ -79,9 +82,56 @@ public:
 	 */
 	data::Unit unit();
 
+	/**
+	 * Return the signals, this math channel is calculated from. The
+	 * MathScheduler uses them to build the dependency graph.
+	 */
+	virtual vector<shared_ptr<data::AnalogTimeSignal>> input_signals() const = 0;
+
+	/**
+	 * Initialize the signal of the channel, after it was added with
+	 * add_signal(). Channels that don't calculate their samples (e.g. views
+	 * of their input signal) can override this.
+	 *
+	 * @return true if the channel must be calculated by the MathScheduler.
+	 */
+	virtual bool init_signal();
+
+	/**
+	 * Process the new samples of the input signals and publish the results
+	 * to the signal of this channel in one block. At most chunk_size samples
+	 * are processed per call, so that a long history of the input signals
+	 * (e.g. when the channel is created during a running acquisition) is
+	 * calculated in multiple chunks.
+	 *
+	 * This is called by the MathScheduler from a worker thread, but never
+	 * concurrently for the same channel.
+	 *
+	 * @return true if there are more samples to process.
+	 */
+	bool update();
+
+	/**
+	 * Return the progress of the calculation of the existing history in
+	 * percent. 100 means, the channel has caught up with the input signals.
+	 */
+	int backfill_progress() const;
+
+	/**
+	 * The maximum number of samples that are processed by one update().
+	 */
+	static const size_t chunk_size = 10000;
+
 protected:
 	/**
-	 * Add a single sample with timestamp to the channel/signal
+	 * Process the new samples of the input signals, but not more than
+	 * max_samples. The results must be added with push_sample().
+	 */
+	virtual void process_samples(size_t max_samples) = 0;
+
+	/**
+	 * Add a single sample with timestamp to the channel/signal. The sample
+	 * is buffered until process_samples() returns.
 	 */
 	void push_sample(double sample, double timestamp);
 
@@ -91,6 +141,19 @@ protected:
 	set<data::QuantityFlag> quantity_flags_;
 	data::Unit unit_;
 
+private:
+	/**
+	 * Update the backfill progress from the buffered samples.
+	 */
+	void update_backfill_progress(bool has_more_samples);
+
+	vector<double> time_buffer_;
+	vector<double> value_buffer_;
+	std::atomic<int> backfill_progress_;
+
+Q_SIGNALS:
+	void backfill_progress_changed(int);
+
 };
 
 } // namespace channels
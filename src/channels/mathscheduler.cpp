@@ -0,0 +1,283 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+
+#include "mathscheduler.hpp"
+#include "src/channels/mathchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::lock_guard;
+using std::make_pair;
+using std::set;
+using std::shared_ptr;
+using std::static_pointer_cast;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace channels {
+
+MathScheduler &MathScheduler::instance()
+{
+	static MathScheduler scheduler;
+	return scheduler;
+}
+
+MathScheduler::MathScheduler() :
+	stop_(false),
+	next_dirty_sequence_(0)
+{
+	// Leave one core for the acquisition and GUI threads.
+	unsigned int worker_count = std::thread::hardware_concurrency();
+	if (worker_count > 1)
+		--worker_count;
+	if (worker_count < 1)
+		worker_count = 1;
+
+	for (unsigned int i = 0; i < worker_count; ++i) {
+		worker_threads_.push_back(
+			std::thread(&MathScheduler::worker_thread_proc, this));
+	}
+}
+
+MathScheduler::~MathScheduler()
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+		stop_ = true;
+	}
+	cond_.notify_all();
+
+	for (auto &worker_thread : worker_threads_) {
+		if (worker_thread.joinable())
+			worker_thread.join();
+	}
+}
+
+void MathScheduler::add_channel(shared_ptr<MathChannel> channel)
+{
+	assert(channel);
+	assert(channel->actual_signal());
+
+	lock_guard<mutex> lock(mutex_);
+
+	if (node_map_.count(channel.get()) > 0)
+		return;
+
+	Node node;
+	node.channel = channel;
+	node.output_signal = static_pointer_cast<data::AnalogTimeSignal>(
+		channel->actual_signal()).get();
+	node.dirty = false;
+	node.running = false;
+	mark_dirty(node);
+
+	for (const auto &signal : channel->input_signals()) {
+		data::AnalogTimeSignal *signal_ptr = signal.get();
+		node.input_signals.push_back(signal_ptr);
+		consumer_map_[signal_ptr].push_back(channel.get());
+
+		if (connection_map_.count(signal_ptr) > 0)
+			continue;
+
+		// The slot is executed in the thread that appends the samples,
+		// which is either an acquisition thread or one of our workers.
+		connection_map_[signal_ptr] = connect(
+			signal_ptr, &data::AnalogTimeSignal::sample_appended,
+			this, [this, signal_ptr]() { on_sample_appended(signal_ptr); },
+			Qt::DirectConnection);
+	}
+
+	producer_map_[node.output_signal] = channel.get();
+	node_map_.insert(make_pair(channel.get(), node));
+
+	cond_.notify_all();
+}
+
+void MathScheduler::remove_channel(MathChannel *channel)
+{
+	unique_lock<mutex> lock(mutex_);
+
+	auto node_it = node_map_.find(channel);
+	if (node_it == node_map_.end())
+		return;
+
+	// Wait for a running update, unless the channel is destructed by the
+	// worker that released the last reference.
+	cond_.wait(lock, [this, channel]() {
+		auto it = node_map_.find(channel);
+		return it == node_map_.end() || !it->second.running ||
+			it->second.worker_id == std::this_thread::get_id();
+	});
+
+	node_it = node_map_.find(channel);
+	if (node_it == node_map_.end())
+		return;
+
+	for (const auto &signal_ptr : node_it->second.input_signals) {
+		auto &consumers = consumer_map_[signal_ptr];
+		consumers.erase(
+			std::remove(consumers.begin(), consumers.end(), channel),
+			consumers.end());
+		if (!consumers.empty())
+			continue;
+
+		consumer_map_.erase(signal_ptr);
+		disconnect(connection_map_[signal_ptr]);
+		connection_map_.erase(signal_ptr);
+	}
+
+	producer_map_.erase(node_it->second.output_signal);
+	node_map_.erase(node_it);
+
+	cond_.notify_all();
+}
+
+size_t MathScheduler::worker_count() const
+{
+	return worker_threads_.size();
+}
+
+void MathScheduler::mark_dirty(Node &node)
+{
+	if (node.dirty)
+		return;
+
+	node.dirty = true;
+	node.dirty_sequence = next_dirty_sequence_++;
+}
+
+void MathScheduler::on_sample_appended(data::AnalogTimeSignal *signal)
+{
+	{
+		lock_guard<mutex> lock(mutex_);
+
+		auto consumers_it = consumer_map_.find(signal);
+		if (consumers_it == consumer_map_.end())
+			return;
+		for (const auto &channel : consumers_it->second)
+			mark_dirty(node_map_[channel]);
+	}
+	cond_.notify_all();
+}
+
+bool MathScheduler::has_pending_input(const Node &node,
+	set<const Node *> &visited) const
+{
+	for (const auto &signal_ptr : node.input_signals) {
+		auto producer_it = producer_map_.find(signal_ptr);
+		if (producer_it == producer_map_.end())
+			continue;
+
+		const Node &input_node = node_map_.at(producer_it->second);
+		if (!visited.insert(&input_node).second)
+			continue;
+		if (input_node.dirty || input_node.running)
+			return true;
+		if (has_pending_input(input_node, visited))
+			return true;
+	}
+
+	return false;
+}
+
+MathChannel *MathScheduler::next_runnable_channel()
+{
+	MathChannel *runnable_channel = nullptr;
+	uint64_t runnable_sequence = 0;
+
+	for (auto &node_pair : node_map_) {
+		Node &node = node_pair.second;
+		if (!node.dirty || node.running)
+			continue;
+		if (runnable_channel && node.dirty_sequence >= runnable_sequence)
+			continue;
+
+		set<const Node *> visited { &node };
+		if (has_pending_input(node, visited))
+			continue;
+
+		runnable_channel = node_pair.first;
+		runnable_sequence = node.dirty_sequence;
+	}
+
+	return runnable_channel;
+}
+
+void MathScheduler::worker_thread_proc()
+{
+	unique_lock<mutex> lock(mutex_);
+
+	while (true) {
+		MathChannel *channel_ptr = nullptr;
+		cond_.wait(lock, [this, &channel_ptr]() {
+			if (stop_)
+				return true;
+			channel_ptr = next_runnable_channel();
+			return channel_ptr != nullptr;
+		});
+		if (stop_)
+			break;
+
+		Node &node = node_map_[channel_ptr];
+		node.dirty = false;
+		node.running = true;
+		node.worker_id = std::this_thread::get_id();
+		shared_ptr<MathChannel> channel = node.channel.lock();
+
+		lock.unlock();
+		bool has_more_samples = false;
+		if (channel) {
+			try {
+				has_more_samples = channel->update();
+			}
+			catch (std::exception &e) {
+				qWarning() << "MathScheduler::worker_thread_proc(): " <<
+					channel->display_name() << ": " << e.what();
+			}
+		}
+		// Release the channel before locking, the destructor of the channel
+		// calls remove_channel().
+		channel.reset();
+		lock.lock();
+
+		auto node_it = node_map_.find(channel_ptr);
+		if (node_it != node_map_.end()) {
+			node_it->second.running = false;
+			// Process the next chunk after all other dirty channels
+			if (has_more_samples)
+				mark_dirty(node_it->second);
+		}
+
+		cond_.notify_all();
+	}
+}
+
+} // namespace channels
+} // namespace sv
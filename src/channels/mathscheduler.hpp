@@ -0,0 +1,152 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef CHANNELS_MATHSCHEDULER_HPP
+#define CHANNELS_MATHSCHEDULER_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <QMetaObject>
+#include <QObject>
+
+using std::condition_variable;
+using std::map;
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::vector;
+using std::weak_ptr;
+
+namespace sv {
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace channels {
+
+class MathChannel;
+
+/**
+ * The MathScheduler calculates all math channels on a pool of worker threads.
+ *
+ * The math channels form a dependency graph (e.g. power -> energy -> moving
+ * average). When new samples are appended to a signal, all math channels that
+ * use this signal as input are marked as dirty. A dirty math channel is only
+ * updated, when none of the math channels it depends on is dirty or running,
+ * so the graph is always calculated in topological order. Independent chains
+ * are calculated in parallel, the GUI thread is never involved.
+ *
+ * A math channel processes at most MathChannel::chunk_size samples per update.
+ * If there are more samples to process, the channel is scheduled again behind
+ * all other dirty channels, so a long backfill doesn't block other channels.
+ */
+class MathScheduler : public QObject
+{
+	Q_OBJECT
+
+public:
+	/**
+	 * Return the scheduler instance, shared by all devices.
+	 */
+	static MathScheduler &instance();
+
+	~MathScheduler();
+
+	/**
+	 * Add a math channel to the dependency graph. The signal of the channel
+	 * must already be created. The channel is scheduled immediately, to
+	 * process already existing samples of the input signals.
+	 */
+	void add_channel(shared_ptr<MathChannel> channel);
+
+	/**
+	 * Remove a math channel from the dependency graph. Waits until a running
+	 * update of the channel has finished.
+	 */
+	void remove_channel(MathChannel *channel);
+
+	/**
+	 * Return the number of worker threads.
+	 */
+	size_t worker_count() const;
+
+private:
+	MathScheduler();
+
+	struct Node {
+		weak_ptr<MathChannel> channel;
+		vector<data::AnalogTimeSignal *> input_signals;
+		data::AnalogTimeSignal *output_signal;
+		bool dirty;
+		uint64_t dirty_sequence;
+		bool running;
+		std::thread::id worker_id;
+	};
+
+	/**
+	 * Mark a node as dirty. Must be called with mutex_ locked.
+	 */
+	void mark_dirty(Node &node);
+
+	/**
+	 * Mark all math channels that use the given signal as dirty.
+	 * Called in the thread that has appended the samples.
+	 */
+	void on_sample_appended(data::AnalogTimeSignal *signal);
+
+	/**
+	 * Check if the node or one of its (transitive) inputs is pending.
+	 * Must be called with mutex_ locked.
+	 */
+	bool has_pending_input(const Node &node,
+		set<const Node *> &visited) const;
+
+	/**
+	 * Find the dirty node, that is ready to run and is waiting the longest.
+	 * Must be called with mutex_ locked.
+	 */
+	MathChannel *next_runnable_channel();
+
+	void worker_thread_proc();
+
+	map<MathChannel *, Node> node_map_;
+	map<data::AnalogTimeSignal *, MathChannel *> producer_map_;
+	map<data::AnalogTimeSignal *, vector<MathChannel *>> consumer_map_;
+	map<data::AnalogTimeSignal *, QMetaObject::Connection> connection_map_;
+
+	mutable mutex mutex_;
+	condition_variable cond_;
+	bool stop_;
+	uint64_t next_dirty_sequence_;
+	vector<std::thread> worker_threads_;
+
+};
+
+} // namespace channels
+} // namespace sv
+
+#endif // CHANNELS_MATHSCHEDULER_HPP
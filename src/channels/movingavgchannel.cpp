@@ -63,14 +63,19 @@ MovingAvgChannel::MovingAvgChannel(
 	avg_samples_.reserve(avg_sample_count_);
 	for (size_t i=0; i<avg_sample_count_; ++i)
 		avg_samples_[i] = 0;
+}
 
-	connect(signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
+vector<shared_ptr<data::AnalogTimeSignal>>
+	MovingAvgChannel::input_signals() const
+{
+	return { signal_ };
 }
 
-void MovingAvgChannel::on_sample_appended()
+void MovingAvgChannel::process_samples(size_t max_samples)
 {
 	size_t signal_sample_count = signal_->sample_count();
+	if (signal_sample_count - next_signal_pos_ > max_samples)
+		signal_sample_count = next_signal_pos_ + max_samples;
 	while (next_signal_pos_ < signal_sample_count) {
 		auto sample = signal_->get_sample(next_signal_pos_, false);
 		avg_samples_[next_signal_pos_%avg_sample_count_] = sample.second;
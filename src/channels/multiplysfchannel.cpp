@@ -32,6 +32,7 @@
 #include "src/devices/basedevice.hpp"
 
 using std::set;
+using std::static_pointer_cast;
 using std::string;
 
 namespace sv {
@@ -51,28 +52,32 @@ MultiplySFChannel::MultiplySFChannel(
 		parent_device, channel_group_names, channel_name,
 		channel_start_timestamp),
 	signal_(signal),
-	factor_(factor),
-	next_signal_pos_(0)
+	factor_(factor)
 {
 	assert(signal_);
 
 	digits_ = signal_->digits();
 	decimal_places_ = signal_->decimal_places();
+}
 
-	connect(signal_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
+vector<shared_ptr<data::AnalogTimeSignal>>
+	MultiplySFChannel::input_signals() const
+{
+	return { signal_ };
+}
+
+bool MultiplySFChannel::init_signal()
+{
+	// The values are calculated from the input signal when they are read,
+	// so there is nothing to calculate for the scheduler.
+	auto signal = static_pointer_cast<data::AnalogTimeSignal>(actual_signal_);
+	signal->set_linear_view(signal_, factor_, 0.);
+	return false;
 }
 
-void MultiplySFChannel::on_sample_appended()
+void MultiplySFChannel::process_samples(size_t)
 {
-	size_t signal_sample_count = signal_->sample_count();
-	while (next_signal_pos_ < signal_sample_count) {
-		auto sample = signal_->get_sample(next_signal_pos_, false);
-		double time = sample.first;
-		double value = sample.second * factor_;
-		push_sample(value, time);
-		++next_signal_pos_;
-	}
+	// Nothing to do, the signal is a view of the input signal.
 }
 
 } // namespace devices
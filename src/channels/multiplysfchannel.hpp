@@ -23,6 +23,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QObject>
 
@@ -33,6 +34,7 @@
 using std::set;
 using std::shared_ptr;
 using std::string;
+using std::vector;
 
 namespace sv {
 
@@ -62,13 +64,15 @@ public:
 		string channel_name,
 		double channel_start_timestamp);
 
+	vector<shared_ptr<data::AnalogTimeSignal>> input_signals() const override;
+	bool init_signal() override;
+
+protected:
+	void process_samples(size_t max_samples) override;
+
 private:
 	shared_ptr<data::AnalogTimeSignal> signal_;
 	double factor_;
-	size_t next_signal_pos_;
-
-private Q_SLOTS:
-	void on_sample_appended();
 
 };
 
@@ -19,7 +19,6 @@
 
 #include <cassert>
 #include <memory>
-#include <mutex>
 #include <set>
 #include <string>
 
@@ -32,9 +31,7 @@
 #include "src/data/datautil.hpp"
 #include "src/devices/basedevice.hpp"
 
-using std::lock_guard;
 using std::make_shared;
-using std::mutex;
 using std::set;
 using std::string;
 
@@ -71,17 +68,16 @@ MultiplySSChannel::MultiplySSChannel(
 		decimal_places_ = signal1_->decimal_places();
 	else
 		decimal_places_ = signal2_->decimal_places();
-
-	connect(signal1_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
-	connect(signal2_.get(), SIGNAL(sample_appended()),
-		this, SLOT(on_sample_appended()));
 }
 
-void MultiplySSChannel::on_sample_appended()
+vector<shared_ptr<data::AnalogTimeSignal>>
+	MultiplySSChannel::input_signals() const
 {
-	lock_guard<mutex> lock(sample_append_mutex_);
+	return { signal1_, signal2_ };
+}
 
+void MultiplySSChannel::process_samples(size_t max_samples)
+{
 	shared_ptr<vector<double>> time = make_shared<vector<double>>();
 	shared_ptr<vector<double>> signal1_data = make_shared<vector<double>>();
 	shared_ptr<vector<double>> signal2_data = make_shared<vector<double>>();
@@ -89,7 +85,7 @@ void MultiplySSChannel::on_sample_appended()
 	sv::data::AnalogTimeSignal::combine_signals(
 		signal1_, signal1_pos_,
 		signal2_, signal2_pos_,
-		time, signal1_data, signal2_data);
+		time, signal1_data, signal2_data, max_samples);
 
 	for (size_t i=0; i<time->size(); i++) {
 		push_sample(signal1_data->at(i) * signal2_data->at(i), time->at(i));
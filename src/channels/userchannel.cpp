@@ -21,6 +21,7 @@
 #include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include <QDebug>
 
@@ -36,6 +37,7 @@ using std::make_shared;
 using std::set;
 using std::static_pointer_cast;
 using std::string;
+using std::vector;
 
 namespace sv {
 namespace channels {
@@ -65,28 +67,61 @@ void UserChannel::push_sample(double sample, double timestamp,
 	data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
 	data::Unit unit, int digits, int decimal_places)
 {
-	if (!actual_signal_ || actual_signal_->quantity() != quantity ||
-		actual_signal_->quantity_flags() != quantity_flags) {
-
-		measured_quantity_t mq = make_pair(quantity, quantity_flags);
-		size_t signals_count = signal_map_.count(mq);
-		if (signals_count == 0) {
-			actual_signal_ = add_signal(quantity, quantity_flags, unit);
-			qWarning() << "UserChannel::push_sample(): " << display_name() <<
-				" - No signal found: " << actual_signal_->display_name();
-		}
-		else if (signals_count > 1) {
-			actual_signal_ = signal_map_[mq][0];
-			qWarning() << "UserChannel::push_sample(): " << display_name() <<
-				" - More than one signal found, using first found signal: " <<
-				actual_signal_->display_name();
-		}
-		Q_EMIT signal_changed(actual_signal_);
-	}
+	init_actual_signal(quantity, quantity_flags, unit);
 
 	static_pointer_cast<data::AnalogTimeSignal>(actual_signal_)->push_sample(
 		&sample, timestamp, size_of_double_, digits, decimal_places);
 }
 
+void UserChannel::push_samples(float *data, size_t sample_count,
+	double timestamp, uint64_t samplerate, data::Quantity quantity,
+	set<data::QuantityFlag> quantity_flags, data::Unit unit,
+	int digits, int decimal_places)
+{
+	init_actual_signal(quantity, quantity_flags, unit);
+
+	static_pointer_cast<data::AnalogTimeSignal>(actual_signal_)->push_samples(
+		data, sample_count, timestamp, samplerate, sizeof(float),
+		digits, decimal_places);
+}
+
+void UserChannel::push_samples(const vector<double> &timestamps,
+	const vector<double> &values, data::Quantity quantity,
+	set<data::QuantityFlag> quantity_flags, data::Unit unit,
+	int digits, int decimal_places)
+{
+	init_actual_signal(quantity, quantity_flags, unit);
+
+	static_pointer_cast<data::AnalogTimeSignal>(actual_signal_)->push_samples(
+		timestamps, values, digits, decimal_places);
+}
+
+void UserChannel::init_actual_signal(data::Quantity quantity,
+	set<data::QuantityFlag> quantity_flags, data::Unit unit)
+{
+	if (actual_signal_ && actual_signal_->quantity() == quantity &&
+		actual_signal_->quantity_flags() == quantity_flags)
+		return;
+
+	measured_quantity_t mq = make_pair(quantity, quantity_flags);
+	const auto signal_map = this->signal_map();
+	size_t signals_count = signal_map->count(mq);
+	if (signals_count == 0) {
+		actual_signal_ = add_signal(quantity, quantity_flags, unit);
+		qWarning() << "UserChannel::init_actual_signal(): " << display_name() <<
+			" - No signal found: " << actual_signal_->display_name();
+	}
+	else if (signals_count > 1) {
+		actual_signal_ = signal_map->at(mq)[0];
+		qWarning() << "UserChannel::init_actual_signal(): " << display_name() <<
+			" - More than one signal found, using first found signal: " <<
+			actual_signal_->display_name();
+	}
+	else {
+		actual_signal_ = signal_map->at(mq)[0];
+	}
+	Q_EMIT signal_changed(actual_signal_);
+}
+
 } // namespace devices
 } // namespace sv
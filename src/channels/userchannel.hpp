@@ -20,6 +20,7 @@
 #ifndef CHANNELS_USERCHANNEL_HPP
 #define CHANNELS_USERCHANNEL_HPP
 
+#include <cstdint>
 #include <memory>
 #include <set>
 #include <string>
@@ -66,6 +67,33 @@ public:
 		data::Quantity quantity, set<data::QuantityFlag> quantity_flags,
 		data::Unit unit, int digits, int decimal_places);
 
+	/**
+	 * Add multiple equidistant samples to the channel/signal. The first
+	 * sample has the given timestamp, the distance between the samples is
+	 * given by the samplerate.
+	 */
+	void push_samples(float *data, size_t sample_count, double timestamp,
+		uint64_t samplerate, data::Quantity quantity,
+		set<data::QuantityFlag> quantity_flags, data::Unit unit,
+		int digits, int decimal_places);
+
+	/**
+	 * Add multiple samples with individual timestamps to the channel/signal
+	 * at once.
+	 */
+	void push_samples(const vector<double> &timestamps,
+		const vector<double> &values, data::Quantity quantity,
+		set<data::QuantityFlag> quantity_flags, data::Unit unit,
+		int digits, int decimal_places);
+
+private:
+	/**
+	 * Set the actual signal to the signal with the given quantity and
+	 * quantity flags. The signal is created, if it doesn't exist.
+	 */
+	void init_actual_signal(data::Quantity quantity,
+		set<data::QuantityFlag> quantity_flags, data::Unit unit);
+
 };
 
 } // namespace channels
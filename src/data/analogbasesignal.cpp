@@ -54,7 +54,7 @@ AnalogBaseSignal::AnalogBaseSignal(
 	max_value_(std::numeric_limits<double>::lowest())
 {
 	qWarning() << "Init analog base signal " << display_name();
-	data_ = make_shared<vector<double>>();
+	data_ = make_shared<SampleBuffer>();
 }
 
 size_t AnalogBaseSignal::sample_count() const
@@ -20,6 +20,7 @@
 #ifndef DATA_ANALOGBASESIGNAL_HPP
 #define DATA_ANALOGBASESIGNAL_HPP
 
+#include <atomic>
 #include <memory>
 #include <set>
 #include <utility>
@@ -29,6 +30,7 @@
 
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/samplebuffer.hpp"
 
 using std::pair;
 using std::set;
@@ -99,8 +101,13 @@ public:
 	*/
 
 protected:
-	shared_ptr<vector<double>> data_;
-	size_t sample_count_;
+	shared_ptr<SampleBuffer> data_;
+	/**
+	 * The sample count is updated after the samples are stored, so that
+	 * readers in other threads (e.g. the MathScheduler workers) only see
+	 * complete samples.
+	 */
+	std::atomic<size_t> sample_count_;
 	int digits_;
 	int decimal_places_;
 	double last_value_;
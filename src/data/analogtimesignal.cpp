@@ -22,6 +22,7 @@
 #include <memory>
 #include <set>
 
+#include <QDateTime>
 #include <QDebug>
 #include <QString>
 
@@ -30,6 +31,8 @@
 #include "src/channels/basechannel.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/memorymanager.hpp"
+#include "src/data/samplebuffer.hpp"
 
 using std::make_pair;
 using std::make_shared;
@@ -48,21 +51,29 @@ AnalogTimeSignal::AnalogTimeSignal(
 		double signal_start_timestamp) :
 	AnalogBaseSignal(quantity, quantity_flags, unit, parent_channel),
 	signal_start_timestamp_(signal_start_timestamp),
-	last_timestamp_(0.)
+	last_timestamp_(0.),
+	consumed_sample_count_(0),
+	view_factor_(1.),
+	view_offset_(0.)
 {
 	qWarning() << "Init analog time signal " << display_name()
 		<< ", signal_start_timestamp_ = "
 		<< util::format_time_date(signal_start_timestamp_);
 
-	time_ = make_shared<vector<double>>();
+	time_ = make_shared<SampleBuffer>();
 }
 
 void AnalogTimeSignal::clear()
 {
+	// The samples are owned by the source signal
+	if (view_source_signal_)
+		return;
+
 	// TODO: mutex
 	time_->clear();
 	data_->clear();
 	sample_count_ = 0;
+	consumed_sample_count_ = 0;
 
 	Q_EMIT samples_cleared();
 }
@@ -81,12 +92,36 @@ analog_time_sample_t AnalogTimeSignal::get_sample(
 			timestamp -= signal_start_timestamp_;
 		//qWarning() << "AnalogSignal::get_sample(" << pos
 		//	<< "): sample = " << timestamp << ", " << data_->at(pos);
-		return make_pair(timestamp, data_->at(pos));
+		return make_pair(timestamp, view_value(data_->at(pos)));
 	}
 
 	return make_pair(0., 0.);
 }
 
+size_t AnalogTimeSignal::get_samples(size_t pos, size_t count,
+	double *timestamps, double *values) const
+{
+	size_t sample_count = sample_count_;
+	if (pos >= sample_count)
+		return 0;
+	count = std::min(count, sample_count - pos);
+
+	count = time_->copy(pos, count, timestamps);
+	count = data_->copy(pos, count, values);
+	if (view_source_signal_) {
+		for (size_t i = 0; i < count; ++i)
+			values[i] = view_factor_ * values[i] + view_offset_;
+	}
+
+	return count;
+}
+
+size_t AnalogTimeSignal::lower_bound(double timestamp) const
+{
+	size_t sample_count = sample_count_;
+	return std::min(time_->lower_bound(timestamp), sample_count);
+}
+
 analog_time_sample_t AnalogTimeSignal::get_last_sample(bool relative_time) const
 {
 	// TODO: retrun reference (&double)? See get_value_at_timestamp()
@@ -97,7 +132,7 @@ analog_time_sample_t AnalogTimeSignal::get_last_sample(bool relative_time) const
 	double timestamp = time_->at(pos);
 	if (relative_time)
 		timestamp -= signal_start_timestamp_;
-	return make_pair(timestamp, data_->at(pos));
+	return make_pair(timestamp, view_value(data_->at(pos)));
 }
 
 bool AnalogTimeSignal::get_value_at_timestamp(
@@ -105,7 +140,7 @@ bool AnalogTimeSignal::get_value_at_timestamp(
 {
 	if (time_->size() == 0)
 		return false;
-	if (timestamp < time_->at(0))
+	if (timestamp < time_->front())
 		return false;
 	if (timestamp > time_->back())
 		return false;
@@ -113,16 +148,15 @@ bool AnalogTimeSignal::get_value_at_timestamp(
 	if (relative_time)
 		timestamp += signal_start_timestamp_;
 
-	auto lower = std::lower_bound(time_->begin(), time_->end(), timestamp);
+	// Only the chunk with the timestamp is searched (and paged in).
+	size_t lower_pos = time_->lower_bound(timestamp);
 
 	// Check if timestamp and found timestamp match
-	if (timestamp == *lower) {
-		value = *lower;
+	if (timestamp == time_->at(lower_pos)) {
+		value = view_value(data_->at(lower_pos));
 		return true;
 	}
 
-	size_t lower_pos = lower - time_->begin();
-
 	// Get the previous timestamp for linear interpolation
 	if (lower_pos > 0)
 		--lower_pos;
@@ -137,13 +171,16 @@ bool AnalogTimeSignal::get_value_at_timestamp(
 	double data_diff = data_->at(upper_pos) - lower_data;
 	double lininter_data = lower_data + (data_diff * ts_factor);
 
-	value = lininter_data;
+	value = view_value(lininter_data);
 	return true;
 }
 
 void AnalogTimeSignal::push_sample(void *sample, double timestamp,
 	size_t unit_size, int digits, int decimal_places)
 {
+	assert(!view_source_signal_);
+	init_precision(unit_size);
+
 	double dsample = 0.;
 	if (unit_size == size_of_float_)
 		dsample = (double) *(float *)sample;
@@ -204,8 +241,15 @@ void AnalogTimeSignal::push_samples(void *data,
 	int digits, int decimal_places)
 {
 	//lock_guard<recursive_mutex> lock(mutex_);
+	assert(!view_source_signal_);
+	init_precision(unit_size);
 
 	double dsample;
+	vector<double> timestamps(samples);
+	// Floats are stored as they are, when the signal is single precision.
+	bool store_floats =
+		unit_size == size_of_float_ && data_->is_single_precision();
+	vector<double> values(store_floats ? 0 : samples);
 
 	uint64_t pos = 0;
 	double time_stride = 0;
@@ -245,15 +289,22 @@ void AnalogTimeSignal::push_samples(void *data,
 			max_value_ = dsample;
 		}
 
-		// TODO: Limit memory!
-		time_->push_back(timestamp);
-		data_->push_back(dsample);
+		timestamps[pos] = timestamp;
+		if (!store_floats)
+			values[pos] = dsample;
 
 		timestamp += time_stride;
 		++pos;
-		++sample_count_;
 	}
 
+	// The MemoryManager keeps the memory of the signal in the budget.
+	time_->append(timestamps.data(), samples);
+	if (store_floats)
+		data_->append((float *)data, samples);
+	else
+		data_->append(values.data(), samples);
+	sample_count_ += samples;
+
 	last_timestamp_ = timestamp - time_stride;
 	last_value_ = dsample;
 	Q_EMIT sample_appended();
@@ -271,6 +322,93 @@ void AnalogTimeSignal::push_samples(void *data,
 		Q_EMIT digits_changed(digits_, decimal_places_);
 }
 
+void AnalogTimeSignal::push_samples(const vector<double> &timestamps,
+	const vector<double> &values, int digits, int decimal_places)
+{
+	assert(!view_source_signal_);
+	assert(timestamps.size() == values.size());
+
+	size_t samples = timestamps.size();
+	if (samples == 0)
+		return;
+	init_precision(size_of_double_);
+
+	for (const double &dsample : values) {
+		if (min_value_ > dsample)
+			min_value_ = dsample;
+		// Ignore infinitiy (overflow) as max value.
+		if (max_value_ < dsample &&
+			dsample != std::numeric_limits<double>::infinity()) {
+
+			max_value_ = dsample;
+		}
+	}
+
+	time_->append(timestamps.data(), samples);
+	data_->append(values.data(), samples);
+
+	last_timestamp_ = timestamps.back();
+	last_value_ = values.back();
+	// Publish the whole block at once
+	sample_count_ += samples;
+	Q_EMIT sample_appended();
+
+	bool digits_chngd = false;
+	if (digits != digits_) {
+		digits_ = digits;
+		digits_chngd = true;
+	}
+	if (decimal_places != decimal_places_) {
+		decimal_places_ = decimal_places;
+		digits_chngd = true;
+	}
+	if (digits_chngd)
+		Q_EMIT digits_changed(digits_, decimal_places_);
+}
+
+void AnalogTimeSignal::mark_consumed()
+{
+	size_t sample_count = sample_count_;
+	size_t consumed_sample_count = consumed_sample_count_.exchange(sample_count);
+	if (sample_count <= consumed_sample_count)
+		return;
+
+	double now = QDateTime::currentMSecsSinceEpoch() / (double)1000;
+	double lag = now - time_->at(consumed_sample_count);
+	ui_lag_.record(lag > 0. ? (uint64_t)(lag * 1e9) : 0);
+}
+
+const LatencyHistogram &AnalogTimeSignal::ui_lag() const
+{
+	return ui_lag_;
+}
+
+LatencyHistogram &AnalogTimeSignal::ui_lag()
+{
+	return ui_lag_;
+}
+
+size_t AnalogTimeSignal::memory_size() const
+{
+	if (view_source_signal_)
+		return 0;
+
+	return time_->memory_size() + data_->memory_size();
+}
+
+size_t AnalogTimeSignal::spilled_size() const
+{
+	if (view_source_signal_)
+		return 0;
+
+	return time_->spilled_size() + data_->spilled_size();
+}
+
+bool AnalogTimeSignal::is_single_precision() const
+{
+	return data_->is_single_precision();
+}
+
 double AnalogTimeSignal::signal_start_timestamp() const
 {
 	return signal_start_timestamp_;
@@ -300,18 +438,112 @@ double AnalogTimeSignal::last_timestamp(bool relative_time) const
 	return last_timestamp_;
 }
 
+void AnalogTimeSignal::set_linear_view(
+	shared_ptr<AnalogTimeSignal> source_signal, double factor, double offset)
+{
+	assert(source_signal);
+	assert(!view_source_signal_);
+	assert(sample_count_ == 0);
+
+	// A view of a view reads the samples of the root signal, so both
+	// transformations are composed into one.
+	while (source_signal->is_view()) {
+		offset = factor * source_signal->view_offset_ + offset;
+		factor = factor * source_signal->view_factor_;
+		source_signal = source_signal->view_source_signal_;
+	}
+
+	view_source_signal_ = source_signal;
+	view_factor_ = factor;
+	view_offset_ = offset;
+	time_ = source_signal->time_;
+	data_ = source_signal->data_;
+	digits_ = source_signal->digits();
+	decimal_places_ = source_signal->decimal_places();
+
+	// The slots are executed in the thread that appends the samples to the
+	// source signal, so the view is always in sync with the source.
+	connect(source_signal.get(), &AnalogTimeSignal::sample_appended,
+		this, &AnalogTimeSignal::on_view_source_sample_appended,
+		Qt::DirectConnection);
+	connect(source_signal.get(), &AnalogTimeSignal::samples_cleared,
+		this, &AnalogTimeSignal::on_view_source_samples_cleared,
+		Qt::DirectConnection);
+	connect(source_signal.get(), &AnalogTimeSignal::digits_changed,
+		this, &AnalogTimeSignal::on_view_source_digits_changed,
+		Qt::DirectConnection);
+
+	// Take over the already existing samples
+	on_view_source_sample_appended();
+}
+
+bool AnalogTimeSignal::is_view() const
+{
+	return view_source_signal_ != nullptr;
+}
+
+double AnalogTimeSignal::view_value(double value) const
+{
+	return view_factor_ * value + view_offset_;
+}
+
+void AnalogTimeSignal::init_precision(size_t unit_size)
+{
+	if (sample_count_ > 0)
+		return;
+
+	data_->set_single_precision(unit_size == size_of_float_ &&
+		MemoryManager::instance().is_native_precision_enabled());
+}
+
 void AnalogTimeSignal::on_channel_start_timestamp_changed(double timestamp)
 {
 	signal_start_timestamp_ = timestamp;
 	Q_EMIT signal_start_timestamp_changed(timestamp);
 }
 
+void AnalogTimeSignal::on_view_source_sample_appended()
+{
+	size_t sample_count = view_source_signal_->sample_count();
+	if (sample_count == 0 || sample_count == sample_count_)
+		return;
+
+	last_timestamp_ = view_source_signal_->last_timestamp(false);
+	last_value_ = view_value(view_source_signal_->last_value());
+	// A negative factor swaps min and max
+	double min_value = view_value(view_source_signal_->min_value());
+	double max_value = view_value(view_source_signal_->max_value());
+	min_value_ = std::min(min_value, max_value);
+	max_value_ = std::max(min_value, max_value);
+	sample_count_ = sample_count;
+	Q_EMIT sample_appended();
+}
+
+void AnalogTimeSignal::on_view_source_samples_cleared()
+{
+	sample_count_ = 0;
+	consumed_sample_count_ = 0;
+	last_timestamp_ = 0.;
+	min_value_ = std::numeric_limits<double>::max();
+	max_value_ = std::numeric_limits<double>::lowest();
+	Q_EMIT samples_cleared();
+}
+
+void AnalogTimeSignal::on_view_source_digits_changed(
+	const int digits, const int decimal_places)
+{
+	digits_ = digits;
+	decimal_places_ = decimal_places;
+	Q_EMIT digits_changed(digits_, decimal_places_);
+}
+
 void AnalogTimeSignal::combine_signals(
 	shared_ptr<AnalogTimeSignal> signal1, size_t &signal1_pos,
 	shared_ptr<AnalogTimeSignal> signal2, size_t &signal2_pos,
 	shared_ptr<vector<double>> time_vector,
 	shared_ptr<vector<double>> data1_vector,
-	shared_ptr<vector<double>> data2_vector)
+	shared_ptr<vector<double>> data2_vector,
+	size_t max_samples)
 {
 	// Ignore the first sample(s)
 	// TODO: Use last of the ignored samples?
@@ -332,7 +564,8 @@ void AnalogTimeSignal::combine_signals(
 		}
 	}
 
-	while (true) {
+	size_t combined_samples = 0;
+	while (combined_samples < max_samples) {
 		if (signal1->sample_count() <= signal1_pos ||
 			signal2->sample_count() <= signal2_pos)
 			break;
@@ -382,6 +615,7 @@ void AnalogTimeSignal::combine_signals(
 		time_vector->push_back(time);
 		data1_vector->push_back(value1);
 		data2_vector->push_back(value2);
+		++combined_samples;
 	}
 }
 
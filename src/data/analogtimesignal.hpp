@@ -20,6 +20,8 @@
 #ifndef DATA_ANALOGTIMESIGNAL_HPP
 #define DATA_ANALOGTIMESIGNAL_HPP
 
+#include <atomic>
+#include <limits>
 #include <memory>
 #include <set>
 #include <utility>
@@ -27,6 +29,7 @@
 
 #include <QObject>
 
+#include "src/latencyhistogram.hpp"
 #include "src/data/analogbasesignal.hpp"
 #include "src/data/datautil.hpp"
 
@@ -53,15 +56,49 @@ public:
 		double signal_start_timestamp);
 
 	/**
-	 * Clear all samples from this signal.
+	 * Clear all samples from this signal. A view signal doesn't own its
+	 * samples and is only cleared together with its source signal.
 	 */
 	void clear() override;
 
+	/**
+	 * Turn this signal into a view of the source signal. The view shares the
+	 * time axis and the sample storage of the source signal and calculates
+	 * its values as "factor * value + offset" when they are read, so no
+	 * samples are stored for the view. Samples must not be pushed to a view.
+	 * If the source signal is a view itself, the view is attached to the root
+	 * signal with the composed factor and offset.
+	 */
+	void set_linear_view(shared_ptr<AnalogTimeSignal> source_signal,
+		double factor, double offset);
+
+	/**
+	 * Return true if this signal is a view of another signal.
+	 */
+	bool is_view() const;
+
 	/**
 	 * Return the sample at the given position.
 	 */
 	analog_time_sample_t get_sample(size_t pos, bool relative_time) const;
 
+	/**
+	 * Copy max. count samples, starting at pos, to the given arrays. The
+	 * time stamps are absolute. This is much faster than calling
+	 * get_sample() for every sample.
+	 *
+	 * @return The number of copied samples.
+	 */
+	size_t get_samples(size_t pos, size_t count,
+		double *timestamps, double *values) const;
+
+	/**
+	 * Return the position of the first sample with a time stamp not less
+	 * than the given absolute time stamp, or sample_count() if there is
+	 * none. Only the chunk with the time stamp is searched (and paged in).
+	 */
+	size_t lower_bound(double timestamp) const;
+
 	/**
 	 * Return the last captured sample.
 	 */
@@ -86,36 +123,108 @@ public:
 	/**
 	 * Push a single sample to the signal.
 	 *
+	 * The values of the signal are stored in the precision of the first
+	 * pushed samples (unit_size), when native precision is enabled in the
+	 * MemoryManager. They are always returned as doubles. A double, that
+	 * doesn't fit into a float, widens the signal to double precision.
+	 *
 	 * TODO: Can this be removed?
 	 */
 	void push_sample(void *sample, double timestamp,
 		size_t unit_size, int digits, int decimal_places);
 
 	/**
-	 * Push multiple samples to the signal.
+	 * Push multiple samples to the signal. Floats are stored without a
+	 * conversion, when the signal stores its values in single precision.
 	 */
 	void push_samples(void *data, uint64_t samples, double timestamp,
 		uint64_t samplerate, size_t unit_size, int digits, int decimal_places);
 
+	/**
+	 * Push multiple samples with individual timestamps to the signal. All
+	 * samples are published at once and sample_appended() is emitted only
+	 * once for the whole block.
+	 */
+	void push_samples(const vector<double> &timestamps,
+		const vector<double> &values, int digits, int decimal_places);
+
+	/**
+	 * Mark all samples of this signal as consumed by the UI. This is called
+	 * by the views when they display new samples. The lag between the
+	 * timestamp of the first new sample and its first display is recorded
+	 * in the ui_lag() histogram.
+	 */
+	void mark_consumed();
+
+	/**
+	 * Return the lag between the sample timestamps and the first display of
+	 * the samples by a view.
+	 */
+	const LatencyHistogram &ui_lag() const;
+	LatencyHistogram &ui_lag();
+
+	/**
+	 * Return the number of bytes allocated for the samples of this signal.
+	 * A view signal doesn't allocate memory for samples.
+	 */
+	size_t memory_size() const;
+
+	/**
+	 * Return the number of bytes of the samples of this signal, that have
+	 * been moved to the disk by the MemoryManager.
+	 */
+	size_t spilled_size() const;
+
+	/**
+	 * Return true if the values are stored as floats.
+	 */
+	bool is_single_precision() const;
+
 	double signal_start_timestamp() const;
 	double first_timestamp(bool relative_time) const;
 	double last_timestamp(bool relative_time) const;
 
+	/**
+	 * Combine the samples of two signals to a common time base, starting at
+	 * the given positions. At most max_samples combined samples are added to
+	 * the vectors, the positions are updated accordingly.
+	 */
 	static void combine_signals(
 		shared_ptr<AnalogTimeSignal> signal1, size_t &signal1_pos,
 		shared_ptr<AnalogTimeSignal> signal2, size_t &signal2_pos,
 		shared_ptr<vector<double>> time_vector,
 		shared_ptr<vector<double>> data1_vector,
-		shared_ptr<vector<double>> data2_vector);
+		shared_ptr<vector<double>> data2_vector,
+		size_t max_samples = std::numeric_limits<size_t>::max());
 
 private:
-	shared_ptr<vector<double>> time_;
+	/**
+	 * Apply the linear view transformation to a stored value.
+	 */
+	double view_value(double value) const;
+
+	/**
+	 * Choose the storage precision for the first samples of the signal.
+	 */
+	void init_precision(size_t unit_size);
+
+	shared_ptr<SampleBuffer> time_;
 	double signal_start_timestamp_;
 	double last_timestamp_;
+	std::atomic<size_t> consumed_sample_count_;
+	LatencyHistogram ui_lag_;
+	shared_ptr<AnalogTimeSignal> view_source_signal_;
+	double view_factor_;
+	double view_offset_;
 
 public Q_SLOTS:
 	void on_channel_start_timestamp_changed(double);
 
+private Q_SLOTS:
+	void on_view_source_sample_appended();
+	void on_view_source_samples_cleared();
+	void on_view_source_digits_changed(const int, const int);
+
 Q_SIGNALS:
 	void signal_start_timestamp_changed(double);
 
@@ -0,0 +1,485 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QDebug>
+#include <QString>
+
+#include "csvexport.hpp"
+#include "src/util.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/decimator.hpp"
+#include "src/data/resampler.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::ofstream;
+using std::shared_ptr;
+using std::string;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+namespace csvexport {
+
+void save(const string &file_name,
+	const vector<shared_ptr<BaseSignal>> &signals,
+	bool relative_time, const string &sep)
+{
+	ofstream output_file;
+	vector<size_t> sample_counts;
+
+	output_file.open(file_name);
+
+	size_t max_sample_count = 0;
+
+	// Header
+	string start_sep("");
+	string device_header_line("");
+	string chg_name_header_line("");
+	string ch_name_header_line("");
+	string signal_name_header_line("");
+	for (const auto &signal : signals) {
+		// Only handle AnalogSignals
+		auto analog_signal =
+			dynamic_pointer_cast<AnalogTimeSignal>(signal);
+		if (!analog_signal)
+			continue;
+
+		size_t sample_count = analog_signal->sample_count();
+		if (sample_count > max_sample_count)
+			max_sample_count = sample_count;
+		sample_counts.push_back(sample_count);
+
+		string name = analog_signal->name();
+		shared_ptr<channels::BaseChannel> parent_channel =
+			analog_signal->parent_channel();
+
+		qWarning() << "csvexport::save(): signal.name() = " <<
+			QString::fromStdString(name);
+		qWarning() << "csvexport::save(): signal.parent_channel().name() = " <<
+			QString::fromStdString(parent_channel->name());
+		qWarning() << "csvexport::save(): signal.parent_channel().parent_device().name() = " <<
+			QString::fromStdString(parent_channel->parent_device()->name());
+
+		string chg_names("");
+		string chg_sep("");
+		for (const auto &chg_name : parent_channel->channel_group_names()) {
+			chg_names += chg_sep;
+			if (chg_name.empty())
+				chg_names += "\"\"";
+			else
+				chg_names += chg_name;
+			chg_sep = ", ";
+		}
+
+		device_header_line += start_sep + parent_channel->parent_device()->name(); // Time
+		device_header_line += sep + parent_channel->parent_device()->name(); // Value
+		chg_name_header_line += start_sep + chg_names; // Time
+		chg_name_header_line += sep + chg_names; // Value
+		ch_name_header_line += start_sep + parent_channel->name(); // Time
+		ch_name_header_line += sep + parent_channel->name(); // Value
+		signal_name_header_line += start_sep + "Time " + name; // Time
+		signal_name_header_line += sep + name; // Value
+
+		start_sep = sep;
+	}
+	output_file << device_header_line << std::endl;
+	output_file << chg_name_header_line << std::endl;
+	output_file << ch_name_header_line << std::endl;
+	output_file << signal_name_header_line << std::endl;
+
+	// Data
+	// TODO: we asume here, that the vector size is the same for all vectors....
+	for (size_t i = 0; i < max_sample_count; i++) {
+		start_sep = "";
+		QString line("");
+		int j = 0;
+		for (const auto &signal : signals) {
+			// Only handle AnalogSignals
+			auto analog_signal =
+				dynamic_pointer_cast<AnalogTimeSignal>(signal);
+			if (!analog_signal)
+				continue;
+
+			QString time("");
+			QString value("");
+
+			size_t sample_count = sample_counts[j];
+			if (i < sample_count-1) {
+				// More samples for this signal
+				auto sample = analog_signal->get_sample(i, relative_time);
+				value = QString("%1").arg(sample.second);
+				if (relative_time)
+					time = QString("%1").arg(sample.first);
+				else
+					time = util::format_time_date(sample.first);
+			}
+
+			line.append(QString("%1%2%3%4").
+				arg(QString::fromStdString(start_sep)).arg(time).
+				arg(QString::fromStdString(sep)).arg(value));
+			start_sep = sep;
+
+			++j;
+		}
+		output_file << line.toStdString() << std::endl;
+	}
+
+	output_file.close();
+}
+
+void save_combined(const string &file_name,
+	const vector<shared_ptr<BaseSignal>> &signals,
+	bool relative_time, const string &sep)
+{
+	ofstream output_file;
+	vector<size_t> sample_counts;
+	vector<size_t> sample_pos;
+
+	output_file.open(file_name);
+
+
+	// Header
+	string device_header_line("Time"); // Time
+	string chg_name_header_line("Time"); // Time
+	string ch_name_header_line("Time"); // Time
+	string signal_name_header_line("Time"); // Time
+	for (const auto &signal : signals) {
+		// Only handle AnalogSignals
+		auto analog_signal =
+			dynamic_pointer_cast<AnalogTimeSignal>(signal);
+		if (!analog_signal)
+			continue;
+
+		shared_ptr<channels::BaseChannel> parent_channel =
+			analog_signal->parent_channel();
+
+		sample_counts.push_back(analog_signal->sample_count());
+		sample_pos.push_back(0);
+
+		string chg_names("");
+		string chg_sep("");
+		for (const auto &chg_name : parent_channel->channel_group_names()) {
+			chg_names += chg_sep;
+			if (chg_name.empty())
+				chg_names += "\"\"";
+			else
+				chg_names += chg_name;
+			chg_sep = ", ";
+		}
+
+		device_header_line += sep + parent_channel->parent_device()->name(); // Value
+		chg_name_header_line += sep + chg_names; // Value
+		ch_name_header_line += sep + parent_channel->name(); // Value
+		signal_name_header_line += sep + analog_signal->name(); // Value
+	}
+	output_file << device_header_line << std::endl;
+	output_file << chg_name_header_line << std::endl;
+	output_file << ch_name_header_line << std::endl;
+	output_file << signal_name_header_line << std::endl;
+
+	// Data
+	while (true) {
+		double next_timestamp = -1;
+		int i = 0;
+		for (const auto &signal : signals) {
+			// Only handle AnalogSignals
+			auto analog_signal =
+				dynamic_pointer_cast<AnalogTimeSignal>(signal);
+			if (!analog_signal)
+				continue;
+
+			if (sample_pos[i] >= sample_counts[i]-1)
+				continue;
+
+			double timestamp =
+				analog_signal->get_sample(sample_pos[i], relative_time).first;
+			if (next_timestamp < 0 || timestamp < next_timestamp)
+				next_timestamp = timestamp;
+
+			++i;
+		}
+
+		if (next_timestamp < 0)
+			break;
+
+		// Timestamp
+		QString line;
+		if (relative_time)
+			line = QString("%1").arg(next_timestamp, 0, 'f', 4);
+		else
+			line = util::format_time_date(next_timestamp);
+
+		// Values
+		i = 0;
+		for (const auto &signal : signals) {
+			// Only handle AnalogSignals
+			auto analog_signal =
+				dynamic_pointer_cast<AnalogTimeSignal>(signal);
+			if (!analog_signal)
+				continue;
+
+			line.append(QString::fromStdString(sep));
+
+			auto sample =
+				analog_signal->get_sample(sample_pos[i], relative_time);
+			double timestamp = sample.first;
+			if (timestamp == next_timestamp) {
+				line.append(QString("%1").arg(sample.second, 0, 'g', -1));
+				++sample_pos[i];
+			}
+
+			++i;
+		}
+		output_file << line.toStdString() << std::endl;
+	}
+
+	output_file.close();
+}
+
+void save_resampled(const string &file_name,
+	const vector<shared_ptr<BaseSignal>> &signals,
+	bool relative_time, const string &sep,
+	ResampleMode mode, double interval)
+{
+	ofstream output_file;
+	output_file.open(file_name);
+
+	// Header
+	vector<shared_ptr<AnalogTimeSignal>> analog_signals;
+	string device_header_line("Time"); // Time
+	string chg_name_header_line("Time"); // Time
+	string ch_name_header_line("Time"); // Time
+	string signal_name_header_line("Time"); // Time
+	for (const auto &signal : signals) {
+		// Only handle AnalogSignals
+		auto analog_signal =
+			dynamic_pointer_cast<AnalogTimeSignal>(signal);
+		if (!analog_signal)
+			continue;
+		analog_signals.push_back(analog_signal);
+
+		shared_ptr<channels::BaseChannel> parent_channel =
+			analog_signal->parent_channel();
+
+		string chg_names("");
+		string chg_sep("");
+		for (const auto &chg_name : parent_channel->channel_group_names()) {
+			chg_names += chg_sep;
+			if (chg_name.empty())
+				chg_names += "\"\"";
+			else
+				chg_names += chg_name;
+			chg_sep = ", ";
+		}
+
+		device_header_line += sep + parent_channel->parent_device()->name(); // Value
+		chg_name_header_line += sep + chg_names; // Value
+		ch_name_header_line += sep + parent_channel->name(); // Value
+		signal_name_header_line += sep + analog_signal->name(); // Value
+	}
+	output_file << device_header_line << std::endl;
+	output_file << chg_name_header_line << std::endl;
+	output_file << ch_name_header_line << std::endl;
+	output_file << signal_name_header_line << std::endl;
+
+	if (analog_signals.empty()) {
+		output_file.close();
+		return;
+	}
+
+	// Data. Resample and write in chunks to limit the memory usage.
+	double time_offset = relative_time ?
+		analog_signals.front()->signal_start_timestamp() : 0.;
+	Resampler resampler(analog_signals, mode, interval);
+	vector<double> time;
+	vector<vector<double>> values;
+	while (resampler.process(time, values, Resampler::chunk_size) > 0) {
+		for (size_t i = 0; i < time.size(); ++i) {
+			QString line;
+			if (relative_time)
+				line = QString("%1").arg(time[i] - time_offset, 0, 'f', 4);
+			else
+				line = util::format_time_date(time[i]);
+
+			for (const auto &signal_values : values) {
+				line.append(QString::fromStdString(sep));
+				line.append(QString("%1").arg(signal_values[i], 0, 'g', -1));
+			}
+			output_file << line.toStdString() << std::endl;
+		}
+
+		time.clear();
+		for (auto &signal_values : values)
+			signal_values.clear();
+	}
+
+	output_file.close();
+}
+
+void save_decimated(const string &file_name,
+	const vector<shared_ptr<BaseSignal>> &signals,
+	bool relative_time, const string &sep,
+	DecimationMode mode, size_t point_count, double bucket_width)
+{
+	ofstream output_file;
+	output_file.open(file_name);
+
+	// Header
+	vector<shared_ptr<AnalogTimeSignal>> analog_signals;
+	string start_sep("");
+	string device_header_line("");
+	string chg_name_header_line("");
+	string ch_name_header_line("");
+	string signal_name_header_line("");
+	for (const auto &signal : signals) {
+		// Only handle AnalogSignals
+		auto analog_signal =
+			dynamic_pointer_cast<AnalogTimeSignal>(signal);
+		if (!analog_signal)
+			continue;
+		analog_signals.push_back(analog_signal);
+
+		string name = analog_signal->name();
+		shared_ptr<channels::BaseChannel> parent_channel =
+			analog_signal->parent_channel();
+
+		string chg_names("");
+		string chg_sep("");
+		for (const auto &chg_name : parent_channel->channel_group_names()) {
+			chg_names += chg_sep;
+			if (chg_name.empty())
+				chg_names += "\"\"";
+			else
+				chg_names += chg_name;
+			chg_sep = ", ";
+		}
+
+		vector<string> value_names;
+		if (mode == DecimationMode::MinMaxMean)
+			value_names = { name + " Min", name + " Max", name + " Mean" };
+		else
+			value_names = { name };
+
+		device_header_line += start_sep + parent_channel->parent_device()->name(); // Time
+		chg_name_header_line += start_sep + chg_names; // Time
+		ch_name_header_line += start_sep + parent_channel->name(); // Time
+		signal_name_header_line += start_sep + "Time " + name; // Time
+		for (const auto &value_name : value_names) {
+			device_header_line += sep + parent_channel->parent_device()->name(); // Value
+			chg_name_header_line += sep + chg_names; // Value
+			ch_name_header_line += sep + parent_channel->name(); // Value
+			signal_name_header_line += sep + value_name; // Value
+		}
+
+		start_sep = sep;
+	}
+	output_file << device_header_line << std::endl;
+	output_file << chg_name_header_line << std::endl;
+	output_file << ch_name_header_line << std::endl;
+	output_file << signal_name_header_line << std::endl;
+
+	// Data. All signals are decimated side by side in a single pass, only the
+	// points of the last read chunk are held in memory. The sample count is
+	// fixed now, so a running acquisition doesn't prolong the export.
+	vector<unique_ptr<Decimator>> decimators;
+	vector<size_t> end_positions;
+	for (const auto &analog_signal : analog_signals) {
+		double width = bucket_width > 0. ? bucket_width :
+			Decimator::bucket_width(analog_signal, mode, point_count);
+		decimators.push_back(unique_ptr<Decimator>(
+			new Decimator(analog_signal, mode, width)));
+		end_positions.push_back(analog_signal->sample_count());
+	}
+	vector<vector<DecimatedPoint>> points(analog_signals.size());
+	vector<size_t> point_pos(analog_signals.size(), 0);
+	vector<bool> finished(analog_signals.size(), false);
+	int value_count = mode == DecimationMode::MinMaxMean ? 3 : 1;
+	QString empty_columns = QString::fromStdString(sep).repeated(value_count);
+
+	while (true) {
+		// Read the next chunks until every signal has a point or is done.
+		for (size_t i = 0; i < decimators.size(); ++i) {
+			while (point_pos[i] >= points[i].size() && !finished[i]) {
+				points[i].clear();
+				point_pos[i] = 0;
+				if (decimators[i]->process(points[i], end_positions[i]) == 0) {
+					decimators[i]->finish(points[i]);
+					finished[i] = true;
+				}
+			}
+		}
+
+		bool has_point = false;
+		QString line("");
+		for (size_t i = 0; i < decimators.size(); ++i) {
+			if (i > 0)
+				line.append(QString::fromStdString(sep));
+			if (point_pos[i] >= points[i].size()) {
+				line.append(empty_columns);
+				continue;
+			}
+			has_point = true;
+
+			const auto &point = points[i][point_pos[i]];
+			if (relative_time) {
+				line.append(QString("%1").arg(
+					point.timestamp -
+						analog_signals[i]->signal_start_timestamp(),
+					0, 'f', 4));
+			}
+			else {
+				line.append(util::format_time_date(point.timestamp));
+			}
+
+			line.append(QString::fromStdString(sep));
+			if (mode == DecimationMode::MinMaxMean) {
+				line.append(QString("%1%2%3%4%5").
+					arg(point.min, 0, 'g', -1).
+					arg(QString::fromStdString(sep)).
+					arg(point.max, 0, 'g', -1).
+					arg(QString::fromStdString(sep)).
+					arg(point.value, 0, 'g', -1));
+			}
+			else {
+				line.append(QString("%1").arg(point.value, 0, 'g', -1));
+			}
+
+			++point_pos[i];
+		}
+		if (!has_point)
+			break;
+
+		output_file << line.toStdString() << std::endl;
+	}
+
+	output_file.close();
+}
+
+} // namespace csvexport
+} // namespace data
+} // namespace sv
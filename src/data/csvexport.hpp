@@ -0,0 +1,106 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_CSVEXPORT_HPP
+#define DATA_CSVEXPORT_HPP
+
+#include <memory>
+#include <string>
+#include <vector>
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class BaseSignal;
+enum class DecimationMode;
+enum class ResampleMode;
+
+namespace csvexport {
+
+/**
+ * Save the signals to a CSV file. Every signal has its own time column.
+ * Only analog time signals are saved.
+ *
+ * @param file_name The name of the CSV file.
+ * @param signals The signals to save.
+ * @param relative_time Save the time relative to the session start time.
+ * @param sep The CSV separator.
+ */
+void save(const string &file_name,
+	const vector<shared_ptr<BaseSignal>> &signals,
+	bool relative_time, const string &sep);
+
+/**
+ * Save the signals to a CSV file. All signals share one time column with the
+ * combined time stamps of all signals. Only analog time signals are saved.
+ *
+ * @param file_name The name of the CSV file.
+ * @param signals The signals to save.
+ * @param relative_time Save the time relative to the session start time.
+ * @param sep The CSV separator.
+ */
+void save_combined(const string &file_name,
+	const vector<shared_ptr<BaseSignal>> &signals,
+	bool relative_time, const string &sep);
+
+/**
+ * Save the signals to a CSV file. All signals are resampled to a common
+ * uniform time grid and share one time column. Only analog time signals are
+ * saved.
+ *
+ * @param file_name The name of the CSV file.
+ * @param signals The signals to save.
+ * @param relative_time Save the time relative to the session start time.
+ * @param sep The CSV separator.
+ * @param mode The resample mode.
+ * @param interval The interval of the time grid in seconds.
+ */
+void save_resampled(const string &file_name,
+	const vector<shared_ptr<BaseSignal>> &signals,
+	bool relative_time, const string &sep,
+	ResampleMode mode, double interval);
+
+/**
+ * Save the decimated signals to a CSV file. Every signal has its own time
+ * column. For min/max/mean, every signal has a min., a max. and a mean
+ * column. Only analog time signals are saved.
+ *
+ * @param file_name The name of the CSV file.
+ * @param signals The signals to save.
+ * @param relative_time Save the time relative to the session start time.
+ * @param sep The CSV separator.
+ * @param mode The decimation mode.
+ * @param point_count The number of points per signal. Only used, if
+ *        bucket_width is 0.
+ * @param bucket_width The width of a bucket in seconds or 0.
+ */
+void save_decimated(const string &file_name,
+	const vector<shared_ptr<BaseSignal>> &signals,
+	bool relative_time, const string &sep,
+	DecimationMode mode, size_t point_count, double bucket_width);
+
+} // namespace csvexport
+} // namespace data
+} // namespace sv
+
+#endif // DATA_CSVEXPORT_HPP
@@ -0,0 +1,299 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "decimator.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t Decimator::chunk_size;
+
+Decimator::Decimator(shared_ptr<AnalogTimeSignal> signal,
+		DecimationMode mode, double bucket_width) :
+	signal_(signal),
+	mode_(mode),
+	bucket_width_(bucket_width),
+	pos_(0),
+	started_(false),
+	finished_(false),
+	origin_(0.),
+	a_timestamp_(0.),
+	a_value_(0.),
+	last_timestamp_(0.),
+	last_value_(0.)
+{
+	assert(signal_);
+	assert(bucket_width_ > 0.);
+
+	clear_bucket(current_, -1);
+	clear_bucket(next_, -1);
+}
+
+size_t Decimator::process(vector<DecimatedPoint> &points, size_t end_pos)
+{
+	if (finished_)
+		return 0;
+
+	end_pos = std::min(end_pos, signal_->sample_count());
+	if (end_pos <= pos_)
+		return 0;
+
+	size_t count = std::min(chunk_size, end_pos - pos_);
+	timestamps_.resize(count);
+	values_.resize(count);
+	count = signal_->get_samples(pos_, count,
+		timestamps_.data(), values_.data());
+	const size_t chunk_pos = pos_;
+	pos_ += count;
+
+	const double *ts = timestamps_.data();
+	const double *vs = values_.data();
+	if (mode_ == DecimationMode::LTTB) {
+		for (size_t i = 0; i < count; ++i)
+			add_lttb(chunk_pos + i, ts[i], vs[i], points);
+	}
+	else {
+		for (size_t i = 0; i < count; ++i)
+			add_min_max_mean(ts[i], vs[i], points);
+	}
+
+	return count;
+}
+
+void Decimator::finish(vector<DecimatedPoint> &points)
+{
+	if (finished_)
+		return;
+	finished_ = true;
+
+	if (!started_)
+		return;
+
+	if (mode_ == DecimationMode::MinMaxMean) {
+		if (current_.count > 0) {
+			points.push_back({
+				origin_ + (double)current_.index * bucket_width_,
+				current_.sum / (double)current_.count,
+				current_.min, current_.max });
+		}
+		return;
+	}
+
+	// The last sample is the third point for the remaining buckets.
+	if (current_.count > 0) {
+		if (next_.count > 0) {
+			select_lttb(current_,
+				next_.timestamp_sum / (double)next_.count,
+				next_.sum / (double)next_.count, points);
+			load_bucket(next_);
+			select_lttb(next_, last_timestamp_, last_value_, points);
+		}
+		else {
+			select_lttb(current_, last_timestamp_, last_value_, points);
+		}
+	}
+	if (a_timestamp_ != last_timestamp_)
+		push_point(last_timestamp_, last_value_, points);
+}
+
+shared_ptr<AnalogTimeSignal> Decimator::signal() const
+{
+	return signal_;
+}
+
+DecimationMode Decimator::mode() const
+{
+	return mode_;
+}
+
+double Decimator::bucket_width() const
+{
+	return bucket_width_;
+}
+
+double Decimator::bucket_width(const shared_ptr<AnalogTimeSignal> &signal,
+	DecimationMode mode, size_t point_count)
+{
+	double span = signal->last_timestamp(false) -
+		signal->first_timestamp(false);
+
+	// LTTB keeps the first and the last sample in addition to the buckets.
+	size_t bucket_count = point_count;
+	if (mode == DecimationMode::LTTB)
+		bucket_count = point_count > 2 ? point_count - 2 : 1;
+	if (bucket_count == 0)
+		bucket_count = 1;
+
+	// Make sure, that the last sample doesn't open an additional bucket.
+	double width = span / (double)bucket_count;
+	width = std::nextafter(width, std::numeric_limits<double>::infinity());
+	if (!(width > 0.) || std::isinf(width))
+		return 1.;
+	return width;
+}
+
+void Decimator::add_lttb(size_t pos, double timestamp, double value,
+	vector<DecimatedPoint> &points)
+{
+	if (!started_) {
+		// The first sample is always kept.
+		started_ = true;
+		origin_ = timestamp;
+		push_point(timestamp, value, points);
+		last_timestamp_ = timestamp;
+		last_value_ = value;
+		return;
+	}
+
+	int64_t index = (int64_t)std::floor((timestamp - origin_) / bucket_width_);
+	if (current_.count == 0 || index == current_.index) {
+		if (current_.count == 0)
+			current_.index = index;
+		current_.timestamps.push_back(timestamp);
+		current_.values.push_back(value);
+		++current_.count;
+	}
+	else {
+		if (next_.count > 0 && index != next_.index) {
+			// The next bucket is complete, so the point of the current
+			// bucket can be selected.
+			select_lttb(current_,
+				next_.timestamp_sum / (double)next_.count,
+				next_.sum / (double)next_.count, points);
+
+			// Keep the sample buffers of the current bucket.
+			std::swap(current_, next_);
+			current_.timestamps.swap(next_.timestamps);
+			current_.values.swap(next_.values);
+			clear_bucket(next_, -1);
+			load_bucket(current_);
+		}
+		if (next_.count == 0) {
+			next_.index = index;
+			next_.pos = pos;
+		}
+		// Only the mean of the next bucket is needed until it becomes the
+		// current bucket, so its samples are not kept.
+		next_.timestamp_sum += timestamp;
+		next_.sum += value;
+		++next_.count;
+	}
+
+	last_timestamp_ = timestamp;
+	last_value_ = value;
+}
+
+void Decimator::add_min_max_mean(double timestamp, double value,
+	vector<DecimatedPoint> &points)
+{
+	if (!started_) {
+		started_ = true;
+		origin_ = timestamp;
+	}
+
+	int64_t index = (int64_t)std::floor((timestamp - origin_) / bucket_width_);
+	if (current_.count > 0 && index != current_.index) {
+		points.push_back({
+			origin_ + (double)current_.index * bucket_width_,
+			current_.sum / (double)current_.count,
+			current_.min, current_.max });
+		clear_bucket(current_, index);
+	}
+	if (current_.count == 0)
+		current_.index = index;
+
+	current_.min = std::min(current_.min, value);
+	current_.max = std::max(current_.max, value);
+	current_.sum += value;
+	++current_.count;
+
+	last_timestamp_ = timestamp;
+	last_value_ = value;
+}
+
+void Decimator::select_lttb(const Bucket &bucket,
+	double c_timestamp, double c_value, vector<DecimatedPoint> &points)
+{
+	const double *ts = bucket.timestamps.data();
+	const double *vs = bucket.values.data();
+	const size_t n = bucket.timestamps.size();
+	if (n == 0)
+		return;
+
+	// Twice the area of the triangle a, (ts[i], vs[i]), c
+	const double dt = a_timestamp_ - c_timestamp;
+	const double dv = c_value - a_value_;
+	size_t max_i = 0;
+	double max_area = -1.;
+	for (size_t i = 0; i < n; ++i) {
+		double area = std::fabs(
+			dt * (vs[i] - a_value_) - (a_timestamp_ - ts[i]) * dv);
+		if (area > max_area) {
+			max_area = area;
+			max_i = i;
+		}
+	}
+
+	push_point(ts[max_i], vs[max_i], points);
+}
+
+void Decimator::push_point(double timestamp, double value,
+	vector<DecimatedPoint> &points)
+{
+	points.push_back({ timestamp, value, value, value });
+	a_timestamp_ = timestamp;
+	a_value_ = value;
+}
+
+void Decimator::load_bucket(Bucket &bucket)
+{
+	bucket.timestamps.resize(bucket.count);
+	bucket.values.resize(bucket.count);
+	size_t count = signal_->get_samples(bucket.pos, bucket.count,
+		bucket.timestamps.data(), bucket.values.data());
+	bucket.timestamps.resize(count);
+	bucket.values.resize(count);
+}
+
+void Decimator::clear_bucket(Bucket &bucket, int64_t index)
+{
+	bucket.index = index;
+	bucket.pos = 0;
+	bucket.timestamps.clear();
+	bucket.values.clear();
+	bucket.min = std::numeric_limits<double>::infinity();
+	bucket.max = -std::numeric_limits<double>::infinity();
+	bucket.sum = 0.;
+	bucket.timestamp_sum = 0.;
+	bucket.count = 0;
+}
+
+} // namespace data
+} // namespace sv
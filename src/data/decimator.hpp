@@ -0,0 +1,188 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_DECIMATOR_HPP
+#define DATA_DECIMATOR_HPP
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QString>
+
+using std::map;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+enum class DecimationMode {
+	/**
+	 * Largest-Triangle-Three-Buckets: One sample per bucket, the one that
+	 * forms the largest triangle with the previously selected sample and the
+	 * mean of the next bucket. The first and the last sample are kept.
+	 */
+	LTTB,
+	/** The min., max. and mean value of every bucket. */
+	MinMaxMean,
+};
+
+// TODO: Use tr(), QCoreApplication::translate(), QT_TR_NOOP() or
+//       QT_TRANSLATE_NOOP() for translation.
+//       See: http://doc.qt.io/qt-5/i18n-source-translation.html
+typedef map<DecimationMode, QString> decimation_mode_name_map_t;
+static decimation_mode_name_map_t decimation_mode_name_map = {
+	{ DecimationMode::LTTB, QString("Largest triangle (LTTB)") },
+	{ DecimationMode::MinMaxMean, QString("Min/max/mean") },
+};
+
+/**
+ * A point of a decimated signal. For LTTB, value, min and max are the value
+ * of the selected sample. For min/max/mean, the time stamp is the start of
+ * the bucket and value is the mean of the bucket.
+ */
+struct DecimatedPoint
+{
+	double timestamp;
+	double value;
+	double min;
+	double max;
+};
+
+/**
+ * The Decimator reduces an analog time signal to a small number of points,
+ * while keeping the peaks visible. The samples are sorted into buckets of a
+ * fixed time width, starting with the first sample. Empty buckets produce no
+ * points, so gaps in the signal stay visible.
+ *
+ * The signal is read in chunks in a single pass, so the Decimator can
+ * process signals, that are much larger than the memory, and it can be used
+ * for live data as well. For min/max/mean only the aggregated values of the
+ * current bucket are held in memory. LTTB holds all samples of the current
+ * bucket and the mean of the next bucket. When the next bucket becomes the
+ * current bucket, its samples are read again from the signal.
+ */
+class Decimator
+{
+
+public:
+	/** The max. number of samples, that are read at once. */
+	static const size_t chunk_size = 65536;
+
+	/**
+	 * Create a decimator.
+	 *
+	 * @param signal The signal to decimate.
+	 * @param mode The decimation mode.
+	 * @param bucket_width The width of a bucket in seconds.
+	 */
+	Decimator(shared_ptr<AnalogTimeSignal> signal, DecimationMode mode,
+		double bucket_width);
+
+	/**
+	 * Read the next chunk of samples and append the points of all completed
+	 * buckets to the vector.
+	 *
+	 * @param points The vector for the new points.
+	 * @param end_pos Only the samples before this position are read.
+	 *
+	 * @return The number of read samples. 0, if there are no new samples.
+	 */
+	size_t process(vector<DecimatedPoint> &points,
+		size_t end_pos = std::numeric_limits<size_t>::max());
+
+	/**
+	 * Append the points of the remaining (incomplete) buckets to the vector.
+	 * The decimator can't process any more samples after this.
+	 */
+	void finish(vector<DecimatedPoint> &points);
+
+	shared_ptr<AnalogTimeSignal> signal() const;
+	DecimationMode mode() const;
+	double bucket_width() const;
+
+	/**
+	 * Return the bucket width, that decimates all existing samples of the
+	 * signal to about point_count points.
+	 */
+	static double bucket_width(const shared_ptr<AnalogTimeSignal> &signal,
+		DecimationMode mode, size_t point_count);
+
+private:
+	/**
+	 * The samples of one bucket. For min/max/mean and the next LTTB bucket
+	 * only the aggregated values are kept. pos is the position of the first
+	 * sample of the bucket in the signal.
+	 */
+	struct Bucket
+	{
+		int64_t index;
+		size_t pos;
+		vector<double> timestamps;
+		vector<double> values;
+		double min;
+		double max;
+		double sum;
+		double timestamp_sum;
+		size_t count;
+	};
+
+	void add_lttb(size_t pos, double timestamp, double value,
+		vector<DecimatedPoint> &points);
+	void add_min_max_mean(double timestamp, double value,
+		vector<DecimatedPoint> &points);
+	void select_lttb(const Bucket &bucket, double c_timestamp, double c_value,
+		vector<DecimatedPoint> &points);
+	void push_point(double timestamp, double value,
+		vector<DecimatedPoint> &points);
+	void load_bucket(Bucket &bucket);
+	void clear_bucket(Bucket &bucket, int64_t index);
+
+	const shared_ptr<AnalogTimeSignal> signal_;
+	const DecimationMode mode_;
+	const double bucket_width_;
+
+	size_t pos_;
+	bool started_;
+	bool finished_;
+	/** The time stamp of the first sample is the start of bucket 0. */
+	double origin_;
+	/** The last point, that has been selected by LTTB. */
+	double a_timestamp_;
+	double a_value_;
+	double last_timestamp_;
+	double last_value_;
+	Bucket current_;
+	Bucket next_;
+
+	/** Buffers for one chunk of samples. */
+	vector<double> timestamps_;
+	vector<double> values_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_DECIMATOR_HPP
@@ -0,0 +1,221 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "energyaccumulator.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+EnergyAccumulator::EnergyAccumulator(
+		shared_ptr<AnalogTimeSignal> voltage_signal,
+		shared_ptr<AnalogTimeSignal> current_signal) :
+	voltage_signal_(voltage_signal),
+	current_signal_(current_signal),
+	voltage_pos_(0),
+	current_pos_(0),
+	time_buffer_(make_shared<vector<double>>()),
+	voltage_buffer_(make_shared<vector<double>>()),
+	current_buffer_(make_shared<vector<double>>())
+{
+	assert(voltage_signal_);
+	assert(current_signal_);
+
+	reset();
+}
+
+void EnergyAccumulator::reset()
+{
+	// Start at the current end of the signals
+	voltage_pos_ = voltage_signal_->sample_count();
+	current_pos_ = current_signal_->sample_count();
+
+	has_values_ = false;
+	last_timestamp_ = 0.;
+	voltage_ = 0.;
+	voltage_min_ = std::numeric_limits<double>::max();
+	voltage_max_ = std::numeric_limits<double>::lowest();
+	current_ = 0.;
+	current_min_ = std::numeric_limits<double>::max();
+	current_max_ = std::numeric_limits<double>::lowest();
+	resistance_ = 0.;
+	resistance_min_ = std::numeric_limits<double>::max();
+	resistance_max_ = std::numeric_limits<double>::lowest();
+	power_ = 0.;
+	power_min_ = std::numeric_limits<double>::max();
+	power_max_ = std::numeric_limits<double>::lowest();
+	amp_hours_ = 0.;
+	watt_hours_ = 0.;
+}
+
+bool EnergyAccumulator::update()
+{
+	// The signals have been cleared, start again at the beginning.
+	if (voltage_pos_ > voltage_signal_->sample_count() ||
+			current_pos_ > current_signal_->sample_count()) {
+		voltage_pos_ = 0;
+		current_pos_ = 0;
+	}
+
+	time_buffer_->clear();
+	voltage_buffer_->clear();
+	current_buffer_->clear();
+	AnalogTimeSignal::combine_signals(
+		voltage_signal_, voltage_pos_, current_signal_, current_pos_,
+		time_buffer_, voltage_buffer_, current_buffer_);
+
+	for (size_t i = 0; i < time_buffer_->size(); ++i) {
+		process_sample(time_buffer_->at(i),
+			voltage_buffer_->at(i), current_buffer_->at(i));
+	}
+
+	return !time_buffer_->empty();
+}
+
+bool EnergyAccumulator::has_new_samples() const
+{
+	return voltage_pos_ != voltage_signal_->sample_count() ||
+		current_pos_ != current_signal_->sample_count();
+}
+
+void EnergyAccumulator::process_sample(
+	double timestamp, double voltage, double current)
+{
+	double resistance = current == 0. ?
+		std::numeric_limits<double>::max() : voltage / current;
+	double power = voltage * current;
+
+	// Trapezoidal integration between the previous and this sample
+	if (has_values_ && timestamp > last_timestamp_) {
+		double elapsed_hours = (timestamp - last_timestamp_) / 3600.;
+		amp_hours_ += (current_ + current) / 2. * elapsed_hours;
+		watt_hours_ += (power_ + power) / 2. * elapsed_hours;
+	}
+
+	if (voltage_min_ > voltage)
+		voltage_min_ = voltage;
+	if (voltage_max_ < voltage)
+		voltage_max_ = voltage;
+	if (current_min_ > current)
+		current_min_ = current;
+	if (current_max_ < current)
+		current_max_ = current;
+	if (resistance_min_ > resistance)
+		resistance_min_ = resistance;
+	if (resistance_max_ < resistance)
+		resistance_max_ = resistance;
+	if (power_min_ > power)
+		power_min_ = power;
+	if (power_max_ < power)
+		power_max_ = power;
+
+	has_values_ = true;
+	last_timestamp_ = timestamp;
+	voltage_ = voltage;
+	current_ = current;
+	resistance_ = resistance;
+	power_ = power;
+}
+
+bool EnergyAccumulator::has_values() const
+{
+	return has_values_;
+}
+
+double EnergyAccumulator::voltage() const
+{
+	return voltage_;
+}
+
+double EnergyAccumulator::voltage_min() const
+{
+	return voltage_min_;
+}
+
+double EnergyAccumulator::voltage_max() const
+{
+	return voltage_max_;
+}
+
+double EnergyAccumulator::current() const
+{
+	return current_;
+}
+
+double EnergyAccumulator::current_min() const
+{
+	return current_min_;
+}
+
+double EnergyAccumulator::current_max() const
+{
+	return current_max_;
+}
+
+double EnergyAccumulator::resistance() const
+{
+	return resistance_;
+}
+
+double EnergyAccumulator::resistance_min() const
+{
+	return resistance_min_;
+}
+
+double EnergyAccumulator::resistance_max() const
+{
+	return resistance_max_;
+}
+
+double EnergyAccumulator::power() const
+{
+	return power_;
+}
+
+double EnergyAccumulator::power_min() const
+{
+	return power_min_;
+}
+
+double EnergyAccumulator::power_max() const
+{
+	return power_max_;
+}
+
+double EnergyAccumulator::amp_hours() const
+{
+	return amp_hours_;
+}
+
+double EnergyAccumulator::watt_hours() const
+{
+	return watt_hours_;
+}
+
+} // namespace data
+} // namespace sv
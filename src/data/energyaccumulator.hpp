@@ -0,0 +1,125 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_ENERGYACCUMULATOR_HPP
+#define DATA_ENERGYACCUMULATOR_HPP
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * The EnergyAccumulator calculates the charge (Ah) and the energy (Wh) from a
+ * voltage and a current signal, as well as the min/max values of voltage,
+ * current, resistance and power.
+ *
+ * Every call of update() only processes the samples that were appended since
+ * the last call. The samples of both signals are combined to a common time
+ * base and integrated with the trapezoidal rule.
+ */
+class EnergyAccumulator
+{
+
+public:
+	EnergyAccumulator(shared_ptr<AnalogTimeSignal> voltage_signal,
+		shared_ptr<AnalogTimeSignal> current_signal);
+
+	/**
+	 * Reset all accumulated values. Only samples that are appended after
+	 * the reset are processed.
+	 */
+	void reset();
+
+	/**
+	 * Process all new samples of the voltage and current signals.
+	 *
+	 * @return true if new samples have been processed.
+	 */
+	bool update();
+
+	/**
+	 * Return true if samples have been appended to (or removed from) the
+	 * voltage or current signal since the last update().
+	 */
+	bool has_new_samples() const;
+
+	/**
+	 * Return true if at least one sample pair has been processed.
+	 */
+	bool has_values() const;
+
+	double voltage() const;
+	double voltage_min() const;
+	double voltage_max() const;
+	double current() const;
+	double current_min() const;
+	double current_max() const;
+	double resistance() const;
+	double resistance_min() const;
+	double resistance_max() const;
+	double power() const;
+	double power_min() const;
+	double power_max() const;
+	double amp_hours() const;
+	double watt_hours() const;
+
+private:
+	void process_sample(double timestamp, double voltage, double current);
+
+	shared_ptr<AnalogTimeSignal> voltage_signal_;
+	shared_ptr<AnalogTimeSignal> current_signal_;
+
+	// Aligned cursor into the voltage and current signals
+	size_t voltage_pos_;
+	size_t current_pos_;
+	shared_ptr<vector<double>> time_buffer_;
+	shared_ptr<vector<double>> voltage_buffer_;
+	shared_ptr<vector<double>> current_buffer_;
+
+	bool has_values_;
+	double last_timestamp_;
+	double voltage_;
+	double voltage_min_;
+	double voltage_max_;
+	double current_;
+	double current_min_;
+	double current_max_;
+	double resistance_;
+	double resistance_min_;
+	double resistance_max_;
+	double power_;
+	double power_min_;
+	double power_max_;
+	double amp_hours_;
+	double watt_hours_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_ENERGYACCUMULATOR_HPP
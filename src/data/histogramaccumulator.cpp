@@ -0,0 +1,329 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "histogramaccumulator.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::deque;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** Limit for the bin indices, to avoid overflows with outliers. */
+const double max_bin_index = 4611686018427387904.; // 2^62
+
+/** The max. number of samples read at once, to remove expired samples. */
+const size_t expire_chunk_size = 1024;
+
+/** Floor division by 2, also for negative bin indices. */
+int64_t half_bin(int64_t bin)
+{
+	return bin >= 0 ? bin / 2 : -((-bin + 1) / 2);
+}
+
+}
+
+const size_t HistogramAccumulator::max_bin_count;
+const size_t HistogramAccumulator::chunk_size;
+
+HistogramAccumulator::HistogramAccumulator(
+		shared_ptr<AnalogTimeSignal> signal,
+		double bin_width, double time_window) :
+	signal_(signal),
+	configured_bin_width_(bin_width > 0. ? bin_width : 0.),
+	time_window_(time_window > 0. ? time_window : 0.)
+{
+	assert(signal_);
+
+	reset(true);
+}
+
+void HistogramAccumulator::reset(bool from_start)
+{
+	bin_width_ = initial_bin_width();
+	first_bin_ = 0;
+	counts_.clear();
+	count_ = 0;
+	reference_value_ = std::numeric_limits<double>::quiet_NaN();
+	sum_ = 0.;
+	sum_squares_ = 0.;
+
+	size_t sample_count = signal_->sample_count();
+	if (!from_start) {
+		// Start at the current end of the signal
+		head_pos_ = sample_count;
+	}
+	else if (time_window_ > 0. && sample_count > 0) {
+		// Skip the samples, that are already outside of the time window.
+		head_pos_ = find_sample(
+			signal_->last_timestamp(false) - time_window_);
+	}
+	else {
+		head_pos_ = 0;
+	}
+	tail_pos_ = head_pos_;
+}
+
+bool HistogramAccumulator::update(size_t max_samples)
+{
+	// The signal has been cleared, start again at the beginning.
+	if (head_pos_ > signal_->sample_count())
+		reset(true);
+
+	size_t sample_count = signal_->sample_count();
+	size_t processed = 0;
+	while (head_pos_ < sample_count && processed < max_samples) {
+		size_t count = std::min(std::min(chunk_size, sample_count - head_pos_),
+			max_samples - processed);
+		timestamps_.resize(count);
+		values_.resize(count);
+		count = signal_->get_samples(head_pos_, count,
+			timestamps_.data(), values_.data());
+		if (count == 0)
+			break;
+
+		for (size_t i = 0; i < count; ++i)
+			add_value(values_[i]);
+		head_pos_ += count;
+		processed += count;
+
+		if (time_window_ > 0.)
+			remove_expired(timestamps_[count - 1]);
+	}
+
+	return processed > 0;
+}
+
+bool HistogramAccumulator::has_new_samples() const
+{
+	return head_pos_ != signal_->sample_count();
+}
+
+void HistogramAccumulator::set_bin_width(double bin_width)
+{
+	configured_bin_width_ = bin_width > 0. ? bin_width : 0.;
+	reset(true);
+}
+
+void HistogramAccumulator::set_time_window(double time_window)
+{
+	time_window_ = time_window > 0. ? time_window : 0.;
+	reset(true);
+}
+
+double HistogramAccumulator::time_window() const
+{
+	return time_window_;
+}
+
+double HistogramAccumulator::bin_width() const
+{
+	return bin_width_;
+}
+
+int64_t HistogramAccumulator::first_bin() const
+{
+	return first_bin_;
+}
+
+const deque<uint64_t> &HistogramAccumulator::counts() const
+{
+	return counts_;
+}
+
+uint64_t HistogramAccumulator::count() const
+{
+	return count_;
+}
+
+double HistogramAccumulator::mean() const
+{
+	if (count_ == 0)
+		return std::numeric_limits<double>::quiet_NaN();
+	return reference_value_ + sum_ / count_;
+}
+
+double HistogramAccumulator::std_dev() const
+{
+	if (count_ < 2)
+		return std::numeric_limits<double>::quiet_NaN();
+	double variance = (sum_squares_ - sum_ * sum_ / count_) / (count_ - 1);
+	return std::sqrt(std::max(variance, 0.));
+}
+
+double HistogramAccumulator::initial_bin_width() const
+{
+	if (configured_bin_width_ > 0.)
+		return configured_bin_width_;
+
+	// The resolution of the signal
+	int decimal_places = std::max(-15, std::min(signal_->decimal_places(), 15));
+	return std::pow(10., -decimal_places);
+}
+
+int64_t HistogramAccumulator::bin_index(double value) const
+{
+	double bin = std::floor(value / bin_width_);
+	bin = std::max(-max_bin_index, std::min(bin, max_bin_index));
+	return (int64_t)bin;
+}
+
+void HistogramAccumulator::add_value(double value)
+{
+	if (!std::isfinite(value))
+		return;
+
+	if (count_ == 0) {
+		reference_value_ = value;
+		sum_ = 0.;
+		sum_squares_ = 0.;
+	}
+
+	int64_t bin = bin_index(value);
+	if (counts_.empty()) {
+		first_bin_ = bin;
+		counts_.push_back(0);
+	}
+	else {
+		// Merge bins until the new range fits.
+		while (std::max(first_bin_ + (int64_t)counts_.size() - 1, bin) -
+				std::min(first_bin_, bin) >= (int64_t)max_bin_count) {
+			merge_bins();
+			bin = bin_index(value);
+		}
+		if (bin < first_bin_) {
+			counts_.insert(counts_.begin(), (size_t)(first_bin_ - bin), 0);
+			first_bin_ = bin;
+		}
+		else if (bin >= first_bin_ + (int64_t)counts_.size()) {
+			counts_.resize((size_t)(bin - first_bin_ + 1), 0);
+		}
+	}
+
+	++counts_[(size_t)(bin - first_bin_)];
+	++count_;
+	double delta = value - reference_value_;
+	sum_ += delta;
+	sum_squares_ += delta * delta;
+}
+
+void HistogramAccumulator::remove_value(double value)
+{
+	if (!std::isfinite(value))
+		return;
+
+	int64_t bin = bin_index(value);
+	if (bin < first_bin_ || bin >= first_bin_ + (int64_t)counts_.size())
+		return;
+	auto &bin_count = counts_[(size_t)(bin - first_bin_)];
+	if (bin_count == 0)
+		return;
+
+	--bin_count;
+	--count_;
+	double delta = value - reference_value_;
+	sum_ -= delta;
+	sum_squares_ -= delta * delta;
+}
+
+void HistogramAccumulator::merge_bins()
+{
+	bin_width_ *= 2.;
+	if (counts_.empty())
+		return;
+
+	int64_t last_bin = first_bin_ + (int64_t)counts_.size() - 1;
+	int64_t new_first_bin = half_bin(first_bin_);
+	deque<uint64_t> merged_counts(
+		(size_t)(half_bin(last_bin) - new_first_bin + 1), 0);
+	for (size_t i = 0; i < counts_.size(); ++i) {
+		int64_t bin = half_bin(first_bin_ + (int64_t)i);
+		merged_counts[(size_t)(bin - new_first_bin)] += counts_[i];
+	}
+	counts_.swap(merged_counts);
+	first_bin_ = new_first_bin;
+}
+
+void HistogramAccumulator::trim_bins()
+{
+	while (!counts_.empty() && counts_.front() == 0) {
+		counts_.pop_front();
+		++first_bin_;
+	}
+	while (!counts_.empty() && counts_.back() == 0)
+		counts_.pop_back();
+}
+
+void HistogramAccumulator::remove_expired(double timestamp)
+{
+	const double limit = timestamp - time_window_;
+	while (tail_pos_ < head_pos_) {
+		size_t count = std::min(expire_chunk_size, head_pos_ - tail_pos_);
+		timestamps_.resize(count);
+		values_.resize(count);
+		count = signal_->get_samples(tail_pos_, count,
+			timestamps_.data(), values_.data());
+
+		size_t expired = 0;
+		while (expired < count && timestamps_[expired] < limit) {
+			remove_value(values_[expired]);
+			++expired;
+		}
+		tail_pos_ += expired;
+		if (expired < count || count == 0)
+			break;
+	}
+
+	trim_bins();
+}
+
+size_t HistogramAccumulator::find_sample(double timestamp) const
+{
+	// Binary search for the first sample at or after the timestamp.
+	size_t first = 0;
+	size_t last = signal_->sample_count();
+	while (first < last) {
+		size_t mid = first + (last - first) / 2;
+		double mid_timestamp;
+		double mid_value;
+		if (signal_->get_samples(mid, 1, &mid_timestamp, &mid_value) == 0)
+			break;
+		if (mid_timestamp < timestamp)
+			first = mid + 1;
+		else
+			last = mid;
+	}
+	return first;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,157 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_HISTOGRAMACCUMULATOR_HPP
+#define DATA_HISTOGRAMACCUMULATOR_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <memory>
+#include <vector>
+
+using std::deque;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * The HistogramAccumulator counts the samples of an analog time signal in
+ * bins of equal width.
+ *
+ * Every call of update() only processes the samples that were appended since
+ * the last call, so the work per sample is constant and the history is never
+ * scanned again. The bins are aligned to multiples of the bin width and the
+ * range is expanded automatically. When the range exceeds max_bin_count
+ * bins, two neighboring bins are merged (the bin width is doubled).
+ *
+ * With a time window, every sample is removed again from its bin when it
+ * leaves the window, so the histogram only shows the last seconds.
+ */
+class HistogramAccumulator
+{
+
+public:
+	static const size_t max_bin_count = 4096;
+	/** The max. number of samples read from the signal at once. */
+	static const size_t chunk_size = 65536;
+
+	/**
+	 * @param signal The signal to count.
+	 * @param bin_width The initial bin width. If 0, the resolution of the
+	 *        signal (decimal places) is used.
+	 * @param time_window Only count the samples of the last time_window
+	 *        seconds. If 0, all samples are counted.
+	 */
+	HistogramAccumulator(shared_ptr<AnalogTimeSignal> signal,
+		double bin_width = 0., double time_window = 0.);
+
+	/**
+	 * Clear the histogram. If from_start is true, all samples of the signal
+	 * are counted again, otherwise only the samples that are appended after
+	 * the reset.
+	 */
+	void reset(bool from_start = false);
+
+	/**
+	 * Count max. max_samples new samples of the signal.
+	 *
+	 * @return true if samples have been processed.
+	 */
+	bool update(size_t max_samples = std::numeric_limits<size_t>::max());
+
+	/**
+	 * Return true if samples have been appended to (or removed from) the
+	 * signal since the last update().
+	 */
+	bool has_new_samples() const;
+
+	/**
+	 * Set the bin width. If 0, the resolution of the signal is used. The
+	 * samples are counted again from the start of the signal.
+	 */
+	void set_bin_width(double bin_width);
+
+	/**
+	 * Set the time window in seconds. If 0, all samples are counted. The
+	 * samples are counted again from the start of the signal.
+	 */
+	void set_time_window(double time_window);
+	double time_window() const;
+
+	/** Return the actual bin width. */
+	double bin_width() const;
+
+	/**
+	 * Return the index of the first bin. The lower edge of the first bin is
+	 * first_bin() * bin_width().
+	 */
+	int64_t first_bin() const;
+
+	/** Return the counts of the bins, starting with first_bin(). */
+	const deque<uint64_t> &counts() const;
+
+	/** Return the number of counted samples. */
+	uint64_t count() const;
+	double mean() const;
+	double std_dev() const;
+
+private:
+	double initial_bin_width() const;
+	void add_value(double value);
+	void remove_value(double value);
+	int64_t bin_index(double value) const;
+	void merge_bins();
+	void trim_bins();
+	void remove_expired(double timestamp);
+	size_t find_sample(double timestamp) const;
+
+	shared_ptr<AnalogTimeSignal> signal_;
+	double configured_bin_width_;
+	double time_window_;
+
+	double bin_width_;
+	int64_t first_bin_;
+	deque<uint64_t> counts_;
+
+	/** The position of the next sample to count. */
+	size_t head_pos_;
+	/** The position of the oldest counted sample (time window). */
+	size_t tail_pos_;
+
+	uint64_t count_;
+	/** The sums are relative to the first value, for numerical stability. */
+	double reference_value_;
+	double sum_;
+	double sum_squares_;
+
+	vector<double> timestamps_;
+	vector<double> values_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_HISTOGRAMACCUMULATOR_HPP
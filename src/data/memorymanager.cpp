@@ -0,0 +1,331 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+#include <QDebug>
+#include <QDir>
+#include <QSettings>
+#include <QString>
+
+#include "memorymanager.hpp"
+#include "src/data/samplebuffer.hpp"
+
+using std::lock_guard;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+const double mib = 1024. * 1024.;
+
+QString format_mib(size_t bytes)
+{
+	return QString::number(bytes / mib, 'f', 1);
+}
+
+}
+
+constexpr double MemoryManager::low_water_mark;
+constexpr double MemoryManager::high_water_mark;
+
+MemoryManager &MemoryManager::instance()
+{
+	static MemoryManager memory_manager;
+	return memory_manager;
+}
+
+MemoryManager::MemoryManager() :
+	budget_(0),
+	spill_enabled_(true),
+	native_precision_enabled_(true),
+	spill_directory_(QDir::tempPath()),
+	memory_size_(0),
+	spilled_size_(0),
+	access_time_(0),
+	warned_(false),
+	out_of_memory_reported_(false),
+	spill_failed_(false),
+	evictable_chunks_(0),
+	exhausted_evictable_chunks_(0),
+	spill_requested_(false),
+	spill_stop_(false)
+{
+}
+
+MemoryManager::~MemoryManager()
+{
+	{
+		lock_guard<std::mutex> lock(spill_mutex_);
+		spill_stop_ = true;
+	}
+	spill_cv_.notify_one();
+	if (spill_thread_.joinable())
+		spill_thread_.join();
+}
+
+void MemoryManager::set_budget(size_t budget)
+{
+	budget_ = budget;
+	warned_ = false;
+	spill_failed_ = false;
+	enforce_budget();
+}
+
+size_t MemoryManager::budget() const
+{
+	return budget_;
+}
+
+void MemoryManager::set_spill_enabled(bool spill_enabled)
+{
+	spill_enabled_ = spill_enabled;
+	warned_ = false;
+	spill_failed_ = false;
+	enforce_budget();
+}
+
+bool MemoryManager::is_spill_enabled() const
+{
+	return spill_enabled_;
+}
+
+void MemoryManager::set_spill_directory(const QString &spill_directory)
+{
+	lock_guard<std::mutex> lock(spill_directory_mutex_);
+	spill_directory_ = spill_directory;
+	spill_failed_ = false;
+}
+
+QString MemoryManager::spill_directory() const
+{
+	lock_guard<std::mutex> lock(spill_directory_mutex_);
+	return spill_directory_;
+}
+
+void MemoryManager::set_native_precision_enabled(
+	bool native_precision_enabled)
+{
+	native_precision_enabled_ = native_precision_enabled;
+}
+
+bool MemoryManager::is_native_precision_enabled() const
+{
+	return native_precision_enabled_;
+}
+
+size_t MemoryManager::memory_size() const
+{
+	return memory_size_;
+}
+
+size_t MemoryManager::spilled_size() const
+{
+	return spilled_size_;
+}
+
+void MemoryManager::report_out_of_memory(const QString &source)
+{
+	qWarning() << "MemoryManager: Out of memory in" << source;
+	if (out_of_memory_reported_.exchange(true))
+		return;
+
+	Q_EMIT memory_warning(tr("%1 ran out of memory, samples have been lost! "
+		"%2 MiB are in use. Set a memory budget to move old samples to the "
+		"disk.").arg(source).arg(format_mib(memory_size_)));
+}
+
+void MemoryManager::save_settings(QSettings &settings) const
+{
+	settings.setValue("budget", (qulonglong)budget_);
+	settings.setValue("spill_enabled", (bool)spill_enabled_);
+	settings.setValue("spill_directory", spill_directory());
+	settings.setValue("native_precision",
+		(bool)native_precision_enabled_);
+}
+
+void MemoryManager::restore_settings(QSettings &settings)
+{
+	if (settings.contains("spill_directory"))
+		set_spill_directory(settings.value("spill_directory").toString());
+	if (settings.contains("spill_enabled"))
+		set_spill_enabled(settings.value("spill_enabled").toBool());
+	if (settings.contains("native_precision"))
+		set_native_precision_enabled(
+			settings.value("native_precision").toBool());
+	if (settings.contains("budget"))
+		set_budget((size_t)settings.value("budget").toULongLong());
+}
+
+void MemoryManager::add_buffer(SampleBuffer *buffer)
+{
+	lock_guard<std::mutex> lock(mutex_);
+	buffers_.insert(buffer);
+}
+
+void MemoryManager::remove_buffer(SampleBuffer *buffer)
+{
+	lock_guard<std::mutex> lock(mutex_);
+	buffers_.erase(buffer);
+}
+
+void MemoryManager::add_sizes(ptrdiff_t memory_delta, ptrdiff_t spilled_delta)
+{
+	memory_size_ += memory_delta;
+	spilled_size_ += spilled_delta;
+}
+
+uint64_t MemoryManager::access_time() const
+{
+	return access_time_.load(std::memory_order_relaxed);
+}
+
+void MemoryManager::add_evictable_chunk()
+{
+	++evictable_chunks_;
+	// The chunks, that are read from now on, are newer than this chunk.
+	access_time_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MemoryManager::enforce_budget()
+{
+	const size_t budget = budget_;
+	if (budget == 0)
+		return;
+
+	const size_t target = (size_t)(budget * low_water_mark);
+	if (memory_size_ <= budget) {
+		if (memory_size_ < target) {
+			warned_ = false;
+			out_of_memory_reported_ = false;
+		}
+		return;
+	}
+
+	if (!spill_enabled_) {
+		warn(tr("The memory budget of %1 MiB is exceeded (%2 MiB in use) and "
+			"spilling to disk is disabled. SmuView may run out of memory and "
+			"lose samples!").arg(format_mib(budget)).
+			arg(format_mib(memory_size_)));
+		return;
+	}
+	if (spill_failed_)
+		return;
+
+	// The worker can't keep up with the acquisition (e.g. a slow disk).
+	if (memory_size_ > (size_t)(budget * high_water_mark)) {
+		warn(tr("The memory budget of %1 MiB is exceeded (%2 MiB in use), "
+			"the samples can't be moved to the disk fast enough. SmuView may "
+			"run out of memory and lose samples!").
+			arg(format_mib(budget)).arg(format_mib(memory_size_)));
+	}
+
+	{
+		lock_guard<std::mutex> lock(spill_mutex_);
+		if (spill_requested_ || spill_stop_)
+			return;
+		spill_requested_ = true;
+		if (!spill_thread_.joinable()) {
+			spill_thread_ = std::thread(
+				&MemoryManager::spill_thread_proc, this);
+		}
+	}
+	spill_cv_.notify_one();
+}
+
+void MemoryManager::spill_thread_proc()
+{
+	while (true) {
+		{
+			std::unique_lock<std::mutex> lock(spill_mutex_);
+			spill_cv_.wait(lock,
+				[this]() { return spill_requested_ || spill_stop_; });
+			if (spill_stop_)
+				return;
+		}
+
+		spill();
+
+		// New requests during spill() are covered by the next run.
+		lock_guard<std::mutex> lock(spill_mutex_);
+		spill_requested_ = false;
+	}
+}
+
+void MemoryManager::spill()
+{
+	const size_t budget = budget_;
+	if (budget == 0 || !spill_enabled_ || spill_failed_)
+		return;
+
+	lock_guard<std::mutex> lock(mutex_);
+	// All chunks have been evicted in the last run.
+	const uint64_t evictable_chunks = evictable_chunks_;
+	if (evictable_chunks == exhausted_evictable_chunks_)
+		return;
+
+	const size_t target = (size_t)(budget * low_water_mark);
+	while (memory_size_ > target && !spill_stop_) {
+		SampleBuffer *oldest_buffer = nullptr;
+		uint64_t oldest_access = 0;
+		for (const auto &buffer : buffers_) {
+			uint64_t last_access;
+			if (buffer->oldest_chunk(last_access) &&
+					(!oldest_buffer || last_access < oldest_access)) {
+				oldest_buffer = buffer;
+				oldest_access = last_access;
+			}
+		}
+
+		if (!oldest_buffer) {
+			exhausted_evictable_chunks_ = evictable_chunks;
+			warn(tr("The memory budget of %1 MiB is exceeded (%2 MiB in use), "
+				"but there are no more samples to move to the disk. SmuView "
+				"may run out of memory and lose samples!").
+				arg(format_mib(budget)).arg(format_mib(memory_size_)));
+			return;
+		}
+		if (!oldest_buffer->evict_oldest_chunk(spill_buffer_)) {
+			spill_failed_ = true;
+			warn(tr("The memory budget of %1 MiB is exceeded (%2 MiB in use), "
+				"but the samples can't be written to the spill directory "
+				"\"%3\". SmuView may run out of memory and lose samples!").
+				arg(format_mib(budget)).arg(format_mib(memory_size_)).
+				arg(spill_directory()));
+			return;
+		}
+	}
+}
+
+void MemoryManager::warn(const QString &message)
+{
+	if (warned_.exchange(true))
+		return;
+
+	qWarning() << "MemoryManager:" << message;
+	Q_EMIT memory_warning(message);
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,182 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_MEMORYMANAGER_HPP
+#define DATA_MEMORYMANAGER_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QSettings>
+#include <QString>
+
+using std::set;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class SampleBuffer;
+
+/**
+ * The MemoryManager accounts the memory of all SampleBuffers and enforces a
+ * global memory budget.
+ *
+ * When the budget is exceeded, the least recently used sealed chunks of all
+ * buffers are written to spill files and removed from memory, until the
+ * memory usage is below low_water_mark of the budget. The spilling is done
+ * by a worker thread, so the acquisition threads never wait for the disk.
+ * When the budget can't be kept (spilling is disabled, the spill files can't
+ * be written or the worker can't keep up), memory_warning() is emitted once,
+ * before the memory runs out and samples are lost.
+ */
+class MemoryManager : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** Evict chunks until the memory usage is below 90% of the budget. */
+	static constexpr double low_water_mark = 0.9;
+	/** Warn, when the spill worker is 50% of the budget behind. */
+	static constexpr double high_water_mark = 1.5;
+
+	~MemoryManager();
+
+	/**
+	 * Return the memory manager instance, shared by all buffers.
+	 */
+	static MemoryManager &instance();
+
+	/**
+	 * Set the memory budget in bytes. 0 means no budget.
+	 */
+	void set_budget(size_t budget);
+	size_t budget() const;
+
+	/**
+	 * Enable or disable the spilling of old chunks to disk. When disabled,
+	 * only a warning is emitted when the budget is exceeded.
+	 */
+	void set_spill_enabled(bool spill_enabled);
+	bool is_spill_enabled() const;
+
+	/**
+	 * Set the directory for the spill files. Per default the temporary
+	 * directory of the system is used.
+	 */
+	void set_spill_directory(const QString &spill_directory);
+	QString spill_directory() const;
+
+	/**
+	 * Store the values of new signals in the precision of the device (e.g.
+	 * as floats), instead of always as doubles. This halves the memory for
+	 * the values of most devices. Enabled per default.
+	 */
+	void set_native_precision_enabled(bool native_precision_enabled);
+	bool is_native_precision_enabled() const;
+
+	/** Return the number of bytes of all buffers in memory. */
+	size_t memory_size() const;
+
+	/** Return the number of bytes of all buffers, that are only on disk. */
+	size_t spilled_size() const;
+
+	/**
+	 * Report, that the memory ran out and samples have been lost.
+	 */
+	void report_out_of_memory(const QString &source);
+
+	void save_settings(QSettings &settings) const;
+	void restore_settings(QSettings &settings);
+
+private:
+	friend class SampleBuffer;
+
+	MemoryManager();
+
+	void add_buffer(SampleBuffer *buffer);
+	void remove_buffer(SampleBuffer *buffer);
+	void add_sizes(ptrdiff_t memory_delta, ptrdiff_t spilled_delta);
+	/**
+	 * Return the current access time for the LRU eviction. The clock only
+	 * advances, when a chunk is sealed or paged in, so reading it is cheap.
+	 */
+	uint64_t access_time() const;
+	/** A chunk has been sealed or paged in and can be evicted. */
+	void add_evictable_chunk();
+
+	/**
+	 * Wake up the spill worker, when the budget is exceeded. This never
+	 * blocks, so it can be called from the acquisition threads.
+	 */
+	void enforce_budget();
+	void spill_thread_proc();
+	/** Spill the oldest chunks, until the usage is below the target. */
+	void spill();
+	void warn(const QString &message);
+
+	/** Protects the buffers, held by the spill worker while it spills. */
+	std::mutex mutex_;
+	set<SampleBuffer *> buffers_;
+	std::atomic<size_t> budget_;
+	std::atomic<bool> spill_enabled_;
+	std::atomic<bool> native_precision_enabled_;
+	mutable std::mutex spill_directory_mutex_;
+	QString spill_directory_;
+	std::atomic<size_t> memory_size_;
+	std::atomic<size_t> spilled_size_;
+	std::atomic<uint64_t> access_time_;
+	/** A warning has been emitted, reset when the usage has decreased. */
+	std::atomic<bool> warned_;
+	std::atomic<bool> out_of_memory_reported_;
+	/** Don't try again to spill after an error, until the config changes. */
+	std::atomic<bool> spill_failed_;
+	/** Counts the sealed and paged in chunks, to skip useless searches. */
+	std::atomic<uint64_t> evictable_chunks_;
+	uint64_t exhausted_evictable_chunks_;
+
+	/** The spill worker is started, when the budget is exceeded first. */
+	std::thread spill_thread_;
+	std::mutex spill_mutex_;
+	std::condition_variable spill_cv_;
+	bool spill_requested_;
+	std::atomic<bool> spill_stop_;
+	/** A copy of the chunk, that is written by the spill worker. */
+	vector<char> spill_buffer_;
+
+Q_SIGNALS:
+	/**
+	 * Emitted (in the thread, that allocates the memory, or in the spill
+	 * worker) when the memory budget can't be kept or the memory ran out.
+	 */
+	void memory_warning(const QString &message);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_MEMORYMANAGER_HPP
@@ -0,0 +1,407 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "resampler.hpp"
+#include "src/data/analogtimesignal.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t Resampler::chunk_size;
+
+Resampler::Resampler(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		ResampleMode mode, double interval, double origin) :
+	signals_(signals),
+	mode_(mode),
+	interval_(interval),
+	origin_(origin),
+	auto_origin_(std::isnan(origin))
+{
+	assert(interval_ > 0.);
+
+	init(-std::numeric_limits<double>::infinity());
+}
+
+Resampler::Resampler(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		ResampleMode mode, shared_ptr<AnalogTimeSignal> reference_signal) :
+	signals_(signals),
+	mode_(mode),
+	interval_(0.),
+	origin_(0.),
+	auto_origin_(false),
+	reference_signal_(reference_signal)
+{
+	assert(reference_signal_);
+
+	init(-std::numeric_limits<double>::infinity());
+}
+
+void Resampler::init(double start_timestamp)
+{
+	started_ = false;
+	start_timestamp_ = 0.;
+	next_k_ = 0;
+	if (auto_origin_)
+		origin_ = std::numeric_limits<double>::quiet_NaN();
+
+	SampleBuffer empty_buffer = { {}, {}, 0, chunk_size };
+	buffers_.assign(signals_.size(), empty_buffer);
+	reference_buffer_ = empty_buffer;
+
+	if (start_timestamp > -std::numeric_limits<double>::infinity()) {
+		for (size_t i = 0; i < signals_.size(); ++i)
+			buffers_[i].buffer_pos = start_pos(signals_[i], start_timestamp);
+		if (reference_signal_) {
+			reference_buffer_.buffer_pos =
+				start_pos(reference_signal_, start_timestamp);
+		}
+	}
+}
+
+size_t Resampler::start_pos(const shared_ptr<AnalogTimeSignal> &signal,
+	double start_timestamp)
+{
+	// Keep the sample before the time stamp for the interpolation.
+	size_t pos = signal->lower_bound(start_timestamp);
+	return pos > 0 ? pos - 1 : 0;
+}
+
+size_t Resampler::process(vector<double> &time,
+	vector<vector<double>> &values, size_t max_points)
+{
+	values.resize(signals_.size());
+	if (signals_.empty())
+		return 0;
+
+	size_t total_count = 0;
+	while (total_count < max_points) {
+		for (size_t i = 0; i < signals_.size(); ++i)
+			fill_buffer(signals_[i], buffers_[i]);
+		if (reference_signal_)
+			fill_buffer(reference_signal_, reference_buffer_);
+
+		if (!started_ && !find_start())
+			break;
+
+		// Only the grid points up to the last buffered sample of every
+		// signal are fully determined.
+		double limit = std::numeric_limits<double>::infinity();
+		for (const auto &buffer : buffers_) {
+			if (buffer.timestamps.empty())
+				return total_count;
+			limit = std::min(limit, buffer.timestamps.back());
+		}
+
+		size_t count = build_grid(limit,
+			std::min(max_points - total_count, chunk_size));
+		if (count == 0) {
+			// A bin may be longer than a full buffer. Grow the buffers, that
+			// are full and have more samples, otherwise wait for new samples.
+			bool grown = false;
+			for (size_t i = 0; i < signals_.size(); ++i) {
+				auto &buffer = buffers_[i];
+				if (buffer.timestamps.size() >= buffer.capacity &&
+					buffer.timestamps.back() <= limit &&
+					signals_[i]->sample_count() >
+						buffer.buffer_pos + buffer.timestamps.size()) {
+					buffer.capacity *= 2;
+					grown = true;
+				}
+			}
+			if (reference_signal_ &&
+				reference_buffer_.timestamps.size() >=
+					reference_buffer_.capacity) {
+				reference_buffer_.capacity *= 2;
+				grown = true;
+			}
+			if (!grown)
+				break;
+			continue;
+		}
+
+		time.insert(time.end(), grid_.begin(), grid_.begin() + count);
+		for (size_t i = 0; i < signals_.size(); ++i) {
+			auto &signal_values = values[i];
+			size_t old_size = signal_values.size();
+			signal_values.resize(old_size + count);
+			resample_signal(buffers_[i], count, signal_values.data() + old_size);
+		}
+
+		// The samples before the next grid point are not needed anymore,
+		// except the last one.
+		double next_timestamp;
+		if (reference_signal_) {
+			auto &ts = reference_buffer_.timestamps;
+			auto &vs = reference_buffer_.values;
+			ts.erase(ts.begin(), ts.begin() + count);
+			vs.erase(vs.begin(), vs.begin() + count);
+			reference_buffer_.buffer_pos += count;
+			next_timestamp = ts.empty() ? grid_[count - 1] : ts.front();
+		}
+		else {
+			next_k_ += count;
+			next_timestamp = origin_ + next_k_ * interval_;
+		}
+		for (auto &buffer : buffers_)
+			drop_samples(buffer, next_timestamp);
+
+		total_count += count;
+	}
+
+	return total_count;
+}
+
+void Resampler::reset(double start_timestamp)
+{
+	init(start_timestamp);
+}
+
+const vector<shared_ptr<AnalogTimeSignal>> &Resampler::signals() const
+{
+	return signals_;
+}
+
+ResampleMode Resampler::mode() const
+{
+	return mode_;
+}
+
+void Resampler::resample(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+	ResampleMode mode, double interval,
+	vector<double> &time, vector<vector<double>> &values)
+{
+	Resampler resampler(signals, mode, interval);
+	resampler.process(time, values);
+}
+
+void Resampler::fill_buffer(const shared_ptr<AnalogTimeSignal> &signal,
+	SampleBuffer &buffer)
+{
+	size_t size = buffer.timestamps.size();
+	if (size >= buffer.capacity)
+		return;
+
+	size_t pos = buffer.buffer_pos + size;
+	size_t sample_count = signal->sample_count();
+	if (sample_count <= pos)
+		return;
+
+	size_t count = std::min(buffer.capacity - size, sample_count - pos);
+	buffer.timestamps.resize(size + count);
+	buffer.values.resize(size + count);
+	count = signal->get_samples(pos, count,
+		buffer.timestamps.data() + size, buffer.values.data() + size);
+	buffer.timestamps.resize(size + count);
+	buffer.values.resize(size + count);
+}
+
+bool Resampler::find_start()
+{
+	double start_timestamp = -std::numeric_limits<double>::infinity();
+	for (const auto &buffer : buffers_) {
+		if (buffer.timestamps.empty())
+			return false;
+		start_timestamp = std::max(start_timestamp, buffer.timestamps.front());
+	}
+	if (reference_signal_ && reference_buffer_.timestamps.empty())
+		return false;
+
+	start_timestamp_ = start_timestamp;
+	if (!reference_signal_) {
+		if (auto_origin_)
+			origin_ = start_timestamp_;
+		next_k_ = (int64_t)std::ceil((start_timestamp_ - origin_) / interval_);
+	}
+	started_ = true;
+	return true;
+}
+
+size_t Resampler::build_grid(double limit, size_t max_points)
+{
+	grid_.clear();
+
+	// For the box average, the end of the bin (the next grid point) must be
+	// determined, too.
+	const bool need_bin_end = mode_ == ResampleMode::BoxAverage;
+
+	if (reference_signal_) {
+		// Skip the reference time stamps before the common start.
+		auto &ts = reference_buffer_.timestamps;
+		auto &vs = reference_buffer_.values;
+		size_t skip = std::lower_bound(ts.begin(), ts.end(), start_timestamp_) -
+			ts.begin();
+		if (skip > 0) {
+			ts.erase(ts.begin(), ts.begin() + skip);
+			vs.erase(vs.begin(), vs.begin() + skip);
+			reference_buffer_.buffer_pos += skip;
+		}
+
+		size_t count = 0;
+		while (count < max_points && count < ts.size()) {
+			double end = need_bin_end ?
+				(count + 1 < ts.size() ? ts[count + 1] : limit + 1.) :
+				ts[count];
+			if (end > limit)
+				break;
+			grid_.push_back(ts[count]);
+			++count;
+		}
+		if (need_bin_end && count > 0)
+			grid_.push_back(ts[count]);
+		return count;
+	}
+
+	size_t count = 0;
+	while (count < max_points) {
+		double t = origin_ + (next_k_ + (int64_t)count) * interval_;
+		double end = need_bin_end ? t + interval_ : t;
+		if (end > limit)
+			break;
+		grid_.push_back(t);
+		++count;
+	}
+	if (need_bin_end && count > 0)
+		grid_.push_back(origin_ + (next_k_ + (int64_t)count) * interval_);
+	return count;
+}
+
+void Resampler::resample_signal(SampleBuffer &buffer, size_t count,
+	double *out)
+{
+	const double *ts = buffer.timestamps.data();
+	const double *vs = buffer.values.data();
+	const size_t n = buffer.timestamps.size();
+	const double *grid = grid_.data();
+	assert(n > 0);
+
+	index_.resize(count);
+	size_t *index = index_.data();
+
+	if (mode_ == ResampleMode::BoxAverage) {
+		end_index_.resize(count);
+		t0_.resize(count);
+		v0_.resize(count);
+		v1_.resize(count);
+		prefix_sum_.resize(n + 1);
+		size_t *end_index = end_index_.data();
+		double *sum = v0_.data();
+		double *hold = v1_.data();
+		double *bin_count = t0_.data();
+		double *prefix_sum = prefix_sum_.data();
+
+		prefix_sum[0] = 0.;
+		for (size_t i = 0; i < n; ++i)
+			prefix_sum[i + 1] = prefix_sum[i] + vs[i];
+
+		// Merge: Find the samples in [grid[j], grid[j+1]).
+		size_t begin = 0;
+		size_t end = 0;
+		for (size_t j = 0; j < count; ++j) {
+			while (begin < n && ts[begin] < grid[j])
+				++begin;
+			if (end < begin)
+				end = begin;
+			while (end < n && ts[end] < grid[j + 1])
+				++end;
+			index[j] = begin;
+			end_index[j] = end;
+		}
+
+		// Gather
+		for (size_t j = 0; j < count; ++j) {
+			sum[j] = prefix_sum[end_index[j]] - prefix_sum[index[j]];
+			bin_count[j] = (double)(end_index[j] - index[j]);
+			hold[j] = vs[index[j] > 0 ? index[j] - 1 : 0];
+		}
+
+		// Calculate
+		for (size_t j = 0; j < count; ++j)
+			out[j] = bin_count[j] > 0. ? sum[j] / bin_count[j] : hold[j];
+
+		return;
+	}
+
+	// Merge: Find the last sample at or before grid[j].
+	size_t pos = 0;
+	for (size_t j = 0; j < count; ++j) {
+		while (pos + 1 < n && ts[pos + 1] <= grid[j])
+			++pos;
+		index[j] = pos;
+	}
+
+	if (mode_ == ResampleMode::ZeroOrderHold) {
+		for (size_t j = 0; j < count; ++j)
+			out[j] = vs[index[j]];
+		return;
+	}
+
+	// Linear: Gather the adjacent samples
+	t0_.resize(count);
+	t1_.resize(count);
+	v0_.resize(count);
+	v1_.resize(count);
+	double *t0 = t0_.data();
+	double *t1 = t1_.data();
+	double *v0 = v0_.data();
+	double *v1 = v1_.data();
+	for (size_t j = 0; j < count; ++j) {
+		size_t i0 = index[j];
+		size_t i1 = i0 + 1 < n ? i0 + 1 : i0;
+		t0[j] = ts[i0];
+		t1[j] = ts[i1];
+		v0[j] = vs[i0];
+		v1[j] = vs[i1];
+	}
+
+	// Calculate
+	for (size_t j = 0; j < count; ++j) {
+		double dt = t1[j] - t0[j];
+		double fraction = dt > 0. ? (grid[j] - t0[j]) / dt : 0.;
+		out[j] = v0[j] + (v1[j] - v0[j]) * fraction;
+	}
+}
+
+void Resampler::drop_samples(SampleBuffer &buffer, double timestamp)
+{
+	// Keep the last sample before timestamp and all following samples.
+	auto &ts = buffer.timestamps;
+	auto &vs = buffer.values;
+	size_t keep = std::lower_bound(ts.begin(), ts.end(), timestamp) -
+		ts.begin();
+	if (keep == 0)
+		return;
+	--keep;
+
+	ts.erase(ts.begin(), ts.begin() + keep);
+	vs.erase(vs.begin(), vs.begin() + keep);
+	buffer.buffer_pos += keep;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,185 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_RESAMPLER_HPP
+#define DATA_RESAMPLER_HPP
+
+#include <cstdint>
+#include <limits>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include <QString>
+
+using std::map;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+enum class ResampleMode {
+	/** The value of the last sample at or before the grid time stamp. */
+	ZeroOrderHold,
+	/** Linear interpolation between the two adjacent samples. */
+	Linear,
+	/**
+	 * The mean of all samples in [t, t_next), where t_next is the next grid
+	 * time stamp (box filter). Empty bins hold the last value.
+	 */
+	BoxAverage,
+};
+
+// TODO: Use tr(), QCoreApplication::translate(), QT_TR_NOOP() or
+//       QT_TRANSLATE_NOOP() for translation.
+//       See: http://doc.qt.io/qt-5/i18n-source-translation.html
+typedef map<ResampleMode, QString> resample_mode_name_map_t;
+static resample_mode_name_map_t resample_mode_name_map = {
+	{ ResampleMode::ZeroOrderHold, QString("Zero-order hold") },
+	{ ResampleMode::Linear, QString("Linear") },
+	{ ResampleMode::BoxAverage, QString("Average") },
+};
+
+/**
+ * The Resampler maps one or more analog time signals onto a common time grid.
+ * The grid is either uniform (origin + k * interval) or the time stamps of a
+ * reference signal. Only the time range covered by all signals is resampled.
+ *
+ * The Resampler works incrementally: Every call of process() resamples the
+ * grid points, that are fully determined by the samples available so far,
+ * so it can be used for live data as well as for a bulk conversion (see
+ * resample()).
+ *
+ * The samples are copied in chunks into contiguous buffers. Finding the
+ * samples for the grid points is a linear merge, the values are calculated
+ * in separate loops over plain arrays, that the compiler can vectorize.
+ */
+class Resampler
+{
+
+public:
+	/** The max. number of buffered samples per signal. */
+	static const size_t chunk_size = 65536;
+
+	/**
+	 * Create a resampler with a uniform grid.
+	 *
+	 * @param signals The signals to resample.
+	 * @param mode The resample mode.
+	 * @param interval The distance between the grid points in seconds.
+	 * @param origin The absolute time stamp of one grid point. If NaN, the
+	 *        grid starts with the first time stamp covered by all signals.
+	 */
+	Resampler(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		ResampleMode mode, double interval,
+		double origin = std::numeric_limits<double>::quiet_NaN());
+
+	/**
+	 * Create a resampler, that uses the time stamps of the reference signal
+	 * as grid. The reference signal itself may be one of the signals.
+	 */
+	Resampler(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		ResampleMode mode, shared_ptr<AnalogTimeSignal> reference_signal);
+
+	/**
+	 * Resample all new grid points and append them to the vectors. The
+	 * values vector has one vector for every signal.
+	 *
+	 * @return The number of added grid points.
+	 */
+	size_t process(vector<double> &time, vector<vector<double>> &values,
+		size_t max_points = std::numeric_limits<size_t>::max());
+
+	/**
+	 * Restart the resampling at the given absolute time stamp. The buffers
+	 * start with the last sample before the time stamp, so the samples
+	 * before are never read. The default restarts at the beginning of the
+	 * signals.
+	 */
+	void reset(
+		double start_timestamp = -std::numeric_limits<double>::infinity());
+
+	const vector<shared_ptr<AnalogTimeSignal>> &signals() const;
+	ResampleMode mode() const;
+
+	/**
+	 * Resample the existing samples of the signals in one go.
+	 */
+	static void resample(const vector<shared_ptr<AnalogTimeSignal>> &signals,
+		ResampleMode mode, double interval,
+		vector<double> &time, vector<vector<double>> &values);
+
+private:
+	/**
+	 * The buffered samples of a signal. buffer_pos is the position of the
+	 * first buffered sample in the signal.
+	 */
+	struct SampleBuffer
+	{
+		vector<double> timestamps;
+		vector<double> values;
+		size_t buffer_pos;
+		/** Grows, when a bin doesn't fit into the buffer. */
+		size_t capacity;
+	};
+
+	void init(double start_timestamp);
+	static size_t start_pos(const shared_ptr<AnalogTimeSignal> &signal,
+		double start_timestamp);
+	void fill_buffer(const shared_ptr<AnalogTimeSignal> &signal,
+		SampleBuffer &buffer);
+	bool find_start();
+	size_t build_grid(double limit, size_t max_points);
+	void resample_signal(SampleBuffer &buffer, size_t count, double *out);
+	void drop_samples(SampleBuffer &buffer, double timestamp);
+
+	const vector<shared_ptr<AnalogTimeSignal>> signals_;
+	const ResampleMode mode_;
+	const double interval_;
+	double origin_;
+	const bool auto_origin_;
+	shared_ptr<AnalogTimeSignal> reference_signal_;
+
+	bool started_;
+	/** The first time stamp covered by all signals. */
+	double start_timestamp_;
+	/** The index of the next uniform grid point. */
+	int64_t next_k_;
+	vector<SampleBuffer> buffers_;
+	SampleBuffer reference_buffer_;
+
+	/** Scratch buffers for one batch of grid points. */
+	vector<double> grid_;
+	vector<size_t> index_;
+	vector<size_t> end_index_;
+	vector<double> t0_;
+	vector<double> t1_;
+	vector<double> v0_;
+	vector<double> v1_;
+	vector<double> prefix_sum_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_RESAMPLER_HPP
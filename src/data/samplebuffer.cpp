@@ -0,0 +1,739 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryFile>
+
+#include "samplebuffer.hpp"
+#include "src/data/memorymanager.hpp"
+
+using std::lock_guard;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** The capacity of a new chunk, it grows up to chunk_size. */
+const size_t min_chunk_capacity = 64;
+
+/**
+ * Make room for n more values in the chunk values and return the number of
+ * the newly allocated bytes. The values may move to a new allocation.
+ */
+template<typename D>
+ptrdiff_t reserve_chunk(vector<D> &chunk_values, size_t n)
+{
+	size_t capacity = chunk_values.capacity();
+	if (chunk_values.size() + n <= capacity)
+		return 0;
+
+	// Grow the chunk geometrically, so small signals stay small.
+	size_t new_capacity = std::max(min_chunk_capacity,
+		std::max(2 * capacity, chunk_values.size() + n));
+	chunk_values.reserve(std::min(new_capacity, SampleBuffer::chunk_size));
+	return (ptrdiff_t)((chunk_values.capacity() - capacity) * sizeof(D));
+}
+
+/** Return true, if appending n values would move the chunk values. */
+template<typename D>
+bool needs_reserve(const vector<D> &chunk_values, size_t n)
+{
+	return chunk_values.size() + n > chunk_values.capacity();
+}
+
+/**
+ * Return true, if all values can be stored as floats without a loss of
+ * precision.
+ */
+bool fits_single_precision(const double *values, size_t n)
+{
+	bool fits = true;
+	for (size_t i = 0; i < n; ++i) {
+		const double value = values[i];
+		// NaN never compares equal, but is stored as float NaN.
+		fits &= (double)(float)value == value || value != value;
+	}
+	return fits;
+}
+
+bool fits_single_precision(const float *values, size_t n)
+{
+	(void)values;
+	(void)n;
+	return true;
+}
+
+/**
+ * Widen the floats to doubles. All four values are loaded before they are
+ * stored, so the compiler can use SIMD conversions (e.g. cvtps2pd) without
+ * checking if the arrays overlap.
+ */
+void widen(const float *values, size_t n, double *out)
+{
+	size_t i = 0;
+	for (; i + 4 <= n; i += 4) {
+		const double value0 = values[i];
+		const double value1 = values[i + 1];
+		const double value2 = values[i + 2];
+		const double value3 = values[i + 3];
+		out[i] = value0;
+		out[i + 1] = value1;
+		out[i + 2] = value2;
+		out[i + 3] = value3;
+	}
+	for (; i < n; ++i)
+		out[i] = values[i];
+}
+
+}
+
+const size_t SampleBuffer::chunk_size;
+
+SampleBuffer::SampleBuffer() :
+	size_(0),
+	single_precision_(false),
+	readers_(0),
+	exclusive_(false),
+	generation_(0),
+	memory_size_(0),
+	spilled_size_(0)
+{
+	MemoryManager::instance().add_buffer(this);
+}
+
+SampleBuffer::~SampleBuffer()
+{
+	MemoryManager::instance().remove_buffer(this);
+	MemoryManager::instance().add_sizes(
+		-(ptrdiff_t)memory_size_, -(ptrdiff_t)spilled_size_);
+}
+
+size_t SampleBuffer::size() const
+{
+	return size_.load(std::memory_order_acquire);
+}
+
+bool SampleBuffer::empty() const
+{
+	return size() == 0;
+}
+
+bool SampleBuffer::set_single_precision(bool single_precision)
+{
+	lock_guard<std::mutex> lock(mutex_);
+	if (size_ > 0)
+		return single_precision == single_precision_;
+
+	begin_exclusive();
+	single_precision_ = single_precision;
+	end_exclusive();
+	return true;
+}
+
+bool SampleBuffer::is_single_precision() const
+{
+	lock_guard<std::mutex> lock(mutex_);
+	return single_precision_;
+}
+
+double SampleBuffer::at(size_t pos) const
+{
+	double value = std::numeric_limits<double>::quiet_NaN();
+
+	// Fast path for chunks in memory, without the mutex.
+	if (pin()) {
+		bool found = false;
+		if (pos >= size_.load(std::memory_order_acquire)) {
+			found = true;
+		}
+		else {
+			const Chunk &chunk = chunks_[pos / chunk_size];
+			if (chunk.resident.load(std::memory_order_acquire)) {
+				touch(chunk);
+				value = this->value(chunk, pos % chunk_size);
+				found = true;
+			}
+		}
+		unpin();
+		if (found)
+			return value;
+	}
+
+	bool paged_in = false;
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		if (pos >= size_)
+			return value;
+
+		const size_t chunk_index = pos / chunk_size;
+		Chunk &chunk = chunks_[chunk_index];
+		if (!is_in_memory(chunk)) {
+			if (!page_in(chunk, chunk_index))
+				return value;
+			paged_in = true;
+		}
+		touch(chunk);
+		value = this->value(chunk, pos % chunk_size);
+	}
+
+	// The paged in chunk may exceed the memory budget.
+	if (paged_in)
+		MemoryManager::instance().enforce_budget();
+	return value;
+}
+
+double SampleBuffer::front() const
+{
+	lock_guard<std::mutex> lock(mutex_);
+	if (chunks_.empty())
+		return std::numeric_limits<double>::quiet_NaN();
+	return chunks_.front().first_value;
+}
+
+double SampleBuffer::back() const
+{
+	lock_guard<std::mutex> lock(mutex_);
+	if (chunks_.empty())
+		return std::numeric_limits<double>::quiet_NaN();
+	return chunks_.back().last_value;
+}
+
+void SampleBuffer::push_back(double value)
+{
+	append(&value, 1);
+}
+
+void SampleBuffer::append(const double *values, size_t count)
+{
+	append_values(values, count);
+}
+
+void SampleBuffer::append(const float *values, size_t count)
+{
+	append_values(values, count);
+}
+
+template<typename T>
+void SampleBuffer::append_values(const T *values, size_t count)
+{
+	if (count == 0)
+		return;
+
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		append_locked(values, count);
+	}
+
+	MemoryManager::instance().enforce_budget();
+}
+
+template<typename T>
+void SampleBuffer::append_locked(const T *values, size_t count)
+{
+	// Doubles are never narrowed silently, the whole buffer is converted to
+	// double precision instead.
+	if (single_precision_ && !fits_single_precision(values, count))
+		widen_locked();
+
+	ptrdiff_t memory_delta = 0;
+	while (count > 0) {
+		if (chunks_.empty() || chunks_.back().count == chunk_size) {
+			// The full chunk is sealed now and may be evicted.
+			if (!chunks_.empty()) {
+				touch(chunks_.back());
+				MemoryManager::instance().add_evictable_chunk();
+			}
+			begin_exclusive();
+			chunks_.emplace_back();
+			end_exclusive();
+			Chunk &chunk = chunks_.back();
+			chunk.count = 0;
+			chunk.on_disk = false;
+			chunk.resident.store(true, std::memory_order_release);
+			touch(chunk);
+		}
+
+		Chunk &chunk = chunks_.back();
+		size_t n = std::min(count, chunk_size - chunk.count);
+		// The unlocked readers must not read the chunk, while it moves.
+		if (single_precision_ ?
+				needs_reserve(chunk.float_values, n) :
+				needs_reserve(chunk.values, n)) {
+			begin_exclusive();
+			if (single_precision_)
+				memory_delta += reserve_chunk(chunk.float_values, n);
+			else
+				memory_delta += reserve_chunk(chunk.values, n);
+			end_exclusive();
+		}
+		if (single_precision_) {
+			chunk.float_values.insert(
+				chunk.float_values.end(), values, values + n);
+		}
+		else {
+			chunk.values.insert(chunk.values.end(), values, values + n);
+		}
+		// The first and last values as stored, for lower_bound().
+		if (chunk.count == 0)
+			chunk.first_value = value(chunk, 0);
+		chunk.count += n;
+		chunk.last_value = value(chunk, chunk.count - 1);
+		// Publish the new values to the unlocked readers.
+		size_.store(size_ + n, std::memory_order_release);
+		values += n;
+		count -= n;
+	}
+
+	memory_size_ += memory_delta;
+	MemoryManager::instance().add_sizes(memory_delta, 0);
+}
+
+void SampleBuffer::widen_locked()
+{
+	begin_exclusive();
+
+	ptrdiff_t memory_delta = 0;
+	ptrdiff_t spilled_delta = 0;
+	for (size_t i = 0; i < chunks_.size(); ++i) {
+		Chunk &chunk = chunks_[i];
+		// The spilled floats are read back, because the layout of the spill
+		// file depends on the precision.
+		if (!is_in_memory(chunk) && !page_in(chunk, i)) {
+			qWarning() << "SampleBuffer::widen_locked(): Chunk" << i <<
+				"is lost";
+			chunk.float_values.assign(chunk.count,
+				std::numeric_limits<float>::quiet_NaN());
+			chunk.resident.store(true, std::memory_order_release);
+			memory_delta += (ptrdiff_t)(
+				chunk.float_values.capacity() * sizeof(float));
+			spilled_delta -= (ptrdiff_t)(chunk.count * sizeof(float));
+		}
+
+		// Keep the capacity of the last chunk, that is still growing.
+		const size_t float_capacity = chunk.float_values.capacity();
+		chunk.values.reserve(float_capacity);
+		chunk.values.resize(chunk.count);
+		widen(chunk.float_values.data(), chunk.count, chunk.values.data());
+		vector<float>().swap(chunk.float_values);
+		chunk.on_disk = false;
+		memory_delta += (ptrdiff_t)(chunk.values.capacity() * sizeof(double)) -
+			(ptrdiff_t)(float_capacity * sizeof(float));
+	}
+
+	++generation_;
+	{
+		lock_guard<std::mutex> file_lock(spill_file_mutex_);
+		if (spill_file_)
+			spill_file_->resize(0);
+	}
+	single_precision_ = false;
+	memory_size_ += memory_delta;
+	spilled_size_ += spilled_delta;
+	MemoryManager::instance().add_sizes(memory_delta, spilled_delta);
+
+	end_exclusive();
+}
+
+void SampleBuffer::clear()
+{
+	lock_guard<std::mutex> lock(mutex_);
+	MemoryManager::instance().add_sizes(
+		-(ptrdiff_t)memory_size_, -(ptrdiff_t)spilled_size_);
+	begin_exclusive();
+	chunks_.clear();
+	size_ = 0;
+	end_exclusive();
+	memory_size_ = 0;
+	spilled_size_ = 0;
+	++generation_;
+	{
+		lock_guard<std::mutex> file_lock(spill_file_mutex_);
+		if (spill_file_)
+			spill_file_->resize(0);
+	}
+}
+
+size_t SampleBuffer::copy(size_t pos, size_t count, double *values) const
+{
+	// Copy the chunks in memory without the mutex, the rest is paged in.
+	size_t copied = copy_resident(pos, count, values);
+	if (copied == count)
+		return copied;
+
+	bool paged_in = false;
+	{
+		lock_guard<std::mutex> lock(mutex_);
+		if (pos + copied >= size_)
+			return copied;
+		count = std::min(count, size_ - pos);
+
+		while (copied < count) {
+			const size_t chunk_index = (pos + copied) / chunk_size;
+			const size_t offset = (pos + copied) % chunk_size;
+			Chunk &chunk = chunks_[chunk_index];
+			if (!is_in_memory(chunk)) {
+				if (!page_in(chunk, chunk_index))
+					break;
+				paged_in = true;
+			}
+			touch(chunk);
+			size_t n = std::min(count - copied, chunk.count - offset);
+			if (single_precision_) {
+				widen(chunk.float_values.data() + offset, n, values + copied);
+			}
+			else {
+				std::copy(chunk.values.begin() + offset,
+					chunk.values.begin() + offset + n, values + copied);
+			}
+			copied += n;
+		}
+	}
+
+	if (paged_in)
+		MemoryManager::instance().enforce_budget();
+	return copied;
+}
+
+size_t SampleBuffer::lower_bound(double value) const
+{
+	bool paged_in = false;
+	size_t pos;
+	{
+		lock_guard<std::mutex> lock(mutex_);
+
+		// Find the chunk via the first and last values of the chunks, so
+		// only one chunk has to be paged in.
+		auto chunk_it = std::lower_bound(chunks_.begin(), chunks_.end(),
+			value, [](const Chunk &chunk, double v) {
+				return chunk.last_value < v;
+			});
+		if (chunk_it == chunks_.end())
+			return size_;
+
+		const size_t chunk_index = chunk_it - chunks_.begin();
+		Chunk &chunk = *chunk_it;
+		if (!is_in_memory(chunk)) {
+			if (!page_in(chunk, chunk_index))
+				return chunk_index * chunk_size;
+			paged_in = true;
+		}
+		touch(chunk);
+		size_t offset;
+		if (single_precision_) {
+			offset = std::lower_bound(chunk.float_values.begin(),
+				chunk.float_values.begin() + chunk.count, value,
+				[](float a, double b) { return a < b; }) -
+				chunk.float_values.begin();
+		}
+		else {
+			offset = std::lower_bound(chunk.values.begin(),
+				chunk.values.begin() + chunk.count, value) -
+				chunk.values.begin();
+		}
+		pos = chunk_index * chunk_size + offset;
+	}
+
+	if (paged_in)
+		MemoryManager::instance().enforce_budget();
+	return pos;
+}
+
+size_t SampleBuffer::memory_size() const
+{
+	lock_guard<std::mutex> lock(mutex_);
+	return memory_size_;
+}
+
+size_t SampleBuffer::spilled_size() const
+{
+	lock_guard<std::mutex> lock(mutex_);
+	return spilled_size_;
+}
+
+bool SampleBuffer::page_in(Chunk &chunk, size_t chunk_index) const
+{
+	// A chunk on disk has a spill file, it is only created by the worker.
+	if (!chunk.on_disk) {
+		qWarning() << "SampleBuffer::page_in(): Chunk" << chunk_index <<
+			"is not in the spill file";
+		return false;
+	}
+
+	const size_t spilled_bytes = chunk.count * value_size();
+	resize_chunk(chunk, chunk.count);
+	lock_guard<std::mutex> file_lock(spill_file_mutex_);
+	if (!spill_file_->seek((qint64)(chunk_index * chunk_size * value_size())) ||
+			spill_file_->read(chunk_data(chunk), (qint64)spilled_bytes) !=
+				(qint64)spilled_bytes) {
+		qWarning() << "SampleBuffer::page_in(): Could not read chunk" <<
+			chunk_index << "from" << spill_file_->fileName() << ":" <<
+			spill_file_->errorString();
+		release_chunk(chunk);
+		return false;
+	}
+
+	const size_t bytes = chunk_capacity_bytes(chunk);
+	memory_size_ += bytes;
+	spilled_size_ -= spilled_bytes;
+	MemoryManager::instance().add_sizes(
+		(ptrdiff_t)bytes, -(ptrdiff_t)spilled_bytes);
+	MemoryManager::instance().add_evictable_chunk();
+	chunk.resident.store(true, std::memory_order_release);
+	return true;
+}
+
+size_t SampleBuffer::copy_resident(size_t pos, size_t count,
+	double *values) const
+{
+	if (!pin())
+		return 0;
+
+	size_t copied = 0;
+	const size_t size = size_.load(std::memory_order_acquire);
+	if (pos < size) {
+		count = std::min(count, size - pos);
+		while (copied < count) {
+			const size_t chunk_index = (pos + copied) / chunk_size;
+			const size_t offset = (pos + copied) % chunk_size;
+			const Chunk &chunk = chunks_[chunk_index];
+			if (!chunk.resident.load(std::memory_order_acquire))
+				break;
+			touch(chunk);
+			// Don't use chunk.count, the last chunk may be filled right now.
+			size_t n = std::min(count - copied, chunk_size - offset);
+			if (single_precision_) {
+				widen(chunk.float_values.data() + offset, n, values + copied);
+			}
+			else {
+				std::copy(chunk.values.data() + offset,
+					chunk.values.data() + offset + n, values + copied);
+			}
+			copied += n;
+		}
+	}
+
+	unpin();
+	return copied;
+}
+
+void SampleBuffer::touch(const Chunk &chunk) const
+{
+	// Only read the clock of the MemoryManager and don't write the stamp
+	// again, so the readers don't contend on a shared cache line.
+	const uint64_t now = MemoryManager::instance().access_time();
+	if (chunk.last_access.load(std::memory_order_relaxed) != now)
+		chunk.last_access.store(now, std::memory_order_relaxed);
+}
+
+bool SampleBuffer::pin() const
+{
+	// Together with begin_exclusive(), either the reader sees the exclusive
+	// flag or the writer sees the reader (sequentially consistent).
+	readers_.fetch_add(1, std::memory_order_seq_cst);
+	if (exclusive_.load(std::memory_order_seq_cst)) {
+		readers_.fetch_sub(1, std::memory_order_release);
+		return false;
+	}
+	return true;
+}
+
+void SampleBuffer::unpin() const
+{
+	readers_.fetch_sub(1, std::memory_order_release);
+}
+
+void SampleBuffer::begin_exclusive() const
+{
+	exclusive_.store(true, std::memory_order_seq_cst);
+	while (readers_.load(std::memory_order_seq_cst) > 0)
+		std::this_thread::yield();
+}
+
+void SampleBuffer::end_exclusive() const
+{
+	exclusive_.store(false, std::memory_order_release);
+}
+
+bool SampleBuffer::is_in_memory(const Chunk &chunk) const
+{
+	return chunk.resident.load(std::memory_order_relaxed);
+}
+
+double SampleBuffer::value(const Chunk &chunk, size_t offset) const
+{
+	if (single_precision_)
+		return chunk.float_values[offset];
+	return chunk.values[offset];
+}
+
+char *SampleBuffer::chunk_data(Chunk &chunk) const
+{
+	if (single_precision_)
+		return (char *)chunk.float_values.data();
+	return (char *)chunk.values.data();
+}
+
+size_t SampleBuffer::chunk_capacity_bytes(const Chunk &chunk) const
+{
+	if (single_precision_)
+		return chunk.float_values.capacity() * sizeof(float);
+	return chunk.values.capacity() * sizeof(double);
+}
+
+void SampleBuffer::resize_chunk(Chunk &chunk, size_t count) const
+{
+	if (single_precision_)
+		chunk.float_values.resize(count);
+	else
+		chunk.values.resize(count);
+}
+
+void SampleBuffer::release_chunk(Chunk &chunk) const
+{
+	vector<double>().swap(chunk.values);
+	vector<float>().swap(chunk.float_values);
+}
+
+size_t SampleBuffer::value_size() const
+{
+	return single_precision_ ? sizeof(float) : sizeof(double);
+}
+
+bool SampleBuffer::oldest_chunk(uint64_t &last_access)
+{
+	lock_guard<std::mutex> lock(mutex_);
+
+	bool found = false;
+	// The last chunk is never sealed.
+	for (size_t i = 0; i + 1 < chunks_.size(); ++i) {
+		const Chunk &chunk = chunks_[i];
+		if (!is_in_memory(chunk))
+			continue;
+		if (!found || chunk.last_access < last_access) {
+			last_access = chunk.last_access;
+			found = true;
+		}
+	}
+	return found;
+}
+
+bool SampleBuffer::evict_oldest_chunk(vector<char> &spill_buffer)
+{
+	// Copy the chunk, so the buffer isn't locked while the file is written.
+	size_t chunk_index;
+	uint64_t generation;
+	size_t value_size;
+	qint64 bytes;
+	{
+		lock_guard<std::mutex> lock(mutex_);
+
+		chunk_index = chunks_.size();
+		for (size_t i = 0; i + 1 < chunks_.size(); ++i) {
+			const Chunk &chunk = chunks_[i];
+			if (!is_in_memory(chunk))
+				continue;
+			if (chunk_index == chunks_.size() ||
+					chunk.last_access < chunks_[chunk_index].last_access)
+				chunk_index = i;
+		}
+		if (chunk_index == chunks_.size())
+			return false;
+
+		Chunk &chunk = chunks_[chunk_index];
+		if (chunk.on_disk) {
+			release_resident_chunk(chunk);
+			return true;
+		}
+
+		generation = generation_;
+		value_size = this->value_size();
+		bytes = (qint64)(chunk.count * value_size);
+		spill_buffer.resize((size_t)bytes);
+		std::memcpy(spill_buffer.data(), chunk_data(chunk), (size_t)bytes);
+	}
+
+	{
+		lock_guard<std::mutex> file_lock(spill_file_mutex_);
+		if (!spill_file_) {
+			auto file = new QTemporaryFile(
+				QDir(MemoryManager::instance().spill_directory()).
+					filePath("smuview_spill_XXXXXX.bin"));
+			spill_file_.reset(file);
+			if (!file->open()) {
+				qWarning() << "SampleBuffer::evict_oldest_chunk(): " <<
+					"Could not create spill file:" << file->errorString();
+				spill_file_.reset();
+				return false;
+			}
+		}
+
+		// Sealed chunks never change, so they are written only once.
+		if (!spill_file_->seek(
+					(qint64)(chunk_index * chunk_size * value_size)) ||
+				spill_file_->write(spill_buffer.data(), bytes) != bytes ||
+				!spill_file_->flush()) {
+			qWarning() << "SampleBuffer::evict_oldest_chunk(): " <<
+				"Could not write to" << spill_file_->fileName() << ":" <<
+				spill_file_->errorString();
+			return false;
+		}
+	}
+
+	lock_guard<std::mutex> lock(mutex_);
+	// The buffer has been cleared or widened in the meantime.
+	if (generation != generation_ || chunk_index + 1 >= chunks_.size())
+		return true;
+	Chunk &chunk = chunks_[chunk_index];
+	if (!is_in_memory(chunk))
+		return true;
+	chunk.on_disk = true;
+	release_resident_chunk(chunk);
+	return true;
+}
+
+void SampleBuffer::release_resident_chunk(Chunk &chunk)
+{
+	const size_t bytes = chunk_capacity_bytes(chunk);
+	const size_t spilled_bytes = chunk.count * value_size();
+	begin_exclusive();
+	chunk.resident.store(false, std::memory_order_relaxed);
+	release_chunk(chunk);
+	end_exclusive();
+	memory_size_ -= bytes;
+	spilled_size_ += spilled_bytes;
+	MemoryManager::instance().add_sizes(
+		-(ptrdiff_t)bytes, (ptrdiff_t)spilled_bytes);
+}
+
+} // namespace data
+} // namespace sv
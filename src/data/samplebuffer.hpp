@@ -0,0 +1,218 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SAMPLEBUFFER_HPP
+#define DATA_SAMPLEBUFFER_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+class QFile;
+
+using std::deque;
+using std::unique_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class MemoryManager;
+
+/**
+ * The SampleBuffer stores the time stamps or the values of a signal in
+ * chunks of chunk_size values. The values can be stored in single precision,
+ * when the source of the values only delivers floats. They are still read
+ * as doubles. When a double is appended, that doesn't fit into a float, the
+ * whole buffer is converted to double precision.
+ *
+ * Full chunks are sealed and never change again. When the MemoryManager
+ * needs memory, its spill worker writes the oldest sealed chunks to a spill
+ * file and removes them from memory. They are paged back in, when they are read again. The
+ * last (unsealed) chunk always stays in memory.
+ *
+ * All methods are thread safe, so the buffer can be filled by the acquisition
+ * thread while it is read by the GUI and the worker threads. Reading chunks,
+ * that are in memory, doesn't lock the mutex: The readers only register in
+ * a counter, and the few operations, that move or free the memory of a chunk
+ * (growing, evicting, clearing), wait until there are no more readers.
+ */
+class SampleBuffer
+{
+
+public:
+	/** The number of values per chunk (512 KiB of doubles). */
+	static const size_t chunk_size = 65536;
+
+	SampleBuffer();
+	~SampleBuffer();
+
+	SampleBuffer(const SampleBuffer &) = delete;
+	SampleBuffer &operator=(const SampleBuffer &) = delete;
+
+	size_t size() const;
+	bool empty() const;
+
+	/**
+	 * Store the values as floats, to halve the memory of values that come
+	 * with single precision from the device. This can only be changed, while
+	 * the buffer is empty. The buffer is widened to double precision later,
+	 * if a double, that doesn't fit into a float, is appended.
+	 *
+	 * @return false if the precision can't be changed anymore.
+	 */
+	bool set_single_precision(bool single_precision);
+	bool is_single_precision() const;
+
+	/**
+	 * Return the value at pos. The chunk is paged in, if it has been spilled
+	 * to disk.
+	 */
+	double at(size_t pos) const;
+	double front() const;
+	double back() const;
+
+	void push_back(double value);
+	void append(const double *values, size_t count);
+	/**
+	 * Append floats. They are stored without a conversion, when the buffer
+	 * is single precision.
+	 */
+	void append(const float *values, size_t count);
+	void clear();
+
+	/**
+	 * Copy max. count values, starting at pos, to values. Single precision
+	 * values are converted in one go per chunk.
+	 *
+	 * @return The number of copied values.
+	 */
+	size_t copy(size_t pos, size_t count, double *values) const;
+
+	/**
+	 * Return the position of the first value, that is not less than value.
+	 * The values must be sorted in ascending order (e.g. time stamps).
+	 */
+	size_t lower_bound(double value) const;
+
+	/** Return the number of bytes of the chunks in memory. */
+	size_t memory_size() const;
+
+	/** Return the number of bytes of the chunks, that are only on disk. */
+	size_t spilled_size() const;
+
+private:
+	friend class MemoryManager;
+
+	struct Chunk
+	{
+		vector<double> values;
+		/** The values of a single precision buffer. */
+		vector<float> float_values;
+		size_t count;
+		double first_value;
+		double last_value;
+		/** The chunk has been written to the spill file. */
+		bool on_disk;
+		/** The values are in memory and can be read without the mutex. */
+		std::atomic<bool> resident;
+		/** The time of the last access, for the eviction of old chunks. */
+		mutable std::atomic<uint64_t> last_access;
+	};
+
+	/** Make sure the chunk is in memory. The mutex must be locked. */
+	bool page_in(Chunk &chunk, size_t chunk_index) const;
+	void touch(const Chunk &chunk) const;
+
+	/**
+	 * Register a reader, that doesn't lock the mutex.
+	 *
+	 * @return false if an exclusive operation is running. The reader must
+	 *         use the mutex then.
+	 */
+	bool pin() const;
+	void unpin() const;
+	/**
+	 * Wait until all unlocked readers are done, before the memory of a chunk
+	 * is moved or freed. The mutex must be locked.
+	 */
+	void begin_exclusive() const;
+	void end_exclusive() const;
+	size_t copy_resident(size_t pos, size_t count, double *values) const;
+	template<typename T> void append_values(const T *values, size_t count);
+	template<typename T> void append_locked(const T *values, size_t count);
+	/** Convert all chunks to double precision. The mutex must be locked. */
+	void widen_locked();
+
+	bool is_in_memory(const Chunk &chunk) const;
+	double value(const Chunk &chunk, size_t offset) const;
+	char *chunk_data(Chunk &chunk) const;
+	size_t chunk_capacity_bytes(const Chunk &chunk) const;
+	void resize_chunk(Chunk &chunk, size_t count) const;
+	void release_chunk(Chunk &chunk) const;
+	size_t value_size() const;
+
+	/**
+	 * Return the last access time of the oldest sealed chunk in memory, or
+	 * false if there is no such chunk. Called by the MemoryManager.
+	 */
+	bool oldest_chunk(uint64_t &last_access);
+
+	/**
+	 * Write the oldest sealed chunk to the spill file (if not already done)
+	 * and remove it from memory. Called by the spill worker of the
+	 * MemoryManager. The buffer isn't locked, while the file is written.
+	 *
+	 * @param spill_buffer A buffer for a copy of the chunk.
+	 *
+	 * @return false if the chunk could not be spilled.
+	 */
+	bool evict_oldest_chunk(vector<char> &spill_buffer);
+	/** Free the memory of a chunk on disk. The mutex must be locked. */
+	void release_resident_chunk(Chunk &chunk);
+
+	mutable std::mutex mutex_;
+	/** A deque, so the chunks don't move, when a chunk is added. */
+	mutable deque<Chunk> chunks_;
+	std::atomic<size_t> size_;
+	bool single_precision_;
+	mutable std::atomic<size_t> readers_;
+	mutable std::atomic<bool> exclusive_;
+	/** Changes, when the chunks are cleared or widened. */
+	uint64_t generation_;
+	/**
+	 * Protects the spill file, so the buffer isn't locked while the spill
+	 * worker writes to it. It is locked after the mutex.
+	 */
+	mutable std::mutex spill_file_mutex_;
+	mutable unique_ptr<QFile> spill_file_;
+	/** The bytes reported to the MemoryManager. */
+	mutable size_t memory_size_;
+	mutable size_t spilled_size_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SAMPLEBUFFER_HPP
@@ -0,0 +1,403 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <QDebug>
+#include <QString>
+
+#include "shmfeed.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** The number of samples, that are copied to a ring at once. */
+const size_t block_size = 4096;
+
+void copy_string(char *dest, size_t dest_size, const string &src)
+{
+	strncpy(dest, src.c_str(), dest_size - 1);
+	dest[dest_size - 1] = '\0';
+}
+
+string error_string(const string &msg)
+{
+	return msg + ": " + strerror(errno);
+}
+
+}
+
+const size_t ShmFeed::default_capacity;
+
+ShmFeed::ShmFeed() :
+	ring_number_(0),
+	listen_fd_(-1)
+{
+	wake_pipe_[0] = -1;
+	wake_pipe_[1] = -1;
+}
+
+ShmFeed::~ShmFeed()
+{
+	stop();
+
+	lock_guard<mutex> lock(rings_mutex_);
+	for (const auto &ring : rings_)
+		destroy_ring(*ring);
+	rings_.clear();
+}
+
+string ShmFeed::start(const string &socket_path)
+{
+	if (listen_fd_ >= 0)
+		return socket_path_;
+
+	string path = socket_path;
+	if (path.empty()) {
+		const char *runtime_dir = getenv("XDG_RUNTIME_DIR");
+		path = string(runtime_dir ? runtime_dir : "/tmp") +
+			"/smuview-" + std::to_string(getpid()) + ".sock";
+	}
+
+	struct sockaddr_un addr;
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	if (path.size() >= sizeof(addr.sun_path))
+		throw std::runtime_error("Socket path is too long: " + path);
+	copy_string(addr.sun_path, sizeof(addr.sun_path), path);
+
+	int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+	if (fd < 0)
+		throw std::runtime_error(error_string("Can't create socket"));
+
+	// Remove a stale socket of a crashed instance.
+	unlink(path.c_str());
+	if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) < 0 ||
+			listen(fd, 8) < 0) {
+		string msg = error_string("Can't bind socket " + path);
+		close(fd);
+		throw std::runtime_error(msg);
+	}
+
+	if (pipe(wake_pipe_) < 0) {
+		string msg = error_string("Can't create pipe");
+		close(fd);
+		unlink(path.c_str());
+		throw std::runtime_error(msg);
+	}
+
+	listen_fd_ = fd;
+	socket_path_ = path;
+	control_thread_ = std::thread(&ShmFeed::control_thread_proc, this);
+
+	qWarning() << "ShmFeed::start(): Control socket" <<
+		QString::fromStdString(socket_path_);
+
+	return socket_path_;
+}
+
+void ShmFeed::stop()
+{
+	if (listen_fd_ < 0)
+		return;
+
+	// Wake up the control thread
+	char c = 0;
+	if (write(wake_pipe_[1], &c, 1) < 0)
+		qWarning() << "ShmFeed::stop(): Can't wake up control thread";
+	if (control_thread_.joinable())
+		control_thread_.join();
+
+	close(wake_pipe_[0]);
+	close(wake_pipe_[1]);
+	wake_pipe_[0] = -1;
+	wake_pipe_[1] = -1;
+	close(listen_fd_);
+	listen_fd_ = -1;
+	unlink(socket_path_.c_str());
+	socket_path_.clear();
+}
+
+string ShmFeed::socket_path() const
+{
+	return socket_path_;
+}
+
+string ShmFeed::publish(shared_ptr<AnalogTimeSignal> signal, size_t capacity)
+{
+	assert(signal);
+
+	{
+		lock_guard<mutex> lock(rings_mutex_);
+		for (const auto &ring : rings_) {
+			if (ring->signal == signal)
+				return ring->shm_name;
+		}
+	}
+
+	// Round up to a power of two, so the ring index is a simple mask.
+	size_t ring_capacity = 1;
+	while (ring_capacity < std::max(capacity, (size_t)1))
+		ring_capacity <<= 1;
+
+	auto ring = make_shared<Ring>();
+	ring->signal = signal;
+	ring->shm_name = "/smuview-" + std::to_string(getpid()) + "-" +
+		std::to_string(ring_number_++);
+	ring->map_size = sizeof(sv_shmfeed_header) +
+		ring_capacity * sizeof(sv_shmfeed_sample);
+	ring->signal_pos = 0;
+	ring->timestamps.resize(block_size);
+	ring->values.resize(block_size);
+
+	int fd = shm_open(ring->shm_name.c_str(),
+		O_CREAT | O_EXCL | O_RDWR, S_IRUSR | S_IWUSR);
+	if (fd < 0) {
+		throw std::runtime_error(
+			error_string("Can't create shared memory " + ring->shm_name));
+	}
+	if (ftruncate(fd, ring->map_size) < 0) {
+		string msg = error_string("Can't resize shared memory");
+		close(fd);
+		shm_unlink(ring->shm_name.c_str());
+		throw std::runtime_error(msg);
+	}
+	void *addr = mmap(nullptr, ring->map_size,
+		PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+	// The mapping stays valid after closing the file descriptor.
+	close(fd);
+	if (addr == MAP_FAILED) {
+		string msg = error_string("Can't map shared memory");
+		shm_unlink(ring->shm_name.c_str());
+		throw std::runtime_error(msg);
+	}
+
+	ring->header = (sv_shmfeed_header *)addr;
+	ring->samples = (sv_shmfeed_sample *)
+		((char *)addr + sizeof(sv_shmfeed_header));
+
+	sv_shmfeed_header *header = ring->header;
+	header->capacity = ring_capacity;
+	header->ring_offset = sizeof(sv_shmfeed_header);
+	header->write_count = 0;
+	header->write_begin = 0;
+	header->session_start_timestamp = Session::session_start_timestamp;
+	auto device = signal->parent_channel()->parent_device();
+	copy_string(header->device, sizeof(header->device),
+		device ? device->id() : "");
+	copy_string(header->name, sizeof(header->name), signal->name());
+	copy_string(header->quantity, sizeof(header->quantity),
+		signal->quantity_name().toStdString());
+	copy_string(header->unit, sizeof(header->unit),
+		signal->unit_name().toStdString());
+	header->version = SV_SHMFEED_VERSION;
+	// The magic is written last, readers check it before using the header.
+	__atomic_store_n(&header->magic, SV_SHMFEED_MAGIC, __ATOMIC_RELEASE);
+
+	// The ring is written in the thread, that appends the samples. The
+	// connections keep the ring alive for a call, that is already running
+	// while the ring is destroyed.
+	ring->appended_connection = connect(
+		signal.get(), &AnalogTimeSignal::sample_appended,
+		this, [ring]() { write_samples(*ring); }, Qt::DirectConnection);
+	ring->cleared_connection = connect(
+		signal.get(), &AnalogTimeSignal::samples_cleared,
+		this, [ring]() { clear_ring(*ring); }, Qt::DirectConnection);
+	write_samples(*ring);
+
+	lock_guard<mutex> lock(rings_mutex_);
+	rings_.push_back(ring);
+
+	return ring->shm_name;
+}
+
+void ShmFeed::unpublish(shared_ptr<AnalogTimeSignal> signal)
+{
+	lock_guard<mutex> lock(rings_mutex_);
+	auto it = std::find_if(rings_.begin(), rings_.end(),
+		[&signal](const shared_ptr<Ring> &r) { return r->signal == signal; });
+	if (it == rings_.end())
+		return;
+
+	destroy_ring(**it);
+	rings_.erase(it);
+}
+
+vector<string> ShmFeed::published_names() const
+{
+	vector<string> names;
+	lock_guard<mutex> lock(rings_mutex_);
+	for (const auto &ring : rings_)
+		names.push_back(ring->shm_name);
+	return names;
+}
+
+void ShmFeed::write_samples(Ring &ring)
+{
+	lock_guard<mutex> lock(ring.mutex);
+	if (!ring.header)
+		return;
+
+	const size_t sample_count = ring.signal->sample_count();
+	if (ring.signal_pos >= sample_count)
+		return;
+
+	// Only the newest samples fit into the ring.
+	const uint64_t capacity = ring.header->capacity;
+	if (sample_count - ring.signal_pos > capacity)
+		ring.signal_pos = sample_count - capacity;
+
+	uint64_t write_count = ring.header->write_count;
+	const uint64_t mask = capacity - 1;
+
+	// Announce the slots, that are overwritten now, before touching them.
+	__atomic_store_n(&ring.header->write_begin,
+		write_count + (sample_count - ring.signal_pos), __ATOMIC_RELAXED);
+	__atomic_thread_fence(__ATOMIC_RELEASE);
+
+	// Copy the samples in blocks, not one by one.
+	size_t pos = ring.signal_pos;
+	while (pos < sample_count) {
+		size_t count = std::min(sample_count - pos, ring.timestamps.size());
+		count = ring.signal->get_samples(pos, count,
+			ring.timestamps.data(), ring.values.data());
+		if (count == 0)
+			break;
+		for (size_t i = 0; i < count; ++i) {
+			sv_shmfeed_sample &dest = ring.samples[write_count & mask];
+			dest.timestamp = ring.timestamps[i];
+			dest.value = ring.values[i];
+			++write_count;
+		}
+		pos += count;
+	}
+	ring.signal_pos = sample_count;
+
+	// Publish the new samples to the readers
+	__atomic_store_n(&ring.header->write_count, write_count, __ATOMIC_RELEASE);
+}
+
+void ShmFeed::clear_ring(Ring &ring)
+{
+	// The ring keeps its samples, new samples are appended after them.
+	lock_guard<mutex> lock(ring.mutex);
+	ring.signal_pos = 0;
+}
+
+void ShmFeed::destroy_ring(Ring &ring)
+{
+	disconnect(ring.appended_connection);
+	disconnect(ring.cleared_connection);
+
+	// Wait for a running write_samples() in another thread.
+	lock_guard<mutex> lock(ring.mutex);
+	munmap(ring.header, ring.map_size);
+	shm_unlink(ring.shm_name.c_str());
+	ring.header = nullptr;
+	ring.samples = nullptr;
+}
+
+string ShmFeed::catalogue() const
+{
+	std::ostringstream ss;
+	ss << "smuview-shmfeed " << SV_SHMFEED_VERSION << "\n";
+
+	lock_guard<mutex> lock(rings_mutex_);
+	for (const auto &ring : rings_) {
+		const sv_shmfeed_header *header = ring->header;
+		ss << ring->shm_name << "\t" << header->capacity << "\t" <<
+			header->quantity << "\t" << header->unit << "\t" <<
+			header->device << "\t" << header->name << "\n";
+	}
+	ss << "\n";
+
+	return ss.str();
+}
+
+void ShmFeed::control_thread_proc()
+{
+	struct pollfd fds[2];
+	fds[0].fd = listen_fd_;
+	fds[0].events = POLLIN;
+	fds[1].fd = wake_pipe_[0];
+	fds[1].events = POLLIN;
+
+	while (true) {
+		if (poll(fds, 2, -1) < 0) {
+			if (errno == EINTR)
+				continue;
+			qWarning() << "ShmFeed::control_thread_proc(): poll failed:" <<
+				strerror(errno);
+			break;
+		}
+		if (fds[1].revents)
+			break;
+		if (!(fds[0].revents & POLLIN))
+			continue;
+
+		int client_fd = accept(listen_fd_, nullptr, nullptr);
+		if (client_fd < 0)
+			continue;
+
+		const string text = catalogue();
+		size_t written = 0;
+		while (written < text.size()) {
+			ssize_t n = send(client_fd, text.data() + written,
+				text.size() - written, MSG_NOSIGNAL);
+			if (n <= 0)
+				break;
+			written += n;
+		}
+		close(client_fd);
+	}
+}
+
+} // namespace data
+} // namespace sv
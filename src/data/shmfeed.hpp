@@ -0,0 +1,146 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SHMFEED_HPP
+#define DATA_SHMFEED_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QMetaObject>
+#include <QObject>
+
+#include "src/data/shmfeedformat.h"
+
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+/**
+ * The ShmFeed mirrors analog time signals into POSIX shared memory rings, so
+ * that other processes on the same host can read the live samples without
+ * copying them through a socket. The layout of the rings and the catalogue of
+ * the control socket are described in shmfeedformat.h.
+ *
+ * The samples are copied to the ring in the thread that appends them to the
+ * signal (acquisition thread or math worker), the GUI thread is not involved.
+ * The control socket is served by its own thread.
+ */
+class ShmFeed : public QObject
+{
+	Q_OBJECT
+
+public:
+	static const size_t default_capacity = 1 << 20;
+
+	ShmFeed();
+	~ShmFeed();
+
+	/**
+	 * Start the control socket. If socket_path is empty, the socket is
+	 * created in $XDG_RUNTIME_DIR (or /tmp) as "smuview-<pid>.sock".
+	 * Throws a std::runtime_error if the socket can't be created.
+	 *
+	 * @return The path of the control socket.
+	 */
+	string start(const string &socket_path = "");
+
+	/**
+	 * Stop the control socket. The rings stay published.
+	 */
+	void stop();
+
+	/**
+	 * Return the path of the control socket, or an empty string, if the
+	 * control socket is not started.
+	 */
+	string socket_path() const;
+
+	/**
+	 * Publish the signal in a new shared memory ring. The capacity is rounded
+	 * up to the next power of two. All samples, that are already in the
+	 * signal, are copied to the ring (as far as they fit into it).
+	 * Throws a std::runtime_error if the ring can't be created.
+	 *
+	 * @return The name of the shared memory object.
+	 */
+	string publish(shared_ptr<AnalogTimeSignal> signal,
+		size_t capacity = default_capacity);
+
+	/**
+	 * Remove the ring of the signal. Readers, that have mapped the ring,
+	 * keep their mapping, but won't get new samples.
+	 */
+	void unpublish(shared_ptr<AnalogTimeSignal> signal);
+
+	/**
+	 * Return the names of the shared memory objects of all published signals.
+	 */
+	vector<string> published_names() const;
+
+private:
+	struct Ring
+	{
+		shared_ptr<AnalogTimeSignal> signal;
+		string shm_name;
+		sv_shmfeed_header *header;
+		sv_shmfeed_sample *samples;
+		size_t map_size;
+		/** The next sample of the signal, that is copied to the ring. */
+		size_t signal_pos;
+		/** Buffers for one block of samples, that is copied to the ring. */
+		vector<double> timestamps;
+		vector<double> values;
+		/** Serializes the writers (sample_appended and samples_cleared). */
+		std::mutex mutex;
+		QMetaObject::Connection appended_connection;
+		QMetaObject::Connection cleared_connection;
+	};
+
+	static void write_samples(Ring &ring);
+	static void clear_ring(Ring &ring);
+	void destroy_ring(Ring &ring);
+	string catalogue() const;
+	void control_thread_proc();
+
+	vector<shared_ptr<Ring>> rings_;
+	mutable std::mutex rings_mutex_;
+	unsigned int ring_number_;
+
+	string socket_path_;
+	int listen_fd_;
+	int wake_pipe_[2];
+	std::thread control_thread_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SHMFEED_HPP
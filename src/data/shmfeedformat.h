@@ -0,0 +1,88 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Layout of the shared memory sample feed. This header is plain C, so it can
+ * be used by external readers (see contrib/shmfeed/).
+ *
+ * Every published signal has its own POSIX shared memory object, that
+ * contains a sv_shmfeed_header followed by a ring of `capacity`
+ * sv_shmfeed_sample entries. `capacity` is a power of two. SmuView is the
+ * only writer. The sample with the (monotonic) index i is stored at
+ * ring[i & (capacity - 1)].
+ *
+ * The writer works like a sequence lock: Before a batch of samples is
+ * stored, `write_begin` is set to the index after the last sample of the
+ * batch, followed by a release fence. After the samples are stored,
+ * `write_count` is set to the same index (with release semantics). So the
+ * slots of all indices smaller than `write_begin` minus `capacity` may be
+ * overwritten at any time.
+ *
+ * A reader loads `write_count` (acquire) and copies the samples from its read
+ * index up to `write_count`. Then it issues an acquire fence
+ * (__atomic_thread_fence(__ATOMIC_ACQUIRE)) and loads `write_begin`. All
+ * copied samples with an index smaller than `write_begin` minus `capacity`
+ * may have been (partially) overwritten during the copy and must be
+ * discarded.
+ *
+ * The control socket (Unix domain socket) answers every connection with a
+ * text catalogue of all published signals and closes the connection:
+ *
+ *   smuview-shmfeed <version>
+ *   <shm name>\t<capacity>\t<quantity>\t<unit>\t<device id>\t<signal name>
+ *   ...
+ *   <empty line>
+ */
+
+#ifndef DATA_SHMFEEDFORMAT_H
+#define DATA_SHMFEEDFORMAT_H
+
+#include <stdint.h>
+
+#define SV_SHMFEED_MAGIC 0x46534d53 /* "SMSF" */
+#define SV_SHMFEED_VERSION 2
+#define SV_SHMFEED_NAME_SIZE 128
+#define SV_SHMFEED_UNIT_SIZE 32
+
+struct sv_shmfeed_header {
+	uint32_t magic;
+	uint32_t version;
+	/* Number of samples in the ring, a power of two. */
+	uint64_t capacity;
+	/* Offset of the sample ring from the start of the object. */
+	uint64_t ring_offset;
+	/* Number of samples written since the feed was created. */
+	uint64_t write_count;
+	/* Number of samples written, including the batch in progress. */
+	uint64_t write_begin;
+	/* The session start time (UNIX time in s), for relative time stamps. */
+	double session_start_timestamp;
+	char device[SV_SHMFEED_NAME_SIZE];
+	char name[SV_SHMFEED_NAME_SIZE];
+	char quantity[SV_SHMFEED_UNIT_SIZE];
+	char unit[SV_SHMFEED_UNIT_SIZE];
+};
+
+struct sv_shmfeed_sample {
+	/* Absolute time stamp (UNIX time in s). */
+	double timestamp;
+	double value;
+};
+
+#endif /* DATA_SHMFEEDFORMAT_H */
@@ -0,0 +1,169 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "signalregistry.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::lock_guard;
+using std::make_pair;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+
+namespace sv {
+namespace data {
+
+const signal_id_t SignalRegistry::invalid_id;
+
+SignalRegistry::SignalRegistry() :
+	signal_map_(make_shared<signal_map_t>()),
+	next_id_(1)
+{
+}
+
+void SignalRegistry::add_device(shared_ptr<devices::BaseDevice> device)
+{
+	assert(device);
+
+	// New channels and signals are added in the acquisition or script
+	// thread, so these connections are queued.
+	connect(device.get(), &devices::BaseDevice::channel_added,
+		this, &SignalRegistry::on_channel_added, Qt::UniqueConnection);
+	const auto channel_map = device->channel_map();
+	for (const auto &channel_pair : *channel_map)
+		add_channel(channel_pair.second);
+}
+
+void SignalRegistry::remove_device(shared_ptr<devices::BaseDevice> device)
+{
+	assert(device);
+
+	disconnect(device.get(), &devices::BaseDevice::channel_added,
+		this, &SignalRegistry::on_channel_added);
+	const auto channel_map = device->channel_map();
+	for (const auto &channel_pair : *channel_map) {
+		disconnect(channel_pair.second.get(),
+			&channels::BaseChannel::signal_added,
+			this, &SignalRegistry::register_signal);
+		const auto signals = channel_pair.second->signals();
+		for (const auto &signal : *signals)
+			unregister_signal(signal);
+	}
+}
+
+void SignalRegistry::add_channel(shared_ptr<channels::BaseChannel> channel)
+{
+	connect(channel.get(), &channels::BaseChannel::signal_added,
+		this, &SignalRegistry::register_signal, Qt::UniqueConnection);
+	const auto signals = channel->signals();
+	for (const auto &signal : *signals)
+		register_signal(signal);
+}
+
+signal_id_t SignalRegistry::register_signal(shared_ptr<BaseSignal> signal)
+{
+	if (!signal)
+		return invalid_id;
+
+	signal_id_t id;
+	{
+		lock_guard<mutex> lock(mutex_);
+		auto it = id_map_.find(signal.get());
+		if (it != id_map_.end())
+			return it->second;
+
+		id = next_id_++;
+		id_map_.insert(make_pair(signal.get(), id));
+		auto signal_map = make_shared<signal_map_t>(*signal_map_);
+		signal_map->insert(make_pair(id, signal));
+		std::atomic_store(&signal_map_,
+			shared_ptr<const signal_map_t>(signal_map));
+	}
+
+	Q_EMIT signal_registered(id, signal);
+	return id;
+}
+
+void SignalRegistry::unregister_signal(shared_ptr<BaseSignal> signal)
+{
+	if (!signal)
+		return;
+
+	signal_id_t id;
+	{
+		lock_guard<mutex> lock(mutex_);
+		auto it = id_map_.find(signal.get());
+		if (it == id_map_.end())
+			return;
+
+		id = it->second;
+		id_map_.erase(it);
+		auto signal_map = make_shared<signal_map_t>(*signal_map_);
+		signal_map->erase(id);
+		std::atomic_store(&signal_map_,
+			shared_ptr<const signal_map_t>(signal_map));
+	}
+
+	Q_EMIT signal_unregistered(id, signal);
+}
+
+signal_id_t SignalRegistry::signal_id(shared_ptr<BaseSignal> signal) const
+{
+	lock_guard<mutex> lock(mutex_);
+	auto it = id_map_.find(signal.get());
+	if (it == id_map_.end())
+		return invalid_id;
+	return it->second;
+}
+
+shared_ptr<BaseSignal> SignalRegistry::signal(signal_id_t id) const
+{
+	const auto signal_map = this->signal_map();
+	auto it = signal_map->find(id);
+	if (it == signal_map->end())
+		return nullptr;
+	return it->second;
+}
+
+shared_ptr<const SignalRegistry::signal_map_t>
+	SignalRegistry::signal_map() const
+{
+	return std::atomic_load(&signal_map_);
+}
+
+size_t SignalRegistry::size() const
+{
+	return signal_map()->size();
+}
+
+void SignalRegistry::on_channel_added(
+	shared_ptr<channels::BaseChannel> channel)
+{
+	add_channel(channel);
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,137 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SIGNALREGISTRY_HPP
+#define DATA_SIGNALREGISTRY_HPP
+
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+#include <QObject>
+
+using std::map;
+using std::shared_ptr;
+using std::unordered_map;
+
+namespace sv {
+
+namespace channels {
+class BaseChannel;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace data {
+
+class BaseSignal;
+
+typedef uint32_t signal_id_t;
+
+/**
+ * The SignalRegistry holds all signals of all devices of the session and
+ * assigns each signal a stable ID. The IDs start at 1 and are never reused,
+ * not even after the signal was removed.
+ *
+ * The registry follows the devices, channels and signals, that are added
+ * to the session, and emits signal_registered()/signal_unregistered(), so
+ * the views can update incrementally.
+ *
+ * The registry is changed only in the thread of the registry (GUI thread).
+ * Every change publishes a new signal map, so the snapshot returned by
+ * signal_map() is never changed and can be used in any thread without
+ * copying. The lookup functions are thread safe.
+ */
+class SignalRegistry : public QObject
+{
+	Q_OBJECT
+
+public:
+	typedef map<signal_id_t, shared_ptr<BaseSignal>> signal_map_t;
+
+	/** The ID of an unknown signal. */
+	static const signal_id_t invalid_id = 0;
+
+	SignalRegistry();
+
+	/**
+	 * Register all existing and future signals of the device.
+	 */
+	void add_device(shared_ptr<devices::BaseDevice> device);
+
+	/**
+	 * Unregister all signals of the device.
+	 */
+	void remove_device(shared_ptr<devices::BaseDevice> device);
+
+	/**
+	 * Return the ID of the signal or invalid_id, if not registered.
+	 */
+	signal_id_t signal_id(shared_ptr<BaseSignal> signal) const;
+
+	/**
+	 * Return the signal for the ID or nullptr, if there is no such signal.
+	 */
+	shared_ptr<BaseSignal> signal(signal_id_t id) const;
+
+	/**
+	 * Return a snapshot of all registered signals ordered by their ID. Hold
+	 * the returned pointer while iterating.
+	 */
+	shared_ptr<const signal_map_t> signal_map() const;
+
+	size_t size() const;
+
+private:
+	void add_channel(shared_ptr<channels::BaseChannel> channel);
+
+	/** Only replaced with std::atomic_store(), never changed in place. */
+	shared_ptr<const signal_map_t> signal_map_;
+	unordered_map<const BaseSignal *, signal_id_t> id_map_;
+	signal_id_t next_id_;
+	/** Guards id_map_ and serializes the changes of signal_map_. */
+	mutable std::mutex mutex_;
+
+public Q_SLOTS:
+	/**
+	 * Register the signal and return its ID. Registering a signal twice
+	 * returns the already assigned ID.
+	 */
+	signal_id_t register_signal(shared_ptr<sv::data::BaseSignal> signal);
+	void unregister_signal(shared_ptr<sv::data::BaseSignal> signal);
+
+private Q_SLOTS:
+	void on_channel_added(shared_ptr<sv::channels::BaseChannel> channel);
+
+Q_SIGNALS:
+	void signal_registered(sv::data::signal_id_t id,
+		shared_ptr<sv::data::BaseSignal> signal);
+	void signal_unregistered(sv::data::signal_id_t id,
+		shared_ptr<sv::data::BaseSignal> signal);
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SIGNALREGISTRY_HPP
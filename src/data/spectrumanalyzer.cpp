@@ -0,0 +1,597 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QDebug>
+#include <QObject>
+
+#include "spectrumanalyzer.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/resampler.hpp"
+
+using std::complex;
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/** The number of samples used to estimate the sample interval. */
+const size_t interval_estimation_samples = 1024;
+
+size_t round_fft_size(size_t fft_size)
+{
+	size_t size = SpectrumAnalyzer::min_fft_size;
+	while (size < fft_size && size < SpectrumAnalyzer::max_fft_size)
+		size <<= 1;
+	return size;
+}
+
+}
+
+const size_t SpectrumAnalyzer::min_fft_size;
+const size_t SpectrumAnalyzer::max_fft_size;
+
+SpectrumAnalyzer::SpectrumAnalyzer(shared_ptr<AnalogTimeSignal> signal,
+		size_t fft_size, SpectrumWindow window, double overlap,
+		SpectrumAveraging averaging, size_t average_count,
+		double sample_interval) :
+	signal_(signal),
+	reset_requested_(true),
+	reset_timestamp_(-std::numeric_limits<double>::infinity()),
+	stop_(true),
+	wake_(false),
+	start_timestamp_(-std::numeric_limits<double>::infinity()),
+	used_sample_interval_(0.),
+	frame_count_(0),
+	has_new_spectrum_(false)
+{
+	assert(signal_);
+
+	config_.fft_size = round_fft_size(fft_size);
+	config_.window = window;
+	config_.overlap = std::max(0., std::min(overlap, 0.95));
+	config_.averaging = averaging;
+	config_.average_count = std::max(average_count, (size_t)1);
+	config_.sample_interval = sample_interval > 0. ? sample_interval : 0.;
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer()
+{
+	stop();
+}
+
+void SpectrumAnalyzer::start()
+{
+	if (worker_thread_.joinable())
+		return;
+
+	// Only wake up the worker here, the samples are read in the worker.
+	sample_appended_conn_ = QObject::connect(
+		signal_.get(), &AnalogTimeSignal::sample_appended,
+		[this]() { wake(); });
+	samples_cleared_conn_ = QObject::connect(
+		signal_.get(), &AnalogTimeSignal::samples_cleared,
+		[this]() {
+			request_reset(-std::numeric_limits<double>::infinity());
+		});
+
+	request_reset(-std::numeric_limits<double>::infinity());
+	stop_ = false;
+	worker_thread_ = std::thread(&SpectrumAnalyzer::worker_thread_proc, this);
+}
+
+void SpectrumAnalyzer::stop()
+{
+	QObject::disconnect(sample_appended_conn_);
+	QObject::disconnect(samples_cleared_conn_);
+
+	stop_ = true;
+	wake();
+	if (worker_thread_.joinable())
+		worker_thread_.join();
+}
+
+bool SpectrumAnalyzer::is_running() const
+{
+	return !stop_;
+}
+
+void SpectrumAnalyzer::reset()
+{
+	request_reset(signal_->last_timestamp(false));
+}
+
+void SpectrumAnalyzer::set_fft_size(size_t fft_size)
+{
+	{
+		lock_guard<mutex> lock(config_mutex_);
+		config_.fft_size = round_fft_size(fft_size);
+	}
+	request_reset(-std::numeric_limits<double>::infinity());
+}
+
+size_t SpectrumAnalyzer::fft_size() const
+{
+	lock_guard<mutex> lock(config_mutex_);
+	return config_.fft_size;
+}
+
+void SpectrumAnalyzer::set_window(SpectrumWindow window)
+{
+	{
+		lock_guard<mutex> lock(config_mutex_);
+		config_.window = window;
+	}
+	request_reset(-std::numeric_limits<double>::infinity());
+}
+
+SpectrumWindow SpectrumAnalyzer::window() const
+{
+	lock_guard<mutex> lock(config_mutex_);
+	return config_.window;
+}
+
+void SpectrumAnalyzer::set_overlap(double overlap)
+{
+	{
+		lock_guard<mutex> lock(config_mutex_);
+		config_.overlap = std::max(0., std::min(overlap, 0.95));
+	}
+	request_reset(-std::numeric_limits<double>::infinity());
+}
+
+double SpectrumAnalyzer::overlap() const
+{
+	lock_guard<mutex> lock(config_mutex_);
+	return config_.overlap;
+}
+
+void SpectrumAnalyzer::set_averaging(SpectrumAveraging averaging,
+	size_t average_count)
+{
+	{
+		lock_guard<mutex> lock(config_mutex_);
+		config_.averaging = averaging;
+		config_.average_count = std::max(average_count, (size_t)1);
+	}
+	request_reset(-std::numeric_limits<double>::infinity());
+}
+
+SpectrumAveraging SpectrumAnalyzer::averaging() const
+{
+	lock_guard<mutex> lock(config_mutex_);
+	return config_.averaging;
+}
+
+size_t SpectrumAnalyzer::average_count() const
+{
+	lock_guard<mutex> lock(config_mutex_);
+	return config_.average_count;
+}
+
+void SpectrumAnalyzer::set_sample_interval(double sample_interval)
+{
+	{
+		lock_guard<mutex> lock(config_mutex_);
+		config_.sample_interval = sample_interval > 0. ? sample_interval : 0.;
+	}
+	request_reset(-std::numeric_limits<double>::infinity());
+}
+
+double SpectrumAnalyzer::sample_interval() const
+{
+	return used_sample_interval_;
+}
+
+uint64_t SpectrumAnalyzer::frame_count() const
+{
+	return frame_count_;
+}
+
+bool SpectrumAnalyzer::has_new_spectrum() const
+{
+	return has_new_spectrum_;
+}
+
+bool SpectrumAnalyzer::spectrum(vector<double> &frequencies,
+	vector<double> &magnitudes)
+{
+	lock_guard<mutex> lock(spectrum_mutex_);
+	has_new_spectrum_ = false;
+	frequencies = frequencies_;
+	magnitudes = magnitudes_;
+	return !magnitudes_.empty();
+}
+
+vector<double> SpectrumAnalyzer::amplitude_spectrum(
+	const vector<double> &samples, SpectrumWindow window)
+{
+	assert(samples.size() >= 2);
+	assert((samples.size() & (samples.size() - 1)) == 0);
+
+	FftPlan plan;
+	init_plan(plan, samples.size(), window);
+	vector<complex<double>> scratch;
+	vector<double> magnitudes(samples.size() / 2 + 1);
+	execute_plan(plan, samples.data(), scratch, magnitudes.data());
+	for (auto &magnitude : magnitudes)
+		magnitude = std::sqrt(magnitude);
+	return magnitudes;
+}
+
+void SpectrumAnalyzer::fft(vector<complex<double>> &data)
+{
+	size_t size = data.size();
+	assert((size & (size - 1)) == 0);
+	if (size < 2)
+		return;
+
+	FftPlan plan;
+	init_plan(plan, size * 2, SpectrumWindow::Rectangular);
+	fft(data.data(), size, plan.twiddles, plan.bit_reversal);
+}
+
+void SpectrumAnalyzer::init_plan(FftPlan &plan, size_t fft_size,
+	SpectrumWindow window)
+{
+	plan.fft_size = fft_size;
+	plan.window.resize(fft_size);
+	calc_window(plan.window, window);
+	plan.window_sum = 0.;
+	for (const double w : plan.window)
+		plan.window_sum += w;
+
+	// The real input of size n is transformed as complex FFT of size n/2.
+	const size_t half_size = fft_size / 2;
+	plan.twiddles.resize(half_size / 2);
+	for (size_t i = 0; i < plan.twiddles.size(); ++i)
+		plan.twiddles[i] = std::polar(1., -2. * M_PI * i / half_size);
+
+	plan.bit_reversal.resize(half_size);
+	size_t bits = 0;
+	while (((size_t)1 << bits) < half_size)
+		++bits;
+	for (size_t i = 0; i < half_size; ++i) {
+		size_t reversed = 0;
+		for (size_t b = 0; b < bits; ++b)
+			reversed |= ((i >> b) & 1) << (bits - 1 - b);
+		plan.bit_reversal[i] = reversed;
+	}
+
+	plan.split_twiddles.resize(half_size + 1);
+	for (size_t k = 0; k <= half_size; ++k)
+		plan.split_twiddles[k] = std::polar(1., -2. * M_PI * k / fft_size);
+}
+
+void SpectrumAnalyzer::calc_window(vector<double> &window,
+	SpectrumWindow type)
+{
+	// Periodic windows, as used for spectral analysis.
+	const size_t size = window.size();
+	for (size_t i = 0; i < size; ++i) {
+		const double x = 2. * M_PI * i / size;
+		switch (type) {
+		case SpectrumWindow::Hann:
+			window[i] = 0.5 - 0.5 * std::cos(x);
+			break;
+		case SpectrumWindow::Hamming:
+			window[i] = 0.54 - 0.46 * std::cos(x);
+			break;
+		case SpectrumWindow::BlackmanHarris:
+			window[i] = 0.35875 - 0.48829 * std::cos(x) +
+				0.14128 * std::cos(2. * x) - 0.01168 * std::cos(3. * x);
+			break;
+		case SpectrumWindow::FlatTop:
+			window[i] = 0.21557895 - 0.41663158 * std::cos(x) +
+				0.277263158 * std::cos(2. * x) -
+				0.083578947 * std::cos(3. * x) +
+				0.006947368 * std::cos(4. * x);
+			break;
+		case SpectrumWindow::Rectangular:
+		default:
+			window[i] = 1.;
+			break;
+		}
+	}
+}
+
+void SpectrumAnalyzer::execute_plan(const FftPlan &plan,
+	const double *samples, vector<complex<double>> &scratch, double *power)
+{
+	const size_t half_size = plan.fft_size / 2;
+	scratch.resize(half_size);
+	complex<double> *z = scratch.data();
+	const double *window = plan.window.data();
+
+	// Pack the even and odd samples into the real and imaginary parts.
+	for (size_t i = 0; i < half_size; ++i) {
+		z[i] = complex<double>(samples[2 * i] * window[2 * i],
+			samples[2 * i + 1] * window[2 * i + 1]);
+	}
+
+	fft(z, half_size, plan.twiddles, plan.bit_reversal);
+
+	// Split into the spectrum of the real input and scale to the peak
+	// amplitude: 2 * |X| / sum(w), DC and Nyquist only |X| / sum(w).
+	const double scale = 2. / plan.window_sum;
+	const complex<double> minus_half_i(0., -0.5);
+	for (size_t k = 0; k <= half_size; ++k) {
+		const complex<double> zk = z[k % half_size];
+		const complex<double> zn = std::conj(z[(half_size - k) % half_size]);
+		const complex<double> even = (zk + zn) * 0.5;
+		const complex<double> odd = (zk - zn) * minus_half_i;
+		const complex<double> x = even + plan.split_twiddles[k] * odd;
+		const double s = (k == 0 || k == half_size) ? scale / 2. : scale;
+		power[k] = std::norm(x) * s * s;
+	}
+}
+
+void SpectrumAnalyzer::fft(complex<double> *data, size_t size,
+	const vector<complex<double>> &twiddles,
+	const vector<size_t> &bit_reversal)
+{
+	for (size_t i = 0; i < size; ++i) {
+		const size_t j = bit_reversal[i];
+		if (i < j)
+			std::swap(data[i], data[j]);
+	}
+
+	for (size_t length = 2; length <= size; length <<= 1) {
+		const size_t half_length = length / 2;
+		const size_t step = size / length;
+		for (size_t i = 0; i < size; i += length) {
+			for (size_t j = 0; j < half_length; ++j) {
+				const complex<double> u = data[i + j];
+				const complex<double> v =
+					data[i + j + half_length] * twiddles[j * step];
+				data[i + j] = u + v;
+				data[i + j + half_length] = u - v;
+			}
+		}
+	}
+}
+
+void SpectrumAnalyzer::request_reset(double start_timestamp)
+{
+	{
+		lock_guard<mutex> lock(config_mutex_);
+		reset_timestamp_ = start_timestamp;
+		reset_requested_ = true;
+	}
+	wake();
+}
+
+void SpectrumAnalyzer::wake()
+{
+	{
+		lock_guard<mutex> lock(wake_mutex_);
+		wake_ = true;
+	}
+	wake_cv_.notify_one();
+}
+
+void SpectrumAnalyzer::worker_thread_proc()
+{
+	while (!stop_) {
+		{
+			unique_lock<mutex> lock(wake_mutex_);
+			wake_cv_.wait_for(lock, std::chrono::milliseconds(250),
+				[this]() { return wake_ || stop_; });
+			wake_ = false;
+		}
+		if (stop_)
+			break;
+
+		if (reset_requested_) {
+			Config config;
+			double start_timestamp;
+			{
+				lock_guard<mutex> lock(config_mutex_);
+				config = config_;
+				start_timestamp = reset_timestamp_;
+				reset_requested_ = false;
+			}
+			restart(config, start_timestamp);
+		}
+
+		if (!resampler_ && !estimate_sample_interval())
+			continue;
+
+		process_frames();
+	}
+}
+
+void SpectrumAnalyzer::restart(const Config &config, double start_timestamp)
+{
+	worker_config_ = config;
+	start_timestamp_ = start_timestamp;
+	init_plan(plan_, config.fft_size, config.window);
+	resampler_ = nullptr;
+	resampled_time_.clear();
+	resampled_values_.clear();
+	frame_buffer_.clear();
+	frame_power_.assign(config.fft_size / 2 + 1, 0.);
+	power_.assign(config.fft_size / 2 + 1, 0.);
+	used_sample_interval_ = config.sample_interval;
+	frame_count_ = 0;
+
+	lock_guard<mutex> lock(spectrum_mutex_);
+	frequencies_.clear();
+	magnitudes_.clear();
+	has_new_spectrum_ = true;
+}
+
+bool SpectrumAnalyzer::estimate_sample_interval()
+{
+	// Start at the reset time stamp, or, after a configuration change, at
+	// the end of the signal. Only the samples from there on are read.
+	const size_t sample_count = signal_->sample_count();
+	const bool has_start = start_timestamp_ >
+		-std::numeric_limits<double>::infinity();
+	const size_t start_pos = has_start ?
+		signal_->lower_bound(start_timestamp_) : sample_count;
+
+	double interval = worker_config_.sample_interval;
+	if (interval <= 0.) {
+		// The median of the time stamp differences is robust against
+		// gaps and jitter. Use the samples around the start position.
+		size_t end = std::min(sample_count,
+			start_pos + interval_estimation_samples + 1);
+		size_t pos = end > interval_estimation_samples + 1 ?
+			end - interval_estimation_samples - 1 : 0;
+		size_t count = end - pos;
+		if (count < 2)
+			return false;
+		vector<double> timestamps(count);
+		vector<double> values(count);
+		count = signal_->get_samples(pos, count,
+			timestamps.data(), values.data());
+		if (count < 2)
+			return false;
+
+		vector<double> diffs(count - 1);
+		for (size_t i = 0; i + 1 < count; ++i)
+			diffs[i] = timestamps[i + 1] - timestamps[i];
+		auto median = diffs.begin() + diffs.size() / 2;
+		std::nth_element(diffs.begin(), median, diffs.end());
+		interval = *median;
+		if (!(interval > 0.))
+			return false;
+	}
+
+	// After a configuration change, only the recent samples, that are
+	// needed for the averaged frames, are analyzed again, not the whole
+	// history of the signal.
+	if (!has_start && sample_count > 0) {
+		const size_t fft_size = worker_config_.fft_size;
+		const size_t hop = std::max((size_t)1, fft_size -
+			(size_t)std::round(worker_config_.overlap * fft_size));
+		const size_t frame_count =
+			worker_config_.averaging == SpectrumAveraging::None ?
+				1 : worker_config_.average_count;
+		const double window = (double)(fft_size + (frame_count - 1) * hop);
+		start_timestamp_ = signal_->last_timestamp(false) - window * interval;
+	}
+
+	used_sample_interval_ = interval;
+	resampler_ = make_shared<Resampler>(
+		vector<shared_ptr<AnalogTimeSignal>>{ signal_ },
+		ResampleMode::Linear, interval);
+	resampler_->reset(start_timestamp_);
+	return true;
+}
+
+void SpectrumAnalyzer::process_frames()
+{
+	const size_t fft_size = worker_config_.fft_size;
+	const size_t hop = std::max((size_t)1, fft_size -
+		(size_t)std::round(worker_config_.overlap * fft_size));
+	const size_t max_points = std::max(fft_size, Resampler::chunk_size);
+
+	while (!stop_ && !reset_requested_) {
+		resampled_time_.clear();
+		for (auto &values : resampled_values_)
+			values.clear();
+		size_t count = resampler_->process(
+			resampled_time_, resampled_values_, max_points);
+		if (count == 0)
+			break;
+
+		// Skip the samples before the last reset.
+		size_t begin = std::lower_bound(resampled_time_.begin(),
+			resampled_time_.end(), start_timestamp_) - resampled_time_.begin();
+		const auto &values = resampled_values_[0];
+		frame_buffer_.insert(frame_buffer_.end(),
+			values.begin() + begin, values.end());
+
+		size_t pos = 0;
+		bool new_frame = false;
+		while (frame_buffer_.size() - pos >= fft_size && !stop_) {
+			execute_plan(plan_, frame_buffer_.data() + pos, scratch_,
+				frame_power_.data());
+
+			const size_t bins = power_.size();
+			double *power = power_.data();
+			const double *frame_power = frame_power_.data();
+			switch (worker_config_.averaging) {
+			case SpectrumAveraging::Average:
+				{
+					const double alpha = 1. / (double)std::min(
+						(size_t)frame_count_ + 1, worker_config_.average_count);
+					for (size_t i = 0; i < bins; ++i)
+						power[i] += alpha * (frame_power[i] - power[i]);
+				}
+				break;
+			case SpectrumAveraging::PeakHold:
+				for (size_t i = 0; i < bins; ++i)
+					power[i] = std::max(power[i], frame_power[i]);
+				break;
+			case SpectrumAveraging::None:
+			default:
+				std::copy(frame_power, frame_power + bins, power);
+				break;
+			}
+
+			++frame_count_;
+			pos += hop;
+			new_frame = true;
+		}
+		frame_buffer_.erase(frame_buffer_.begin(),
+			frame_buffer_.begin() + std::min(pos, frame_buffer_.size()));
+
+		if (new_frame)
+			publish_spectrum();
+	}
+}
+
+void SpectrumAnalyzer::publish_spectrum()
+{
+	const size_t bins = power_.size();
+	const double resolution =
+		1. / (worker_config_.fft_size * used_sample_interval_);
+
+	lock_guard<mutex> lock(spectrum_mutex_);
+	frequencies_.resize(bins);
+	magnitudes_.resize(bins);
+	for (size_t i = 0; i < bins; ++i) {
+		frequencies_[i] = i * resolution;
+		magnitudes_[i] = std::sqrt(power_[i]);
+	}
+	has_new_spectrum_ = true;
+}
+
+} // namespace data
+} // namespace sv
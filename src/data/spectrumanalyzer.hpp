@@ -0,0 +1,276 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SPECTRUMANALYZER_HPP
+#define DATA_SPECTRUMANALYZER_HPP
+
+#include <atomic>
+#include <complex>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <QMetaObject>
+#include <QString>
+
+using std::complex;
+using std::map;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+class Resampler;
+
+enum class SpectrumWindow {
+	Rectangular,
+	Hann,
+	Hamming,
+	BlackmanHarris,
+	FlatTop,
+};
+
+enum class SpectrumAveraging {
+	/** Show the spectrum of the last frame. */
+	None,
+	/**
+	 * Average the power of the frames. The first frames are averaged
+	 * linearly, then exponentially with the configured frame count.
+	 */
+	Average,
+	/** Hold the max. power of all frames. */
+	PeakHold,
+};
+
+// TODO: Use tr(), QCoreApplication::translate(), QT_TR_NOOP() or
+//       QT_TRANSLATE_NOOP() for translation.
+//       See: http://doc.qt.io/qt-5/i18n-source-translation.html
+typedef map<SpectrumWindow, QString> spectrum_window_name_map_t;
+static spectrum_window_name_map_t spectrum_window_name_map = {
+	{ SpectrumWindow::Rectangular, QString("Rectangular") },
+	{ SpectrumWindow::Hann, QString("Hann") },
+	{ SpectrumWindow::Hamming, QString("Hamming") },
+	{ SpectrumWindow::BlackmanHarris, QString("Blackman-Harris") },
+	{ SpectrumWindow::FlatTop, QString("Flat top") },
+};
+
+typedef map<SpectrumAveraging, QString> spectrum_averaging_name_map_t;
+static spectrum_averaging_name_map_t spectrum_averaging_name_map = {
+	{ SpectrumAveraging::None, QString("None") },
+	{ SpectrumAveraging::Average, QString("Average") },
+	{ SpectrumAveraging::PeakHold, QString("Peak hold") },
+};
+
+/**
+ * The SpectrumAnalyzer calculates the amplitude spectrum of an analog time
+ * signal on a worker thread.
+ *
+ * New samples are resampled to a uniform grid with the sample interval of
+ * the signal (estimated from the time stamps) or a given interval, so
+ * irregular sampled signals can be analyzed, too. Every time a new frame of
+ * fft_size samples is complete (frames overlap by the configured fraction),
+ * the frame is windowed and transformed, and the power is averaged or
+ * peak-held across the frames. A configuration change only re-analyzes the
+ * recent samples needed for the averaged frames.
+ *
+ * Only the finished spectrum is handed over to the GUI thread with
+ * spectrum(), so the analysis doesn't block the acquisition or the GUI.
+ */
+class SpectrumAnalyzer
+{
+
+public:
+	static const size_t min_fft_size = 16;
+	static const size_t max_fft_size = 1 << 20;
+
+	/**
+	 * @param signal The signal to analyze.
+	 * @param fft_size The number of samples per frame, must be a power of 2.
+	 * @param window The window function.
+	 * @param overlap The overlap of two frames, [0, 0.95].
+	 * @param averaging How to combine the spectra of the frames.
+	 * @param average_count The number of averaged frames.
+	 * @param sample_interval The sample interval in seconds. If 0, the
+	 *        interval is estimated from the time stamps of the signal.
+	 */
+	SpectrumAnalyzer(shared_ptr<AnalogTimeSignal> signal,
+		size_t fft_size = 1024, SpectrumWindow window = SpectrumWindow::Hann,
+		double overlap = 0.5,
+		SpectrumAveraging averaging = SpectrumAveraging::Average,
+		size_t average_count = 8, double sample_interval = 0.);
+	~SpectrumAnalyzer();
+
+	/**
+	 * Start the worker thread. Already existing samples of the signal are
+	 * analyzed, too.
+	 */
+	void start();
+
+	/**
+	 * Stop the worker thread. The last spectrum is kept.
+	 */
+	void stop();
+
+	bool is_running() const;
+
+	/**
+	 * Clear the averaged spectrum and restart with the next samples. The
+	 * following setters also reset the analyzer.
+	 */
+	void reset();
+
+	void set_fft_size(size_t fft_size);
+	size_t fft_size() const;
+	void set_window(SpectrumWindow window);
+	SpectrumWindow window() const;
+	void set_overlap(double overlap);
+	double overlap() const;
+	void set_averaging(SpectrumAveraging averaging, size_t average_count);
+	SpectrumAveraging averaging() const;
+	size_t average_count() const;
+	void set_sample_interval(double sample_interval);
+
+	/**
+	 * Return the used sample interval in seconds or 0, if not known yet.
+	 */
+	double sample_interval() const;
+
+	/**
+	 * Return the number of processed frames since the last reset.
+	 */
+	uint64_t frame_count() const;
+
+	/**
+	 * Return true, if a new spectrum was calculated since the last call of
+	 * spectrum().
+	 */
+	bool has_new_spectrum() const;
+
+	/**
+	 * Copy the current spectrum. The magnitudes are the (averaged) peak
+	 * amplitudes in the unit of the signal, corrected for the coherent gain
+	 * of the window.
+	 *
+	 * @return false if there is no spectrum yet.
+	 */
+	bool spectrum(vector<double> &frequencies, vector<double> &magnitudes);
+
+	/**
+	 * Calculate the single-sided amplitude spectrum of the samples, using
+	 * the given window. The number of samples must be a power of 2. Used by
+	 * the worker thread and the python bindings for one-shot analyses.
+	 */
+	static vector<double> amplitude_spectrum(const vector<double> &samples,
+		SpectrumWindow window);
+
+	/**
+	 * In-place radix-2 FFT. The size must be a power of 2.
+	 */
+	static void fft(vector<complex<double>> &data);
+
+private:
+	/** The configuration, copied by the worker on every reset. */
+	struct Config
+	{
+		size_t fft_size;
+		SpectrumWindow window;
+		double overlap;
+		SpectrumAveraging averaging;
+		size_t average_count;
+		double sample_interval;
+	};
+
+	/** Precalculated tables for one FFT size. */
+	struct FftPlan
+	{
+		size_t fft_size;
+		vector<double> window;
+		double window_sum;
+		/** Twiddle factors and bit reversal for the half size FFT. */
+		vector<complex<double>> twiddles;
+		vector<size_t> bit_reversal;
+		/** Twiddle factors to split the half size FFT. */
+		vector<complex<double>> split_twiddles;
+	};
+
+	static void init_plan(FftPlan &plan, size_t fft_size,
+		SpectrumWindow window);
+	static void calc_window(vector<double> &window, SpectrumWindow type);
+	static void execute_plan(const FftPlan &plan, const double *samples,
+		vector<complex<double>> &scratch, double *power);
+	static void fft(complex<double> *data, size_t size,
+		const vector<complex<double>> &twiddles,
+		const vector<size_t> &bit_reversal);
+
+	void request_reset(double start_timestamp);
+	void wake();
+	void worker_thread_proc();
+	void restart(const Config &config, double start_timestamp);
+	bool estimate_sample_interval();
+	void process_frames();
+	void publish_spectrum();
+
+	shared_ptr<AnalogTimeSignal> signal_;
+
+	mutable std::mutex config_mutex_;
+	Config config_;
+	std::atomic<bool> reset_requested_;
+	/** The time stamp of the first sample after a reset. */
+	double reset_timestamp_;
+
+	std::thread worker_thread_;
+	std::atomic<bool> stop_;
+	std::mutex wake_mutex_;
+	std::condition_variable wake_cv_;
+	bool wake_;
+	QMetaObject::Connection sample_appended_conn_;
+	QMetaObject::Connection samples_cleared_conn_;
+
+	// Only used by the worker thread
+	Config worker_config_;
+	FftPlan plan_;
+	shared_ptr<Resampler> resampler_;
+	double start_timestamp_;
+	vector<double> resampled_time_;
+	vector<vector<double>> resampled_values_;
+	vector<double> frame_buffer_;
+	vector<complex<double>> scratch_;
+	vector<double> frame_power_;
+	vector<double> power_;
+
+	std::atomic<double> used_sample_interval_;
+	std::atomic<uint64_t> frame_count_;
+
+	mutable std::mutex spectrum_mutex_;
+	vector<double> frequencies_;
+	vector<double> magnitudes_;
+	std::atomic<bool> has_new_spectrum_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SPECTRUMANALYZER_HPP
@@ -0,0 +1,462 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <QDateTime>
+#include <QDebug>
+#include <QMetaObject>
+#include <QThread>
+#include <QTimer>
+#include <QVariant>
+
+#include "sweep.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/triggerengine.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+namespace {
+
+/**
+ * Return the quantity for the unit of a property, for the set value channel.
+ */
+Quantity quantity_for_unit(Unit unit)
+{
+	switch (unit) {
+	case Unit::Volt:
+		return Quantity::Voltage;
+	case Unit::Ampere:
+		return Quantity::Current;
+	case Unit::Ohm:
+		return Quantity::Resistance;
+	case Unit::Watt:
+		return Quantity::Power;
+	case Unit::Hertz:
+		return Quantity::Frequency;
+	case Unit::Celsius:
+		return Quantity::Temperature;
+	default:
+		return Quantity::Unknown;
+	}
+}
+
+} // namespace
+
+Sweep::Sweep(Session &session,
+		shared_ptr<properties::DoubleProperty> property,
+		const vector<shared_ptr<AnalogTimeSignal>> &measurement_signals) :
+	QObject(),
+	session_(session),
+	property_(property),
+	measurement_signals_(measurement_signals),
+	settle_delay_(0.),
+	settle_samples_(1),
+	settle_tolerance_(0.),
+	timeout_(10.),
+	started_(false),
+	running_(false),
+	step_index_(0),
+	unsettled_count_(0),
+	step_timestamp_(0.),
+	evaluation_pending_(false),
+	timeout_timer_(new QTimer(this)),
+	settle_timer_(new QTimer(this))
+{
+	assert(property_);
+
+	timeout_timer_->setSingleShot(true);
+	connect(timeout_timer_, &QTimer::timeout, this, &Sweep::on_timeout);
+	settle_timer_->setSingleShot(true);
+	connect(settle_timer_, &QTimer::timeout, this, &Sweep::evaluate);
+
+	// A safety trigger stops the sweep together with the sequences.
+	connect(session_.trigger_engine().get(), &TriggerEngine::stop_sequences,
+		this, &Sweep::stop);
+
+	// The sweep may be created by a script, but must run in the thread of
+	// the session, that has an event loop.
+	if (thread() != session_.thread())
+		moveToThread(session_.thread());
+}
+
+Sweep::~Sweep()
+{
+	for (const auto &connection : sample_connections_)
+		disconnect(connection);
+}
+
+vector<double> Sweep::generate_steps(SweepType type,
+	double start, double stop, size_t count)
+{
+	if (count == 0)
+		throw std::invalid_argument("The number of steps must not be 0");
+	if (count == 1)
+		return vector<double>{ start };
+
+	vector<double> steps(count);
+	if (type == SweepType::Log) {
+		if (start == 0. || stop == 0. || (start < 0.) != (stop < 0.)) {
+			throw std::invalid_argument(
+				"Start and stop of a logarithmic sweep must have the same "
+				"sign and must not be 0");
+		}
+		double log_start = std::log(std::fabs(start));
+		double log_step = (std::log(std::fabs(stop)) - log_start) /
+			(double)(count - 1);
+		double sign = start < 0. ? -1. : 1.;
+		for (size_t i = 0; i < count; ++i)
+			steps[i] = sign * std::exp(log_start + (double)i * log_step);
+	}
+	else {
+		double step = (stop - start) / (double)(count - 1);
+		for (size_t i = 0; i < count; ++i)
+			steps[i] = start + (double)i * step;
+	}
+	// Hit the end point exactly.
+	steps.back() = stop;
+
+	return steps;
+}
+
+void Sweep::set_steps(const vector<double> &steps)
+{
+	if (running_)
+		return;
+	steps_ = steps;
+}
+
+void Sweep::set_settle(double settle_delay, size_t settle_samples,
+	double settle_tolerance, double timeout)
+{
+	if (running_)
+		return;
+	settle_delay_ = std::max(0., settle_delay);
+	settle_samples_ = std::max((size_t)1, settle_samples);
+	settle_tolerance_ = std::max(0., settle_tolerance);
+	timeout_ = timeout;
+}
+
+shared_ptr<properties::DoubleProperty> Sweep::property() const
+{
+	return property_;
+}
+
+vector<shared_ptr<AnalogTimeSignal>> Sweep::measurement_signals() const
+{
+	return measurement_signals_;
+}
+
+vector<double> Sweep::steps() const
+{
+	return steps_;
+}
+
+double Sweep::settle_delay() const
+{
+	return settle_delay_;
+}
+
+size_t Sweep::settle_samples() const
+{
+	return settle_samples_;
+}
+
+double Sweep::settle_tolerance() const
+{
+	return settle_tolerance_;
+}
+
+double Sweep::timeout() const
+{
+	return timeout_;
+}
+
+bool Sweep::is_running() const
+{
+	return running_;
+}
+
+size_t Sweep::step_index() const
+{
+	return step_index_;
+}
+
+size_t Sweep::unsettled_count() const
+{
+	return unsettled_count_;
+}
+
+shared_ptr<devices::UserDevice> Sweep::result_device() const
+{
+	return result_device_;
+}
+
+bool Sweep::wait(double timeout)
+{
+	assert(QThread::currentThread() != thread());
+
+	unique_lock<mutex> lock(running_mutex_);
+	return running_cv_.wait_for(lock,
+		std::chrono::duration<double>(timeout),
+		[this]() { return !running_; });
+}
+
+void Sweep::start()
+{
+	if (QThread::currentThread() != thread()) {
+		// Mark the sweep as running right away, so a following wait() from
+		// the calling thread doesn't return before the sweep has started.
+		set_running(true);
+		QMetaObject::invokeMethod(this, "start", Qt::QueuedConnection);
+		return;
+	}
+	if (started_)
+		return;
+	if (steps_.empty()) {
+		qWarning() << "Sweep::start(): No steps";
+		set_running(false);
+		return;
+	}
+
+	init_result_channels();
+
+	// The new samples are evaluated in the thread of the sweep. Only one
+	// evaluation is queued at a time, no matter how fast the samples come.
+	for (const auto &signal : measurement_signals_) {
+		sample_connections_.push_back(connect(signal.get(),
+			&AnalogBaseSignal::sample_appended, this, [this]() {
+				if (!evaluation_pending_.exchange(true)) {
+					QMetaObject::invokeMethod(this, "evaluate",
+						Qt::QueuedConnection);
+				}
+			}, Qt::DirectConnection));
+	}
+
+	step_index_ = 0;
+	unsettled_count_ = 0;
+	started_ = true;
+	set_running(true);
+	Q_EMIT started();
+
+	start_step();
+}
+
+void Sweep::stop()
+{
+	if (QThread::currentThread() != thread()) {
+		QMetaObject::invokeMethod(this, "stop", Qt::QueuedConnection);
+		return;
+	}
+
+	timeout_timer_->stop();
+	settle_timer_->stop();
+	for (const auto &connection : sample_connections_)
+		disconnect(connection);
+	sample_connections_.clear();
+
+	bool was_started = started_;
+	started_ = false;
+	set_running(false);
+	if (was_started)
+		Q_EMIT finished();
+}
+
+void Sweep::init_result_channels()
+{
+	if (result_device_)
+		return;
+
+	result_device_ = session_.add_user_device();
+	setpoint_channel_ = result_device_->add_user_channel(
+		property_->name(), "Sweep");
+	for (const auto &signal : measurement_signals_) {
+		// The measurement signals may be from channels with the same name.
+		string name = signal->parent_channel()->name();
+		const auto channels = result_device_->channel_map();
+		for (int i = 2; channels->count(name) > 0; ++i)
+			name = signal->parent_channel()->name() + " " + std::to_string(i);
+		result_channels_.push_back(
+			result_device_->add_user_channel(name, "Sweep"));
+	}
+}
+
+void Sweep::start_step()
+{
+	start_positions_.clear();
+	for (const auto &signal : measurement_signals_)
+		start_positions_.push_back(signal->sample_count());
+	step_timestamp_ = QDateTime::currentMSecsSinceEpoch() / (double)1000;
+
+	property_->change_value(QVariant(steps_[step_index_]));
+
+	if (timeout_ > 0.)
+		timeout_timer_->start((int)(timeout_ * 1000));
+
+	// Without measurement signals, every step is settled after the delay.
+	if (measurement_signals_.empty())
+		settle_timer_->start((int)(settle_delay_ * 1000));
+}
+
+void Sweep::evaluate()
+{
+	evaluation_pending_ = false;
+	if (!started_)
+		return;
+
+	if (measurement_signals_.empty()) {
+		finish_step(true);
+		return;
+	}
+
+	double value;
+	for (size_t i = 0; i < measurement_signals_.size(); ++i) {
+		if (!settled_value(i, false, value))
+			return;
+	}
+	finish_step(true);
+}
+
+void Sweep::on_timeout()
+{
+	if (!started_)
+		return;
+
+	qWarning() << "Sweep::on_timeout(): Step" << step_index_ <<
+		"has not settled";
+	finish_step(false);
+}
+
+bool Sweep::settled_value(size_t i, bool ignore_count, double &value)
+{
+	const auto &signal = measurement_signals_[i];
+	size_t sample_count = signal->sample_count();
+	if (sample_count <= start_positions_[i])
+		return false;
+
+	size_t count = std::min(settle_samples_,
+		sample_count - start_positions_[i]);
+	if (!ignore_count && count < settle_samples_)
+		return false;
+
+	timestamps_.resize(count);
+	values_.resize(count);
+	count = signal->get_samples(sample_count - count, count,
+		timestamps_.data(), values_.data());
+
+	// Only the samples after the settle delay are valid.
+	const double valid_timestamp = step_timestamp_ + settle_delay_;
+	size_t first = 0;
+	while (first < count && timestamps_[first] < valid_timestamp)
+		++first;
+	if (first == count || (!ignore_count && first > 0))
+		return false;
+
+	double min = values_[first];
+	double max = values_[first];
+	double sum = 0.;
+	for (size_t j = first; j < count; ++j) {
+		min = std::min(min, values_[j]);
+		max = std::max(max, values_[j]);
+		sum += values_[j];
+	}
+	if (!ignore_count && settle_tolerance_ > 0. &&
+			max - min > 2 * settle_tolerance_)
+		return false;
+
+	value = sum / (double)(count - first);
+	return true;
+}
+
+void Sweep::finish_step(bool settled)
+{
+	timeout_timer_->stop();
+	settle_timer_->stop();
+
+	// All results of a step have the same time stamp, so they can be
+	// combined to x/y curves.
+	double timestamp = QDateTime::currentMSecsSinceEpoch() / (double)1000;
+	double step_value = steps_[step_index_];
+	setpoint_channel_->push_sample(step_value, timestamp,
+		quantity_for_unit(property_->unit()), set<QuantityFlag>(),
+		property_->unit(), property_->digits(),
+		property_->decimal_places());
+
+	for (size_t i = 0; i < measurement_signals_.size(); ++i) {
+		const auto &signal = measurement_signals_[i];
+		double value;
+		if (!settled_value(i, !settled, value)) {
+			// Not a single valid sample, use the last one.
+			if (signal->sample_count() == 0)
+				continue;
+			value = signal->get_sample(signal->sample_count() - 1, false).
+				second;
+		}
+		result_channels_[i]->push_sample(value, timestamp,
+			signal->quantity(), signal->quantity_flags(), signal->unit(),
+			signal->digits(), signal->decimal_places());
+	}
+
+	if (!settled)
+		++unsettled_count_;
+	Q_EMIT step_finished(step_index_, step_value, settled);
+
+	if (step_index_ + 1 >= steps_.size()) {
+		stop();
+		return;
+	}
+	++step_index_;
+	start_step();
+}
+
+void Sweep::set_running(bool running)
+{
+	{
+		lock_guard<mutex> lock(running_mutex_);
+		running_ = running;
+	}
+	running_cv_.notify_all();
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,221 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_SWEEP_HPP
+#define DATA_SWEEP_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include <QMetaObject>
+#include <QObject>
+#include <QString>
+
+using std::map;
+using std::shared_ptr;
+using std::vector;
+
+class QTimer;
+
+namespace sv {
+
+class Session;
+
+namespace channels {
+class UserChannel;
+}
+namespace devices {
+class UserDevice;
+}
+
+namespace data {
+
+class AnalogTimeSignal;
+
+namespace properties {
+class DoubleProperty;
+}
+
+enum class SweepType {
+	/** Equidistant steps from start to stop. */
+	Linear,
+	/** Logarithmic spaced steps from start to stop. */
+	Log,
+	/** A list of arbitrary steps. */
+	List,
+};
+
+// TODO: Use tr(), QCoreApplication::translate(), QT_TR_NOOP() or
+//       QT_TRANSLATE_NOOP() for translation.
+//       See: http://doc.qt.io/qt-5/i18n-source-translation.html
+typedef map<SweepType, QString> sweep_type_name_map_t;
+static sweep_type_name_map_t sweep_type_name_map = {
+	{ SweepType::Linear, QString("Linear") },
+	{ SweepType::Log, QString("Logarithmic") },
+	{ SweepType::List, QString("List") },
+};
+
+/**
+ * A Sweep sets a double property (e.g. the output voltage of a power supply)
+ * to a sequence of values and measures the given signals for every step.
+ *
+ * Instead of a fixed delay, every step waits until the measurement signals
+ * have settled: Each signal must have settle_samples new samples, that are
+ * taken at least settle_delay seconds after the value has been set and that
+ * are within +/- settle_tolerance of their center. With a tolerance of 0,
+ * only the new samples are counted. If the signals don't settle within the
+ * timeout, the step is taken anyway and marked as not settled. The next step
+ * is set immediately, so the sweep runs as fast as the devices allow.
+ *
+ * The set value and the mean of the settled samples of every measurement
+ * signal are pushed with the same time stamp to the channels of a user
+ * device, so every result signal can be shown over the set value in a x/y
+ * plot.
+ *
+ * The sweep runs in the thread of the Session (the GUI thread). start(),
+ * stop() and wait() can be called from any thread, e.g. from a script.
+ */
+class Sweep : public QObject
+{
+	Q_OBJECT
+
+public:
+	Sweep(Session &session,
+		shared_ptr<properties::DoubleProperty> property,
+		const vector<shared_ptr<AnalogTimeSignal>> &measurement_signals);
+	~Sweep();
+
+	/**
+	 * Return count steps from start to stop. The logarithmic steps need
+	 * start and stop with the same sign, both not 0.
+	 *
+	 * @throws std::invalid_argument If the parameters are invalid.
+	 */
+	static vector<double> generate_steps(SweepType type,
+		double start, double stop, size_t count);
+
+	/** Set the steps. Only while the sweep isn't running. */
+	void set_steps(const vector<double> &steps);
+	/**
+	 * Set the settle condition. Only while the sweep isn't running. With a
+	 * timeout of 0, a step waits forever for the signals to settle.
+	 */
+	void set_settle(double settle_delay, size_t settle_samples,
+		double settle_tolerance, double timeout);
+
+	shared_ptr<properties::DoubleProperty> property() const;
+	vector<shared_ptr<AnalogTimeSignal>> measurement_signals() const;
+	vector<double> steps() const;
+	double settle_delay() const;
+	size_t settle_samples() const;
+	double settle_tolerance() const;
+	double timeout() const;
+
+	bool is_running() const;
+	/** The index of the current (or last) step. */
+	size_t step_index() const;
+	/** The number of steps, that didn't settle within the timeout. */
+	size_t unsettled_count() const;
+
+	/**
+	 * Return the user device with the results. The device is created when
+	 * the sweep is started for the first time.
+	 */
+	shared_ptr<devices::UserDevice> result_device() const;
+
+	/**
+	 * Wait max. timeout seconds for the sweep to finish. Must not be called
+	 * from the thread of the sweep.
+	 *
+	 * @return true, if the sweep isn't running anymore.
+	 */
+	bool wait(double timeout);
+
+private:
+	void init_result_channels();
+	void start_step();
+	void finish_step(bool settled);
+	/**
+	 * Return the mean of the last settle_samples valid samples of the signal.
+	 * A sample is valid, if it has been appended after the step was set and
+	 * it is not older than settle_delay. With ignore_count, the mean of the
+	 * available valid samples is returned.
+	 */
+	bool settled_value(size_t i, bool ignore_count, double &value);
+	void set_running(bool running);
+
+	Session &session_;
+	const shared_ptr<properties::DoubleProperty> property_;
+	const vector<shared_ptr<AnalogTimeSignal>> measurement_signals_;
+	vector<double> steps_;
+	double settle_delay_;
+	size_t settle_samples_;
+	double settle_tolerance_;
+	double timeout_;
+
+	/** Only used in the thread of the sweep. */
+	bool started_;
+	std::atomic<bool> running_;
+	std::atomic<size_t> step_index_;
+	std::atomic<size_t> unsettled_count_;
+	std::mutex running_mutex_;
+	std::condition_variable running_cv_;
+
+	/** The sample counts of the signals, when the step was set. */
+	vector<size_t> start_positions_;
+	double step_timestamp_;
+	/** Scratch buffers for the samples of one signal. */
+	vector<double> timestamps_;
+	vector<double> values_;
+	/** Set, while an evaluation of the new samples is queued. */
+	std::atomic<bool> evaluation_pending_;
+	vector<QMetaObject::Connection> sample_connections_;
+	QTimer *timeout_timer_;
+	/** Settles the steps, if there are no measurement signals. */
+	QTimer *settle_timer_;
+
+	shared_ptr<devices::UserDevice> result_device_;
+	shared_ptr<channels::UserChannel> setpoint_channel_;
+	vector<shared_ptr<channels::UserChannel>> result_channels_;
+
+public Q_SLOTS:
+	/** Start the sweep at the first step. */
+	void start();
+	/** Stop the sweep. The current step is discarded. */
+	void stop();
+
+private Q_SLOTS:
+	void evaluate();
+	void on_timeout();
+
+Q_SIGNALS:
+	void started();
+	void step_finished(size_t index, double value, bool settled);
+	void finished();
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_SWEEP_HPP
@@ -0,0 +1,340 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+
+#include <QString>
+#include <QVariant>
+
+#include "trigger.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/triggerengine.hpp"
+#include "src/data/properties/baseproperty.hpp"
+
+using std::lock_guard;
+using std::mutex;
+using std::shared_ptr;
+
+namespace sv {
+namespace data {
+
+Trigger::Trigger(TriggerEngine &engine, shared_ptr<AnalogTimeSignal> signal,
+		TriggerCondition condition, double level, double level2,
+		double duration, double hysteresis, bool single_shot) :
+	engine_(engine),
+	signal_(signal),
+	condition_(condition),
+	level_(level),
+	level2_(level2),
+	duration_(duration),
+	hysteresis_(std::fabs(hysteresis)),
+	single_shot_(single_shot),
+	armed_(false),
+	event_count_(0),
+	stop_sequences_action_(false)
+{
+	assert(signal_);
+
+	reset_state();
+	signal_pos_ = signal_->sample_count();
+
+	// The samples are evaluated in the thread, that appends them.
+	appended_connection_ = connect(
+		signal_.get(), &AnalogTimeSignal::sample_appended,
+		this, [this]() { evaluate(); }, Qt::DirectConnection);
+	cleared_connection_ = connect(
+		signal_.get(), &AnalogTimeSignal::samples_cleared,
+		this, [this]() {
+			lock_guard<mutex> lock(mutex_);
+			reset_state();
+			signal_pos_ = 0;
+		}, Qt::DirectConnection);
+}
+
+Trigger::~Trigger()
+{
+	disconnect(appended_connection_);
+	disconnect(cleared_connection_);
+	// Wait for a running evaluation in another thread.
+	lock_guard<mutex> lock(mutex_);
+}
+
+shared_ptr<AnalogTimeSignal> Trigger::signal() const
+{
+	return signal_;
+}
+
+TriggerCondition Trigger::condition() const
+{
+	return condition_;
+}
+
+double Trigger::level() const
+{
+	return level_;
+}
+
+double Trigger::level2() const
+{
+	return level2_;
+}
+
+double Trigger::duration() const
+{
+	return duration_;
+}
+
+double Trigger::hysteresis() const
+{
+	return hysteresis_;
+}
+
+bool Trigger::is_single_shot() const
+{
+	return single_shot_;
+}
+
+QString Trigger::name() const
+{
+	QString name = QString::fromStdString(signal_->name()) + ": " +
+		trigger_condition_name_map[condition_];
+	switch (condition_) {
+	case TriggerCondition::InsideWindow:
+	case TriggerCondition::OutsideWindow:
+		return name + QString(" [%1, %2]").arg(level_).arg(level2_);
+	case TriggerCondition::Stable:
+		return name + QString(" +/-%1 for %2 s").arg(level_).arg(duration_);
+	default:
+		return name + QString(" %1").arg(level_);
+	}
+}
+
+void Trigger::arm()
+{
+	lock_guard<mutex> lock(mutex_);
+	reset_state();
+	signal_pos_ = signal_->sample_count();
+	armed_ = true;
+}
+
+void Trigger::disarm()
+{
+	armed_ = false;
+}
+
+bool Trigger::is_armed() const
+{
+	return armed_;
+}
+
+uint64_t Trigger::event_count() const
+{
+	return event_count_;
+}
+
+void Trigger::set_property_action(
+	shared_ptr<properties::BaseProperty> property, QVariant value)
+{
+	lock_guard<mutex> lock(mutex_);
+	action_property_ = property;
+	action_value_ = value;
+}
+
+shared_ptr<properties::BaseProperty> Trigger::action_property() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return action_property_;
+}
+
+QVariant Trigger::action_value() const
+{
+	lock_guard<mutex> lock(mutex_);
+	return action_value_;
+}
+
+void Trigger::set_stop_sequences_action(bool stop_sequences)
+{
+	stop_sequences_action_ = stop_sequences;
+}
+
+bool Trigger::stop_sequences_action() const
+{
+	return stop_sequences_action_;
+}
+
+void Trigger::set_callback(std::function<void(const TriggerEvent &)> callback)
+{
+	callback_ = callback;
+}
+
+std::function<void(const TriggerEvent &)> Trigger::callback() const
+{
+	return callback_;
+}
+
+void Trigger::evaluate()
+{
+	lock_guard<mutex> lock(mutex_);
+
+	const size_t sample_count = signal_->sample_count();
+	if (!armed_) {
+		signal_pos_ = sample_count;
+		return;
+	}
+
+	for (; signal_pos_ < sample_count; ++signal_pos_) {
+		auto sample = signal_->get_sample(signal_pos_, false);
+		double timestamp = sample.first;
+		if (!evaluate_sample(timestamp, sample.second))
+			continue;
+
+		shared_ptr<Trigger> self;
+		try {
+			self = shared_from_this();
+		}
+		catch (const std::bad_weak_ptr &) {
+			// The trigger is destructed right now.
+			return;
+		}
+		TriggerEvent event = { timestamp, sample.second, ++event_count_ };
+		engine_.post_event(self, event);
+		if (single_shot_) {
+			armed_ = false;
+			signal_pos_ = sample_count;
+			break;
+		}
+	}
+}
+
+bool Trigger::evaluate_sample(double &timestamp, double value)
+{
+	const double sample_timestamp = timestamp;
+	bool fire = false;
+	bool enter = false;
+	bool leave = false;
+	double slope = 0.;
+
+	switch (condition_) {
+	case TriggerCondition::Above:
+		enter = value > level_;
+		leave = value < level_ - hysteresis_;
+		break;
+	case TriggerCondition::Below:
+		enter = value < level_;
+		leave = value > level_ + hysteresis_;
+		break;
+	case TriggerCondition::RisingEdge:
+		enter = value >= level_;
+		leave = value < level_ - hysteresis_;
+		break;
+	case TriggerCondition::FallingEdge:
+		enter = value <= level_;
+		leave = value > level_ + hysteresis_;
+		break;
+	case TriggerCondition::InsideWindow:
+		enter = value >= level_ && value <= level2_;
+		leave = value < level_ - hysteresis_ || value > level2_ + hysteresis_;
+		break;
+	case TriggerCondition::OutsideWindow:
+		enter = value < level_ || value > level2_;
+		leave = value > level_ + hysteresis_ && value < level2_ - hysteresis_;
+		break;
+	case TriggerCondition::SlopeAbove:
+	case TriggerCondition::SlopeBelow:
+		if (has_prev_ && timestamp > prev_timestamp_) {
+			slope = (value - prev_value_) / (timestamp - prev_timestamp_);
+			if (condition_ == TriggerCondition::SlopeAbove) {
+				enter = slope > level_;
+				leave = slope < level_ - hysteresis_;
+			}
+			else {
+				enter = slope < level_;
+				leave = slope > level_ + hysteresis_;
+			}
+		}
+		break;
+	case TriggerCondition::Stable:
+		if (!has_prev_ || std::fabs(value - stable_value_) > level_) {
+			// Start a new stable interval with this sample.
+			stable_timestamp_ = timestamp;
+			stable_value_ = value;
+			active_ = false;
+		}
+		else if (!active_ && timestamp - stable_timestamp_ >= duration_) {
+			active_ = true;
+			fire = true;
+		}
+		break;
+	}
+
+	if (condition_ != TriggerCondition::Stable) {
+		const bool is_edge = condition_ == TriggerCondition::RisingEdge ||
+			condition_ == TriggerCondition::FallingEdge;
+		if (!active_ && enter) {
+			active_ = true;
+			// An edge needs a sample on the other side of the level.
+			fire = !is_edge || has_prev_;
+			if (fire && has_prev_ && (is_edge ||
+					condition_ == TriggerCondition::Above ||
+					condition_ == TriggerCondition::Below)) {
+				timestamp = crossing_time(timestamp, value, level_);
+			}
+		}
+		else if (active_ && leave) {
+			active_ = false;
+		}
+	}
+
+	has_prev_ = true;
+	prev_timestamp_ = sample_timestamp;
+	prev_value_ = value;
+
+	return fire;
+}
+
+double Trigger::crossing_time(
+	double timestamp, double value, double level) const
+{
+	if (value == prev_value_)
+		return timestamp;
+
+	double fraction = (level - prev_value_) / (value - prev_value_);
+	if (fraction < 0. || fraction > 1.)
+		return timestamp;
+
+	return prev_timestamp_ + fraction * (timestamp - prev_timestamp_);
+}
+
+void Trigger::reset_state()
+{
+	has_prev_ = false;
+	prev_timestamp_ = 0.;
+	prev_value_ = 0.;
+	active_ = false;
+	stable_timestamp_ = 0.;
+	stable_value_ = 0.;
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,229 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_TRIGGER_HPP
+#define DATA_TRIGGER_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+
+#include <QMetaObject>
+#include <QMetaType>
+#include <QObject>
+#include <QString>
+#include <QVariant>
+
+using std::map;
+using std::shared_ptr;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+class TriggerEngine;
+
+namespace properties {
+class BaseProperty;
+}
+
+/**
+ * The conditions of a trigger. The meaning of the parameters level, level2,
+ * duration and hysteresis depends on the condition:
+ *
+ *  - Above/Below: The value is above/below level. The trigger is re-armed,
+ *    when the value is hysteresis below/above level.
+ *  - RisingEdge/FallingEdge: The value crosses level. The trigger is
+ *    re-armed, when the value is hysteresis below/above level.
+ *  - InsideWindow/OutsideWindow: The value is inside/outside of
+ *    [level, level2].
+ *  - SlopeAbove/SlopeBelow: The slope between two samples (in unit/s) is
+ *    above/below level.
+ *  - Stable: The value stays within +/- level for duration seconds.
+ *
+ * Except for the edges and the stable condition, the trigger fires when the
+ * condition becomes true and fires again only after the condition was false.
+ */
+enum class TriggerCondition {
+	Above,
+	Below,
+	RisingEdge,
+	FallingEdge,
+	InsideWindow,
+	OutsideWindow,
+	SlopeAbove,
+	SlopeBelow,
+	Stable,
+};
+
+// TODO: Use tr(), QCoreApplication::translate(), QT_TR_NOOP() or
+//       QT_TRANSLATE_NOOP() for translation.
+//       See: http://doc.qt.io/qt-5/i18n-source-translation.html
+typedef map<TriggerCondition, QString> trigger_condition_name_map_t;
+static trigger_condition_name_map_t trigger_condition_name_map = {
+	{ TriggerCondition::Above, QString("Above") },
+	{ TriggerCondition::Below, QString("Below") },
+	{ TriggerCondition::RisingEdge, QString("Rising edge") },
+	{ TriggerCondition::FallingEdge, QString("Falling edge") },
+	{ TriggerCondition::InsideWindow, QString("Inside window") },
+	{ TriggerCondition::OutsideWindow, QString("Outside window") },
+	{ TriggerCondition::SlopeAbove, QString("Slope above") },
+	{ TriggerCondition::SlopeBelow, QString("Slope below") },
+	{ TriggerCondition::Stable, QString("Stable") },
+};
+
+struct TriggerEvent
+{
+	/** Absolute time stamp of the event. Edges are interpolated. */
+	double timestamp;
+	/** The value of the sample, that fired the trigger. */
+	double value;
+	/** The number of the event, starting at 1. */
+	uint64_t number;
+};
+
+/**
+ * A Trigger evaluates a condition on every sample of a signal, in the thread
+ * that appends the samples to the signal. The events are passed to the
+ * TriggerEngine, that delivers them to the scripts, the plots and executes
+ * the actions of the trigger.
+ */
+class Trigger :
+	public QObject,
+	public std::enable_shared_from_this<Trigger>
+{
+	Q_OBJECT
+
+public:
+	Trigger(TriggerEngine &engine, shared_ptr<AnalogTimeSignal> signal,
+		TriggerCondition condition, double level, double level2,
+		double duration, double hysteresis, bool single_shot);
+	~Trigger();
+
+	shared_ptr<AnalogTimeSignal> signal() const;
+	TriggerCondition condition() const;
+	double level() const;
+	double level2() const;
+	double duration() const;
+	double hysteresis() const;
+	bool is_single_shot() const;
+
+	/**
+	 * Return a description of the trigger, e.g. "CH1 [V]: Above 3.5".
+	 */
+	QString name() const;
+
+	/**
+	 * Arm the trigger. The evaluation starts with the next appended sample.
+	 */
+	void arm();
+
+	/**
+	 * Disarm the trigger. A single shot trigger is disarmed after the event.
+	 */
+	void disarm();
+
+	bool is_armed() const;
+	uint64_t event_count() const;
+
+	/**
+	 * Set the property to value, when the trigger fires. The property is set
+	 * in the GUI thread.
+	 */
+	void set_property_action(
+		shared_ptr<properties::BaseProperty> property, QVariant value);
+	shared_ptr<properties::BaseProperty> action_property() const;
+	QVariant action_value() const;
+
+	/**
+	 * Stop all running sequences (SequenceOutputView), when the trigger
+	 * fires.
+	 */
+	void set_stop_sequences_action(bool stop_sequences);
+	bool stop_sequences_action() const;
+
+	/**
+	 * Set the callback for the events. The callback is not called by the
+	 * trigger, but by the owner of the event queue (see
+	 * TriggerEngine::wait_events()).
+	 */
+	void set_callback(std::function<void(const TriggerEvent &)> callback);
+	std::function<void(const TriggerEvent &)> callback() const;
+
+private:
+	/**
+	 * Evaluate the new samples of the signal.
+	 */
+	void evaluate();
+
+	/**
+	 * Evaluate one sample. Return true and the event time stamp in timestamp,
+	 * if the trigger fires.
+	 */
+	bool evaluate_sample(double &timestamp, double value);
+
+	/**
+	 * Interpolate the time stamp where the value crosses level between the
+	 * previous sample and the given sample.
+	 */
+	double crossing_time(double timestamp, double value, double level) const;
+
+	void reset_state();
+
+	TriggerEngine &engine_;
+	shared_ptr<AnalogTimeSignal> signal_;
+	const TriggerCondition condition_;
+	const double level_;
+	const double level2_;
+	const double duration_;
+	const double hysteresis_;
+	const bool single_shot_;
+
+	std::atomic<bool> armed_;
+	std::atomic<uint64_t> event_count_;
+	shared_ptr<properties::BaseProperty> action_property_;
+	QVariant action_value_;
+	bool stop_sequences_action_;
+	std::function<void(const TriggerEvent &)> callback_;
+
+	/** Serializes the evaluation and the state changes. */
+	mutable std::mutex mutex_;
+	QMetaObject::Connection appended_connection_;
+	QMetaObject::Connection cleared_connection_;
+	size_t signal_pos_;
+	bool has_prev_;
+	double prev_timestamp_;
+	double prev_value_;
+	/** The condition was true at the previous sample. */
+	bool active_;
+	/** The start of the stable interval. */
+	double stable_timestamp_;
+	double stable_value_;
+
+};
+
+} // namespace data
+} // namespace sv
+
+Q_DECLARE_METATYPE(sv::data::TriggerEvent)
+
+#endif // DATA_TRIGGER_HPP
@@ -0,0 +1,147 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+
+#include "triggerengine.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/trigger.hpp"
+#include "src/data/properties/baseproperty.hpp"
+
+using std::lock_guard;
+using std::make_shared;
+using std::mutex;
+using std::shared_ptr;
+using std::unique_lock;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+const size_t TriggerEngine::max_queued_events;
+
+TriggerEngine::TriggerEngine() :
+	dropped_event_count_(0)
+{
+	// The actions are executed in the thread of the engine.
+	connect(this, &TriggerEngine::triggered,
+		this, &TriggerEngine::execute_actions, Qt::QueuedConnection);
+}
+
+shared_ptr<Trigger> TriggerEngine::add_trigger(
+	shared_ptr<AnalogTimeSignal> signal, TriggerCondition condition,
+	double level, double level2, double duration, double hysteresis,
+	bool single_shot)
+{
+	assert(signal);
+
+	auto trigger = make_shared<Trigger>(*this, signal, condition,
+		level, level2, duration, hysteresis, single_shot);
+	{
+		lock_guard<mutex> lock(triggers_mutex_);
+		triggers_.push_back(trigger);
+	}
+	trigger->arm();
+
+	return trigger;
+}
+
+void TriggerEngine::remove_trigger(shared_ptr<Trigger> trigger)
+{
+	if (!trigger)
+		return;
+
+	trigger->disarm();
+	lock_guard<mutex> lock(triggers_mutex_);
+	triggers_.erase(std::remove(triggers_.begin(), triggers_.end(), trigger),
+		triggers_.end());
+}
+
+vector<shared_ptr<Trigger>> TriggerEngine::triggers() const
+{
+	lock_guard<mutex> lock(triggers_mutex_);
+	return triggers_;
+}
+
+void TriggerEngine::post_event(
+	shared_ptr<Trigger> trigger, const TriggerEvent &event)
+{
+	{
+		lock_guard<mutex> lock(event_queue_mutex_);
+		if (event_queue_.size() >= max_queued_events) {
+			event_queue_.pop_front();
+			++dropped_event_count_;
+		}
+		event_queue_.push_back(std::make_pair(trigger, event));
+	}
+	event_queue_cv_.notify_all();
+
+	Q_EMIT triggered(trigger, event);
+}
+
+vector<trigger_event_t> TriggerEngine::wait_events(double timeout)
+{
+	unique_lock<mutex> lock(event_queue_mutex_);
+	if (event_queue_.empty() && timeout > 0) {
+		event_queue_cv_.wait_for(lock,
+			std::chrono::duration<double>(timeout),
+			[this]() { return !event_queue_.empty(); });
+	}
+
+	vector<trigger_event_t> events(event_queue_.begin(), event_queue_.end());
+	event_queue_.clear();
+	return events;
+}
+
+uint64_t TriggerEngine::dropped_event_count() const
+{
+	return dropped_event_count_;
+}
+
+void TriggerEngine::clear_callbacks()
+{
+	for (const auto &trigger : triggers())
+		trigger->set_callback(nullptr);
+
+	// The queued events may hold the last reference of a removed trigger.
+	lock_guard<mutex> lock(event_queue_mutex_);
+	event_queue_.clear();
+}
+
+void TriggerEngine::execute_actions(
+	shared_ptr<Trigger> trigger, TriggerEvent event)
+{
+	(void)event;
+
+	auto property = trigger->action_property();
+	if (property)
+		property->change_value(trigger->action_value());
+
+	if (trigger->stop_sequences_action())
+		Q_EMIT stop_sequences();
+}
+
+} // namespace data
+} // namespace sv
@@ -0,0 +1,129 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DATA_TRIGGERENGINE_HPP
+#define DATA_TRIGGERENGINE_HPP
+
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+#include <QObject>
+
+#include "src/data/trigger.hpp"
+
+using std::deque;
+using std::pair;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace data {
+
+class AnalogTimeSignal;
+
+typedef pair<shared_ptr<Trigger>, TriggerEvent> trigger_event_t;
+
+/**
+ * The TriggerEngine owns all triggers of the session and distributes their
+ * events:
+ *
+ *  - triggered() is emitted in the thread of the trigger (use a queued
+ *    connection), e.g. for the markers of the plots.
+ *  - The actions of the triggers are executed in the thread of the engine
+ *    (GUI thread).
+ *  - The events are queued for the scripts, see wait_events().
+ */
+class TriggerEngine : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** The max. number of events in the queue for wait_events(). */
+	static const size_t max_queued_events = 10000;
+
+	TriggerEngine();
+
+	/**
+	 * Create a new trigger for the signal and arm it. See TriggerCondition
+	 * for the parameters.
+	 */
+	shared_ptr<Trigger> add_trigger(shared_ptr<AnalogTimeSignal> signal,
+		TriggerCondition condition, double level, double level2 = 0.,
+		double duration = 0., double hysteresis = 0.,
+		bool single_shot = false);
+
+	/**
+	 * Disarm and remove the trigger.
+	 */
+	void remove_trigger(shared_ptr<Trigger> trigger);
+
+	vector<shared_ptr<Trigger>> triggers() const;
+
+	/**
+	 * Called by the triggers for every event, in the thread that appends the
+	 * samples.
+	 */
+	void post_event(shared_ptr<Trigger> trigger, const TriggerEvent &event);
+
+	/**
+	 * Wait max. timeout seconds for events and return all queued events.
+	 * When the queue overflows, the oldest events are dropped.
+	 */
+	vector<trigger_event_t> wait_events(double timeout);
+
+	/**
+	 * Return the number of events dropped because of a queue overflow.
+	 */
+	uint64_t dropped_event_count() const;
+
+	/**
+	 * Remove the callbacks of all triggers. Called by the SmuScriptRunner,
+	 * before the python interpreter is finalized.
+	 */
+	void clear_callbacks();
+
+private:
+	vector<shared_ptr<Trigger>> triggers_;
+	mutable std::mutex triggers_mutex_;
+
+	deque<trigger_event_t> event_queue_;
+	std::mutex event_queue_mutex_;
+	std::condition_variable event_queue_cv_;
+	uint64_t dropped_event_count_;
+
+private Q_SLOTS:
+	void execute_actions(shared_ptr<sv::data::Trigger> trigger,
+		sv::data::TriggerEvent event);
+
+Q_SIGNALS:
+	void triggered(shared_ptr<sv::data::Trigger> trigger,
+		sv::data::TriggerEvent event);
+	void stop_sequences();
+
+};
+
+} // namespace data
+} // namespace sv
+
+#endif // DATA_TRIGGERENGINE_HPP
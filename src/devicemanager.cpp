@@ -62,10 +62,14 @@ DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
 		vector<string> drivers, bool do_scan) :
 	context_(context)
 {
-	unique_ptr<QProgressDialog> progress(new QProgressDialog("",
-		QObject::tr("Cancel"), 0, context->drivers().size() + 1));
-	progress->setWindowModality(Qt::WindowModal);
-	progress->setMinimumDuration(1);  // To show the dialog immediately
+	// No progress dialog in headless mode (QCoreApplication).
+	unique_ptr<QProgressDialog> progress;
+	if (qobject_cast<QApplication *>(QCoreApplication::instance())) {
+		progress.reset(new QProgressDialog("",
+			QObject::tr("Cancel"), 0, context->drivers().size() + 1));
+		progress->setWindowModality(Qt::WindowModal);
+		progress->setMinimumDuration(1);  // To show the dialog immediately
+	}
 
 	int entry_num = 1;
 
@@ -98,17 +102,21 @@ DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
 		if (!devices::deviceutil::is_supported_driver(entry.second))
 			continue;
 
-		progress->setLabelText(QObject::tr("Scanning for %1...")
-			.arg(QString::fromStdString(entry.first)));
+		if (progress) {
+			progress->setLabelText(QObject::tr("Scanning for %1...")
+				.arg(QString::fromStdString(entry.first)));
+		}
 
 		if (user_drvs_name_opts.count(entry.first) > 0)
 			continue;
 		driver_scan(entry.second, map<const sigrok::ConfigKey *, VariantBase>());
 
-		progress->setValue(entry_num++);
-		QApplication::processEvents();
-		if (progress->wasCanceled())
-			break;
+		if (progress) {
+			progress->setValue(entry_num++);
+			QApplication::processEvents();
+			if (progress->wasCanceled())
+				break;
+		}
 	}
 
 	/*
@@ -134,7 +142,8 @@ DeviceManager::DeviceManager(shared_ptr<sigrok::Context> context,
 				user_spec_devices_.push_back(found.front());
 		}
 	}
-	progress->setValue(entry_num++);
+	if (progress)
+		progress->setValue(entry_num++);
 }
 
 const shared_ptr<sigrok::Context>& DeviceManager::context() const
@@ -0,0 +1,114 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <chrono>
+#include <cstdint>
+
+#include "acquisitionstats.hpp"
+#include "src/latencyhistogram.hpp"
+
+namespace sv {
+namespace devices {
+
+namespace {
+
+// The rates are calculated over this window.
+const uint64_t rate_window_ns = 1000000000;
+
+}
+
+AcquisitionStats::AcquisitionStats() :
+	window_start_ns_(0),
+	window_packets_(0),
+	window_samples_(0)
+{
+	reset();
+}
+
+void AcquisitionStats::record_packet(size_t samples, uint64_t feed_in_time_ns)
+{
+	uint64_t now = now_ns();
+
+	packet_count_.fetch_add(1, std::memory_order_relaxed);
+	sample_count_.fetch_add(samples, std::memory_order_relaxed);
+	feed_in_time_.record(feed_in_time_ns);
+	last_packet_ns_.store(now, std::memory_order_relaxed);
+
+	if (window_start_ns_ == 0)
+		window_start_ns_ = now;
+	++window_packets_;
+	window_samples_ += samples;
+	if (now - window_start_ns_ >= rate_window_ns) {
+		double seconds = (now - window_start_ns_) / 1e9;
+		packet_rate_.store(window_packets_ / seconds);
+		sample_rate_.store(window_samples_ / seconds);
+		window_start_ns_ = now;
+		window_packets_ = 0;
+		window_samples_ = 0;
+	}
+}
+
+void AcquisitionStats::reset()
+{
+	packet_count_.store(0);
+	sample_count_.store(0);
+	packet_rate_.store(0.);
+	sample_rate_.store(0.);
+	last_packet_ns_.store(0);
+	feed_in_time_.reset();
+}
+
+uint64_t AcquisitionStats::packet_count() const
+{
+	return packet_count_.load(std::memory_order_relaxed);
+}
+
+uint64_t AcquisitionStats::sample_count() const
+{
+	return sample_count_.load(std::memory_order_relaxed);
+}
+
+double AcquisitionStats::packet_rate() const
+{
+	// No packets received within the last two windows
+	if (now_ns() - last_packet_ns_.load() > 2 * rate_window_ns)
+		return 0.;
+	return packet_rate_.load();
+}
+
+double AcquisitionStats::sample_rate() const
+{
+	if (now_ns() - last_packet_ns_.load() > 2 * rate_window_ns)
+		return 0.;
+	return sample_rate_.load();
+}
+
+const LatencyHistogram &AcquisitionStats::feed_in_time() const
+{
+	return feed_in_time_;
+}
+
+uint64_t AcquisitionStats::now_ns()
+{
+	return std::chrono::duration_cast<std::chrono::nanoseconds>(
+		std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+} // namespace devices
+} // namespace sv
@@ -0,0 +1,94 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_ACQUISITIONSTATS_HPP
+#define DEVICES_ACQUISITIONSTATS_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "src/latencyhistogram.hpp"
+
+namespace sv {
+namespace devices {
+
+/**
+ * Counters and latencies of the data acquisition of a device. The counters
+ * are updated by the acquisition thread of the device and can be read from
+ * any thread.
+ */
+class AcquisitionStats
+{
+
+public:
+	AcquisitionStats();
+
+	/**
+	 * Count a received packet. Called by the acquisition thread.
+	 *
+	 * @param samples The number of samples in the packet (per channel).
+	 * @param feed_in_time_ns The time spent in processing the packet.
+	 */
+	void record_packet(size_t samples, uint64_t feed_in_time_ns);
+
+	/**
+	 * Reset all counters. The rates are not affected.
+	 */
+	void reset();
+
+	uint64_t packet_count() const;
+	uint64_t sample_count() const;
+
+	/**
+	 * Return the packets per second, measured over the last second.
+	 */
+	double packet_rate() const;
+
+	/**
+	 * Return the samples per second, measured over the last second.
+	 */
+	double sample_rate() const;
+
+	/**
+	 * Return the time spent in processing the analog packets.
+	 */
+	const LatencyHistogram &feed_in_time() const;
+
+private:
+	static uint64_t now_ns();
+
+	std::atomic<uint64_t> packet_count_;
+	std::atomic<uint64_t> sample_count_;
+	std::atomic<double> packet_rate_;
+	std::atomic<double> sample_rate_;
+	std::atomic<uint64_t> last_packet_ns_;
+	LatencyHistogram feed_in_time_;
+
+	// Only used by the acquisition thread
+	uint64_t window_start_ns_;
+	uint64_t window_packets_;
+	uint64_t window_samples_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_ACQUISITIONSTATS_HPP
@@ -18,7 +18,9 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <map>
 #include <memory>
 #include <mutex>
@@ -37,8 +39,10 @@
 #include "src/channels/basechannel.hpp"
 #include "src/channels/hardwarechannel.hpp"
 #include "src/channels/mathchannel.hpp"
+#include "src/channels/mathscheduler.hpp"
 #include "src/channels/userchannel.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/memorymanager.hpp"
 #include "src/devices/configurable.hpp"
 
 #define USER_CHANNEL_START_INDEX 1000
@@ -66,6 +70,10 @@ BaseDevice::BaseDevice(const shared_ptr<sigrok::Context> sr_context,
 	device_open_(false),
 	next_channel_index_(USER_CHANNEL_START_INDEX),
 	next_configurable_index_(CONFIGURABLE_START_INDEX),
+	channel_map_(make_shared<channel_map_t>()),
+	channel_group_map_(make_shared<channel_group_map_t>()),
+	sr_channel_map_(make_shared<sr_channel_map_t>()),
+	signals_(make_shared<signal_vector_t>()),
 	frame_began_(false)
 {
 	// Set up a sigrok session per smuvierw device
@@ -170,6 +178,11 @@ void BaseDevice::pause_aquisition()
 	aquisition_state_ = AquisitionState::Paused;
 }
 
+AcquisitionStats &BaseDevice::acquisition_stats()
+{
+	return acquisition_stats_;
+}
+
 string BaseDevice::name() const
 {
 	string sep("");
@@ -248,40 +261,32 @@ QString BaseDevice::short_name() const
 	return name;
 }
 
-map<string, shared_ptr<devices::Configurable>>
+const map<string, shared_ptr<devices::Configurable>> &
 	BaseDevice::configurable_map() const
 {
 	return configurable_map_;
 }
 
-map<string, shared_ptr<channels::BaseChannel>> BaseDevice::channel_map() const
+shared_ptr<const BaseDevice::channel_map_t> BaseDevice::channel_map() const
 {
-	return channel_map_;
+	return std::atomic_load(&channel_map_);
 }
 
-map<string, vector<shared_ptr<channels::BaseChannel>>>
+shared_ptr<const BaseDevice::channel_group_map_t>
 	BaseDevice::channel_group_map() const
 {
-	return channel_group_map_;
+	return std::atomic_load(&channel_group_map_);
 }
 
-map<shared_ptr<sigrok::Channel>, shared_ptr<channels::BaseChannel>>
+shared_ptr<const BaseDevice::sr_channel_map_t>
 	BaseDevice::sr_channel_map() const
 {
-	return sr_channel_map_;
+	return std::atomic_load(&sr_channel_map_);
 }
 
-vector<shared_ptr<data::BaseSignal>> BaseDevice::signals() const
+shared_ptr<const BaseDevice::signal_vector_t> BaseDevice::signals() const
 {
-	vector<shared_ptr<sv::data::BaseSignal>> signals;
-	for (const auto &ch_pair : channel_map_) {
-		for (const auto &signal_pair : ch_pair.second->signal_map()) {
-			for (const auto &signal : signal_pair.second) {
-				signals.push_back(signal);
-			}
-		}
-	}
-	return signals;
+	return std::atomic_load(&signals_);
 }
 
 unsigned int BaseDevice::next_channel_index()
@@ -293,21 +298,37 @@ unsigned int BaseDevice::next_channel_index()
 void BaseDevice::add_channel(shared_ptr<channels::BaseChannel> channel,
 	string channel_group_name)
 {
-	// Check if channel already exists. Channel names are unique per device.
-	if (channel_map_.count(channel->name()) == 0) {
-		connect(this, SIGNAL(aquisition_start_timestamp_changed(double)),
-			channel.get(), SLOT(on_aquisition_start_timestamp_changed(double)));
+	bool is_new_channel;
+	{
+		// Copy on write, the published snapshots are never changed.
+		lock_guard<mutex> lock(channels_mutex_);
+
+		// Check if channel already exists. Channel names are unique per device.
+		is_new_channel = channel_map_->count(channel->name()) == 0;
+		if (is_new_channel) {
+			auto channel_map = make_shared<channel_map_t>(*channel_map_);
+			channel_map->insert(make_pair(channel->name(), channel));
+			std::atomic_store(&channel_map_,
+				shared_ptr<const channel_map_t>(channel_map));
+		}
 
-		// map<QString, shared_ptr<channels::BaseChannel>> channel_name_map_;
-		channel_map_.insert(make_pair(channel->name(), channel));
+		auto channel_group_map =
+			make_shared<channel_group_map_t>(*channel_group_map_);
+		(*channel_group_map)[channel_group_name].push_back(channel);
+		std::atomic_store(&channel_group_map_,
+			shared_ptr<const channel_group_map_t>(channel_group_map));
 	}
 
-	// map<QString, vector<shared_ptr<channels::BaseChannel>>> channel_group_name_map_;
-	if (channel_group_map_.count(channel_group_name) == 0) {
-		channel_group_map_.insert(make_pair(
-			channel_group_name, vector<shared_ptr<channels::BaseChannel>>()));
+	if (is_new_channel) {
+		connect(this, SIGNAL(aquisition_start_timestamp_changed(double)),
+			channel.get(), SLOT(on_aquisition_start_timestamp_changed(double)));
+
+		// The signals are added in the thread of the channel. Connect before
+		// taking the existing signals, so no signal is missed.
+		connect(channel.get(), &channels::BaseChannel::signal_added,
+			this, &BaseDevice::on_channel_signal_added, Qt::DirectConnection);
+		add_signals(*channel->signals());
 	}
-	channel_group_map_[channel_group_name].push_back(channel);
 
 	if (channel->channel_group_names().count(channel_group_name) == 0) {
 		channel->add_channel_group_name(channel_group_name);
@@ -322,16 +343,20 @@ shared_ptr<channels::BaseChannel> BaseDevice::add_sr_channel(
 	// Check if channel already exists.
 	// NOTE: Channel names are unique per device.
 	shared_ptr<channels::BaseChannel> channel;
-	if (channel_map_.count(sr_channel->name()) > 0) {
-		channel = channel_map()[sr_channel->name()];
+	const auto channel_map = this->channel_map();
+	if (channel_map->count(sr_channel->name()) > 0) {
+		channel = channel_map->at(sr_channel->name());
 	}
 	else {
 		set<string> chg_names { channel_group_name };
 		channel = make_shared<channels::HardwareChannel>(sr_channel,
 			shared_from_this(), chg_names, aquisition_start_timestamp_);
 
-		// map<shared_ptr<sigrok::Channel>, shared_ptr<channels::BaseChannel>> sr_channel_map_;
-		sr_channel_map_.insert(make_pair(sr_channel, channel));
+		lock_guard<mutex> lock(channels_mutex_);
+		auto sr_channel_map = make_shared<sr_channel_map_t>(*sr_channel_map_);
+		sr_channel_map->insert(make_pair(sr_channel, channel));
+		std::atomic_store(&sr_channel_map_,
+			shared_ptr<const sr_channel_map_t>(sr_channel_map));
 	}
 
 	add_channel(channel, channel_group_name);
@@ -352,6 +377,10 @@ void BaseDevice::add_math_channel(
 		math_channel->quantity(),
 		math_channel->quantity_flags(),
 		math_channel->unit());
+
+	// The math channel is calculated by the worker threads of the scheduler.
+	if (math_channel->init_signal())
+		channels::MathScheduler::instance().add_channel(math_channel);
 }
 
 shared_ptr<channels::UserChannel> BaseDevice::add_user_channel(
@@ -420,7 +449,8 @@ void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 			feed_in_logic(
 				dynamic_pointer_cast<sigrok::Logic>(sr_packet->payload()));
 		} catch (bad_alloc &) {
-			//out_of_memory_ = true;
+			data::MemoryManager::instance().report_out_of_memory(
+				short_name());
 		}
 		break;
 
@@ -430,10 +460,17 @@ void BaseDevice::data_feed_in(shared_ptr<sigrok::Device> sr_device,
 			return;
 
 		try {
-			feed_in_analog(
-				dynamic_pointer_cast<sigrok::Analog>(sr_packet->payload()));
+			auto sr_analog =
+				dynamic_pointer_cast<sigrok::Analog>(sr_packet->payload());
+			auto start = std::chrono::steady_clock::now();
+			feed_in_analog(sr_analog);
+			auto feed_in_time = std::chrono::steady_clock::now() - start;
+			acquisition_stats_.record_packet(sr_analog->num_samples(),
+				std::chrono::duration_cast<std::chrono::nanoseconds>(
+					feed_in_time).count());
 		} catch (bad_alloc &) {
-			//out_of_memory_ = true;
+			data::MemoryManager::instance().report_out_of_memory(
+				short_name());
 		}
 		break;
 
@@ -497,5 +534,28 @@ void BaseDevice::aquisition_thread_proc()
 	aquisition_state_ = AquisitionState::Stopped;
 }
 
+void BaseDevice::add_signals(const signal_vector_t &signals)
+{
+	lock_guard<mutex> lock(channels_mutex_);
+	shared_ptr<signal_vector_t> new_signals;
+	for (const auto &signal : signals) {
+		if (std::find(signals_->begin(), signals_->end(), signal) !=
+				signals_->end())
+			continue;
+		if (!new_signals)
+			new_signals = make_shared<signal_vector_t>(*signals_);
+		new_signals->push_back(signal);
+	}
+	if (new_signals) {
+		std::atomic_store(&signals_,
+			shared_ptr<const signal_vector_t>(new_signals));
+	}
+}
+
+void BaseDevice::on_channel_signal_added(shared_ptr<data::BaseSignal> signal)
+{
+	add_signals(signal_vector_t { signal });
+}
+
 } // namespace devices
 } // namespace sv
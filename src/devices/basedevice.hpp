@@ -26,10 +26,12 @@
 #include <mutex>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include <QObject>
 #include <QString>
 
+#include "src/devices/acquisitionstats.hpp"
 #include "src/devices/deviceutil.hpp"
 
 using std::map;
@@ -81,6 +83,13 @@ class BaseDevice :
 	Q_OBJECT
 
 public:
+	typedef map<string, shared_ptr<channels::BaseChannel>> channel_map_t;
+	typedef map<string, vector<shared_ptr<channels::BaseChannel>>>
+		channel_group_map_t;
+	typedef map<shared_ptr<sigrok::Channel>, shared_ptr<channels::BaseChannel>>
+		sr_channel_map_t;
+	typedef vector<shared_ptr<data::BaseSignal>> signal_vector_t;
+
 	BaseDevice(const shared_ptr<sigrok::Context> sr_context,
 		shared_ptr<sigrok::Device> sr_device);
 	virtual ~BaseDevice();
@@ -148,6 +157,11 @@ public:
 	 */
 	AquisitionState aquisition_state();
 
+	/**
+	 * Get the counters and latencies of the data aquisition.
+	 */
+	AcquisitionStats &acquisition_stats();
+
 	/**
 	 * Get the next index for a new channel.
 	 */
@@ -178,29 +192,39 @@ public:
 		string channel_name, string channel_group_name);
 
 	/**
-	 * Returns a map with all configurables of this device
+	 * Returns a map with all configurables of this device. The map is not
+	 * copied, so don't hold the reference while the device could be changed.
 	 */
-	map<string, shared_ptr<devices::Configurable>> configurable_map() const;
+	const map<string, shared_ptr<devices::Configurable>> &
+		configurable_map() const;
 
 	/**
-	 * Returns a map with all channels of this device
+	 * Returns a map with all channels of this device.
+	 *
+	 * The channels may be added in the aquisition thread. Adding a channel
+	 * publishes a new map, so the returned snapshot is never changed and can
+	 * be iterated without copying or locking. Hold the returned pointer while
+	 * iterating.
 	 */
-	map<string, shared_ptr<channels::BaseChannel>> channel_map() const;
+	shared_ptr<const channel_map_t> channel_map() const;
 
 	/**
-	 * Returns a map with all channel groups of this device
+	 * Returns a map with all channel groups of this device (a snapshot, see
+	 * channel_map()).
 	 */
-	map<string, vector<shared_ptr<channels::BaseChannel>>> channel_group_map() const;
+	shared_ptr<const channel_group_map_t> channel_group_map() const;
 
 	/**
 	 * Get the map between sigrok::Channel and sv::Channels::BaseChannel
+	 * (a snapshot, see channel_map()).
 	 */
-	map<shared_ptr<sigrok::Channel>, shared_ptr<channels::BaseChannel>> sr_channel_map() const;
+	shared_ptr<const sr_channel_map_t> sr_channel_map() const;
 
 	/**
-	 * Returns all signals of this device
+	 * Returns all signals of all channels of this device in the order they
+	 * were added (a snapshot, see channel_map()).
 	 */
-	vector<shared_ptr<data::BaseSignal>> signals() const;
+	shared_ptr<const signal_vector_t> signals() const;
 
 
 protected:
@@ -242,22 +266,38 @@ protected:
 	unsigned int next_configurable_index_;
 
 	map<string, shared_ptr<devices::Configurable>> configurable_map_;
-	map<string, shared_ptr<channels::BaseChannel>> channel_map_;
-	map<string, vector<shared_ptr<channels::BaseChannel>>> channel_group_map_;
-	map<shared_ptr<sigrok::Channel>, shared_ptr<channels::BaseChannel>> sr_channel_map_;
+	/*
+	 * The channel maps and the signals are only replaced with
+	 * std::atomic_store(), never changed in place.
+	 */
+	shared_ptr<const channel_map_t> channel_map_;
+	shared_ptr<const channel_group_map_t> channel_group_map_;
+	shared_ptr<const sr_channel_map_t> sr_channel_map_;
+	shared_ptr<const signal_vector_t> signals_;
+	/**
+	 * Serializes the threads, that add channels and signals. Readers don't
+	 * lock.
+	 */
+	mutable mutex channels_mutex_;
 
 	mutable mutex aquisition_mutex_; //!< Protects access to capture_state_. // TODO
 	mutable recursive_mutex data_mutex_; // TODO
 	AquisitionState aquisition_state_;
 	double aquisition_start_timestamp_;
+	AcquisitionStats acquisition_stats_;
 
 	bool frame_began_;
 
 private:
 	void aquisition_thread_proc();
+	/** Add the signals, that are not yet in signals_. */
+	void add_signals(const signal_vector_t &signals);
 
 	std::thread aquisition_thread_;
 
+private Q_SLOTS:
+	void on_channel_signal_added(shared_ptr<sv::data::BaseSignal> signal);
+
 Q_SIGNALS:
 	void aquisition_start_timestamp_changed(double);
 	void channel_added(shared_ptr<sv::channels::BaseChannel>);
@@ -0,0 +1,227 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QDateTime>
+
+#include "generatordevice.hpp"
+#include "config.h"
+#include "src/channels/userchannel.hpp"
+#include "src/data/datautil.hpp"
+#include "src/devices/basedevice.hpp"
+
+using std::set;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+namespace devices {
+
+GeneratorDevice::GeneratorDevice(
+		const shared_ptr<sigrok::Context> &sr_context,
+		unsigned int channel_count, uint64_t samplerate, uint64_t packet_rate,
+		GeneratorWaveform waveform, double frequency, double amplitude) :
+	UserDevice(sr_context, "SmuView", "Generator", SV_VERSION_STRING),
+	channel_count_(std::max(channel_count, 1U)),
+	samplerate_(std::max(samplerate, (uint64_t)1)),
+	packet_rate_(std::min(std::max(packet_rate, (uint64_t)1), samplerate_)),
+	waveform_(waveform),
+	frequency_(frequency),
+	// A negative amplitude would be undefined for the noise distribution.
+	amplitude_(std::fabs(amplitude)),
+	generator_stop_(false),
+	late_packet_count_(0),
+	random_generator_(42)
+{
+}
+
+GeneratorDevice::~GeneratorDevice()
+{
+	stop_generator();
+}
+
+void GeneratorDevice::open()
+{
+	UserDevice::open();
+
+	if (generator_channels_.empty())
+		init_channels();
+
+	start_aquisition();
+	start_generator();
+}
+
+void GeneratorDevice::close()
+{
+	stop_generator();
+	UserDevice::close();
+}
+
+unsigned int GeneratorDevice::channel_count() const
+{
+	return channel_count_;
+}
+
+uint64_t GeneratorDevice::samplerate() const
+{
+	return samplerate_;
+}
+
+uint64_t GeneratorDevice::packet_rate() const
+{
+	return packet_rate_;
+}
+
+GeneratorWaveform GeneratorDevice::waveform() const
+{
+	return waveform_;
+}
+
+double GeneratorDevice::frequency() const
+{
+	return frequency_;
+}
+
+double GeneratorDevice::amplitude() const
+{
+	return amplitude_;
+}
+
+uint64_t GeneratorDevice::late_packet_count() const
+{
+	return late_packet_count_;
+}
+
+void GeneratorDevice::init_channels()
+{
+	for (unsigned int i = 0; i < channel_count_; ++i) {
+		auto channel = add_user_channel("CH" + std::to_string(i + 1), "");
+		channel->add_signal(data::Quantity::Voltage,
+			set<data::QuantityFlag>(), data::Unit::Volt);
+		generator_channels_.push_back(channel);
+	}
+}
+
+void GeneratorDevice::start_generator()
+{
+	if (generator_thread_.joinable())
+		return;
+
+	generator_stop_ = false;
+	generator_thread_ = std::thread(
+		&GeneratorDevice::generator_thread_proc, this);
+}
+
+void GeneratorDevice::stop_generator()
+{
+	generator_stop_ = true;
+	if (generator_thread_.joinable())
+		generator_thread_.join();
+}
+
+void GeneratorDevice::generator_thread_proc()
+{
+	const size_t samples_per_packet = samplerate_ / packet_rate_;
+	// The period is calculated from the rounded packet size, so the
+	// samplerate is exact.
+	const auto packet_period = std::chrono::duration_cast<
+		std::chrono::steady_clock::duration>(std::chrono::duration<double>(
+			samples_per_packet / (double)samplerate_));
+
+	vector<float> data(samples_per_packet);
+	const auto start = std::chrono::steady_clock::now();
+	const double start_timestamp =
+		QDateTime::currentMSecsSinceEpoch() / (double)1000;
+
+	for (uint64_t packet = 0; !generator_stop_; ++packet) {
+		// Absolute deadlines, a late packet doesn't shift the following ones.
+		const auto deadline = start + packet * packet_period;
+		const auto now = std::chrono::steady_clock::now();
+		if (now < deadline)
+			std::this_thread::sleep_until(deadline);
+		else if (now - deadline > packet_period)
+			++late_packet_count_;
+
+		if (generator_stop_)
+			break;
+		if (aquisition_state_ != AquisitionState::Running)
+			continue;
+
+		const uint64_t first_sample = packet * samples_per_packet;
+		const double timestamp =
+			start_timestamp + first_sample / (double)samplerate_;
+
+		const auto feed_start = std::chrono::steady_clock::now();
+		for (unsigned int i = 0; i < channel_count_; ++i) {
+			generate_samples(data.data(), samples_per_packet, first_sample, i);
+			generator_channels_[i]->push_samples(data.data(),
+				samples_per_packet, timestamp, samplerate_,
+				data::Quantity::Voltage, set<data::QuantityFlag>(),
+				data::Unit::Volt, 7, 3);
+		}
+		const auto feed_time = std::chrono::steady_clock::now() - feed_start;
+		acquisition_stats_.record_packet(samples_per_packet,
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				feed_time).count());
+	}
+}
+
+void GeneratorDevice::generate_samples(float *data, size_t sample_count,
+	uint64_t first_sample, unsigned int channel)
+{
+	const double two_pi = 2 * M_PI;
+	const double phase_offset = channel / (double)channel_count_;
+	std::uniform_real_distribution<float> noise(-amplitude_, amplitude_);
+
+	for (size_t i = 0; i < sample_count; ++i) {
+		double t = (first_sample + i) / (double)samplerate_;
+		double phase = frequency_ * t + phase_offset;
+		phase -= std::floor(phase);
+
+		switch (waveform_) {
+		case GeneratorWaveform::Sine:
+			data[i] = amplitude_ * std::sin(two_pi * phase);
+			break;
+		case GeneratorWaveform::Square:
+			data[i] = phase < 0.5 ? amplitude_ : -amplitude_;
+			break;
+		case GeneratorWaveform::Triangle:
+			data[i] = amplitude_ * (4 * std::fabs(phase - 0.5) - 1);
+			break;
+		case GeneratorWaveform::Sawtooth:
+			data[i] = amplitude_ * (2 * phase - 1);
+			break;
+		case GeneratorWaveform::Noise:
+			data[i] = noise(random_generator_);
+			break;
+		}
+	}
+}
+
+} // namespace devices
+} // namespace sv
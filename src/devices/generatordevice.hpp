@@ -0,0 +1,154 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DEVICES_GENERATORDEVICE_HPP
+#define DEVICES_GENERATORDEVICE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+
+#include "src/devices/userdevice.hpp"
+
+using std::map;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sigrok {
+class Context;
+}
+
+namespace sv {
+
+namespace channels {
+class UserChannel;
+}
+
+namespace devices {
+
+enum class GeneratorWaveform {
+	Sine,
+	Square,
+	Triangle,
+	Sawtooth,
+	Noise
+};
+
+// TODO: Use tr(), QCoreApplication::translate(), QT_TR_NOOP() or
+//       QT_TRANSLATE_NOOP() for translation.
+//       See: http://doc.qt.io/qt-5/i18n-source-translation.html
+typedef map<GeneratorWaveform, QString> generator_waveform_name_map_t;
+static generator_waveform_name_map_t generator_waveform_name_map = {
+	{ GeneratorWaveform::Sine, QString("Sine") },
+	{ GeneratorWaveform::Square, QString("Square") },
+	{ GeneratorWaveform::Triangle, QString("Triangle") },
+	{ GeneratorWaveform::Sawtooth, QString("Sawtooth") },
+	{ GeneratorWaveform::Noise, QString("Noise") },
+};
+
+/**
+ * The GeneratorDevice is a user device, that generates synthetic voltage
+ * signals on its own thread. It is used to load test the data pipeline
+ * (ingest, math channels, plots, export) without hardware.
+ *
+ * Every packet_rate-th of a second a packet with samplerate / packet_rate
+ * samples per channel is pushed to the signals. The packets are paced
+ * against absolute deadlines, so the samplerate doesn't drift when a packet
+ * is late. The channels have a phase offset of 1 / channel_count periods.
+ */
+class GeneratorDevice : public UserDevice
+{
+	Q_OBJECT
+
+public:
+	GeneratorDevice(const shared_ptr<sigrok::Context> &sr_context,
+		unsigned int channel_count, uint64_t samplerate, uint64_t packet_rate,
+		GeneratorWaveform waveform, double frequency, double amplitude);
+
+	~GeneratorDevice();
+
+	/**
+	 * Create the channels (if not done yet) and start the generator thread.
+	 */
+	void open() override;
+
+	/**
+	 * Stop the generator thread.
+	 */
+	void close() override;
+
+	unsigned int channel_count() const;
+	uint64_t samplerate() const;
+	uint64_t packet_rate() const;
+	GeneratorWaveform waveform() const;
+	double frequency() const;
+	double amplitude() const;
+
+	/**
+	 * Return the number of packets, that were generated more than one packet
+	 * period after their deadline.
+	 */
+	uint64_t late_packet_count() const;
+
+protected:
+	/**
+	 * Init all channels of this generator device.
+	 */
+	void init_channels() override;
+
+private:
+	void start_generator();
+	void stop_generator();
+	void generator_thread_proc();
+
+	/**
+	 * Calculate the samples of one channel, starting at sample number
+	 * first_sample.
+	 */
+	void generate_samples(float *data, size_t sample_count,
+		uint64_t first_sample, unsigned int channel);
+
+	const unsigned int channel_count_;
+	const uint64_t samplerate_;
+	const uint64_t packet_rate_;
+	const GeneratorWaveform waveform_;
+	const double frequency_;
+	const double amplitude_;
+
+	vector<shared_ptr<channels::UserChannel>> generator_channels_;
+	std::thread generator_thread_;
+	std::atomic<bool> generator_stop_;
+	std::atomic<uint64_t> late_packet_count_;
+	std::mt19937 random_generator_;
+
+};
+
+} // namespace devices
+} // namespace sv
+
+#endif // DEVICES_GENERATORDEVICE_HPP
@@ -237,7 +237,7 @@ void HardwareDevice::init_channels()
 	// Init Channels that are not in a channel group
 	vector<shared_ptr<sigrok::Channel>> sr_channels = sr_device_->channels();
 	for (const auto &sr_channel : sr_channels) {
-		if (sr_channel_map_.count(sr_channel) > 0)
+		if (sr_channel_map()->count(sr_channel) > 0)
 			continue;
 		add_sr_channel(sr_channel, "");
 	}
@@ -310,10 +310,11 @@ void HardwareDevice::feed_in_analog(shared_ptr<sigrok::Analog> sr_analog)
 			" channel_data = " << *channel_data;
 		*/
 
-		if (!sr_channel_map_.count(sr_channel))
+		const auto sr_channel_map = this->sr_channel_map();
+		if (!sr_channel_map->count(sr_channel))
 			assert("Unknown channel");
 		auto channel = static_pointer_cast<channels::HardwareChannel>(
-			sr_channel_map_[sr_channel]);
+			sr_channel_map->at(sr_channel));
 
 		// TODO: use std::chrono / std::time
 		double timestamp;
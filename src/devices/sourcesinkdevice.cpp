@@ -89,7 +89,8 @@ void SourceSinkDevice::init_channels()
 	HardwareDevice::init_channels();
 
 	// Preinitialize known fixed channels with a signal
-	for (const auto &chg_name_channels_pair : channel_group_map_) {
+	const auto channel_group_map = this->channel_group_map();
+	for (const auto &chg_name_channels_pair : *channel_group_map) {
 		string ch_suffix = "";
 		for (const auto &channel : chg_name_channels_pair.second) {
 			if (channel->type() != channels::ChannelType::AnalogChannel)
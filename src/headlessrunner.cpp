@@ -0,0 +1,171 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFileInfo>
+#include <QString>
+
+#include "headlessrunner.hpp"
+#include "src/devicemanager.hpp"
+#include "src/session.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/csvexport.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/devices/hardwaredevice.hpp"
+#include "src/python/smuscriptrunner.hpp"
+
+using std::make_shared;
+using std::shared_ptr;
+using std::string;
+using std::vector;
+
+namespace sv {
+
+HeadlessRunner::HeadlessRunner(DeviceManager &device_manager,
+		QObject *parent) :
+	QObject(parent),
+	device_manager_(device_manager),
+	duration_(0.),
+	output_separator_(","),
+	script_running_(false),
+	quitting_(false)
+{
+	session_ = make_shared<Session>(device_manager_, nullptr);
+
+	duration_timer_.setSingleShot(true);
+	connect(&duration_timer_, SIGNAL(timeout()), this, SLOT(quit()));
+
+	auto runner = session_->smu_script_runner();
+	connect(runner.get(), &python::SmuScriptRunner::script_finished,
+		this, &HeadlessRunner::on_script_finished);
+	// The output is written directly from the script thread, so nothing gets
+	// lost when the event loop has already quit.
+	connect(runner.get(), &python::SmuScriptRunner::send_py_stdout,
+		this, &HeadlessRunner::on_py_stdout, Qt::DirectConnection);
+	connect(runner.get(), &python::SmuScriptRunner::send_py_stderr,
+		this, &HeadlessRunner::on_py_stderr, Qt::DirectConnection);
+}
+
+HeadlessRunner::~HeadlessRunner()
+{
+}
+
+shared_ptr<Session> HeadlessRunner::session() const
+{
+	return session_;
+}
+
+void HeadlessRunner::set_duration(double duration)
+{
+	duration_ = duration;
+}
+
+void HeadlessRunner::set_output_file(const string &file_name,
+	const string &separator)
+{
+	output_file_ = file_name;
+	output_separator_ = separator;
+}
+
+void HeadlessRunner::start(const string &script_file)
+{
+	for (const auto &device : device_manager_.user_spec_devices())
+		session_->add_device(device);
+
+	if (!script_file.empty()) {
+		QFileInfo file_info(QString::fromStdString(script_file));
+		if (!file_info.exists() || !file_info.isFile()) {
+			qCritical() << "HeadlessRunner: Script file not found:" <<
+				QString::fromStdString(script_file);
+			// Quit as soon as the event loop is running.
+			QTimer::singleShot(0, this, SLOT(quit()));
+			return;
+		}
+		script_running_ = true;
+		session_->smu_script_runner()->run(script_file);
+	}
+
+	if (duration_ > 0)
+		duration_timer_.start((int)(duration_ * 1000));
+	else if (script_file.empty())
+		qWarning() << "HeadlessRunner: Acquiring until SIGINT or SIGTERM.";
+}
+
+void HeadlessRunner::quit()
+{
+	if (quitting_)
+		return;
+	quitting_ = true;
+
+	duration_timer_.stop();
+	if (script_running_)
+		session_->smu_script_runner()->stop();
+
+	save_output();
+	QCoreApplication::quit();
+}
+
+void HeadlessRunner::save_output() const
+{
+	if (output_file_.empty())
+		return;
+
+	// The signals are exported in the order they were created.
+	vector<shared_ptr<data::BaseSignal>> signals;
+	const auto signal_map = session_->signal_registry()->signal_map();
+	signals.reserve(signal_map->size());
+	for (const auto &signal_pair : *signal_map)
+		signals.push_back(signal_pair.second);
+
+	qWarning() << "HeadlessRunner: Saving" << signals.size() <<
+		"signals to" << QString::fromStdString(output_file_);
+	data::csvexport::save(output_file_, signals, true, output_separator_);
+}
+
+void HeadlessRunner::on_script_finished()
+{
+	script_running_ = false;
+
+	// With a duration, the script only sets up the acquisition.
+	if (duration_ <= 0)
+		quit();
+}
+
+void HeadlessRunner::on_py_stdout(const std::string &text)
+{
+	// The text already has its line breaks (see SmuScriptRunner).
+	fwrite(text.data(), 1, text.size(), stdout);
+	fflush(stdout);
+}
+
+void HeadlessRunner::on_py_stderr(const std::string &text)
+{
+	// The text already has its line breaks (see SmuScriptRunner).
+	fwrite(text.data(), 1, text.size(), stderr);
+	fflush(stderr);
+}
+
+} // namespace sv
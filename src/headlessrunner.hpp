@@ -0,0 +1,101 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEADLESSRUNNER_HPP
+#define HEADLESSRUNNER_HPP
+
+#include <memory>
+#include <string>
+
+#include <QObject>
+#include <QTimer>
+
+using std::shared_ptr;
+using std::string;
+
+namespace sv {
+
+class DeviceManager;
+class Session;
+
+/**
+ * The HeadlessRunner replaces the MainWindow in the headless mode. It owns the
+ * session, opens the devices given on the command line, runs the SmuScript and
+ * saves all signals to a CSV file when the acquisition has finished.
+ *
+ * The acquisition finishes when the duration has elapsed, or, without a
+ * duration, when the SmuScript has finished. Without duration and script, the
+ * acquisition runs until quit() is called (e.g. by SIGINT or SIGTERM).
+ */
+class HeadlessRunner : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit HeadlessRunner(DeviceManager &device_manager,
+		QObject *parent = nullptr);
+	~HeadlessRunner();
+
+	shared_ptr<Session> session() const;
+
+	/**
+	 * Set the acquisition duration in seconds. 0 means no limit.
+	 */
+	void set_duration(double duration);
+
+	/**
+	 * Set the CSV file, where all signals are saved when the acquisition has
+	 * finished. An empty file name disables the export.
+	 */
+	void set_output_file(const string &file_name, const string &separator);
+
+	/**
+	 * Open all devices that were specified on the command line, run the
+	 * SmuScript (if not empty) and start the duration timer.
+	 */
+	void start(const string &script_file);
+
+public Q_SLOTS:
+	/**
+	 * Stop the script, save the signals and quit the application.
+	 */
+	void quit();
+
+private:
+	void save_output() const;
+
+	DeviceManager &device_manager_;
+	shared_ptr<Session> session_;
+	QTimer duration_timer_;
+	double duration_;
+	string output_file_;
+	string output_separator_;
+	bool script_running_;
+	bool quitting_;
+
+private Q_SLOTS:
+	void on_script_finished();
+	void on_py_stdout(const std::string &text);
+	void on_py_stderr(const std::string &text);
+
+};
+
+} // namespace sv
+
+#endif // HEADLESSRUNNER_HPP
@@ -0,0 +1,110 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+
+#include "latencyhistogram.hpp"
+
+namespace sv {
+
+LatencyHistogram::LatencyHistogram()
+{
+	reset();
+}
+
+void LatencyHistogram::record(uint64_t latency_ns)
+{
+	// Bucket i holds the latencies in [2^(i-1), 2^i)
+	size_t bucket = 0;
+	for (uint64_t value = latency_ns; value > 0; value >>= 1)
+		++bucket;
+	if (bucket >= bucket_count)
+		bucket = bucket_count - 1;
+
+	buckets_[bucket].fetch_add(1, std::memory_order_relaxed);
+	sum_.fetch_add(latency_ns, std::memory_order_relaxed);
+	count_.fetch_add(1, std::memory_order_relaxed);
+
+	uint64_t max = max_.load(std::memory_order_relaxed);
+	while (latency_ns > max &&
+		!max_.compare_exchange_weak(max, latency_ns,
+			std::memory_order_relaxed)) {
+	}
+}
+
+void LatencyHistogram::reset()
+{
+	for (auto &bucket : buckets_)
+		bucket.store(0, std::memory_order_relaxed);
+	count_.store(0, std::memory_order_relaxed);
+	sum_.store(0, std::memory_order_relaxed);
+	max_.store(0, std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::count() const
+{
+	return count_.load(std::memory_order_relaxed);
+}
+
+double LatencyHistogram::mean() const
+{
+	uint64_t count = count_.load(std::memory_order_relaxed);
+	if (count == 0)
+		return 0.;
+	return sum_.load(std::memory_order_relaxed) / (double)count;
+}
+
+uint64_t LatencyHistogram::max() const
+{
+	return max_.load(std::memory_order_relaxed);
+}
+
+uint64_t LatencyHistogram::percentile(double percent) const
+{
+	uint64_t counts[bucket_count];
+	uint64_t total = 0;
+	for (size_t i = 0; i < bucket_count; ++i) {
+		counts[i] = buckets_[i].load(std::memory_order_relaxed);
+		total += counts[i];
+	}
+	if (total == 0)
+		return 0;
+
+	uint64_t rank = (uint64_t)(total * percent / 100.);
+	if (rank >= total)
+		rank = total - 1;
+
+	uint64_t seen = 0;
+	for (size_t i = 0; i < bucket_count; ++i) {
+		seen += counts[i];
+		if (seen <= rank)
+			continue;
+		if (i == 0)
+			return 0;
+		// The upper bound of the bucket, but never more than the max.
+		uint64_t upper_bound = max();
+		if (i < 64 && ((uint64_t)1 << i) - 1 < upper_bound)
+			upper_bound = ((uint64_t)1 << i) - 1;
+		return upper_bound;
+	}
+
+	return max();
+}
+
+} // namespace sv
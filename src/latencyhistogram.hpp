@@ -0,0 +1,84 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LATENCYHISTOGRAM_HPP
+#define LATENCYHISTOGRAM_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace sv {
+
+/**
+ * A lock free histogram for latencies in nanoseconds. The latencies are
+ * counted in buckets with power of two bounds, so record() is cheap enough
+ * for the acquisition hot path. record() can be called from multiple
+ * threads, the statistics can be read from any thread.
+ */
+class LatencyHistogram
+{
+
+public:
+	LatencyHistogram();
+
+	/**
+	 * Add a latency in nanoseconds to the histogram.
+	 */
+	void record(uint64_t latency_ns);
+
+	/**
+	 * Reset all counters.
+	 */
+	void reset();
+
+	/**
+	 * Return the number of recorded latencies.
+	 */
+	uint64_t count() const;
+
+	/**
+	 * Return the mean latency in nanoseconds.
+	 */
+	double mean() const;
+
+	/**
+	 * Return the maximum latency in nanoseconds.
+	 */
+	uint64_t max() const;
+
+	/**
+	 * Return the (upper bound of the) latency in nanoseconds, below which
+	 * the given percentage (0 - 100) of the recorded latencies are.
+	 */
+	uint64_t percentile(double percent) const;
+
+	static const size_t bucket_count = 64;
+
+private:
+	std::atomic<uint64_t> buckets_[bucket_count];
+	std::atomic<uint64_t> count_;
+	std::atomic<uint64_t> sum_;
+	std::atomic<uint64_t> max_;
+
+};
+
+} // namespace sv
+
+#endif // LATENCYHISTOGRAM_HPP
@@ -39,6 +39,7 @@
 #include "src/util.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/analogtimesignal.hpp"
+#include "src/data/memorymanager.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
 #include "src/devices/deviceutil.hpp"
@@ -55,6 +56,7 @@
 #include "src/ui/tabs/tabhelper.hpp"
 #include "src/ui/tabs/welcometab.hpp"
 #include "src/ui/views/devicesview.hpp"
+#include "src/ui/views/diagnosticsview.hpp"
 #include "src/ui/views/smuscripttreeview.hpp"
 
 using std::make_pair;
@@ -63,11 +65,6 @@ using std::map;
 using std::shared_ptr;
 using std::string;
 
-Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
-Q_DECLARE_METATYPE(std::shared_ptr<sv::devices::BaseDevice>)
-Q_DECLARE_METATYPE(std::shared_ptr<sv::channels::BaseChannel>)
-Q_DECLARE_METATYPE(std::shared_ptr<sv::data::BaseSignal>)
-
 namespace sv
 {
 
@@ -75,17 +72,8 @@ MainWindow::MainWindow(DeviceManager &device_manager, QWidget *parent) :
 	QMainWindow(parent),
 	device_manager_(device_manager)
 {
-	qRegisterMetaType<util::Timestamp>("util::Timestamp");
-	qRegisterMetaType<uint64_t>("uint64_t");
-	qRegisterMetaType<std::string>("std::string");
+	// The data types of the session are registered by the Session.
 	qRegisterMetaType<Qt::DockWidgetArea>("Qt::DockWidgetArea");
-	qRegisterMetaType<shared_ptr<devices::BaseDevice>>("shared_ptr<sv::devices::BaseDevice>");
-	qRegisterMetaType<shared_ptr<devices::Configurable>>("shared_ptr<sv::devices::Configurable>");
-	qRegisterMetaType<shared_ptr<devices::HardwareDevice>>("shared_ptr<sv::devices::HardwareDevice>");
-	qRegisterMetaType<shared_ptr<channels::BaseChannel>>("shared_ptr<sv::channels::BaseChannel>");
-	qRegisterMetaType<shared_ptr<data::BaseSignal>>("shared_ptr<sv::data::BaseSignal>");
-	qRegisterMetaType<shared_ptr<data::AnalogTimeSignal>>("shared_ptr<sv::data::AnalogTimeSignal>");
-	qRegisterMetaType<devices::ConfigKey>("devices::ConfigKey");
 
 	// Add embedded mono space font for the value display.
 	QFontDatabase::addApplicationFont(":/fonts/DejaVuSansMono.ttf");
@@ -138,6 +126,10 @@ void MainWindow::save_session()
 	settings.remove("");  // Remove all keys in this group
 	session_->save_settings(settings);
 	settings.endGroup();
+
+	settings.beginGroup("MemoryManager");
+	data::MemoryManager::instance().save_settings(settings);
+	settings.endGroup();
 }
 
 void MainWindow::restore_session()
@@ -147,6 +139,10 @@ void MainWindow::restore_session()
 	settings.beginGroup("Session");
 	session_->restore_settings(settings);
 	settings.endGroup();
+
+	settings.beginGroup("MemoryManager");
+	data::MemoryManager::instance().restore_settings(settings);
+	settings.endGroup();
 }
 
 void MainWindow::run_smu_script(string script_file)
@@ -284,6 +280,18 @@ void MainWindow::setup_ui()
 	script_dock->setWidget(smu_script_tree_view_);
 	this->tabifyDockWidget(dev_dock, script_dock);
 
+	// Diagnostics Dock
+	diagnostics_view_ = new ui::views::DiagnosticsView(*session_);
+
+	QDockWidget* diagnostics_dock =
+		new QDockWidget(diagnostics_view_->title());
+	diagnostics_dock->setAllowedAreas(Qt::AllDockWidgetAreas);
+	diagnostics_dock->setContextMenuPolicy(Qt::PreventContextMenu);
+	diagnostics_dock->setFeatures(QDockWidget::DockWidgetMovable |
+		QDockWidget::DockWidgetFloatable);
+	diagnostics_dock->setWidget(diagnostics_view_);
+	this->tabifyDockWidget(dev_dock, diagnostics_dock);
+
 	// Select device tree dock tab
 	dev_dock->show();
 	dev_dock->raise();
@@ -294,6 +302,11 @@ void MainWindow::connect_signals()
 	// Connect error handlers
 	connect(session_->smu_script_runner().get(), &python::SmuScriptRunner::script_error,
 		this, &MainWindow::error_handler);
+
+	// The warning is emitted in the thread, that allocates the memory.
+	connect(&data::MemoryManager::instance(),
+		&data::MemoryManager::memory_warning,
+		this, &MainWindow::on_memory_warning, Qt::QueuedConnection);
 }
 
 void MainWindow::error_handler(
@@ -307,6 +320,11 @@ void MainWindow::error_handler(
 	msg_box.exec();
 }
 
+void MainWindow::on_memory_warning(const QString &message)
+{
+	QMessageBox::warning(this, tr("Memory"), message);
+}
+
 void MainWindow::on_tab_close_requested(int index)
 {
 	auto *tab_window = (ui::tabs::BaseTab *)tab_widget_->widget(index);
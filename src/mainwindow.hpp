@@ -46,6 +46,7 @@ class BaseTab;
 }
 namespace views {
 class DevicesView;
+class DiagnosticsView;
 class SmuScriptTreeView;
 }
 }
@@ -87,6 +88,7 @@ private:
 
 	QWidget *central_widget_;
 	ui::views::DevicesView *devices_view_;
+	ui::views::DiagnosticsView *diagnostics_view_;
 	ui::views::SmuScriptTreeView *smu_script_tree_view_;
 	QTabWidget *tab_widget_;
 	/** tab_window_map_ is used to get the index of the tab in the QTabWidget */
@@ -94,6 +96,7 @@ private:
 
 private Q_SLOTS:
 	void error_handler(const std::string &sender, const std::string &msg);
+	void on_memory_warning(const QString &message);
 	void on_tab_close_requested(int);
 
 public Q_SLOTS:
@@ -17,9 +17,12 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <limits>
 #include <memory>
 #include <set>
 #include <string>
+#include <tuple>
+#include <vector>
 #include <pybind11/embed.h>
 #include <pybind11/stl.h>
 
@@ -34,9 +37,20 @@
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
 #include "src/data/datautil.hpp"
+#ifdef ENABLE_SHMFEED
+#include "src/data/shmfeed.hpp"
+#endif
+#include "src/data/resampler.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/data/sweep.hpp"
+#include "src/data/trigger.hpp"
+#include "src/data/triggerengine.hpp"
+#include "src/data/properties/baseproperty.hpp"
+#include "src/data/properties/doubleproperty.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
 #include "src/devices/deviceutil.hpp"
+#include "src/devices/generatordevice.hpp"
 #include "src/devices/hardwaredevice.hpp"
 #include "src/devices/userdevice.hpp"
 #include "src/python/pystreambuf.hpp"
@@ -94,12 +108,38 @@ PYBIND11_EMBEDDED_MODULE(smuview, m) {
 	init_Signal(m);
 	init_Channel(m);
 	init_Configurable(m);
+	init_Trigger(m);
 	init_Device(m);
+	init_Sweep(m);
 	init_Session(m);
 	init_UI(m);
 	init_StreamBuf(m);
 }
 
+/**
+ * Helper to create a sweep for the property of a configurable. The sweep
+ * lives in the GUI thread and must be deleted there.
+ */
+static std::shared_ptr<sv::data::Sweep> add_sweep(sv::Session &session,
+	std::shared_ptr<sv::devices::Configurable> configurable,
+	sv::devices::ConfigKey config_key,
+	const std::vector<std::shared_ptr<sv::data::AnalogTimeSignal>> &signals)
+{
+	auto property = configurable->get_property(config_key);
+	if (!property)
+		throw py::value_error("The configurable has no property for this config key.");
+	if (property->data_type() != sv::data::DataType::Double)
+		throw py::value_error("The property for this config key is not of type double.");
+
+	return std::shared_ptr<sv::data::Sweep>(new sv::data::Sweep(session,
+			std::static_pointer_cast<sv::data::properties::DoubleProperty>(property),
+			signals),
+		[](sv::data::Sweep *sweep) {
+			sweep->stop();
+			sweep->deleteLater();
+		});
+}
+
 void init_Session(py::module &m)
 {
 	py::class_<sv::Session> py_session(m, "Session");
@@ -127,6 +167,147 @@ void init_Session(py::module &m)
 		"-------\n"
 		"UserDevice\n"
 		"    The created user device object.");
+	py_session.def("add_generator_device", &sv::Session::add_generator_device,
+		py::arg("channel_count") = 1, py::arg("samplerate") = 1000,
+		py::arg("packet_rate") = 100,
+		py::arg("waveform") = sv::devices::GeneratorWaveform::Sine,
+		py::arg("frequency") = 1., py::arg("amplitude") = 1.,
+		"Create a new generator device, that generates synthetic voltage signals for load tests.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"channel_count : int\n"
+		"    The number of channels.\n"
+		"samplerate : int\n"
+		"    The samplerate per channel in samples per second.\n"
+		"packet_rate : int\n"
+		"    The number of packets per second. Each packet contains `samplerate / packet_rate` samples per channel.\n"
+		"waveform : GeneratorWaveform\n"
+		"    The waveform of the signals.\n"
+		"frequency : float\n"
+		"    The frequency of the waveform in Hz.\n"
+		"amplitude : float\n"
+		"    The amplitude of the waveform in V. The sign is ignored.\n\n"
+		"Returns\n"
+		"-------\n"
+		"GeneratorDevice\n"
+		"    The created generator device object.");
+	py_session.def("signal_registry", &sv::Session::signal_registry,
+		"Return the registry with all signals of all devices.\n\n"
+		"Returns\n"
+		"-------\n"
+		"SignalRegistry\n"
+		"    The signal registry object.");
+	py_session.def("add_sweep", &add_sweep,
+		py::arg("configurable"), py::arg("config_key"), py::arg("signals"),
+		"Create a new sweep of a double property, e.g. the output voltage of a power supply.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"configurable : Configurable\n"
+		"    The configurable.\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` of the property to sweep. The property must be of type double.\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The signals to measure for every step.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Sweep\n"
+		"    The new sweep object.");
+
+	py::class_<sv::data::SignalRegistry, std::shared_ptr<sv::data::SignalRegistry>> py_signal_registry(m, "SignalRegistry");
+	py_signal_registry.doc() = "The registry with all signals of the session. Every signal has a stable ID, that is never reused.";
+	py_signal_registry.def("signal_id", &sv::data::SignalRegistry::signal_id,
+		py::arg("signal"),
+		"Return the ID of a signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : BaseSignal\n"
+		"    The signal object.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The ID of the signal or 0, if the signal is unknown.");
+	py_signal_registry.def("signal", &sv::data::SignalRegistry::signal,
+		py::arg("id"),
+		"Return the signal for an ID.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"id : int\n"
+		"    The ID of the signal.\n\n"
+		"Returns\n"
+		"-------\n"
+		"BaseSignal\n"
+		"    The signal object or `None`, if there is no signal with this ID.");
+	py_signal_registry.def("signals",
+		[](const sv::data::SignalRegistry &registry) {
+			return *registry.signal_map();
+		},
+		"Return all registered signals.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Dict[int, BaseSignal]\n"
+		"    All signals with their ID as key.");
+	py_session.def("trigger_engine", &sv::Session::trigger_engine,
+		"Return the trigger engine, that evaluates triggers on the incoming samples.\n\n"
+		"Returns\n"
+		"-------\n"
+		"TriggerEngine\n"
+		"    The trigger engine object.");
+#ifdef ENABLE_SHMFEED
+	py_session.def("shm_feed", &sv::Session::shm_feed,
+		"Return the shared memory feed, that publishes signals to other processes on the same host.\n\n"
+		"Returns\n"
+		"-------\n"
+		"ShmFeed\n"
+		"    The shared memory feed object.");
+
+	py::class_<sv::data::ShmFeed, std::shared_ptr<sv::data::ShmFeed>> py_shm_feed(m, "ShmFeed");
+	py_shm_feed.doc() = "Publishes analog time signals in POSIX shared memory rings. See `contrib/shmfeed/` for readers.";
+	py_shm_feed.def("start", &sv::data::ShmFeed::start,
+		py::arg("socket_path") = "",
+		"Start the control socket, that lists the published signals.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"socket_path : str\n"
+		"    The path of the Unix domain socket. If empty, `$XDG_RUNTIME_DIR/smuview-<pid>.sock` is used.\n\n"
+		"Returns\n"
+		"-------\n"
+		"str\n"
+		"    The path of the control socket.");
+	py_shm_feed.def("stop", &sv::data::ShmFeed::stop,
+		"Stop the control socket. The signals stay published.");
+	py_shm_feed.def("socket_path", &sv::data::ShmFeed::socket_path,
+		"Return the path of the control socket.\n\n"
+		"Returns\n"
+		"-------\n"
+		"str\n"
+		"    The path of the control socket or an empty string, if not started.");
+	py_shm_feed.def("publish", &sv::data::ShmFeed::publish,
+		py::arg("signal"), py::arg("capacity") = sv::data::ShmFeed::default_capacity,
+		"Publish a signal in a new shared memory ring.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal to publish.\n"
+		"capacity : int\n"
+		"    The number of samples in the ring, rounded up to a power of two.\n\n"
+		"Returns\n"
+		"-------\n"
+		"str\n"
+		"    The name of the shared memory object.");
+	py_shm_feed.def("unpublish", &sv::data::ShmFeed::unpublish,
+		py::arg("signal"),
+		"Remove the shared memory ring of a signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal to remove.");
+	py_shm_feed.def("published_names", &sv::data::ShmFeed::published_names,
+		"Return the names of the shared memory objects of all published signals.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[str]\n"
+		"    The names of the shared memory objects.");
+#endif
 }
 
 void init_Device(py::module &m)
@@ -145,7 +326,10 @@ void init_Device(py::module &m)
 		"-------\n"
 		"str\n"
 		"    The id of the device.");
-	py_base_device.def("channels", &sv::devices::BaseDevice::channel_map,
+	py_base_device.def("channels",
+		[](const sv::devices::BaseDevice &device) {
+			return *device.channel_map();
+		},
 		"Return all channels of the device.\n\n"
 		"Returns\n"
 		"-------\n"
@@ -170,12 +354,40 @@ void init_Device(py::module &m)
 		"-------\n"
 		"UserChannel\n"
 		"    The new user channel object.");
+	py_base_device.def("acquisition_stats",
+		[](sv::devices::BaseDevice &device) {
+			const auto &stats = device.acquisition_stats();
+			const auto &feed_in_time = stats.feed_in_time();
+			return py::dict(
+				"packet_count"_a = stats.packet_count(),
+				"sample_count"_a = stats.sample_count(),
+				"packet_rate"_a = stats.packet_rate(),
+				"sample_rate"_a = stats.sample_rate(),
+				"feed_in_mean_ns"_a = feed_in_time.mean(),
+				"feed_in_p50_ns"_a = feed_in_time.percentile(50),
+				"feed_in_p99_ns"_a = feed_in_time.percentile(99),
+				"feed_in_max_ns"_a = feed_in_time.max());
+		},
+		"Return the counters of the data acquisition of the device.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Dict[str, float]\n"
+		"    A Dict with the received packets and samples (`packet_count`, `sample_count`), the packets and samples per second (`packet_rate`, `sample_rate`) and the time spent in processing the packets in nanoseconds (`feed_in_mean_ns`, `feed_in_p50_ns`, `feed_in_p99_ns`, `feed_in_max_ns`).");
 
 	py::class_<sv::devices::HardwareDevice, std::shared_ptr<sv::devices::HardwareDevice>> py_hardware_device(m, "HardwareDevice", py_base_device);
 	py_hardware_device.doc() = "An actual hardware device.";
 
 	py::class_<sv::devices::UserDevice, std::shared_ptr<sv::devices::UserDevice>> py_user_device(m, "UserDevice", py_base_device);
 	py_user_device.doc() = "An user generated (virtual) device for storing custom data and showing a custom tab.";
+
+	py::class_<sv::devices::GeneratorDevice, std::shared_ptr<sv::devices::GeneratorDevice>> py_generator_device(m, "GeneratorDevice", py_user_device);
+	py_generator_device.doc() = "A device, that generates synthetic signals with a fixed samplerate on its own thread.";
+	py_generator_device.def("late_packet_count", &sv::devices::GeneratorDevice::late_packet_count,
+		"Return the number of packets, that were generated more than one packet period too late.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of late packets.");
 }
 
 void init_Channel(py::module &m)
@@ -212,7 +424,10 @@ void init_Channel(py::module &m)
 		"-------\n"
 		"BaseSignal\n"
 		"    The actual signal object.");
-	py_base_channel.def("signals", &sv::channels::BaseChannel::signals,
+	py_base_channel.def("signals",
+		[](const sv::channels::BaseChannel &channel) {
+			return *channel.signals();
+		},
 		"Return all signals of the channel.\n\n"
 		"Returns\n"
 		"-------\n"
@@ -311,6 +526,39 @@ void init_Signal(py::module &m)
 		"    The total number of digits.\n"
 		"decimal_places : int\n"
 		"    The number of decimal places.");
+	py_analog_time_signal.def("ui_lag",
+		[](const sv::data::AnalogTimeSignal &signal) {
+			const auto &ui_lag = signal.ui_lag();
+			return py::dict(
+				"count"_a = ui_lag.count(),
+				"mean_ns"_a = ui_lag.mean(),
+				"p50_ns"_a = ui_lag.percentile(50),
+				"p99_ns"_a = ui_lag.percentile(99),
+				"max_ns"_a = ui_lag.max());
+		},
+		"Return the lag between the sample timestamps and the first display of the samples in a view.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Dict[str, float]\n"
+		"    A Dict with the number of measured lags (`count`) and the lags in nanoseconds (`mean_ns`, `p50_ns`, `p99_ns`, `max_ns`).");
+	py_analog_time_signal.def("memory_size", &sv::data::AnalogTimeSignal::memory_size,
+		"Return the number of bytes of the samples of the signal in memory.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of bytes.");
+	py_analog_time_signal.def("spilled_size", &sv::data::AnalogTimeSignal::spilled_size,
+		"Return the number of bytes of the samples of the signal, that have been moved to the disk.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of bytes.");
+	py_analog_time_signal.def("is_single_precision", &sv::data::AnalogTimeSignal::is_single_precision,
+		"Return true if the sample values are stored as floats (single precision). They are always returned as doubles.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    True if the values are stored as floats.");
 
 	py::class_<sv::data::AnalogSampleSignal, std::shared_ptr<sv::data::AnalogSampleSignal>> py_analog_sample_signal(m, "AnalogSampleSignal", py_base_signal);
 	py_analog_sample_signal.doc() = "A signal with key-value pairs.";
@@ -341,6 +589,62 @@ void init_Signal(py::module &m)
 		"    The total number of digits.\n"
 		"decimal_places : int\n"
 		"    The number of decimal places.");
+
+	py::class_<sv::data::Resampler, std::shared_ptr<sv::data::Resampler>> py_resampler(m, "Resampler");
+	py_resampler.doc() = "Resamples one or more analog time signals to a common time grid. "
+		"Call `process()` repeatedly to resample live data incrementally.";
+	py_resampler.def(py::init<const std::vector<std::shared_ptr<sv::data::AnalogTimeSignal>> &, sv::data::ResampleMode, double, double>(),
+		py::arg("signals"), py::arg("mode"), py::arg("interval"),
+		py::arg("origin") = std::numeric_limits<double>::quiet_NaN(),
+		"Create a resampler with a uniform time grid.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The signals to resample.\n"
+		"mode : ResampleMode\n"
+		"    The resample mode.\n"
+		"interval : float\n"
+		"    The distance between the grid points in seconds.\n"
+		"origin : float\n"
+		"    The absolute time stamp of one grid point. If NaN, the grid starts with the first time stamp covered by all signals.");
+	py_resampler.def(py::init<const std::vector<std::shared_ptr<sv::data::AnalogTimeSignal>> &, sv::data::ResampleMode, std::shared_ptr<sv::data::AnalogTimeSignal>>(),
+		py::arg("signals"), py::arg("mode"), py::arg("reference_signal"),
+		"Create a resampler, that uses the time stamps of a reference signal as time grid.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signals : List[AnalogTimeSignal]\n"
+		"    The signals to resample.\n"
+		"mode : ResampleMode\n"
+		"    The resample mode.\n"
+		"reference_signal : AnalogTimeSignal\n"
+		"    The signal with the time stamps of the grid.");
+	py_resampler.def("process",
+		[](sv::data::Resampler &resampler, size_t max_points) {
+			std::vector<double> time;
+			std::vector<std::vector<double>> values;
+			{
+				py::gil_scoped_release release;
+				resampler.process(time, values, max_points);
+			}
+			return std::make_tuple(time, values);
+		},
+		py::arg("max_points") = std::numeric_limits<size_t>::max(),
+		"Resample all new grid points, that are covered by the samples of all signals.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"max_points : int\n"
+		"    The max. number of grid points to return.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Tuple[List[float], List[List[float]]]\n"
+		"    The absolute time stamps of the grid points and a list with the values for every signal.");
+	py_resampler.def("reset", &sv::data::Resampler::reset,
+		"Restart the resampling at the given time stamp.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"start_timestamp : float\n"
+		"    The absolute time stamp to restart at. The default restarts at the beginning of the signals.",
+		py::arg("start_timestamp") = -std::numeric_limits<double>::infinity());
 }
 
 void init_Configurable(py::module &m)
@@ -460,6 +764,307 @@ void init_Configurable(py::module &m)
 		"    The string value of the config key.");
 }
 
+/**
+ * Helper to set a property action for the types of the python bindings.
+ */
+template<typename T>
+static void set_trigger_property_action(sv::data::Trigger &trigger,
+	std::shared_ptr<sv::devices::Configurable> configurable,
+	sv::devices::ConfigKey config_key, T value)
+{
+	auto property = configurable->get_property(config_key);
+	if (!property)
+		throw py::value_error("The configurable has no property for this config key.");
+	trigger.set_property_action(property, QVariant(value));
+}
+
+void init_Trigger(py::module &m)
+{
+	py::class_<sv::data::TriggerEvent> py_trigger_event(m, "TriggerEvent");
+	py_trigger_event.doc() = "An event of a trigger.";
+	py_trigger_event.def_readonly("timestamp", &sv::data::TriggerEvent::timestamp,
+		"The absolute time stamp of the event in seconds. Edges are interpolated between two samples.");
+	py_trigger_event.def_readonly("value", &sv::data::TriggerEvent::value,
+		"The value of the sample, that fired the trigger.");
+	py_trigger_event.def_readonly("number", &sv::data::TriggerEvent::number,
+		"The number of the event, starting at 1.");
+	py_trigger_event.def("__repr__", [](const sv::data::TriggerEvent &event) {
+		return "<TriggerEvent #" + std::to_string(event.number) + " t=" +
+			std::to_string(event.timestamp) + " value=" +
+			std::to_string(event.value) + ">";
+	});
+
+	py::class_<sv::data::Trigger, std::shared_ptr<sv::data::Trigger>> py_trigger(m, "Trigger");
+	py_trigger.doc() = "A trigger, that evaluates a condition on every sample of an analog time signal.";
+	py_trigger.def("name", [](const sv::data::Trigger &trigger) {
+			return trigger.name().toStdString();
+		},
+		"Return the description of the trigger.\n\n"
+		"Returns\n"
+		"-------\n"
+		"str\n"
+		"    The description of the trigger.");
+	py_trigger.def("signal", &sv::data::Trigger::signal,
+		"Return the signal of the trigger.\n\n"
+		"Returns\n"
+		"-------\n"
+		"AnalogTimeSignal\n"
+		"    The signal of the trigger.");
+	py_trigger.def("arm", &sv::data::Trigger::arm,
+		"Arm the trigger. The evaluation starts with the next incoming sample.");
+	py_trigger.def("disarm", &sv::data::Trigger::disarm,
+		"Disarm the trigger.");
+	py_trigger.def("is_armed", &sv::data::Trigger::is_armed,
+		"Return whether the trigger is armed. A single shot trigger is disarmed after its event.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the trigger is armed.");
+	py_trigger.def("event_count", &sv::data::Trigger::event_count,
+		"Return the number of events of the trigger.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of events.");
+	py_trigger.def("set_callback", [](sv::data::Trigger &trigger, py::object callback) {
+			if (callback.is_none()) {
+				trigger.set_callback(nullptr);
+				return;
+			}
+			py::function func = callback;
+			trigger.set_callback([func](const sv::data::TriggerEvent &event) {
+				func(event);
+			});
+		},
+		py::arg("callback"),
+		"Set a callback for the events of the trigger. The callback is called with a `TriggerEvent` "
+		"from within `TriggerEngine.dispatch()`, in the thread of the script.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"callback : Callable[[TriggerEvent], None]\n"
+		"    The callback or `None` to remove the callback.");
+	py_trigger.def("set_property_action", &set_trigger_property_action<bool>,
+		py::arg("configurable"), py::arg("config_key"), py::arg("value"),
+		"Set a boolean property of a configurable, when the trigger fires, e.g. to switch off an output.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"configurable : Configurable\n"
+		"    The configurable.\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` of the property.\n"
+		"value : bool\n"
+		"    The bool value to set.");
+	py_trigger.def("set_property_action", &set_trigger_property_action<qlonglong>,
+		py::arg("configurable"), py::arg("config_key"), py::arg("value"),
+		"Set an integer property of a configurable, when the trigger fires.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"configurable : Configurable\n"
+		"    The configurable.\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` of the property.\n"
+		"value : int\n"
+		"    The int value to set.");
+	py_trigger.def("set_property_action", &set_trigger_property_action<double>,
+		py::arg("configurable"), py::arg("config_key"), py::arg("value"),
+		"Set a double property of a configurable, when the trigger fires.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"configurable : Configurable\n"
+		"    The configurable.\n"
+		"config_key : ConfigKey\n"
+		"    The `ConfigKey` of the property.\n"
+		"value : float\n"
+		"    The float value to set.");
+	py_trigger.def("set_stop_sequences_action", &sv::data::Trigger::set_stop_sequences_action,
+		py::arg("stop_sequences"),
+		"Stop all running sequence output views, when the trigger fires.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"stop_sequences : bool\n"
+		"    `True` to stop the sequences.");
+
+	py::class_<sv::data::TriggerEngine, std::shared_ptr<sv::data::TriggerEngine>> py_trigger_engine(m, "TriggerEngine");
+	py_trigger_engine.doc() = "Evaluates the triggers on the incoming samples and delivers the events to the scripts, the plots and the actions of the triggers.";
+	py_trigger_engine.def("add_trigger", &sv::data::TriggerEngine::add_trigger,
+		py::arg("signal"), py::arg("condition"), py::arg("level"),
+		py::arg("level2") = 0., py::arg("duration") = 0.,
+		py::arg("hysteresis") = 0., py::arg("single_shot") = false,
+		"Add a new armed trigger to an analog time signal.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal to evaluate.\n"
+		"condition : TriggerCondition\n"
+		"    The condition of the trigger.\n"
+		"level : float\n"
+		"    The level, the lower limit of the window, the slope in unit/s or the tolerance for `TriggerCondition.Stable`.\n"
+		"level2 : float\n"
+		"    The upper limit of the window.\n"
+		"duration : float\n"
+		"    The duration in seconds for `TriggerCondition.Stable`.\n"
+		"hysteresis : float\n"
+		"    The value must leave the condition by this amount before the trigger fires again.\n"
+		"single_shot : bool\n"
+		"    If `True`, the trigger is disarmed after the first event.\n\n"
+		"Returns\n"
+		"-------\n"
+		"Trigger\n"
+		"    The new trigger object.");
+	py_trigger_engine.def("remove_trigger",
+		[](sv::data::TriggerEngine &engine, std::shared_ptr<sv::data::Trigger> trigger) {
+			if (trigger)
+				trigger->set_callback(nullptr);
+			engine.remove_trigger(trigger);
+		},
+		py::arg("trigger"),
+		"Disarm and remove a trigger.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"trigger : Trigger\n"
+		"    The trigger to remove.");
+	py_trigger_engine.def("triggers", &sv::data::TriggerEngine::triggers,
+		"Return all triggers.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[Trigger]\n"
+		"    All trigger objects.");
+	py_trigger_engine.def("wait_events", &sv::data::TriggerEngine::wait_events,
+		py::arg("timeout"), py::call_guard<py::gil_scoped_release>(),
+		"Wait for trigger events and return all queued events.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timeout : float\n"
+		"    The max. time to wait in seconds. With 0, the function returns immediately.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[Tuple[Trigger, TriggerEvent]]\n"
+		"    The queued events.");
+	py_trigger_engine.def("dispatch",
+		[](sv::data::TriggerEngine &engine, double timeout) {
+			std::vector<sv::data::trigger_event_t> events;
+			{
+				py::gil_scoped_release release;
+				events = engine.wait_events(timeout);
+			}
+			for (const auto &event : events) {
+				auto callback = event.first->callback();
+				if (callback)
+					callback(event.second);
+			}
+			return events.size();
+		},
+		py::arg("timeout"),
+		"Wait for trigger events and call the callbacks of the triggers.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timeout : float\n"
+		"    The max. time to wait in seconds. With 0, the function returns immediately.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of dispatched events.");
+	py_trigger_engine.def("dropped_event_count", &sv::data::TriggerEngine::dropped_event_count,
+		"Return the number of events, that were dropped because the script did not fetch them in time.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of dropped events.");
+}
+
+void init_Sweep(py::module &m)
+{
+	py::class_<sv::data::Sweep, std::shared_ptr<sv::data::Sweep>> py_sweep(m, "Sweep");
+	py_sweep.doc() = "A sweep sets a double property to a sequence of values and measures signals for every step. "
+		"A step is finished, as soon as the signals have settled, so no fixed delays are needed. "
+		"The set value and the settled values of the signals are pushed with the same time stamp "
+		"to the channels of a user device, see `Sweep.result_device()`.";
+	py_sweep.def_static("generate_steps", &sv::data::Sweep::generate_steps,
+		py::arg("type"), py::arg("start"), py::arg("stop"), py::arg("count"),
+		"Return the steps of a linear or logarithmic sweep.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"type : SweepType\n"
+		"    The type of the sweep. `SweepType.List` returns linear steps.\n"
+		"start : float\n"
+		"    The first step.\n"
+		"stop : float\n"
+		"    The last step.\n"
+		"count : int\n"
+		"    The number of steps.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[float]\n"
+		"    The steps.");
+	py_sweep.def("set_steps", &sv::data::Sweep::set_steps,
+		py::arg("steps"),
+		"Set the steps of the sweep. Ignored while the sweep is running.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"steps : List[float]\n"
+		"    The values to set.");
+	py_sweep.def("steps", &sv::data::Sweep::steps,
+		"Return the steps of the sweep.\n\n"
+		"Returns\n"
+		"-------\n"
+		"List[float]\n"
+		"    The values to set.");
+	py_sweep.def("set_settle", &sv::data::Sweep::set_settle,
+		py::arg("settle_delay") = 0., py::arg("settle_samples") = 1,
+		py::arg("settle_tolerance") = 0., py::arg("timeout") = 10.,
+		"Set the settle condition of the steps. Ignored while the sweep is running.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"settle_delay : float\n"
+		"    Only samples taken this many seconds after the value has been set are used.\n"
+		"settle_samples : int\n"
+		"    The number of new samples every signal must have.\n"
+		"settle_tolerance : float\n"
+		"    The samples must be within +/- settle_tolerance. With 0, only the samples are counted.\n"
+		"timeout : float\n"
+		"    The max. time in seconds for a step. The step is then marked as not settled. With 0, there is no timeout.");
+	py_sweep.def("start", &sv::data::Sweep::start,
+		"Start the sweep.");
+	py_sweep.def("stop", &sv::data::Sweep::stop,
+		"Stop the sweep.");
+	py_sweep.def("wait", &sv::data::Sweep::wait,
+		py::arg("timeout"), py::call_guard<py::gil_scoped_release>(),
+		"Wait for the sweep to finish.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"timeout : float\n"
+		"    The max. time to wait in seconds.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the sweep has finished.");
+	py_sweep.def("is_running", &sv::data::Sweep::is_running,
+		"Return whether the sweep is running.\n\n"
+		"Returns\n"
+		"-------\n"
+		"bool\n"
+		"    `True` if the sweep is running.");
+	py_sweep.def("step_index", &sv::data::Sweep::step_index,
+		"Return the index of the current step.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The index of the current step.");
+	py_sweep.def("unsettled_count", &sv::data::Sweep::unsettled_count,
+		"Return the number of steps, that didn't settle within the timeout.\n\n"
+		"Returns\n"
+		"-------\n"
+		"int\n"
+		"    The number of not settled steps.");
+	py_sweep.def("result_device", &sv::data::Sweep::result_device,
+		"Return the user device with the results. The first channel contains the set values, "
+		"the other channels the settled values of the measured signals.\n\n"
+		"Returns\n"
+		"-------\n"
+		"UserDevice\n"
+		"    The user device or `None`, if the sweep hasn't been started yet.");
+}
+
 void init_UI(py::module &m)
 {
 	/*
@@ -507,6 +1112,21 @@ void init_UI(py::module &m)
 		"-------\n"
 		"str\n"
 		"    The id of the new view.");
+	py_ui_helper.def("add_histogram_view", &sv::python::UiProxy::ui_add_histogram_view,
+		py::arg("device_id"), py::arg("area"), py::arg("signal"),
+		"Add a histogram view for a signal to the given tab.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"device_id : str\n"
+		"    The id (device id) of the tab.\n"
+		"area : DockArea\n"
+		"    Where to put the new view.\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal object.\n\n"
+		"Returns\n"
+		"-------\n"
+		"str\n"
+		"    The id of the new view.");
 	py_ui_helper.def("add_plot_view",
 		(std::string (sv::python::UiProxy::*) (std::string, Qt::DockWidgetArea, shared_ptr<sv::channels::BaseChannel>))
 			&sv::python::UiProxy::ui_add_plot_view,
@@ -579,6 +1199,22 @@ void init_UI(py::module &m)
 		"-------\n"
 		"str\n"
 		"    The id of the new view.");
+	py_ui_helper.def("add_spectrum_view", &sv::python::UiProxy::ui_add_spectrum_view,
+		py::arg("device_id"), py::arg("area"), py::arg("signal"),
+		"Add a spectrum view for a signal to the given tab. The spectrum is "
+		"calculated in the background from the incoming samples.\n\n"
+		"Parameters\n"
+		"----------\n"
+		"device_id : str\n"
+		"    The id (device id) of the tab.\n"
+		"area : DockArea\n"
+		"    Where to put the new view.\n"
+		"signal : AnalogTimeSignal\n"
+		"    The signal object.\n\n"
+		"Returns\n"
+		"-------\n"
+		"str\n"
+		"    The id of the new view.");
 	py_ui_helper.def("add_value_panel_view",
 		(std::string (sv::python::UiProxy::*) (std::string, Qt::DockWidgetArea, shared_ptr<sv::channels::BaseChannel>))
 			&sv::python::UiProxy::ui_add_value_panel_view,
@@ -1089,4 +1725,52 @@ void init_Enums(py::module &m)
 		"Piece");
 	py_unit.value("Unknown", sv::data::Unit::Unknown,
 		"Unknown");
+
+	py::enum_<sv::devices::GeneratorWaveform> py_generator_waveform(m, "GeneratorWaveform", "Enum of all available waveforms of the generator device.");
+	py_generator_waveform.value("Sine", sv::devices::GeneratorWaveform::Sine,
+		"Sine");
+	py_generator_waveform.value("Square", sv::devices::GeneratorWaveform::Square,
+		"Square");
+	py_generator_waveform.value("Triangle", sv::devices::GeneratorWaveform::Triangle,
+		"Triangle");
+	py_generator_waveform.value("Sawtooth", sv::devices::GeneratorWaveform::Sawtooth,
+		"Sawtooth");
+	py_generator_waveform.value("Noise", sv::devices::GeneratorWaveform::Noise,
+		"Uniformly distributed noise");
+
+	py::enum_<sv::data::ResampleMode> py_resample_mode(m, "ResampleMode", "Enum of all available resample modes.");
+	py_resample_mode.value("ZeroOrderHold", sv::data::ResampleMode::ZeroOrderHold,
+		"The value of the last sample at or before the grid time stamp.");
+	py_resample_mode.value("Linear", sv::data::ResampleMode::Linear,
+		"Linear interpolation between the two adjacent samples.");
+	py_resample_mode.value("BoxAverage", sv::data::ResampleMode::BoxAverage,
+		"The mean of all samples between the grid time stamp and the next grid time stamp.");
+
+	py::enum_<sv::data::TriggerCondition> py_trigger_condition(m, "TriggerCondition", "Enum of all available trigger conditions.");
+	py_trigger_condition.value("Above", sv::data::TriggerCondition::Above,
+		"The value is above the level.");
+	py_trigger_condition.value("Below", sv::data::TriggerCondition::Below,
+		"The value is below the level.");
+	py_trigger_condition.value("RisingEdge", sv::data::TriggerCondition::RisingEdge,
+		"The value crosses the level upwards.");
+	py_trigger_condition.value("FallingEdge", sv::data::TriggerCondition::FallingEdge,
+		"The value crosses the level downwards.");
+	py_trigger_condition.value("InsideWindow", sv::data::TriggerCondition::InsideWindow,
+		"The value is inside of [level, level2].");
+	py_trigger_condition.value("OutsideWindow", sv::data::TriggerCondition::OutsideWindow,
+		"The value is outside of [level, level2].");
+	py_trigger_condition.value("SlopeAbove", sv::data::TriggerCondition::SlopeAbove,
+		"The slope is above the level (in unit/s).");
+	py_trigger_condition.value("SlopeBelow", sv::data::TriggerCondition::SlopeBelow,
+		"The slope is below the level (in unit/s).");
+	py_trigger_condition.value("Stable", sv::data::TriggerCondition::Stable,
+		"The value stays within +/- level for duration seconds.");
+
+	py::enum_<sv::data::SweepType> py_sweep_type(m, "SweepType", "Enum of all available sweep types.");
+	py_sweep_type.value("Linear", sv::data::SweepType::Linear,
+		"Equidistant steps from start to stop.");
+	py_sweep_type.value("Log", sv::data::SweepType::Log,
+		"Logarithmic spaced steps from start to stop.");
+	py_sweep_type.value("List", sv::data::SweepType::List,
+		"A list of arbitrary steps.");
 }
@@ -29,6 +29,8 @@ void init_Device(py::module &m);
 void init_Channel(py::module &m);
 void init_Signal(py::module &m);
 void init_Configurable(py::module &m);
+void init_Trigger(py::module &m);
+void init_Sweep(py::module &m);
 void init_UI(py::module &m);
 void init_StreamBuf(py::module &m);
 void init_Enums(py::module &m);
@@ -17,7 +17,6 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <mutex>
 #include <string>
 #include <vector>
 
@@ -29,10 +28,13 @@
 namespace sv {
 namespace python {
 
-PyStreamBuf::PyStreamBuf(const std::string &encoding, const std::string &errors) :
+PyStreamBuf::PyStreamBuf(const std::string &encoding, const std::string &errors,
+		ScriptOutputBuffer *output_buffer, ScriptOutputBuffer::Stream stream) :
 	py_closed(false),
 	py_encoding(encoding),
-	py_errors(errors)
+	py_errors(errors),
+	output_buffer_(output_buffer),
+	stream_(stream)
 {
 }
 
@@ -43,14 +45,8 @@ PyStreamBuf::~PyStreamBuf()
 
 void PyStreamBuf::py_close()
 {
-	std::lock_guard<std::mutex> lock(mutex_);
-
-	// output anything that is left
-	if (!string_.empty()) {
-		Q_EMIT send_string(string_);
-		string_.erase(string_.begin(), string_.end());
-	}
-
+	// The text is already in the output buffer, that is flushed by its
+	// owner.
 	py_closed = true;
 }
 
@@ -63,10 +59,8 @@ int PyStreamBuf::py_fileno()
 
 void PyStreamBuf::py_flush()
 {
-	std::lock_guard<std::mutex> lock(mutex_);
-
-	Q_EMIT send_string(string_);
-	string_.erase(string_.begin(), string_.end());
+	// Nothing to do, the output buffer is flushed periodically. Flushing
+	// here would emit a signal for every print().
 }
 
 bool PyStreamBuf::py_isatty()
@@ -151,18 +145,7 @@ int PyStreamBuf::py_write(std::string s)
 	if (py_closed)
 		PyErr_SetString(PyExc_ValueError, "PyStreamBuf is already closed!");
 
-	std::lock_guard<std::mutex> lock(mutex_);
-
-	string_.append(s);
-	size_t pos = 0;
-	while (pos != std::string::npos) {
-		pos = string_.find('\n');
-		if (pos != std::string::npos) {
-			std::string tmp(string_.begin(), string_.begin() + pos);
-			Q_EMIT send_string(tmp);
-			string_.erase(string_.begin(), string_.begin() + pos + 1);
-		}
-	}
+	output_buffer_->write(stream_, s);
 
 	return s.size();
 }
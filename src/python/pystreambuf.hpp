@@ -20,24 +20,25 @@
 #ifndef PYTHON_PYSTREAMBUF_H
 #define PYTHON_PYSTREAMBUF_H
 
-#include <mutex>
 #include <string>
 #include <vector>
 
-#include <QObject>
+#include "src/python/scriptoutputbuffer.hpp"
 
 namespace sv {
 namespace python {
 
 /**
- * Buffer that writes to C++ instead of Python.
+ * Buffer that writes to C++ instead of Python. The text is passed to a
+ * ScriptOutputBuffer without locking or signals, so a script, that prints a
+ * lot, is not slowed down.
  */
-class PyStreamBuf : public QObject
+class PyStreamBuf
 {
-	Q_OBJECT
 
 public:
-	PyStreamBuf(const std::string &encoding, const std::string &errors);
+	PyStreamBuf(const std::string &encoding, const std::string &errors,
+		ScriptOutputBuffer *output_buffer, ScriptOutputBuffer::Stream stream);
 	~PyStreamBuf();
 
 	/** True if the stream is closed. */
@@ -84,11 +85,8 @@ public:
 	int py_write(std::string s);
 
 private:
-	std::string string_;
-	std::mutex mutex_;
-
-Q_SIGNALS:
-	void send_string(const std::string &text);
+	ScriptOutputBuffer *output_buffer_;
+	const ScriptOutputBuffer::Stream stream_;
 
 };
 
@@ -29,6 +29,7 @@
 #include <QObject>
 
 #include "src/python/pystreambuf.hpp"
+#include "src/python/scriptoutputbuffer.hpp"
 #include "src/python/smuscriptrunner.hpp"
 
 using std::shared_ptr;
@@ -56,19 +57,17 @@ public:
 
 		stdout_buf_ = new PyStreamBuf(
 			py::str(py::getattr(old_stdout_, "encoding", default_encoding)),
-			py::str(py::getattr(old_stdout_, "errors", py::str("strict"))));
+			py::str(py::getattr(old_stdout_, "errors", py::str("strict"))),
+			script_runner_->output_buffer(), ScriptOutputBuffer::Stream::Out);
 		auto py_stdout_buf = py::cast(
 			stdout_buf_, py::return_value_policy::reference);
-		connect(stdout_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stdout);
 
 		stderr_buf_ = new PyStreamBuf(
 			py::str(py::getattr(old_stderr_, "encoding", default_encoding)),
-			py::str(py::getattr(old_stderr_, "errors", py::str("backslashreplace"))));
+			py::str(py::getattr(old_stderr_, "errors", py::str("backslashreplace"))),
+			script_runner_->output_buffer(), ScriptOutputBuffer::Stream::Err);
 		auto py_stderr_buf = py::cast(
 			stderr_buf_, py::return_value_policy::reference);
-		connect(stderr_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stderr);
 
 		sys_module.attr("stdout") = py_stdout_buf;
 		sys_module.attr("stderr") = py_stderr_buf;
@@ -82,11 +81,6 @@ public:
 
 		stdout_buf_->py_close();
 		stderr_buf_->py_close();
-
-		disconnect(stdout_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stdout);
-		disconnect(stderr_buf_, &PyStreamBuf::send_string,
-			script_runner_.get(), &SmuScriptRunner::send_py_stderr);
 	}
 
 private:
@@ -0,0 +1,219 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <signal.h>
+
+#include <stdexcept>
+#include <string>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QProcess>
+#include <QProcessEnvironment>
+#include <QStandardPaths>
+#include <QString>
+#include <QStringList>
+#include <QTimer>
+
+#include "scripthostprocess.hpp"
+#include "src/session.hpp"
+#include "src/python/scripthostprotocol.hpp"
+#include "src/python/scripthostserver.hpp"
+#include "src/python/scriptoutputbuffer.hpp"
+
+using std::string;
+
+namespace sv {
+namespace python {
+
+ScriptHostProcess::ScriptHostProcess(Session &session, QObject *parent) :
+	QObject(parent),
+	session_(session),
+	process_(new QProcess(this)),
+	kill_timer_(new QTimer(this)),
+	output_buffer_(new ScriptOutputBuffer(this))
+{
+	connect(output_buffer_, &ScriptOutputBuffer::out_text,
+		this, &ScriptHostProcess::send_py_stdout);
+	connect(output_buffer_, &ScriptOutputBuffer::err_text,
+		this, &ScriptHostProcess::send_py_stderr);
+
+	kill_timer_->setSingleShot(true);
+	kill_timer_->setInterval(stop_timeout_ms);
+	connect(kill_timer_, &QTimer::timeout, process_, &QProcess::kill);
+
+	connect(process_, &QProcess::started,
+		this, &ScriptHostProcess::on_started);
+	connect(process_,
+		static_cast<void (QProcess::*)(int, QProcess::ExitStatus)>(
+			&QProcess::finished),
+		this, &ScriptHostProcess::on_finished);
+	connect(process_, &QProcess::errorOccurred,
+		this, &ScriptHostProcess::on_error);
+	connect(process_, &QProcess::readyReadStandardOutput,
+		this, &ScriptHostProcess::on_ready_read_stdout);
+	connect(process_, &QProcess::readyReadStandardError,
+		this, &ScriptHostProcess::on_ready_read_stderr);
+}
+
+ScriptHostProcess::~ScriptHostProcess()
+{
+	if (process_->state() != QProcess::NotRunning) {
+		process_->kill();
+		process_->waitForFinished(stop_timeout_ms);
+	}
+}
+
+QString ScriptHostProcess::executable()
+{
+	QString path = QDir(QCoreApplication::applicationDirPath()).
+		filePath(SV_SCRIPTHOST_EXECUTABLE);
+	if (QFileInfo(path).isExecutable())
+		return path;
+	return QStandardPaths::findExecutable(SV_SCRIPTHOST_EXECUTABLE);
+}
+
+void ScriptHostProcess::run(string file_name)
+{
+	if (is_running())
+		return;
+
+	QFileInfo file_info(QString::fromStdString(file_name));
+	if (file_name.empty() || !file_info.exists() || !file_info.isFile()) {
+		error(tr("No valide script file specified!").toStdString());
+		return;
+	}
+
+	QString program = executable();
+	if (program.isEmpty()) {
+		error(tr("The script host \"%1\" was not found!").
+			arg(SV_SCRIPTHOST_EXECUTABLE).toStdString());
+		return;
+	}
+
+	auto server = session_.script_host_server();
+	QString server_name;
+	try {
+		server_name = server->start();
+	}
+	catch (const std::runtime_error &e) {
+		error(e.what());
+		return;
+	}
+	token_ = server->create_token();
+
+	QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+	env.insert(SV_SCRIPTHOST_SOCKET_ENV, server_name);
+	env.insert(SV_SCRIPTHOST_TOKEN_ENV, token_);
+	// Pass the output of the script to the output view without delay.
+	env.insert("PYTHONUNBUFFERED", "1");
+	process_->setProcessEnvironment(env);
+	process_->setWorkingDirectory(file_info.absolutePath());
+
+	qWarning() << "ScriptHostProcess::run() executing" <<
+		file_info.absoluteFilePath();
+	process_->start(program, QStringList() << file_info.absoluteFilePath());
+}
+
+void ScriptHostProcess::stop()
+{
+	if (!is_running())
+		return;
+
+	// Raise a KeyboardInterrupt in the script, like the SmuScriptRunner
+	// does. A script, that doesn't stop, is killed after a while.
+	::kill((pid_t)process_->processId(), SIGINT);
+	kill_timer_->start();
+}
+
+bool ScriptHostProcess::is_running()
+{
+	return process_->state() != QProcess::NotRunning;
+}
+
+void ScriptHostProcess::error(const string &msg)
+{
+	// The output view shows the error like the errors of the script.
+	output_buffer_->write(ScriptOutputBuffer::Stream::Err, msg + "\n");
+	output_buffer_->flush();
+	Q_EMIT script_error("ScriptHostProcess", msg);
+}
+
+void ScriptHostProcess::on_started()
+{
+	output_buffer_->start();
+	Q_EMIT script_started();
+}
+
+void ScriptHostProcess::on_finished(int exit_code,
+	QProcess::ExitStatus exit_status)
+{
+	kill_timer_->stop();
+	session_.script_host_server()->revoke_token(token_);
+	token_.clear();
+
+	// Pass on the last output before script_finished().
+	on_ready_read_stdout();
+	on_ready_read_stderr();
+	output_buffer_->stop();
+
+	if (exit_status == QProcess::CrashExit) {
+		error(tr("The script host has crashed or has been killed!").
+			toStdString());
+	}
+	else if (exit_code != 0) {
+		// The traceback has already been printed to stderr.
+		Q_EMIT script_error("ScriptHostProcess",
+			tr("The script has exited with code %1.").
+				arg(exit_code).toStdString());
+	}
+
+	qWarning() << "ScriptHostProcess::on_finished() has finished!";
+	Q_EMIT script_finished();
+}
+
+void ScriptHostProcess::on_error(QProcess::ProcessError process_error)
+{
+	// All other errors are followed by finished().
+	if (process_error != QProcess::FailedToStart)
+		return;
+
+	session_.script_host_server()->revoke_token(token_);
+	token_.clear();
+	error(tr("The script host could not be started: %1").
+		arg(process_->errorString()).toStdString());
+	Q_EMIT script_finished();
+}
+
+void ScriptHostProcess::on_ready_read_stdout()
+{
+	output_buffer_->write(ScriptOutputBuffer::Stream::Out,
+		process_->readAllStandardOutput().toStdString());
+}
+
+void ScriptHostProcess::on_ready_read_stderr()
+{
+	output_buffer_->write(ScriptOutputBuffer::Stream::Err,
+		process_->readAllStandardError().toStdString());
+}
+
+} // namespace python
+} // namespace sv
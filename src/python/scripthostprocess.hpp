@@ -0,0 +1,99 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_SCRIPTHOSTPROCESS_HPP
+#define PYTHON_SCRIPTHOSTPROCESS_HPP
+
+#include <string>
+
+#include <QObject>
+#include <QProcess>
+#include <QString>
+
+class QTimer;
+
+using std::string;
+
+namespace sv {
+
+class Session;
+
+namespace python {
+
+class ScriptOutputBuffer;
+
+/**
+ * The ScriptHostProcess runs a script in its own smuview-scripthost process.
+ * The script has its own python interpreter, so it can't block the GUI, a
+ * crash of the script doesn't take down SmuView and several scripts can run
+ * at the same time.
+ *
+ * It has the same signals as the SmuScriptRunner, so the views can handle
+ * both the same way.
+ */
+class ScriptHostProcess : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** The time to wait for the script to stop, before it is killed. */
+	static const int stop_timeout_ms = 3000;
+
+	ScriptHostProcess(Session &session, QObject *parent = nullptr);
+	~ScriptHostProcess();
+
+	void run(string file_name);
+	void stop();
+	bool is_running();
+
+	/**
+	 * Return the path of the smuview-scripthost executable. It is searched
+	 * next to the SmuView executable first and then in the PATH.
+	 */
+	static QString executable();
+
+private:
+	void error(const string &msg);
+
+	Session &session_;
+	QProcess *process_;
+	QTimer *kill_timer_;
+	ScriptOutputBuffer *output_buffer_;
+	QString token_;
+
+private Q_SLOTS:
+	void on_started();
+	void on_finished(int exit_code, QProcess::ExitStatus exit_status);
+	void on_error(QProcess::ProcessError process_error);
+	void on_ready_read_stdout();
+	void on_ready_read_stderr();
+
+Q_SIGNALS:
+	void script_error(const std::string &sender, const std::string &msg);
+	void script_started();
+	void script_finished();
+	void send_py_stdout(const std::string &text);
+	void send_py_stderr(const std::string &text);
+
+};
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_SCRIPTHOSTPROCESS_HPP
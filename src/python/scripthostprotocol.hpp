@@ -0,0 +1,78 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+/*
+ * Protocol between SmuView and the out-of-process script host
+ * (smuview-scripthost).
+ *
+ * SmuView starts one host process per script. The host gets the name of the
+ * local socket of the ScriptHostServer and a random token in the environment
+ * variables SMUVIEW_SCRIPTHOST_SOCKET and SMUVIEW_SCRIPTHOST_TOKEN, and the
+ * script file as its only argument. The stdout and stderr of the host are the
+ * output of the script.
+ *
+ * The messages are JSON objects, one per line. The host sends requests and
+ * waits for the reply to each request:
+ *
+ *   request: { "id": <int>, "method": <string>, "params": <object>,
+ *              "payload": <int> }
+ *   reply:   { "id": <int>, "result": <value> }
+ *      or:   { "id": <int>, "error": <string> }
+ *
+ * The optional "payload" is the size in bytes of binary data, that directly
+ * follows the line of the request.
+ *
+ * The first request must be "hello", all other requests are rejected until
+ * the token has been verified:
+ *
+ *   hello        { "token" }                       -> true
+ *   signals      {}                                -> [ { "device",
+ *                                                      "channel", "signal",
+ *                                                      "quantity", "unit" } ]
+ *   subscribe    { "device", "channel", "signal",  -> { "shm_name",
+ *                  "capacity" }                         "capacity" }
+ *   get_property { "device", "configurable",       -> <value>
+ *                  "config_key" }
+ *   set_property { "device", "configurable",       -> true
+ *                  "config_key", "value" }
+ *   push_samples { "channel", "quantity", "unit",  -> <number of samples>
+ *                  "count", "digits",
+ *                  "decimal_places" }
+ *
+ * "device" is the device id, "config_key", "quantity" and "unit" are the
+ * names of deviceutil.hpp/datautil.hpp (e.g. "Voltage Target", "Voltage",
+ * "V").
+ *
+ * The samples of subscribed signals are not sent over the socket. The signal
+ * is published by the ShmFeed and the host maps the shared memory ring
+ * (see shmfeedformat.h). The samples of push_samples are the payload: "count"
+ * time stamps and then "count" values, as doubles in the byte order of the
+ * host. They are added to a user device, that is created for the host on the
+ * first push. "digits" and "decimal_places" may be omitted, when the channel
+ * already has a signal.
+ */
+
+#ifndef PYTHON_SCRIPTHOSTPROTOCOL_HPP
+#define PYTHON_SCRIPTHOSTPROTOCOL_HPP
+
+#define SV_SCRIPTHOST_SOCKET_ENV "SMUVIEW_SCRIPTHOST_SOCKET"
+#define SV_SCRIPTHOST_TOKEN_ENV "SMUVIEW_SCRIPTHOST_TOKEN"
+#define SV_SCRIPTHOST_EXECUTABLE "smuview-scripthost"
+
+#endif // PYTHON_SCRIPTHOSTPROTOCOL_HPP
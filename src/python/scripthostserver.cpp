@@ -0,0 +1,453 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QString>
+#include <QUuid>
+
+#include "scripthostserver.hpp"
+#include "src/session.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/channels/userchannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/shmfeed.hpp"
+#include "src/data/properties/baseproperty.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/deviceutil.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::dynamic_pointer_cast;
+using std::make_shared;
+using std::runtime_error;
+using std::string;
+
+namespace sv {
+namespace python {
+
+namespace {
+
+QString param_string(const QJsonObject &params, const QString &name)
+{
+	if (!params.value(name).isString())
+		throw runtime_error("Missing parameter \"" + name.toStdString() + "\"");
+	return params.value(name).toString();
+}
+
+/** Find the key of the name in one of the name maps of the util headers. */
+template<typename K> K find_by_name(const map<K, QString> &name_map,
+	const QString &name, const char *what)
+{
+	for (const auto &entry : name_map) {
+		if (entry.second == name)
+			return entry.first;
+	}
+	throw runtime_error(string("Unknown ") + what + " \"" +
+		name.toStdString() + "\"");
+}
+
+shared_ptr<devices::BaseDevice> find_device(Session &session,
+	const QString &device_id)
+{
+	const auto &devices = session.devices();
+	const auto it = devices.find(device_id.toStdString());
+	if (it == devices.end())
+		throw runtime_error("Unknown device \"" +
+			device_id.toStdString() + "\"");
+	return it->second;
+}
+
+shared_ptr<data::properties::BaseProperty> find_property(Session &session,
+	const QJsonObject &params)
+{
+	auto device = find_device(session, param_string(params, "device"));
+	const auto &configurables = device->configurable_map();
+	const auto it = configurables.find(
+		param_string(params, "configurable").toStdString());
+	if (it == configurables.end())
+		throw runtime_error("Unknown configurable");
+
+	devices::ConfigKey config_key = find_by_name(
+		devices::deviceutil::get_config_key_name_map(),
+		param_string(params, "config_key"), "config key");
+	auto property = it->second->get_property(config_key);
+	if (!property)
+		throw runtime_error("The configurable has no such property");
+	return property;
+}
+
+}
+
+ScriptHostServer::ScriptHostServer(Session &session) :
+	session_(session),
+	server_(nullptr)
+{
+}
+
+ScriptHostServer::~ScriptHostServer()
+{
+	for (const auto &signal : published_signals_)
+		session_.shm_feed()->unpublish(signal);
+}
+
+QString ScriptHostServer::start()
+{
+	if (server_)
+		return server_->serverName();
+
+	QString name = QString("smuview-scripthost-%1").
+		arg(QCoreApplication::applicationPid());
+	QLocalServer::removeServer(name);
+
+	server_ = new QLocalServer(this);
+	server_->setSocketOptions(QLocalServer::UserAccessOption);
+	if (!server_->listen(name)) {
+		string msg = server_->errorString().toStdString();
+		delete server_;
+		server_ = nullptr;
+		throw runtime_error("Can't start the script host server: " + msg);
+	}
+	connect(server_, &QLocalServer::newConnection,
+		this, &ScriptHostServer::on_new_connection);
+
+	return server_->serverName();
+}
+
+QString ScriptHostServer::create_token()
+{
+	QString token = QUuid::createUuid().toString();
+	tokens_.insert(token);
+	return token;
+}
+
+void ScriptHostServer::revoke_token(const QString &token)
+{
+	tokens_.erase(token);
+	// The connection of the token could still be open, when the host has
+	// crashed.
+	vector<QLocalSocket *> sockets;
+	for (const auto &connection : connections_) {
+		if (connection.second->token == token)
+			sockets.push_back(connection.first);
+	}
+	for (const auto &socket : sockets)
+		socket->abort();
+}
+
+void ScriptHostServer::on_new_connection()
+{
+	while (QLocalSocket *socket = server_->nextPendingConnection()) {
+		auto connection = make_shared<Connection>();
+		connection->socket = socket;
+		connection->payload_size = 0;
+		connection->authenticated = false;
+		connections_[socket] = connection;
+
+		connect(socket, &QLocalSocket::readyRead, this, [this, socket]() {
+			const auto it = connections_.find(socket);
+			if (it == connections_.end())
+				return;
+			// Keep the connection, when the socket is closed by a request.
+			auto connection = it->second;
+			connection->buffer.append(socket->readAll());
+			while (true) {
+				// The binary payload follows the line of its request.
+				if (connection->payload_size > 0) {
+					const int size = connection->payload_size;
+					if (connection->buffer.size() < size)
+						break;
+					QByteArray payload = connection->buffer.left(size);
+					connection->buffer.remove(0, size);
+					connection->payload_size = 0;
+					reply(*connection, connection->pending_request, payload);
+					continue;
+				}
+
+				int pos = connection->buffer.indexOf('\n');
+				if (pos < 0)
+					break;
+				QByteArray line = connection->buffer.left(pos);
+				connection->buffer.remove(0, pos + 1);
+				handle_message(*connection, line);
+			}
+		});
+		connect(socket, &QLocalSocket::disconnected, this, [this, socket]() {
+			close_connection(socket);
+		});
+	}
+}
+
+void ScriptHostServer::close_connection(QLocalSocket *socket)
+{
+	const auto it = connections_.find(socket);
+	if (it == connections_.end())
+		return;
+
+	for (const auto &signal : it->second->subscriptions) {
+		if (--subscription_counts_[signal] > 0)
+			continue;
+		subscription_counts_.erase(signal);
+		// Only remove the rings, that have been published for the hosts.
+		if (published_signals_.erase(signal) > 0)
+			session_.shm_feed()->unpublish(signal);
+	}
+	connections_.erase(it);
+	socket->deleteLater();
+}
+
+void ScriptHostServer::handle_message(Connection &connection,
+	const QByteArray &line)
+{
+	QJsonParseError parse_error;
+	QJsonDocument request = QJsonDocument::fromJson(line, &parse_error);
+	if (!request.isObject()) {
+		qWarning() << "ScriptHostServer: Invalid request:" <<
+			parse_error.errorString();
+		connection.socket->abort();
+		return;
+	}
+
+	// Wait for the binary payload. Only authenticated hosts may send one.
+	const double payload_size = request.object().value("payload").toDouble();
+	if (payload_size > 0) {
+		if (!connection.authenticated || payload_size > max_payload_size) {
+			qWarning() << "ScriptHostServer: Invalid payload";
+			connection.socket->abort();
+			return;
+		}
+		connection.pending_request = request.object();
+		connection.payload_size = (int)payload_size;
+		return;
+	}
+
+	reply(connection, request.object(), QByteArray());
+}
+
+void ScriptHostServer::reply(Connection &connection,
+	const QJsonObject &request, const QByteArray &payload)
+{
+	QJsonObject reply;
+	reply["id"] = request.value("id");
+	try {
+		reply["result"] = handle_request(connection,
+			request.value("method").toString(),
+			request.value("params").toObject(), payload);
+	}
+	catch (const runtime_error &e) {
+		reply["error"] = QString::fromStdString(e.what());
+	}
+	connection.socket->write(
+		QJsonDocument(reply).toJson(QJsonDocument::Compact) + '\n');
+
+	// An unauthenticated host gets the error and is disconnected.
+	if (!connection.authenticated)
+		connection.socket->disconnectFromServer();
+}
+
+QJsonValue ScriptHostServer::handle_request(Connection &connection,
+	const QString &method, const QJsonObject &params,
+	const QByteArray &payload)
+{
+	if (method == "hello") {
+		QString token = params.value("token").toString();
+		if (connection.authenticated || tokens_.count(token) == 0)
+			throw runtime_error("Invalid token");
+		connection.authenticated = true;
+		connection.token = token;
+		return true;
+	}
+	if (!connection.authenticated)
+		throw runtime_error("Not authenticated");
+
+	if (method == "signals")
+		return list_signals();
+	if (method == "subscribe")
+		return subscribe(connection, params);
+	if (method == "get_property")
+		return get_property(params);
+	if (method == "set_property")
+		return set_property(params);
+	if (method == "push_samples")
+		return push_samples(connection, params, payload);
+
+	throw runtime_error("Unknown method \"" + method.toStdString() + "\"");
+}
+
+QJsonValue ScriptHostServer::list_signals() const
+{
+	QJsonArray result;
+	for (const auto &device : session_.devices()) {
+		const auto channels = device.second->channel_map();
+		for (const auto &channel : *channels) {
+			const auto signals = channel.second->signals();
+			for (const auto &signal : *signals) {
+				if (!dynamic_pointer_cast<data::AnalogTimeSignal>(signal))
+					continue;
+				QJsonObject entry;
+				entry["device"] = QString::fromStdString(device.first);
+				entry["channel"] = QString::fromStdString(channel.first);
+				entry["signal"] = QString::fromStdString(signal->name());
+				entry["quantity"] = signal->quantity_name();
+				entry["unit"] = signal->unit_name();
+				result.append(entry);
+			}
+		}
+	}
+	return result;
+}
+
+QJsonValue ScriptHostServer::subscribe(Connection &connection,
+	const QJsonObject &params)
+{
+	auto device = find_device(session_, param_string(params, "device"));
+	const auto channels = device->channel_map();
+	const auto channel_it = channels->find(
+		param_string(params, "channel").toStdString());
+	if (channel_it == channels->end())
+		throw runtime_error("Unknown channel");
+
+	string signal_name = param_string(params, "signal").toStdString();
+	shared_ptr<data::AnalogTimeSignal> signal;
+	const auto signals = channel_it->second->signals();
+	for (const auto &s : *signals) {
+		if (s->name() == signal_name)
+			signal = dynamic_pointer_cast<data::AnalogTimeSignal>(s);
+	}
+	if (!signal)
+		throw runtime_error("Unknown signal \"" + signal_name + "\"");
+
+	size_t capacity = default_capacity;
+	if (params.value("capacity").toDouble() > 0)
+		capacity = (size_t)params.value("capacity").toDouble();
+
+	auto shm_feed = session_.shm_feed();
+	vector<string> names = shm_feed->published_names();
+	string shm_name = shm_feed->publish(signal, capacity);
+	if (std::find(names.begin(), names.end(), shm_name) == names.end())
+		published_signals_.insert(signal);
+
+	if (std::find(connection.subscriptions.begin(),
+			connection.subscriptions.end(), signal) ==
+			connection.subscriptions.end()) {
+		connection.subscriptions.push_back(signal);
+		++subscription_counts_[signal];
+	}
+
+	QJsonObject result;
+	result["shm_name"] = QString::fromStdString(shm_name);
+	return result;
+}
+
+QJsonValue ScriptHostServer::get_property(const QJsonObject &params) const
+{
+	auto property = find_property(session_, params);
+	if (!property->is_getable())
+		throw runtime_error("The property is not getable");
+	return QJsonValue::fromVariant(property->value());
+}
+
+QJsonValue ScriptHostServer::set_property(const QJsonObject &params)
+{
+	auto property = find_property(session_, params);
+	if (!property->is_setable())
+		throw runtime_error("The property is not setable");
+	if (!params.contains("value"))
+		throw runtime_error("Missing parameter \"value\"");
+	property->change_value(params.value("value").toVariant());
+	return true;
+}
+
+QJsonValue ScriptHostServer::push_samples(Connection &connection,
+	const QJsonObject &params, const QByteArray &payload)
+{
+	QString channel_name = param_string(params, "channel");
+	data::Quantity quantity = find_by_name(
+		data::datautil::get_quantity_name_map(),
+		param_string(params, "quantity"), "quantity");
+	data::Unit unit = find_by_name(data::datautil::get_unit_name_map(),
+		param_string(params, "unit"), "unit");
+
+	// The payload has the time stamps and then the values as doubles.
+	const size_t count = (size_t)params.value("count").toDouble();
+	if ((size_t)payload.size() != 2 * count * sizeof(double))
+		throw runtime_error("The payload doesn't match the sample count");
+
+	if (!connection.user_device)
+		connection.user_device = session_.add_user_device();
+	shared_ptr<channels::UserChannel> channel;
+	const auto channels = connection.user_device->channel_map();
+	const auto it = channels->find(channel_name.toStdString());
+	if (it != channels->end())
+		channel = dynamic_pointer_cast<channels::UserChannel>(it->second);
+	else
+		channel = connection.user_device->add_user_channel(
+			channel_name.toStdString(), "Script");
+	if (!channel)
+		throw runtime_error("Invalid channel");
+
+	// Use the digits of the request or of the existing signal.
+	int digits;
+	int decimal_places;
+	auto signal = dynamic_pointer_cast<data::AnalogTimeSignal>(
+		channel->actual_signal());
+	if (params.contains("digits") && params.contains("decimal_places")) {
+		digits = params.value("digits").toInt();
+		decimal_places = params.value("decimal_places").toInt();
+	}
+	else if (signal) {
+		digits = signal->digits();
+		decimal_places = signal->decimal_places();
+	}
+	else {
+		throw runtime_error("Missing parameters \"digits\" and "
+			"\"decimal_places\" for the new channel");
+	}
+
+	if (count == 0)
+		return 0;
+	vector<double> timestamps(count);
+	vector<double> values(count);
+	std::memcpy(timestamps.data(), payload.constData(),
+		count * sizeof(double));
+	std::memcpy(values.data(), payload.constData() + count * sizeof(double),
+		count * sizeof(double));
+	channel->push_samples(timestamps, values, quantity,
+		set<data::QuantityFlag>(), unit, digits, decimal_places);
+	return (double)count;
+}
+
+} // namespace python
+} // namespace sv
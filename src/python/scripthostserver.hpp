@@ -0,0 +1,138 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_SCRIPTHOSTSERVER_HPP
+#define PYTHON_SCRIPTHOSTSERVER_HPP
+
+#include <map>
+#include <memory>
+#include <set>
+#include <vector>
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QObject>
+#include <QString>
+
+class QLocalServer;
+class QLocalSocket;
+
+using std::map;
+using std::set;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+}
+
+namespace devices {
+class UserDevice;
+}
+
+namespace python {
+
+/**
+ * The ScriptHostServer serves the requests of the out-of-process script
+ * hosts (see scripthostprotocol.hpp). It runs in the GUI thread, but the
+ * requests are short (look ups and property changes), the samples of the
+ * signals are passed to the hosts through the ShmFeed.
+ */
+class ScriptHostServer : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** The capacity of the ring, when the host doesn't request one. */
+	static const size_t default_capacity = 1 << 20;
+	/** The max. size of the binary payload of a request. */
+	static const int max_payload_size = 256 << 20;
+
+	ScriptHostServer(Session &session);
+	~ScriptHostServer();
+
+	/**
+	 * Start the local server, if not already started. Throws a
+	 * std::runtime_error if the server can't be started.
+	 *
+	 * @return The name of the local server.
+	 */
+	QString start();
+
+	/**
+	 * Create a new token, that allows one host process to connect.
+	 */
+	QString create_token();
+
+	/**
+	 * Revoke the token, when the host process has finished.
+	 */
+	void revoke_token(const QString &token);
+
+private:
+	struct Connection
+	{
+		QLocalSocket *socket;
+		QByteArray buffer;
+		/** The request, that waits for its binary payload. */
+		QJsonObject pending_request;
+		int payload_size;
+		bool authenticated;
+		QString token;
+		vector<shared_ptr<data::AnalogTimeSignal>> subscriptions;
+		shared_ptr<devices::UserDevice> user_device;
+	};
+
+	void handle_message(Connection &connection, const QByteArray &line);
+	void reply(Connection &connection, const QJsonObject &request,
+		const QByteArray &payload);
+	QJsonValue handle_request(Connection &connection,
+		const QString &method, const QJsonObject &params,
+		const QByteArray &payload);
+	QJsonValue list_signals() const;
+	QJsonValue subscribe(Connection &connection, const QJsonObject &params);
+	QJsonValue get_property(const QJsonObject &params) const;
+	QJsonValue set_property(const QJsonObject &params);
+	QJsonValue push_samples(Connection &connection,
+		const QJsonObject &params, const QByteArray &payload);
+	void close_connection(QLocalSocket *socket);
+
+	Session &session_;
+	QLocalServer *server_;
+	set<QString> tokens_;
+	map<QLocalSocket *, shared_ptr<Connection>> connections_;
+	/** The number of hosts, that have subscribed the signals. */
+	map<shared_ptr<data::AnalogTimeSignal>, size_t> subscription_counts_;
+	/** The signals, that have been published for the hosts. */
+	set<shared_ptr<data::AnalogTimeSignal>> published_signals_;
+
+private Q_SLOTS:
+	void on_new_connection();
+
+};
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_SCRIPTHOSTSERVER_HPP
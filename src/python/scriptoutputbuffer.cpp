@@ -0,0 +1,117 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include <QTimer>
+
+#include "scriptoutputbuffer.hpp"
+
+using std::lock_guard;
+using std::string;
+
+namespace sv {
+namespace python {
+
+ScriptOutputBuffer::ScriptOutputBuffer(QObject *parent) :
+	QObject(parent),
+	head_(nullptr),
+	timer_(new QTimer(this))
+{
+	timer_->setInterval(flush_interval_ms);
+	connect(timer_, &QTimer::timeout, this, &ScriptOutputBuffer::flush);
+}
+
+ScriptOutputBuffer::~ScriptOutputBuffer()
+{
+	Node *node = head_.exchange(nullptr);
+	while (node) {
+		Node *next = node->next;
+		delete node;
+		node = next;
+	}
+}
+
+void ScriptOutputBuffer::write(Stream stream, const string &text)
+{
+	if (text.empty())
+		return;
+
+	Node *node = new Node{ stream, text, nullptr };
+	node->next = head_.load(std::memory_order_relaxed);
+	while (!head_.compare_exchange_weak(node->next, node,
+		std::memory_order_release, std::memory_order_relaxed)) {
+	}
+}
+
+void ScriptOutputBuffer::flush()
+{
+	lock_guard<std::mutex> lock(flush_mutex_);
+
+	Node *node = head_.exchange(nullptr, std::memory_order_acquire);
+	if (!node)
+		return;
+
+	// Reverse the list, so the oldest text comes first.
+	Node *first = nullptr;
+	while (node) {
+		Node *next = node->next;
+		node->next = first;
+		first = node;
+		node = next;
+	}
+
+	string text;
+	Stream stream = first->stream;
+	for (node = first; node; ) {
+		if (node->stream != stream) {
+			if (stream == Stream::Out)
+				Q_EMIT out_text(text);
+			else
+				Q_EMIT err_text(text);
+			text.clear();
+			stream = node->stream;
+		}
+		text.append(node->text);
+
+		Node *next = node->next;
+		delete node;
+		node = next;
+	}
+	if (stream == Stream::Out)
+		Q_EMIT out_text(text);
+	else
+		Q_EMIT err_text(text);
+}
+
+void ScriptOutputBuffer::start()
+{
+	timer_->start();
+}
+
+void ScriptOutputBuffer::stop()
+{
+	timer_->stop();
+	flush();
+}
+
+} // namespace python
+} // namespace sv
@@ -0,0 +1,102 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PYTHON_SCRIPTOUTPUTBUFFER_HPP
+#define PYTHON_SCRIPTOUTPUTBUFFER_HPP
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include <QObject>
+
+class QTimer;
+
+using std::string;
+
+namespace sv {
+namespace python {
+
+/**
+ * The ScriptOutputBuffer collects the stdout and stderr output of a script
+ * and passes it on in large pieces at a bounded rate, instead of one signal
+ * per written line.
+ *
+ * write() is lock free and can be called from any thread (e.g. the script
+ * thread). The collected text is emitted every flush_interval_ms by a timer
+ * in the thread of the buffer, while the buffer is started. The text is
+ * emitted as it was written (including the line breaks), consecutive writes
+ * to the same stream are joined.
+ */
+class ScriptOutputBuffer : public QObject
+{
+	Q_OBJECT
+
+public:
+	/** Emit the collected text max. 20 times per second. */
+	static const int flush_interval_ms = 50;
+
+	enum class Stream {
+		Out,
+		Err
+	};
+
+	ScriptOutputBuffer(QObject *parent = nullptr);
+	~ScriptOutputBuffer();
+
+	/**
+	 * Append the text to the stream. Lock free and thread safe.
+	 */
+	void write(Stream stream, const string &text);
+
+	/**
+	 * Emit all collected text now, in the calling thread. Thread safe.
+	 */
+	void flush();
+
+private:
+	struct Node
+	{
+		Stream stream;
+		string text;
+		Node *next;
+	};
+
+	/** The last written text, the nodes are linked from new to old. */
+	std::atomic<Node *> head_;
+	/** Keeps the order of the emitted text, if flushed by two threads. */
+	std::mutex flush_mutex_;
+	QTimer *timer_;
+
+public Q_SLOTS:
+	/** Start the periodic flush. */
+	void start();
+	/** Stop the periodic flush and emit the rest of the text. */
+	void stop();
+
+Q_SIGNALS:
+	void out_text(const std::string &text);
+	void err_text(const std::string &text);
+
+};
+
+} // namespace python
+} // namespace sv
+
+#endif // PYTHON_SCRIPTOUTPUTBUFFER_HPP
@@ -30,9 +30,11 @@
 
 #include "smuscriptrunner.hpp"
 #include "src/session.hpp"
+#include "src/data/triggerengine.hpp"
 #include "src/python/bindings.hpp"
 #include "src/python/pystreambuf.hpp"
 #include "src/python/pystreamredirect.hpp"
+#include "src/python/scriptoutputbuffer.hpp"
 #include "src/python/uihelper.hpp"
 #include "src/python/uiproxy.hpp"
 
@@ -50,6 +52,20 @@ SmuScriptRunner::SmuScriptRunner(Session &session) :
 	is_running_(false)
 {
 	ui_helper_ = make_shared<UiHelper>(session_);
+
+	output_buffer_ = new ScriptOutputBuffer(this);
+	// Direct connections, so the last output is also passed on, when it is
+	// flushed by the script thread and the event loop has already quit.
+	connect(output_buffer_, &ScriptOutputBuffer::out_text,
+		this, &SmuScriptRunner::send_py_stdout, Qt::DirectConnection);
+	connect(output_buffer_, &ScriptOutputBuffer::err_text,
+		this, &SmuScriptRunner::send_py_stderr, Qt::DirectConnection);
+	// The runner is emitting these signals from the script thread, the
+	// flush timer is started and stopped in the thread of the buffer.
+	connect(this, &SmuScriptRunner::script_started,
+		output_buffer_, &ScriptOutputBuffer::start);
+	connect(this, &SmuScriptRunner::script_finished,
+		output_buffer_, &ScriptOutputBuffer::stop);
 }
 
 SmuScriptRunner::~SmuScriptRunner()
@@ -91,6 +107,11 @@ bool SmuScriptRunner::is_running()
 	return is_running_;
 }
 
+ScriptOutputBuffer *SmuScriptRunner::output_buffer() const
+{
+	return output_buffer_;
+}
+
 void SmuScriptRunner::script_thread_proc()
 {
 	// TODO: mutex?
@@ -118,11 +139,18 @@ void SmuScriptRunner::script_thread_proc()
 		py::eval_file(script_file_name_, py::globals(), locals);
 	}
 	catch (py::error_already_set &ex) {
-		Q_EMIT send_py_stderr(ex.what());
+		output_buffer_->write(ScriptOutputBuffer::Stream::Err,
+			string(ex.what()) + "\n");
 		Q_EMIT script_error("SmuScriptRunner py::error_already_set", ex.what());
 	}
 
+	// The trigger callbacks are python objects and must be released before
+	// the interpreter is finalized.
+	session_.trigger_engine()->clear_callbacks();
+
 	qWarning() << "SmuScriptRunner::script_thread_proc() has finished!";
+	// Pass on the rest of the output before script_finished().
+	output_buffer_->flush();
 	Q_EMIT script_finished();
 	is_running_ = false;
 }
@@ -36,6 +36,7 @@ class Session;
 
 namespace python {
 
+class ScriptOutputBuffer;
 class UiHelper;
 
 class SmuScriptRunner :
@@ -52,11 +53,18 @@ public:
 	void stop();
 	bool is_running();
 
+	/**
+	 * Return the buffer, that collects the output of the script. The output
+	 * is emitted by send_py_stdout() and send_py_stderr() in large pieces.
+	 */
+	ScriptOutputBuffer *output_buffer() const;
+
 private:
 	void script_thread_proc();
 
 	Session &session_;
 	shared_ptr<UiHelper> ui_helper_;
+	ScriptOutputBuffer *output_buffer_;
 	string script_file_name_;
 	std::thread script_thread_;
 	bool is_running_;
@@ -65,6 +73,10 @@ Q_SIGNALS:
 	void script_error(const std::string &sender, const std::string &msg);
 	void script_started();
 	void script_finished();
+	/**
+	 * The output of the script. The text is passed on unchanged, including
+	 * its line breaks, and a piece may end in the middle of a line.
+	 */
 	void send_py_stdout(const std::string &text);
 	void send_py_stderr(const std::string &text);
 
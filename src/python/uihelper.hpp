@@ -69,6 +69,8 @@ public Q_SLOTS:
 		shared_ptr<sv::data::AnalogTimeSignal> signal);
 	void add_control_view(std::string device_id, Qt::DockWidgetArea area,
 		shared_ptr<sv::devices::Configurable> configurable);
+	void add_histogram_view(std::string device_id, Qt::DockWidgetArea area,
+		shared_ptr<sv::data::AnalogTimeSignal> signal);
 	void add_plot_view(std::string device_id, Qt::DockWidgetArea area,
 		shared_ptr<sv::channels::BaseChannel> channel);
 	void add_plot_view(std::string device_id, Qt::DockWidgetArea area,
@@ -79,6 +81,8 @@ public Q_SLOTS:
 	void add_power_panel_view(std::string device_id, Qt::DockWidgetArea area,
 		shared_ptr<sv::data::AnalogTimeSignal> voltage_signal,
 		shared_ptr<sv::data::AnalogTimeSignal> current_signal);
+	void add_spectrum_view(std::string device_id, Qt::DockWidgetArea area,
+		shared_ptr<sv::data::AnalogTimeSignal> signal);
 	void add_value_panel_view(std::string device_id, Qt::DockWidgetArea area,
 		shared_ptr<sv::channels::BaseChannel> channel);
 	void add_value_panel_view(std::string device_id, Qt::DockWidgetArea area,
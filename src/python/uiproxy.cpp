@@ -46,6 +46,14 @@ UiProxy::UiProxy(Session &session, shared_ptr<UiHelper> ui_helper) :
 	session_(session),
 	ui_helper_(ui_helper)
 {
+	// In headless mode there is no user interface, all UI calls of a script
+	// are ignored.
+	if (!session_.main_window()) {
+		qWarning() << "UiProxy: No main window (headless), UI calls from the "
+			"script are ignored.";
+		return;
+	}
+
 	connect(this, &UiProxy::add_device_tab,
 		session_.main_window(), &MainWindow::add_device_tab);
 
@@ -55,6 +63,9 @@ UiProxy::UiProxy(Session &session, shared_ptr<UiHelper> ui_helper) :
 	connect(this, &UiProxy::add_control_view,
 		ui_helper_.get(), &UiHelper::add_control_view);
 
+	connect(this, &UiProxy::add_histogram_view,
+		ui_helper_.get(), &UiHelper::add_histogram_view);
+
 	connect(this, QOverload<std::string, Qt::DockWidgetArea, shared_ptr<sv::channels::BaseChannel>>::of(&UiProxy::add_plot_view),
 		ui_helper_.get(), QOverload<std::string, Qt::DockWidgetArea, shared_ptr<sv::channels::BaseChannel>>::of(&UiHelper::add_plot_view));
 	connect(this, QOverload<std::string, Qt::DockWidgetArea, shared_ptr<sv::data::AnalogTimeSignal>>::of(&UiProxy::add_plot_view),
@@ -65,6 +76,9 @@ UiProxy::UiProxy(Session &session, shared_ptr<UiHelper> ui_helper) :
 	connect(this, &UiProxy::add_power_panel_view,
 		ui_helper_.get(), &UiHelper::add_power_panel_view);
 
+	connect(this, &UiProxy::add_spectrum_view,
+		ui_helper_.get(), &UiHelper::add_spectrum_view);
+
 	connect(this, QOverload<std::string, Qt::DockWidgetArea, shared_ptr<sv::channels::BaseChannel>>::of(&UiProxy::add_value_panel_view),
 		ui_helper_.get(), QOverload<std::string, Qt::DockWidgetArea, shared_ptr<sv::channels::BaseChannel>>::of(&UiHelper::add_value_panel_view));
 	connect(this, QOverload<std::string, Qt::DockWidgetArea, shared_ptr<sv::data::AnalogTimeSignal>>::of(&UiProxy::add_value_panel_view),
@@ -99,6 +113,13 @@ string UiProxy::ui_add_control_view(string device_id, Qt::DockWidgetArea area,
 	return "control:" + configurable->name();
 }
 
+string UiProxy::ui_add_histogram_view(string device_id,
+	Qt::DockWidgetArea area, shared_ptr<data::AnalogTimeSignal> signal)
+{
+	Q_EMIT add_histogram_view(device_id, area, signal);
+	return "histogram:" + signal->name();
+}
+
 string UiProxy::ui_add_plot_view(string device_id, Qt::DockWidgetArea area,
 	shared_ptr<channels::BaseChannel> channel)
 {
@@ -131,6 +152,13 @@ string UiProxy::ui_add_power_panel_view(string device_id, Qt::DockWidgetArea are
 
 }
 
+string UiProxy::ui_add_spectrum_view(string device_id, Qt::DockWidgetArea area,
+	shared_ptr<data::AnalogTimeSignal> signal)
+{
+	Q_EMIT add_spectrum_view(device_id, area, signal);
+	return "spectrum:" + signal->name();
+}
+
 string UiProxy::ui_add_value_panel_view(string device_id, Qt::DockWidgetArea area,
 	shared_ptr<channels::BaseChannel> channel)
 {
@@ -67,6 +67,8 @@ public:
 		shared_ptr<data::AnalogTimeSignal> signal);
 	string ui_add_control_view(string device_id, Qt::DockWidgetArea area,
 		shared_ptr<devices::Configurable> configurable);
+	string ui_add_histogram_view(string device_id, Qt::DockWidgetArea area,
+		shared_ptr<data::AnalogTimeSignal> signal);
 	string ui_add_plot_view(string device_id, Qt::DockWidgetArea area,
 		shared_ptr<channels::BaseChannel> channel);
 	string ui_add_plot_view(string device_id, Qt::DockWidgetArea area,
@@ -77,6 +79,8 @@ public:
 	string ui_add_power_panel_view(string device_id, Qt::DockWidgetArea area,
 		shared_ptr<data::AnalogTimeSignal> voltage_signal,
 		shared_ptr<data::AnalogTimeSignal> current_signal);
+	string ui_add_spectrum_view(string device_id, Qt::DockWidgetArea area,
+		shared_ptr<data::AnalogTimeSignal> signal);
 	string ui_add_value_panel_view(string device_id, Qt::DockWidgetArea area,
 		shared_ptr<channels::BaseChannel> channel);
 	string ui_add_value_panel_view(string device_id, Qt::DockWidgetArea area,
@@ -102,6 +106,8 @@ Q_SIGNALS:
 		shared_ptr<sv::data::AnalogTimeSignal> signal);
 	void add_control_view(std::string device_id, Qt::DockWidgetArea area,
 		shared_ptr<sv::devices::Configurable> configurable);
+	void add_histogram_view(std::string device_id, Qt::DockWidgetArea area,
+		shared_ptr<sv::data::AnalogTimeSignal> signal);
 	void add_plot_view(std::string device_id, Qt::DockWidgetArea area,
 		shared_ptr<sv::channels::BaseChannel> channel);
 	void add_plot_view(std::string device_id, Qt::DockWidgetArea area,
@@ -112,6 +118,8 @@ Q_SIGNALS:
 	void add_power_panel_view(std::string device_id, Qt::DockWidgetArea area,
 		shared_ptr<sv::data::AnalogTimeSignal> voltage_signal,
 		shared_ptr<sv::data::AnalogTimeSignal> current_signal);
+	void add_spectrum_view(std::string device_id, Qt::DockWidgetArea area,
+		shared_ptr<sv::data::AnalogTimeSignal> signal);
 	void add_value_panel_view(std::string device_id, Qt::DockWidgetArea area,
 		shared_ptr<sv::channels::BaseChannel> channel);
 	void add_value_panel_view(std::string device_id, Qt::DockWidgetArea area,
@@ -26,14 +26,30 @@
 #include <vector>
 
 #include <QDebug>
+#include <QMetaType>
 
 #include "session.hpp"
 #include "config.h"
 #include "src/devicemanager.hpp"
 #include "src/util.hpp"
+#include "src/channels/basechannel.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/signalregistry.hpp"
+#ifdef ENABLE_SHMFEED
+#include "src/data/shmfeed.hpp"
+#endif
+#include "src/data/trigger.hpp"
+#include "src/data/triggerengine.hpp"
 #include "src/devices/basedevice.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/deviceutil.hpp"
+#include "src/devices/generatordevice.hpp"
 #include "src/devices/hardwaredevice.hpp"
 #include "src/devices/userdevice.hpp"
+#ifdef ENABLE_SCRIPTHOST
+#include "src/python/scripthostserver.hpp"
+#endif
 #include "src/python/smuscriptrunner.hpp"
 
 using std::list;
@@ -44,6 +60,12 @@ using std::shared_ptr;
 using std::string;
 using std::vector;
 
+Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
+Q_DECLARE_METATYPE(std::shared_ptr<sv::devices::BaseDevice>)
+Q_DECLARE_METATYPE(std::shared_ptr<sv::channels::BaseChannel>)
+Q_DECLARE_METATYPE(std::shared_ptr<sv::data::BaseSignal>)
+Q_DECLARE_METATYPE(std::shared_ptr<sv::data::Trigger>)
+
 namespace sigrok {
 class Context;
 }
@@ -57,9 +79,35 @@ Session::Session(DeviceManager &device_manager, MainWindow *main_window) :
 	device_manager_(device_manager),
 	main_window_(main_window)
 {
+	// Register the types used in queued connections between the acquisition,
+	// script and GUI threads. Also needed without a MainWindow (headless).
+	qRegisterMetaType<util::Timestamp>("util::Timestamp");
+	qRegisterMetaType<uint64_t>("uint64_t");
+	qRegisterMetaType<std::string>("std::string");
+	qRegisterMetaType<shared_ptr<devices::BaseDevice>>("shared_ptr<sv::devices::BaseDevice>");
+	qRegisterMetaType<shared_ptr<devices::Configurable>>("shared_ptr<sv::devices::Configurable>");
+	qRegisterMetaType<shared_ptr<devices::HardwareDevice>>("shared_ptr<sv::devices::HardwareDevice>");
+	qRegisterMetaType<shared_ptr<channels::BaseChannel>>("shared_ptr<sv::channels::BaseChannel>");
+	qRegisterMetaType<shared_ptr<data::BaseSignal>>("shared_ptr<sv::data::BaseSignal>");
+	qRegisterMetaType<shared_ptr<data::AnalogTimeSignal>>("shared_ptr<sv::data::AnalogTimeSignal>");
+	qRegisterMetaType<devices::ConfigKey>("devices::ConfigKey");
+	qRegisterMetaType<shared_ptr<data::Trigger>>("shared_ptr<sv::data::Trigger>");
+	qRegisterMetaType<data::TriggerEvent>("sv::data::TriggerEvent");
+	qRegisterMetaType<data::signal_id_t>("sv::data::signal_id_t");
+
+	signal_registry_ = make_shared<data::SignalRegistry>();
+
 	smu_script_runner_ = make_shared<python::SmuScriptRunner>(*this);
 	connect(smu_script_runner_.get(), &python::SmuScriptRunner::script_error,
 		this, &Session::error_handler);
+
+#ifdef ENABLE_SHMFEED
+	shm_feed_ = make_shared<data::ShmFeed>();
+#endif
+#ifdef ENABLE_SCRIPTHOST
+	script_host_server_ = make_shared<python::ScriptHostServer>(*this);
+#endif
+	trigger_engine_ = make_shared<data::TriggerEngine>();
 }
 
 Session::~Session()
@@ -83,6 +131,30 @@ shared_ptr<python::SmuScriptRunner> Session::smu_script_runner()
 	return smu_script_runner_;
 }
 
+shared_ptr<data::SignalRegistry> Session::signal_registry() const
+{
+	return signal_registry_;
+}
+
+#ifdef ENABLE_SHMFEED
+shared_ptr<data::ShmFeed> Session::shm_feed()
+{
+	return shm_feed_;
+}
+#endif
+
+#ifdef ENABLE_SCRIPTHOST
+shared_ptr<python::ScriptHostServer> Session::script_host_server()
+{
+	return script_host_server_;
+}
+#endif
+
+shared_ptr<data::TriggerEngine> Session::trigger_engine()
+{
+	return trigger_engine_;
+}
+
 void Session::save_settings(QSettings &settings) const
 {
 	(QSettings)&settings;
@@ -97,7 +169,7 @@ void Session::restore_settings(QSettings &settings)
 	// TODO: Restore all signal data from settings?
 }
 
-map<string, shared_ptr<devices::BaseDevice>> Session::devices() const
+const map<string, shared_ptr<devices::BaseDevice>> &Session::devices() const
 {
 	return devices_;
 }
@@ -136,6 +208,7 @@ void Session::add_device(shared_ptr<devices::BaseDevice> device)
 		this, &Session::error_handler);
 
 	devices_.insert(make_pair(device->id(), device));
+	signal_registry_->add_device(device);
 
 	Q_EMIT device_added(device);
 }
@@ -153,6 +226,18 @@ shared_ptr<devices::UserDevice> Session::add_user_device()
 	return device;
 }
 
+shared_ptr<devices::GeneratorDevice> Session::add_generator_device(
+	unsigned int channel_count, uint64_t samplerate, uint64_t packet_rate,
+	devices::GeneratorWaveform waveform, double frequency, double amplitude)
+{
+	auto device = make_shared<devices::GeneratorDevice>(sr_context,
+		channel_count, samplerate, packet_rate, waveform, frequency,
+		amplitude);
+	this->add_device(device);
+
+	return device;
+}
+
 void Session::remove_device(shared_ptr<devices::BaseDevice> device)
 {
 	if (device) {
@@ -162,6 +247,7 @@ void Session::remove_device(shared_ptr<devices::BaseDevice> device)
 			this, &Session::error_handler);
 
 		devices_.erase(device->id());
+		signal_registry_->remove_device(device);
 
 		Q_EMIT device_removed(device);
 	}
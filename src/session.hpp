@@ -20,6 +20,7 @@
 #ifndef SESSION_HPP
 #define SESSION_HPP
 
+#include <cstdint>
 #include <list>
 #include <map>
 #include <memory>
@@ -42,13 +43,24 @@ namespace sv {
 class DeviceManager;
 class MainWindow;
 
+namespace data {
+class ShmFeed;
+class SignalRegistry;
+class TriggerEngine;
+}
+
 namespace devices {
 class BaseDevice;
+class GeneratorDevice;
 class HardwareDevice;
 class UserDevice;
+enum class GeneratorWaveform;
 }
 
 namespace python {
+#ifdef ENABLE_SCRIPTHOST
+class ScriptHostServer;
+#endif
 class SmuScriptRunner;
 }
 
@@ -68,14 +80,43 @@ public:
 	DeviceManager &device_manager();
 	const DeviceManager &device_manager() const;
 	shared_ptr<python::SmuScriptRunner> smu_script_runner();
+	/**
+	 * Return the registry with all signals of all devices of the session.
+	 */
+	shared_ptr<data::SignalRegistry> signal_registry() const;
+#ifdef ENABLE_SHMFEED
+	/**
+	 * Return the shared memory feed, that publishes signals to other
+	 * processes. The feed is inactive until signals are published.
+	 */
+	shared_ptr<data::ShmFeed> shm_feed();
+#endif
+#ifdef ENABLE_SCRIPTHOST
+	/**
+	 * Return the server for the out-of-process script hosts. The server is
+	 * started, when the first script is run in a script host.
+	 */
+	shared_ptr<python::ScriptHostServer> script_host_server();
+#endif
+	/**
+	 * Return the trigger engine, that evaluates the triggers on the signals.
+	 */
+	shared_ptr<data::TriggerEngine> trigger_engine();
 
 	void save_settings(QSettings &settings) const;
 	void restore_settings(QSettings &settings);
 
-	map<string, shared_ptr<devices::BaseDevice>> devices() const;
+	/**
+	 * Return all devices of the session. The map is not copied.
+	 */
+	const map<string, shared_ptr<devices::BaseDevice>> &devices() const;
 	list<shared_ptr<devices::HardwareDevice>> connect_device(string conn_string);
 	void add_device(shared_ptr<devices::BaseDevice> device);
 	shared_ptr<devices::UserDevice> add_user_device();
+	shared_ptr<devices::GeneratorDevice> add_generator_device(
+		unsigned int channel_count, uint64_t samplerate, uint64_t packet_rate,
+		devices::GeneratorWaveform waveform, double frequency,
+		double amplitude);
 	void remove_device(shared_ptr<devices::BaseDevice> device);
 
 	void load_init_file(const string &file_name, const string &format);
@@ -87,6 +128,14 @@ private:
 	map<string, shared_ptr<devices::BaseDevice>> devices_;
 	MainWindow *main_window_;
 	shared_ptr<python::SmuScriptRunner> smu_script_runner_;
+	shared_ptr<data::SignalRegistry> signal_registry_;
+#ifdef ENABLE_SHMFEED
+	shared_ptr<data::ShmFeed> shm_feed_;
+#endif
+#ifdef ENABLE_SCRIPTHOST
+	shared_ptr<python::ScriptHostServer> script_host_server_;
+#endif
+	shared_ptr<data::TriggerEngine> trigger_engine_;
 
 	void free_unused_memory();
 
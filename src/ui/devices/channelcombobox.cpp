@@ -65,14 +65,9 @@ void ChannelComboBox::filter_quantity(sv::data::Quantity quantity)
 void ChannelComboBox::select_channel(
 	shared_ptr<sv::channels::BaseChannel> channel)
 {
-	for (int i = 0; i < this->count(); ++i) {
-		QVariant data = this->itemData(i, Qt::UserRole);
-		auto item_channel = data.value<shared_ptr<sv::channels::BaseChannel>>();
-		if (item_channel == channel) {
-			this->setCurrentIndex(i);
-			break;
-		}
-	}
+	int index = find_channel(channel);
+	if (index >= 0)
+		this->setCurrentIndex(index);
 }
 
 shared_ptr<sv::channels::BaseChannel> ChannelComboBox::selected_channel() const
@@ -97,39 +92,94 @@ void ChannelComboBox::fill_channels()
 	if (channel_group_name_ == nullptr)
 		channel_group_name_ = "";
 
-	string chg_name_str = channel_group_name_.toStdString();
-	if (!device_->channel_group_map().count(chg_name_str))
+	// Channels, that are added later, are appended by on_channel_added().
+	connect(device_.get(), &sv::devices::BaseDevice::channel_added,
+		this, &ChannelComboBox::on_channel_added, Qt::UniqueConnection);
+
+	const auto channel_group_map = device_->channel_group_map();
+	const auto chg_it =
+		channel_group_map->find(channel_group_name_.toStdString());
+	if (chg_it == channel_group_map->end())
 		return;
 
-	auto ch_list = device_->channel_group_map()[chg_name_str];
-	for (const auto &ch : ch_list) {
-		// Check if channel contains a signal with the filter quantity.
-		if (filter_active_) {
-			bool found = false;
-			for (const auto &signal : ch->signals()) {
-				if (filter_quantity_ == signal->quantity()) {
-					found = true;
-					break;
-				}
+	for (const auto &ch : chg_it->second)
+		add_channel(ch);
+}
+
+void ChannelComboBox::add_channel(
+	shared_ptr<sv::channels::BaseChannel> channel)
+{
+	if (find_channel(channel) >= 0)
+		return;
+
+	// Check if channel contains a signal with the filter quantity.
+	if (filter_active_) {
+		bool found = false;
+		const auto signals = channel->signals();
+		for (const auto &signal : *signals) {
+			if (filter_quantity_ == signal->quantity()) {
+				found = true;
+				break;
 			}
-			if (!found)
-				continue;
 		}
+		if (!found) {
+			// Add the channel, when it gets a signal with the quantity.
+			connect(channel.get(), &sv::channels::BaseChannel::signal_added,
+				this, &ChannelComboBox::on_signal_added, Qt::UniqueConnection);
+			return;
+		}
+	}
+
+	this->addItem(
+		QString::fromStdString(channel->name()),
+		QVariant::fromValue(channel));
+}
 
-		this->addItem(
-			QString::fromStdString(ch->name()),
-			QVariant::fromValue(ch));
+int ChannelComboBox::find_channel(
+	shared_ptr<sv::channels::BaseChannel> channel) const
+{
+	for (int i = 0; i < this->count(); ++i) {
+		QVariant data = this->itemData(i, Qt::UserRole);
+		auto item_channel = data.value<shared_ptr<sv::channels::BaseChannel>>();
+		if (item_channel == channel)
+			return i;
 	}
+	return -1;
+}
+
+bool ChannelComboBox::is_in_channel_group(
+	shared_ptr<sv::channels::BaseChannel> channel) const
+{
+	return channel->parent_device() == device_ &&
+		channel->channel_group_names().count(
+			channel_group_name_.toStdString()) > 0;
 }
 
 void ChannelComboBox::change_device_channel_group(
 	shared_ptr<sv::devices::BaseDevice> device, QString channel_group_name)
 {
+	if (device_)
+		disconnect(device_.get(), nullptr, this, nullptr);
 	device_ = device;
 	channel_group_name_ = channel_group_name;
 	this->fill_channels();
 }
 
+void ChannelComboBox::on_channel_added(
+	shared_ptr<sv::channels::BaseChannel> channel)
+{
+	if (device_ && is_in_channel_group(channel))
+		add_channel(channel);
+}
+
+void ChannelComboBox::on_signal_added(
+	shared_ptr<sv::data::BaseSignal> signal)
+{
+	auto channel = signal->parent_channel();
+	if (device_ && channel && is_in_channel_group(channel))
+		add_channel(channel);
+}
+
 } // namespace devices
 } // namespace ui
 } // namespace sv
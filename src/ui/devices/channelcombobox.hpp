@@ -35,6 +35,9 @@ namespace sv {
 namespace channels {
 class BaseChannel;
 }
+namespace data {
+class BaseSignal;
+}
 namespace devices {
 class BaseDevice;
 }
@@ -42,6 +45,10 @@ class BaseDevice;
 namespace ui {
 namespace devices {
 
+/**
+ * The ChannelComboBox lists the channels of a channel group. Channels, that
+ * are added later, are appended incrementally.
+ */
 class ChannelComboBox : public QComboBox
 {
 	Q_OBJECT
@@ -58,6 +65,10 @@ public:
 private:
 	void setup_ui();
 	void fill_channels();
+	void add_channel(shared_ptr<sv::channels::BaseChannel> channel);
+	int find_channel(shared_ptr<sv::channels::BaseChannel> channel) const;
+	bool is_in_channel_group(
+		shared_ptr<sv::channels::BaseChannel> channel) const;
 
 	shared_ptr<sv::devices::BaseDevice> device_;
 	QString channel_group_name_;
@@ -68,6 +79,10 @@ public Q_SLOTS:
 	void change_device_channel_group(
 		shared_ptr<sv::devices::BaseDevice>, QString);
 
+private Q_SLOTS:
+	void on_channel_added(shared_ptr<sv::channels::BaseChannel> channel);
+	void on_signal_added(shared_ptr<sv::data::BaseSignal> signal);
+
 };
 
 } // namespace devices
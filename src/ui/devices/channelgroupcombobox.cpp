@@ -72,7 +72,8 @@ void ChannelGroupComboBox::fill_channel_groups()
 	if (device_ == nullptr)
 		return;
 
-	for (const auto &chg_pair : device_->channel_group_map()) {
+	const auto channel_group_map = device_->channel_group_map();
+	for (const auto &chg_pair : *channel_group_map) {
 		this->addItem(QString::fromStdString(chg_pair.first));
 	}
 }
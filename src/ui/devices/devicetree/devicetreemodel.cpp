@@ -31,12 +31,16 @@
 #include "devicetreemodel.hpp"
 #include "src/session.hpp"
 #include "src/data/properties/baseproperty.hpp"
+#include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/signalregistry.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/configurable.hpp"
 #include "src/channels/basechannel.hpp"
+#include "src/channels/mathchannel.hpp"
 #include "src/ui/devices/devicetree/treeitem.hpp"
 
+using std::dynamic_pointer_cast;
 using std::set;
 using std::shared_ptr;
 using std::string;
@@ -67,6 +71,33 @@ DeviceTreeModel::DeviceTreeModel(const Session &session,
 	setup_model();
 }
 
+QVariant DeviceTreeModel::data(const QModelIndex &index, int role) const
+{
+	if (role != Qt::ToolTipRole)
+		return QStandardItemModel::data(index, role);
+
+	QStandardItem *item = itemFromIndex(index);
+	if (!item || item->type() != (int)TreeItemType::SignalItem)
+		return QStandardItemModel::data(index, role);
+
+	// Calculated on demand, so the tool tip is always up to date.
+	auto signal = dynamic_pointer_cast<sv::data::AnalogTimeSignal>(
+		item->data(DeviceTreeModel::DataRole).
+			value<shared_ptr<sv::data::BaseSignal>>());
+	if (!signal)
+		return QStandardItemModel::data(index, role);
+
+	const double mib = 1024. * 1024.;
+	QString tool_tip = tr("%1\n%2 samples (%3), %4 MiB in memory").
+		arg(signal->display_name()).arg(signal->sample_count()).
+		arg(signal->is_single_precision() ? tr("float") : tr("double")).
+		arg(signal->memory_size() / mib, 0, 'f', 1);
+	if (signal->spilled_size() > 0)
+		tool_tip += tr(", %1 MiB on disk").
+			arg(signal->spilled_size() / mib, 0, 'f', 1);
+	return tool_tip;
+}
+
 void DeviceTreeModel::setup_model()
 {
 	std::lock_guard<std::recursive_mutex> lock(mutex_);
@@ -79,6 +110,12 @@ void DeviceTreeModel::setup_model()
 	connect(
 		&session_, SIGNAL(device_removed(shared_ptr<sv::devices::BaseDevice>)),
 		this, SLOT(on_device_removed(shared_ptr<sv::devices::BaseDevice>)));
+	// The signals are added and removed incrementally by the registry.
+	auto registry = session_.signal_registry();
+	connect(registry.get(), &sv::data::SignalRegistry::signal_registered,
+		this, &DeviceTreeModel::on_signal_registered);
+	connect(registry.get(), &sv::data::SignalRegistry::signal_unregistered,
+		this, &DeviceTreeModel::on_signal_unregistered);
 
 	for (const auto &device_pair : session_.devices()) {
 		shared_ptr<sv::devices::BaseDevice> device = device_pair.second;
@@ -119,7 +156,8 @@ void DeviceTreeModel::add_device(shared_ptr<sv::devices::BaseDevice> device)
 	}
 
 	// Channels and ChannelGroups
-	for (const auto &channel_pair : device->channel_map()) {
+	const auto channel_map = device->channel_map();
+	for (const auto &channel_pair : *channel_map) {
 		add_channel(channel_pair.second,
 			channel_pair.second->channel_group_names(), device_item);
 	}
@@ -166,11 +204,11 @@ void DeviceTreeModel::add_channel(shared_ptr<channels::BaseChannel> channel,
 	std::lock_guard<std::recursive_mutex> lock(mutex_);
 
 	// Find existing channel in all channel groups
-	if (!find_channel(channel, channel->channel_group_names(), parent_item)) {
+	if (!find_channel(channel, channel->channel_group_names(), parent_item) &&
+			channel->type() == channels::ChannelType::MathChannel) {
 		connect(
-			channel.get(),
-			SIGNAL(signal_added(shared_ptr<sv::data::BaseSignal>)),
-			this, SLOT(on_signal_added(shared_ptr<sv::data::BaseSignal>)));
+			channel.get(), SIGNAL(backfill_progress_changed(int)),
+			this, SLOT(on_backfill_progress_changed(int)));
 	}
 
 	for (const auto &chg_name : channel_group_names) {
@@ -194,11 +232,11 @@ void DeviceTreeModel::add_channel(shared_ptr<channels::BaseChannel> channel,
 			new_parent_item->sortChildren(0);
 		}
 
-		// Signals
-		for (const auto &signal_pair : channel->signal_map()) {
-			for (const auto &signal : signal_pair.second) {
-				add_signal(signal, channel_item);
-			}
+		// Signals, the signals added later are added by
+		// on_signal_registered().
+		const auto signals = channel->signals();
+		for (const auto &signal : *signals) {
+			add_signal(signal, channel_item);
 		}
 	}
 }
@@ -436,16 +474,81 @@ void DeviceTreeModel::on_channel_removed(
 	std::lock_guard<std::recursive_mutex> lock(mutex_);
 }
 
-void DeviceTreeModel::on_signal_added(shared_ptr<sv::data::BaseSignal> signal)
+void DeviceTreeModel::on_signal_registered(sv::data::signal_id_t id,
+	shared_ptr<sv::data::BaseSignal> signal)
+{
+	(void)id;
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+	shared_ptr<sv::channels::BaseChannel> channel = signal->parent_channel();
+	if (!channel)
+		return;
+	TreeItem *device_item = find_device(channel->parent_device());
+	if (!device_item)
+		return;
+
+	for (const auto &chg_name : channel->channel_group_names()) {
+		set<string> chg_names { chg_name };
+		TreeItem *channel_item = find_channel(channel, chg_names, device_item);
+		if (!channel_item) {
+			// The channel_added() signal of the device is not yet delivered,
+			// add the channel with all its signals.
+			add_channel(channel, channel->channel_group_names(), device_item);
+			return;
+		}
+		add_signal(signal, channel_item);
+	}
+}
+
+void DeviceTreeModel::on_signal_unregistered(sv::data::signal_id_t id,
+	shared_ptr<sv::data::BaseSignal> signal)
 {
+	(void)id;
+	std::lock_guard<std::recursive_mutex> lock(mutex_);
+
 	shared_ptr<sv::channels::BaseChannel> channel = signal->parent_channel();
-	on_channel_added(channel);
+	if (!channel)
+		return;
+	TreeItem *device_item = find_device(channel->parent_device());
+	if (!device_item)
+		return;
+
+	for (const auto &chg_name : channel->channel_group_names()) {
+		set<string> chg_names { chg_name };
+		TreeItem *channel_item = find_channel(channel, chg_names, device_item);
+		if (!channel_item)
+			continue;
+		TreeItem *signal_item = find_signal(signal, channel_item);
+		if (signal_item)
+			removeRow(signal_item->row(), channel_item->index());
+	}
 }
 
-void DeviceTreeModel::on_signal_removed(shared_ptr<sv::data::BaseSignal> signal)
+void DeviceTreeModel::on_backfill_progress_changed(int progress)
 {
-	(void)signal;
+	auto math_channel = qobject_cast<sv::channels::MathChannel *>(sender());
+	if (!math_channel)
+		return;
+
 	std::lock_guard<std::recursive_mutex> lock(mutex_);
+
+	shared_ptr<sv::channels::BaseChannel> channel =
+		math_channel->shared_from_this();
+	TreeItem *device_item = find_device(channel->parent_device());
+	if (!device_item)
+		return;
+
+	// Show the progress of the calculation of the existing samples
+	QString text = QString::fromStdString(channel->name());
+	if (progress < 100)
+		text = tr("%1 (calculating %2%)").arg(text).arg(progress);
+
+	for (const auto &chg_name : channel->channel_group_names()) {
+		set<string> chg_names { chg_name };
+		TreeItem *channel_item = find_channel(channel, chg_names, device_item);
+		if (channel_item)
+			channel_item->setText(text);
+	}
 }
 
 } // namespace devicetree
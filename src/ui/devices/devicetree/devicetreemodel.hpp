@@ -28,6 +28,9 @@
 
 #include <QStandardItem>
 #include <QStandardItemModel>
+#include <QVariant>
+
+#include "src/data/signalregistry.hpp"
 
 using std::set;
 using std::shared_ptr;
@@ -71,6 +74,12 @@ public:
 
 	TreeItem *find_device(shared_ptr<sv::devices::BaseDevice> device) const;
 
+	/**
+	 * The tool tip of a signal item shows the memory usage of the signal.
+	 */
+	QVariant data(const QModelIndex &index,
+		int role = Qt::DisplayRole) const override;
+
 	const static int DataRole = Qt::UserRole + 1;
 	const static int SortRole = Qt::UserRole + 2;
 
@@ -117,8 +126,11 @@ private Q_SLOTS:
 	void on_device_removed(shared_ptr<sv::devices::BaseDevice> device);
 	void on_channel_added(shared_ptr<sv::channels::BaseChannel> channel);
 	void on_channel_removed(shared_ptr<sv::channels::BaseChannel> channel);
-	void on_signal_added(shared_ptr<sv::data::BaseSignal> signal);
-	void on_signal_removed(shared_ptr<sv::data::BaseSignal> signal);
+	void on_signal_registered(sv::data::signal_id_t id,
+		shared_ptr<sv::data::BaseSignal> signal);
+	void on_signal_unregistered(sv::data::signal_id_t id,
+		shared_ptr<sv::data::BaseSignal> signal);
+	void on_backfill_progress_changed(int progress);
 
 };
 
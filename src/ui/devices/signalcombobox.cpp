@@ -86,22 +86,45 @@ void SignalComboBox::fill_signals()
 	if (channel_ == nullptr)
 		return;
 
-	for (const auto &signal_pair : channel_->signal_map()) {
-		for (const auto &signal : signal_pair.second) {
-			if (filter_active_ && filter_quantity_ != signal->quantity())
-				continue;
-			this->addItem(signal->display_name(), QVariant::fromValue(signal));
-		}
+	// Signals, that are added later, are appended by on_signal_added().
+	connect(channel_.get(), &sv::channels::BaseChannel::signal_added,
+		this, &SignalComboBox::on_signal_added, Qt::UniqueConnection);
+
+	const auto signal_map = channel_->signal_map();
+	for (const auto &signal_pair : *signal_map) {
+		for (const auto &signal : signal_pair.second)
+			add_signal(signal);
+	}
+}
+
+void SignalComboBox::add_signal(shared_ptr<sv::data::BaseSignal> signal)
+{
+	if (filter_active_ && filter_quantity_ != signal->quantity())
+		return;
+
+	for (int i = 0; i < this->count(); ++i) {
+		QVariant data = this->itemData(i, Qt::UserRole);
+		if (data.value<shared_ptr<sv::data::BaseSignal>>() == signal)
+			return;
 	}
+	this->addItem(signal->display_name(), QVariant::fromValue(signal));
 }
 
 void SignalComboBox::change_channel(
 	shared_ptr<sv::channels::BaseChannel> channel)
 {
+	if (channel_)
+		disconnect(channel_.get(), nullptr, this, nullptr);
 	channel_ = channel;
 	this->fill_signals();
 }
 
+void SignalComboBox::on_signal_added(shared_ptr<sv::data::BaseSignal> signal)
+{
+	if (channel_ && signal->parent_channel() == channel_)
+		add_signal(signal);
+}
+
 } // namespace devices
 } // namespace ui
 } // namespace sv
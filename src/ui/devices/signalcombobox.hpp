@@ -41,6 +41,10 @@ class BaseSignal;
 namespace ui {
 namespace devices {
 
+/**
+ * The SignalComboBox lists the signals of a channel. Signals, that are added
+ * later, are appended incrementally.
+ */
 class SignalComboBox : public QComboBox
 {
 	Q_OBJECT
@@ -57,6 +61,7 @@ public:
 private:
 	void setup_ui();
 	void fill_signals();
+	void add_signal(shared_ptr<sv::data::BaseSignal> signal);
 
 	shared_ptr<sv::channels::BaseChannel> channel_;
 	bool filter_active_;
@@ -66,6 +71,9 @@ private:
 public Q_SLOTS:
 	void change_channel(shared_ptr<sv::channels::BaseChannel>);
 
+private Q_SLOTS:
+	void on_signal_added(shared_ptr<sv::data::BaseSignal> signal);
+
 };
 
 } // namespace devices
@@ -19,6 +19,7 @@
 
 #include <memory>
 #include <set>
+#include <vector>
 
 #include <QDebug>
 #include <QGroupBox>
@@ -41,14 +42,18 @@
 #include "src/ui/devices/devicetree/devicetreeview.hpp"
 #include "src/ui/views/baseview.hpp"
 #include "src/ui/views/dataview.hpp"
+#include "src/ui/views/histogramview.hpp"
 #include "src/ui/views/plotview.hpp"
 #include "src/ui/views/powerpanelview.hpp"
 #include "src/ui/views/sequenceoutputview.hpp"
+#include "src/ui/views/spectrumview.hpp"
+#include "src/ui/views/sweepview.hpp"
 #include "src/ui/views/valuepanelview.hpp"
 #include "src/ui/views/viewhelper.hpp"
 
 using std::set;
 using std::static_pointer_cast;
+using std::vector;
 
 Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
 
@@ -87,6 +92,9 @@ void AddViewDialog::setup_ui()
 	this->setup_ui_xy_plot_tab();
 	this->setup_ui_data_table_tab();
 	this->setup_ui_power_panel_tab();
+	this->setup_ui_spectrum_tab();
+	this->setup_ui_histogram_tab();
+	this->setup_ui_sweep_tab();
 	tab_widget_->setCurrentIndex(selected_tab_);
 	main_layout->addWidget(tab_widget_);
 
@@ -228,6 +236,63 @@ void AddViewDialog::setup_ui_power_panel_tab()
 	tab_widget_->addTab(pp_widget, title);
 }
 
+void AddViewDialog::setup_ui_spectrum_tab()
+{
+	QString title(tr("Spectrum"));
+	QWidget *spectrum_widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+	spectrum_widget->setLayout(layout);
+
+	spectrum_signal_tree_ = new ui::devices::devicetree::DeviceTreeView(
+		session_, false, false, false, true, false, false, false, false);
+	spectrum_signal_tree_->expand_device(device_);
+
+	layout->addWidget(spectrum_signal_tree_);
+
+	tab_widget_->addTab(spectrum_widget, title);
+}
+
+void AddViewDialog::setup_ui_histogram_tab()
+{
+	QString title(tr("Histogram"));
+	QWidget *histogram_widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+	histogram_widget->setLayout(layout);
+
+	histogram_signal_tree_ = new ui::devices::devicetree::DeviceTreeView(
+		session_, false, false, false, true, false, false, false, false);
+	histogram_signal_tree_->expand_device(device_);
+
+	layout->addWidget(histogram_signal_tree_);
+
+	tab_widget_->addTab(histogram_widget, title);
+}
+
+void AddViewDialog::setup_ui_sweep_tab()
+{
+	QString title(tr("Sweep"));
+	QWidget *sweep_widget = new QWidget();
+	QVBoxLayout *layout = new QVBoxLayout();
+	sweep_widget->setLayout(layout);
+
+	sweep_property_form_ = new ui::devices::SelectPropertyForm(session_);
+	sweep_property_form_->select_device(device_);
+	sweep_property_form_->filter_config_keys(set<sv::data::DataType>{
+		sv::data::DataType::Double});
+	layout->addLayout(sweep_property_form_);
+
+	QGroupBox *signal_group = new QGroupBox(tr("Measurement signals"));
+	QVBoxLayout *signal_layout = new QVBoxLayout();
+	sweep_signal_tree_ = new ui::devices::devicetree::DeviceTreeView(
+		session_, false, false, false, true, false, false, false, false);
+	sweep_signal_tree_->expand_device(device_);
+	signal_layout->addWidget(sweep_signal_tree_);
+	signal_group->setLayout(signal_layout);
+	layout->addWidget(signal_group);
+
+	tab_widget_->addTab(sweep_widget, title);
+}
+
 vector<ui::views::BaseView *> AddViewDialog::views()
 {
 	return views_;
@@ -314,6 +379,37 @@ void AddViewDialog::accept()
 			}
 		}
 		break;
+	case 7:
+		// Add spectrum views
+		for (const auto &signal : spectrum_signal_tree_->checked_signals()) {
+			views_.push_back(new ui::views::SpectrumView(session_,
+				static_pointer_cast<data::AnalogTimeSignal>(signal)));
+		}
+		break;
+	case 8:
+		// Add histogram views
+		for (const auto &signal : histogram_signal_tree_->checked_signals()) {
+			views_.push_back(new ui::views::HistogramView(session_,
+				static_pointer_cast<data::AnalogTimeSignal>(signal)));
+		}
+		break;
+	case 9:
+		// Add sweep view for property
+		{
+			auto property = sweep_property_form_->selected_property();
+			if (property == nullptr)
+				break;
+			vector<shared_ptr<data::AnalogTimeSignal>> signals;
+			for (const auto &signal : sweep_signal_tree_->checked_signals()) {
+				signals.push_back(
+					static_pointer_cast<data::AnalogTimeSignal>(signal));
+			}
+			views_.push_back(new ui::views::SweepView(session_,
+				static_pointer_cast<sv::data::properties::DoubleProperty>(
+					property),
+				signals));
+		}
+		break;
 	default:
 		break;
 	}
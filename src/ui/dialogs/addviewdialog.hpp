@@ -74,6 +74,9 @@ private:
 	void setup_ui_xy_plot_tab();
 	void setup_ui_data_table_tab();
 	void setup_ui_power_panel_tab();
+	void setup_ui_spectrum_tab();
+	void setup_ui_histogram_tab();
+	void setup_ui_sweep_tab();
 
 	Session &session_;
 	const shared_ptr<sv::devices::BaseDevice> device_;
@@ -90,6 +93,10 @@ private:
 	ui::devices::devicetree::DeviceTreeView *data_table_signal_tree_;
 	ui::devices::SelectSignalWidget *ppanel_voltage_signal_widget_;
 	ui::devices::SelectSignalWidget *ppanel_current_signal_widget_;
+	ui::devices::devicetree::DeviceTreeView *spectrum_signal_tree_;
+	ui::devices::devicetree::DeviceTreeView *histogram_signal_tree_;
+	ui::devices::SelectPropertyForm *sweep_property_form_;
+	ui::devices::devicetree::DeviceTreeView *sweep_signal_tree_;
 	QDialogButtonBox *button_box_;
 
 public Q_SLOTS:
@@ -251,12 +251,12 @@ void GenerateWaveformDialog::setup_ui()
 	this->setLayout(layout);
 }
 
-vector<double> GenerateWaveformDialog::sequence_values() const
+const vector<double> &GenerateWaveformDialog::sequence_values() const
 {
 	return sequence_values_;
 }
 
-vector<double> GenerateWaveformDialog::sequence_delays() const
+const vector<double> &GenerateWaveformDialog::sequence_delays() const
 {
 	return sequence_delays_;
 }
@@ -282,6 +282,11 @@ void GenerateWaveformDialog::accept()
 	double omega = 2 * pi * frequency;
 
 	WaveformType w_type = waveform_box_->currentData().value<WaveformType>();
+	sequence_values_.clear();
+	sequence_delays_.clear();
+	size_t sample_count = (size_t)std::ceil(periode / interval);
+	sequence_values_.reserve(sample_count);
+	sequence_delays_.reserve(sample_count);
 	for (double t=0; t<periode; t+=interval) {
 		double x = omega * t + phi;
 		double value;
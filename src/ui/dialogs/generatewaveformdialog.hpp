@@ -63,8 +63,8 @@ public:
 		shared_ptr<sv::data::properties::DoubleProperty> property,
 		QWidget *parent = nullptr);
 
-	vector<double> sequence_values() const;
-	vector<double> sequence_delays() const;
+	const vector<double> &sequence_values() const;
+	const vector<double> &sequence_delays() const;
 
 private:
 	void setup_ui();
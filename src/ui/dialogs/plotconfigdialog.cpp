@@ -37,6 +37,7 @@
 #include "src/ui/widgets/plot/plot.hpp"
 
 Q_DECLARE_METATYPE(sv::ui::widgets::plot::PlotUpdateMode)
+Q_DECLARE_METATYPE(sv::ui::widgets::plot::XYRenderMode)
 
 namespace sv {
 namespace ui {
@@ -67,6 +68,9 @@ void PlotConfigDialog::setup_ui()
 	if (plot_type_ == views::PlotType::TimePlot) {
 		this->setup_ui_plot_mode_tab();
 	}
+	else {
+		this->setup_ui_render_mode_tab();
+	}
 	this->setup_ui_markers_tab();
 	//this->setup_ui_style_tab();
 	tab_widget_->setCurrentIndex(0);
@@ -129,6 +133,31 @@ void PlotConfigDialog::setup_ui_plot_mode_tab()
 	tab_widget_->addTab(widget, title);
 }
 
+void PlotConfigDialog::setup_ui_render_mode_tab()
+{
+	QString title(tr("Render mode"));
+
+	QWidget *widget = new QWidget();
+	QFormLayout *layout = new QFormLayout();
+
+	xy_render_mode_combobox_ = new QComboBox();
+	size_t cb_index = 0;
+	for (const auto &render_mode_pair : widgets::plot::xy_render_mode_name_map) {
+		xy_render_mode_combobox_->addItem(
+			render_mode_pair.second,
+			QVariant::fromValue(render_mode_pair.first));
+		if (plot_->xy_render_mode() == render_mode_pair.first)
+			xy_render_mode_combobox_->setCurrentIndex(cb_index);
+		++cb_index;
+	}
+	xy_render_mode_combobox_->setToolTip(
+		tr("The density mode paints dense point clouds as a density image"));
+	layout->addRow(tr("Render mode"), xy_render_mode_combobox_);
+
+	widget->setLayout(layout);
+	tab_widget_->addTab(widget, title);
+}
+
 void PlotConfigDialog::setup_ui_markers_tab()
 {
 	QString title(tr("Markers"));
@@ -228,6 +257,13 @@ void PlotConfigDialog::accept()
 				update_mode == widgets::plot::PlotUpdateMode::Rolling)
 			plot_->set_add_time(add_time_edit_->text().toDouble());
 	}
+	else {
+		QVariant render_mode_var = xy_render_mode_combobox_->currentData();
+		sv::ui::widgets::plot::XYRenderMode xy_render_mode =
+			render_mode_var.value<sv::ui::widgets::plot::XYRenderMode>();
+		if (xy_render_mode != plot_->xy_render_mode())
+			plot_->set_xy_render_mode(xy_render_mode);
+	}
 
 	plot_->set_markers_label_alignment(
 		markers_box_pos_combobox_->currentData().toInt());
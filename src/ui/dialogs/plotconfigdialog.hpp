@@ -48,6 +48,7 @@ public:
 private:
 	void setup_ui();
 	void setup_ui_plot_mode_tab();
+	void setup_ui_render_mode_tab();
 	void setup_ui_markers_tab();
 	void setup_ui_style_tab();
 	void setup_ui_additive();
@@ -60,6 +61,7 @@ private:
 	QComboBox *plot_update_mode_combobox_;
 	QLineEdit *time_span_edit_;
 	QLineEdit *add_time_edit_;
+	QComboBox *xy_render_mode_combobox_;
 	QComboBox *markers_box_pos_combobox_;
 	QDialogButtonBox *button_box_;
 
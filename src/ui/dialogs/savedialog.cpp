@@ -17,8 +17,7 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <iostream>
-#include <fstream>
+#include <algorithm>
 #include <memory>
 #include <string>
 
@@ -31,16 +30,15 @@
 #include <QVBoxLayout>
 
 #include "savedialog.hpp"
-#include "src/util.hpp"
-#include "src/channels/basechannel.hpp"
-#include "src/data/analogtimesignal.hpp"
 #include "src/data/basesignal.hpp"
+#include "src/data/csvexport.hpp"
+#include "src/data/decimator.hpp"
+#include "src/data/resampler.hpp"
+#include "src/data/signalregistry.hpp"
 #include "src/devices/basedevice.hpp"
 #include "src/devices/hardwaredevice.hpp"
 #include "src/ui/devices/devicetree/devicetreeview.hpp"
 
-using std::dynamic_pointer_cast;
-using std::ofstream;
 using std::string;
 
 Q_DECLARE_SMART_POINTER_METATYPE(std::shared_ptr)
@@ -74,7 +72,7 @@ void SaveDialog::setup_ui()
 	device_tree_ = new ui::devices::devicetree::DeviceTreeView(
 		session_, false, false, false, true, false, false, false, false);
 	device_tree_->expand_device(selected_device_);
-	device_tree_->check_signals(selected_device_->signals());
+	device_tree_->check_signals(*selected_device_->signals());
 	main_layout->addWidget(device_tree_);
 
 	QFormLayout *form_layout = new QFormLayout();
@@ -82,6 +80,50 @@ void SaveDialog::setup_ui()
 	timestamps_combined_ = new QCheckBox(tr("Combine all time stamps"));
 	form_layout->addRow("", timestamps_combined_);
 
+	resample_mode_box_ = new QComboBox();
+	resample_mode_box_->addItem(tr("No resampling"));
+	for (const auto &mode_pair : data::resample_mode_name_map) {
+		resample_mode_box_->addItem(
+			mode_pair.second, QVariant::fromValue((int)mode_pair.first));
+	}
+	form_layout->addRow(tr("Resample"), resample_mode_box_);
+
+	resample_interval_box_ = new QDoubleSpinBox();
+	resample_interval_box_->setDecimals(6);
+	resample_interval_box_->setRange(0.000001, 86400.);
+	resample_interval_box_->setValue(1.);
+	resample_interval_box_->setSuffix(" s");
+	form_layout->addRow(tr("Resample interval"), resample_interval_box_);
+	connect(resample_mode_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_mode_changed()));
+
+	decimation_mode_box_ = new QComboBox();
+	decimation_mode_box_->addItem(tr("No decimation"));
+	for (const auto &mode_pair : data::decimation_mode_name_map) {
+		decimation_mode_box_->addItem(
+			mode_pair.second, QVariant::fromValue((int)mode_pair.first));
+	}
+	form_layout->addRow(tr("Decimate"), decimation_mode_box_);
+
+	decimation_points_box_ = new QSpinBox();
+	decimation_points_box_->setRange(10, 100000000);
+	decimation_points_box_->setValue(10000);
+	form_layout->addRow(tr("Points per signal"), decimation_points_box_);
+
+	// A bucket width of 0 ("Auto") uses the number of points.
+	decimation_bucket_box_ = new QDoubleSpinBox();
+	decimation_bucket_box_->setDecimals(6);
+	decimation_bucket_box_->setRange(0., 86400.);
+	decimation_bucket_box_->setValue(0.);
+	decimation_bucket_box_->setSuffix(" s");
+	decimation_bucket_box_->setSpecialValueText(tr("Auto"));
+	form_layout->addRow(tr("Bucket width"), decimation_bucket_box_);
+	connect(decimation_mode_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_mode_changed()));
+	connect(decimation_bucket_box_, SIGNAL(valueChanged(double)),
+		this, SLOT(on_mode_changed()));
+	on_mode_changed();
+
 	time_absolut_ = new QCheckBox(tr("Absolut time"));
 	form_layout->addRow("", time_absolut_);
 
@@ -100,240 +142,66 @@ void SaveDialog::setup_ui()
 	this->setLayout(main_layout);
 }
 
-void SaveDialog::save(QString file_name)
+void SaveDialog::accept()
 {
-	ofstream output_file;
-	string str_file_name = file_name.toStdString();
-	vector<size_t> sample_counts;
-
-	output_file.open(str_file_name);
-
-	auto signals = device_tree_->checked_signals();
-	bool relative_time = !time_absolut_->isChecked();
-	string sep = separator_edit_->text().toStdString();
-	size_t max_sample_count = 0;
-
-	// Header
-	string start_sep("");
-	string device_header_line("");
-	string chg_name_header_line("");
-	string ch_name_header_line("");
-	string signal_name_header_line("");
-	for (const auto &signal : signals) {
-		// Only handle AnalogSignals
-		auto analog_signal =
-			dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-		if (!analog_signal)
-			continue;
-
-		size_t sample_count = analog_signal->sample_count();
-		if (sample_count > max_sample_count)
-			max_sample_count = sample_count;
-		sample_counts.push_back(sample_count);
-
-		string name = analog_signal->name();
-		shared_ptr<sv::channels::BaseChannel> parent_channel =
-			analog_signal->parent_channel();
-
-		qWarning() << "SaveDialog::save(): signal.name() = " <<
-			QString::fromStdString(name);
-		qWarning() << "SaveDialog::save(): signal.parent_channel().name() = " <<
-			QString::fromStdString(parent_channel->name());
-		qWarning() << "SaveDialog::save(): signal.parent_channel().parent_device().name() = " <<
-			QString::fromStdString(parent_channel->parent_device()->name());
+	// Get file name
+	QString file_name = QFileDialog::getSaveFileName(this,
+		tr("Save CSV-File"), QDir::homePath(), tr("CSV Files (*.csv)"));
 
-		string chg_names("");
-		string chg_sep("");
-		for (const auto &chg_name : parent_channel->channel_group_names()) {
-			chg_names += chg_sep;
-			if (chg_name.empty())
-				chg_names += "\"\"";
-			else
-				chg_names += chg_name;
-			chg_sep = ", ";
+	if (file_name.length() > 0) {
+		// Export the signals in the order they were created, like the
+		// headless mode does.
+		auto signals = device_tree_->checked_signals();
+		auto registry = session_.signal_registry();
+		std::stable_sort(signals.begin(), signals.end(),
+			[&registry](const shared_ptr<data::BaseSignal> &signal1,
+					const shared_ptr<data::BaseSignal> &signal2) {
+				return registry->signal_id(signal1) <
+					registry->signal_id(signal2);
+			});
+		bool relative_time = !time_absolut_->isChecked();
+		string sep = separator_edit_->text().toStdString();
+		QVariant resample_mode = resample_mode_box_->currentData();
+		QVariant decimation_mode = decimation_mode_box_->currentData();
+		if (decimation_mode.isValid()) {
+			data::csvexport::save_decimated(
+				file_name.toStdString(), signals, relative_time, sep,
+				(data::DecimationMode)decimation_mode.toInt(),
+				(size_t)decimation_points_box_->value(),
+				decimation_bucket_box_->value());
 		}
-
-		device_header_line += start_sep + parent_channel->parent_device()->name(); // Time
-		device_header_line += sep + parent_channel->parent_device()->name(); // Value
-		chg_name_header_line += start_sep + chg_names; // Time
-		chg_name_header_line += sep + chg_names; // Value
-		ch_name_header_line += start_sep + parent_channel->name(); // Time
-		ch_name_header_line += sep + parent_channel->name(); // Value
-		signal_name_header_line += start_sep + "Time " + name; // Time
-		signal_name_header_line += sep + name; // Value
-
-		start_sep = sep;
-	}
-	output_file << device_header_line << std::endl;
-	output_file << chg_name_header_line << std::endl;
-	output_file << ch_name_header_line << std::endl;
-	output_file << signal_name_header_line << std::endl;
-
-	// Data
-	// TODO: we asume here, that the vector size is the same for all vectors....
-	for (size_t i = 0; i < max_sample_count; i++) {
-		start_sep = "";
-		QString line("");
-		int j = 0;
-		for (const auto &signal : signals) {
-			// Only handle AnalogSignals
-			auto analog_signal =
-				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-			if (!analog_signal)
-				continue;
-
-			QString time("");
-			QString value("");
-
-			size_t sample_count = sample_counts[j];
-			if (i < sample_count-1) {
-				// More samples for this signal
-				auto sample = analog_signal->get_sample(i, relative_time);
-				value = QString("%1").arg(sample.second);
-				if (relative_time)
-					time = QString("%1").arg(sample.first);
-				else
-					time = util::format_time_date(sample.first);
-			}
-
-			line.append(QString("%1%2%3%4").
-				arg(QString::fromStdString(start_sep)).arg(time).
-				arg(QString::fromStdString(sep)).arg(value));
-			start_sep = sep;
-
-			++j;
+		else if (resample_mode.isValid()) {
+			data::csvexport::save_resampled(
+				file_name.toStdString(), signals, relative_time, sep,
+				(data::ResampleMode)resample_mode.toInt(),
+				resample_interval_box_->value());
 		}
-		output_file << line.toStdString() << std::endl;
-	}
-
-	output_file.close();
-}
-
-void SaveDialog::save_combined(QString file_name)
-{
-	ofstream output_file;
-	string str_file_name = file_name.toStdString();
-	vector<size_t> sample_counts;
-	vector<size_t> sample_pos;
-
-	output_file.open(str_file_name);
-
-	auto signals = device_tree_->checked_signals();
-	bool relative_time = !time_absolut_->isChecked();
-	string sep = separator_edit_->text().toStdString();
-
-	// Header
-	string device_header_line("Time"); // Time
-	string chg_name_header_line("Time"); // Time
-	string ch_name_header_line("Time"); // Time
-	string signal_name_header_line("Time"); // Time
-	for (const auto &signal : signals) {
-		// Only handle AnalogSignals
-		auto analog_signal =
-			dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-		if (!analog_signal)
-			continue;
-
-		shared_ptr<sv::channels::BaseChannel> parent_channel =
-			analog_signal->parent_channel();
-
-		sample_counts.push_back(analog_signal->sample_count());
-		sample_pos.push_back(0);
-
-		string chg_names("");
-		string chg_sep("");
-		for (const auto &chg_name : parent_channel->channel_group_names()) {
-			chg_names += chg_sep;
-			if (chg_name.empty())
-				chg_names += "\"\"";
-			else
-				chg_names += chg_name;
-			chg_sep = ", ";
+		else if (timestamps_combined_->isChecked()) {
+			data::csvexport::save_combined(
+				file_name.toStdString(), signals, relative_time, sep);
 		}
-
-		device_header_line += sep + parent_channel->parent_device()->name(); // Value
-		chg_name_header_line += sep + chg_names; // Value
-		ch_name_header_line += sep + parent_channel->name(); // Value
-		signal_name_header_line += sep + analog_signal->name(); // Value
-	}
-	output_file << device_header_line << std::endl;
-	output_file << chg_name_header_line << std::endl;
-	output_file << ch_name_header_line << std::endl;
-	output_file << signal_name_header_line << std::endl;
-
-	// Data
-	while (true) {
-		double next_timestamp = -1;
-		int i = 0;
-		for (const auto &signal : signals) {
-			// Only handle AnalogSignals
-			auto analog_signal =
-				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-			if (!analog_signal)
-				continue;
-
-			if (sample_pos[i] >= sample_counts[i]-1)
-				continue;
-
-			double timestamp =
-				analog_signal->get_sample(sample_pos[i], relative_time).first;
-			if (next_timestamp < 0 || timestamp < next_timestamp)
-				next_timestamp = timestamp;
-
-			++i;
+		else {
+			data::csvexport::save(
+				file_name.toStdString(), signals, relative_time, sep);
 		}
 
-		if (next_timestamp < 0)
-			break;
-
-		// Timestamp
-		QString line;
-		if (relative_time)
-			line = QString("%1").arg(next_timestamp, 0, 'f', 4);
-		else
-			line = util::format_time_date(next_timestamp);
-
-		// Values
-		i = 0;
-		for (const auto &signal : signals) {
-			// Only handle AnalogSignals
-			auto analog_signal =
-				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
-			if (!analog_signal)
-				continue;
-
-			line.append(QString::fromStdString(sep));
-
-			auto sample =
-				analog_signal->get_sample(sample_pos[i], relative_time);
-			double timestamp = sample.first;
-			if (timestamp == next_timestamp) {
-				line.append(QString("%1").arg(sample.second, 0, 'g', -1));
-				++sample_pos[i];
-			}
-
-			++i;
-		}
-		output_file << line.toStdString() << std::endl;
+		QDialog::accept();
 	}
-
-	output_file.close();
 }
 
-void SaveDialog::accept()
+void SaveDialog::on_mode_changed()
 {
-	// Get file name
-	QString file_name = QFileDialog::getSaveFileName(this,
-		tr("Save CSV-File"), QDir::homePath(), tr("CSV Files (*.csv)"));
-
-	if (file_name.length() > 0) {
-		if (timestamps_combined_->isChecked())
-			save_combined(file_name);
-		else
-			save(file_name);
-
-		QDialog::accept();
-	}
+	// The resampled signals always share one time column, the decimated
+	// signals always have their own time columns.
+	bool resample = resample_mode_box_->currentData().isValid();
+	bool decimate = decimation_mode_box_->currentData().isValid();
+	resample_mode_box_->setEnabled(!decimate);
+	resample_interval_box_->setEnabled(resample && !decimate);
+	decimation_mode_box_->setEnabled(!resample);
+	decimation_points_box_->setEnabled(decimate && !resample &&
+		decimation_bucket_box_->value() <= 0.);
+	decimation_bucket_box_->setEnabled(decimate && !resample);
+	timestamps_combined_->setEnabled(!resample && !decimate);
 }
 
 } // namespace dialogs
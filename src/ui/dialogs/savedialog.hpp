@@ -24,9 +24,12 @@
 #include <vector>
 
 #include <QCheckBox>
+#include <QComboBox>
 #include <QDialog>
 #include <QDialogButtonBox>
+#include <QDoubleSpinBox>
 #include <QLineEdit>
+#include <QSpinBox>
 #include <QString>
 #include <QTreeWidget>
 
@@ -62,14 +65,17 @@ public:
 
 private:
 	void setup_ui();
-	void save(QString file_name);
-	void save_combined(QString file_name);
 
 	const Session &session_;
 	const shared_ptr<sv::devices::BaseDevice> selected_device_;
 
 	ui::devices::devicetree::DeviceTreeView *device_tree_;
 	QCheckBox *timestamps_combined_;
+	QComboBox *resample_mode_box_;
+	QDoubleSpinBox *resample_interval_box_;
+	QComboBox *decimation_mode_box_;
+	QSpinBox *decimation_points_box_;
+	QDoubleSpinBox *decimation_bucket_box_;
 	QCheckBox *time_absolut_;
 	QLineEdit *separator_edit_;
 	QDialogButtonBox *button_box_;
@@ -77,6 +83,9 @@ private:
 public Q_SLOTS:
 	void accept() override;
 
+private Q_SLOTS:
+	void on_mode_changed();
+
 };
 
 } // namespace dialogs
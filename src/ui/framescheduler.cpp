@@ -0,0 +1,185 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <memory>
+#include <vector>
+
+#include <QWidget>
+
+#include "framescheduler.hpp"
+
+using std::make_shared;
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace ui {
+
+constexpr double FrameScheduler::default_frame_rate;
+constexpr double FrameScheduler::min_frame_rate;
+
+FrameScheduler &FrameScheduler::instance()
+{
+	static FrameScheduler scheduler;
+	return scheduler;
+}
+
+FrameScheduler::FrameScheduler() :
+	frame_rate_(default_frame_rate),
+	interval_ms_(1000. / default_frame_rate),
+	last_frame_time_ms_(0.)
+{
+	timer_.setTimerType(Qt::PreciseTimer);
+	timer_.setInterval((int)interval_ms_);
+	connect(&timer_, SIGNAL(timeout()), this, SLOT(on_frame()));
+}
+
+void FrameScheduler::add_client(FrameClient *client, QWidget *widget)
+{
+	assert(client);
+	assert(widget);
+
+	for (const auto &c : clients_) {
+		if (c->client == client)
+			return;
+	}
+
+	auto c = make_shared<Client>();
+	c->client = client;
+	c->widget = widget;
+	c->update_count = 0;
+	c->skip_count = 0;
+	clients_.push_back(c);
+
+	if (!timer_.isActive())
+		timer_.start();
+}
+
+void FrameScheduler::remove_client(FrameClient *client)
+{
+	clients_.erase(std::remove_if(clients_.begin(), clients_.end(),
+		[client](const shared_ptr<Client> &c) { return c->client == client; }),
+		clients_.end());
+
+	// Don't wake up the GUI thread without clients.
+	if (clients_.empty())
+		timer_.stop();
+}
+
+void FrameScheduler::set_frame_rate(double frame_rate)
+{
+	frame_rate_ = std::max(frame_rate, min_frame_rate);
+	interval_ms_ = 1000. / frame_rate_;
+	timer_.setInterval((int)interval_ms_);
+}
+
+double FrameScheduler::frame_rate() const
+{
+	return frame_rate_;
+}
+
+double FrameScheduler::actual_frame_rate() const
+{
+	return 1000. / interval_ms_;
+}
+
+double FrameScheduler::last_frame_time() const
+{
+	return last_frame_time_ms_;
+}
+
+vector<FrameScheduler::ClientStats> FrameScheduler::client_stats() const
+{
+	vector<ClientStats> stats;
+	for (const auto &c : clients_) {
+		stats.push_back({ c->client->frame_client_name(),
+			is_visible(c->widget), c->update_count, c->skip_count,
+			&c->update_time });
+	}
+	return stats;
+}
+
+void FrameScheduler::reset_stats()
+{
+	for (const auto &c : clients_) {
+		c->update_count = 0;
+		c->skip_count = 0;
+		c->update_time.reset();
+	}
+}
+
+bool FrameScheduler::is_visible(QWidget *widget)
+{
+	// Hidden docks and inactive tabs are not visible.
+	if (!widget->isVisible())
+		return false;
+	if (widget->window()->isMinimized())
+		return false;
+	// Covered completely, e.g. by a floating dock.
+	return !widget->visibleRegion().isEmpty();
+}
+
+void FrameScheduler::adapt_interval(double frame_time_ms)
+{
+	const double min_interval_ms = 1000. / frame_rate_;
+	const double max_interval_ms = 1000. / min_frame_rate;
+	double interval_ms = interval_ms_;
+
+	// Leave at least half of the time to the rest of the GUI thread.
+	if (frame_time_ms > interval_ms_ * 0.5)
+		interval_ms = std::min(interval_ms_ * 1.5, max_interval_ms);
+	else if (frame_time_ms < interval_ms_ * 0.2)
+		interval_ms = std::max(interval_ms_ * 0.8, min_interval_ms);
+
+	if (interval_ms != interval_ms_) {
+		interval_ms_ = interval_ms;
+		timer_.setInterval((int)interval_ms_);
+	}
+}
+
+void FrameScheduler::on_frame()
+{
+	const auto frame_start = std::chrono::steady_clock::now();
+
+	// A client may be removed while another client is updated.
+	for (size_t i = 0; i < clients_.size(); ++i) {
+		shared_ptr<Client> c = clients_[i];
+		if (!is_visible(c->widget) || !c->client->has_frame_update()) {
+			++c->skip_count;
+			continue;
+		}
+
+		const auto start = std::chrono::steady_clock::now();
+		c->client->update_frame();
+		c->update_time.record(
+			std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now() - start).count());
+		++c->update_count;
+	}
+
+	last_frame_time_ms_ = std::chrono::duration<double, std::milli>(
+		std::chrono::steady_clock::now() - frame_start).count();
+	adapt_interval(last_frame_time_ms_);
+}
+
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,169 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_FRAMESCHEDULER_HPP
+#define UI_FRAMESCHEDULER_HPP
+
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include <QObject>
+#include <QString>
+#include <QTimer>
+#include <QWidget>
+
+#include "src/latencyhistogram.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+namespace ui {
+
+/**
+ * Interface for all widgets, that display live data and are updated by the
+ * FrameScheduler.
+ */
+class FrameClient
+{
+
+public:
+	virtual ~FrameClient() = default;
+
+	/**
+	 * Return true, if there is new data to display since the last
+	 * update_frame().
+	 */
+	virtual bool has_frame_update() const = 0;
+
+	/**
+	 * Display the new data. Called by the FrameScheduler in the GUI thread.
+	 */
+	virtual void update_frame() = 0;
+
+	/**
+	 * The name of the client for the diagnostics.
+	 */
+	virtual QString frame_client_name() const = 0;
+
+};
+
+/**
+ * The FrameScheduler updates all live views with one timer in the GUI thread.
+ *
+ * On every frame, only the clients are updated that are visible (not hidden,
+ * not in an inactive tab and not in a minimized window) and that have new
+ * data. When the updates take more than half of the frame interval, the
+ * frame rate is lowered (down to min_frame_rate), and raised again up to the
+ * configured frame rate when the load decreases.
+ */
+class FrameScheduler : public QObject
+{
+	Q_OBJECT
+
+public:
+	struct ClientStats
+	{
+		QString name;
+		bool visible;
+		uint64_t update_count;
+		uint64_t skip_count;
+		const LatencyHistogram *update_time;
+	};
+
+	/**
+	 * Return the scheduler instance, shared by all views.
+	 */
+	static FrameScheduler &instance();
+
+	/**
+	 * Add a client. The widget is used to check the visibility of the client.
+	 */
+	void add_client(FrameClient *client, QWidget *widget);
+
+	/**
+	 * Remove a client. Must be called before the client is destructed.
+	 */
+	void remove_client(FrameClient *client);
+
+	/**
+	 * Set the frame rate in frames per second.
+	 */
+	void set_frame_rate(double frame_rate);
+
+	/**
+	 * Return the configured frame rate in frames per second.
+	 */
+	double frame_rate() const;
+
+	/**
+	 * Return the actual frame rate in frames per second, which is lower than
+	 * the configured frame rate under load.
+	 */
+	double actual_frame_rate() const;
+
+	/**
+	 * Return the time spent in the last frame in milliseconds.
+	 */
+	double last_frame_time() const;
+
+	/**
+	 * Return the update counters and the update times of all clients.
+	 */
+	vector<ClientStats> client_stats() const;
+
+	/**
+	 * Reset the counters of all clients.
+	 */
+	void reset_stats();
+
+	static constexpr double default_frame_rate = 5.;
+	static constexpr double min_frame_rate = 1.;
+
+private:
+	FrameScheduler();
+
+	struct Client
+	{
+		FrameClient *client;
+		QWidget *widget;
+		uint64_t update_count;
+		uint64_t skip_count;
+		LatencyHistogram update_time;
+	};
+
+	static bool is_visible(QWidget *widget);
+	void adapt_interval(double frame_time_ms);
+
+	vector<shared_ptr<Client>> clients_;
+	QTimer timer_;
+	double frame_rate_;
+	double interval_ms_;
+	double last_frame_time_ms_;
+
+private Q_SLOTS:
+	void on_frame();
+
+};
+
+} // namespace ui
+} // namespace sv
+
+#endif // UI_FRAMESCHEDULER_HPP
@@ -77,7 +77,8 @@ void MeasurementTab::setup_ui()
 	}
 
 	views::BaseView *first_panel_view = nullptr;
-	for (const auto &ch_pair : measurement_device_->channel_map()) {
+	const auto channel_map = measurement_device_->channel_map();
+	for (const auto &ch_pair : *channel_map) {
 		// Ignore digital channels (starting with "D") from the demo devive.
 		if (util::starts_with(ch_pair.first, "D"))
 			continue;
@@ -99,7 +100,7 @@ void MeasurementTab::setup_ui()
 			new ui::views::PlotView(session_, channel);
 		add_view(value_plot_view, Qt::BottomDockWidgetArea);
 	}
-	if (measurement_device_->channel_map().size() > 1) {
+	if (channel_map->size() > 1) {
 		first_panel_view->show();
 		first_panel_view->raise();
 	}
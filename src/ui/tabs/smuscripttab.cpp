@@ -26,6 +26,9 @@
 #include "smuscripttab.hpp"
 #include "src/mainwindow.hpp"
 #include "src/session.hpp"
+#ifdef ENABLE_SCRIPTHOST
+#include "src/python/scripthostprocess.hpp"
+#endif
 #include "src/python/smuscriptrunner.hpp"
 #include "src/ui/tabs/basetab.hpp"
 #include "src/ui/views/smuscriptoutputview.hpp"
@@ -91,6 +94,16 @@ void SmuScriptTab::connect_signals()
 		this, &SmuScriptTab::on_script_started);
 	connect(smu_script_view_, &views::SmuScriptView::script_finished,
 		this, &SmuScriptTab::on_script_finished);
+
+#ifdef ENABLE_SCRIPTHOST
+	// The script host process belongs to this tab, its output always goes
+	// to the SmuScriptOutputView of this tab.
+	auto script_host_process = smu_script_view_->script_host_process();
+	connect(script_host_process, &python::ScriptHostProcess::send_py_stdout,
+		smu_script_output_view_, &views::SmuScriptOutputView::append_out_text);
+	connect(script_host_process, &python::ScriptHostProcess::send_py_stderr,
+		smu_script_output_view_, &views::SmuScriptOutputView::append_err_text);
+#endif
 }
 
 void SmuScriptTab::on_file_name_changed(const QString &file_name)
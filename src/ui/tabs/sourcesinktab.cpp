@@ -79,7 +79,8 @@ void SourceSinkTab::setup_ui()
 	// Get signals by their channel group. The signals in a channel are "fixed"
 	// for power supplys and loads.
 	views::BaseView *first_pp_view = nullptr;
-	for (const auto &chg_pair : device_->channel_group_map()) {
+	const auto channel_group_map = device_->channel_group_map();
+	for (const auto &chg_pair : *channel_group_map) {
 		ui::views::PlotView *plot_view = NULL;
 		shared_ptr<data::AnalogTimeSignal> voltage_signal;
 		shared_ptr<data::AnalogTimeSignal> current_signal;
@@ -125,7 +126,7 @@ void SourceSinkTab::setup_ui()
 				add_view_ontop(power_panel_view, first_pp_view);
 		}
 	}
-	if (device_->channel_group_map().size() > 1) {
+	if (channel_group_map->size() > 1) {
 		first_pp_view->show();
 		first_pp_view->raise();
 	}
@@ -39,10 +39,12 @@ enum class ViewType {
 	DataView,
 	DemoControlView,
 	DeviceTreeView,
+	HistogramView,
 	MeasurementControlView,
 	PlotView,
 	PowerPanelView,
 	SourceSinkControlView,
+	SpectrumView,
 	ValuePanelView
 };
 
@@ -177,6 +177,7 @@ void DataView::populate_table()
 
 			++next_signal_pos_[i];
 		}
+		signals_[i]->mark_consumed();
 	}
 	if (auto_scroll_)
 		data_table_->scrollToBottom();
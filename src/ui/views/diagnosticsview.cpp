@@ -0,0 +1,393 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <map>
+#include <memory>
+#include <set>
+
+#include <QHeaderView>
+#include <QIcon>
+#include <QStringList>
+#include <QVBoxLayout>
+
+#include "diagnosticsview.hpp"
+#include "src/latencyhistogram.hpp"
+#include "src/session.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/basesignal.hpp"
+#include "src/data/memorymanager.hpp"
+#include "src/data/signalregistry.hpp"
+#include "src/devices/acquisitionstats.hpp"
+#include "src/devices/basedevice.hpp"
+#include "src/ui/framescheduler.hpp"
+#include "src/ui/views/baseview.hpp"
+
+using std::dynamic_pointer_cast;
+using std::set;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+namespace {
+
+enum Column {
+	NameColumn,
+	PacketRateColumn,
+	SampleRateColumn,
+	SampleCountColumn,
+	FeedInMeanColumn,
+	FeedInP99Column,
+	FeedInMaxColumn,
+	UiLagP50Column,
+	UiLagP99Column,
+	UiLagMaxColumn,
+	MemoryColumn,
+	SpilledColumn
+};
+
+enum ViewColumn {
+	ViewNameColumn,
+	ViewVisibleColumn,
+	ViewUpdateCountColumn,
+	ViewSkipCountColumn,
+	ViewUpdateMeanColumn,
+	ViewUpdateP99Column,
+	ViewUpdateMaxColumn
+};
+
+QString format_us(double ns)
+{
+	return QString::number(ns / 1000., 'f', 1);
+}
+
+QString format_ms(double ns)
+{
+	return QString::number(ns / 1000000., 'f', 1);
+}
+
+const size_t mib = 1024 * 1024;
+
+QString format_mib(size_t bytes)
+{
+	return QString::number(bytes / (double)mib, 'f', 1);
+}
+
+}
+
+DiagnosticsView::DiagnosticsView(Session &session, QWidget *parent) :
+	BaseView(session, parent),
+	action_reset_(new QAction(this)),
+	action_spill_(new QAction(this)),
+	action_native_precision_(new QAction(this))
+{
+	id_ = "diagnostics";
+
+	setup_ui();
+	setup_toolbar();
+
+	timer_ = new QTimer(this);
+	connect_signals();
+	timer_->start(1000);
+}
+
+QString DiagnosticsView::title() const
+{
+	return tr("Diagnostics");
+}
+
+void DiagnosticsView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	tree_ = new QTreeWidget();
+	tree_->setHeaderLabels(QStringList()
+		<< tr("Name")
+		<< tr("Packets/s")
+		<< tr("Samples/s")
+		<< tr("Samples")
+		<< tr("Feed in mean [µs]")
+		<< tr("Feed in p99 [µs]")
+		<< tr("Feed in max [µs]")
+		<< tr("UI lag p50 [ms]")
+		<< tr("UI lag p99 [ms]")
+		<< tr("UI lag max [ms]")
+		<< tr("Memory [MiB]")
+		<< tr("Spilled [MiB]"));
+	tree_->header()->setSectionResizeMode(QHeaderView::ResizeToContents);
+	layout->addWidget(tree_);
+
+	views_tree_ = new QTreeWidget();
+	views_tree_->setRootIsDecorated(false);
+	views_tree_->setHeaderLabels(QStringList()
+		<< tr("View")
+		<< tr("Visible")
+		<< tr("Updates")
+		<< tr("Skipped")
+		<< tr("Update mean [µs]")
+		<< tr("Update p99 [µs]")
+		<< tr("Update max [µs]"));
+	views_tree_->header()->setSectionResizeMode(
+		QHeaderView::ResizeToContents);
+	layout->addWidget(views_tree_);
+	layout->setContentsMargins(2, 2, 2, 2);
+
+	this->central_widget_->setLayout(layout);
+}
+
+void DiagnosticsView::setup_toolbar()
+{
+	action_reset_->setText(tr("Reset counters"));
+	action_reset_->setIcon(
+		QIcon::fromTheme("view-refresh",
+		QIcon(":/icons/view-refresh.png")));
+	connect(action_reset_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_reset_triggered()));
+
+	frame_rate_spin_box_ = new QSpinBox();
+	frame_rate_spin_box_->setRange(
+		(int)FrameScheduler::min_frame_rate, 60);
+	frame_rate_spin_box_->setSuffix(" fps");
+	frame_rate_spin_box_->setToolTip(tr("Frame rate of the live views"));
+	frame_rate_spin_box_->setValue(
+		(int)FrameScheduler::instance().frame_rate());
+	frame_rate_label_ = new QLabel();
+
+	memory_budget_spin_box_ = new QSpinBox();
+	memory_budget_spin_box_->setRange(0, 1024 * 1024);
+	memory_budget_spin_box_->setSingleStep(64);
+	memory_budget_spin_box_->setSuffix(" MiB");
+	memory_budget_spin_box_->setSpecialValueText(tr("Unlimited"));
+	memory_budget_spin_box_->setToolTip(
+		tr("Memory budget for the samples of all signals"));
+
+	action_spill_->setText(tr("Spill to disk"));
+	action_spill_->setToolTip(tr("Move the oldest samples to the disk, "
+		"when the memory budget is exceeded"));
+	action_spill_->setCheckable(true);
+	action_native_precision_->setText(tr("Native precision"));
+	action_native_precision_->setToolTip(tr("Store the samples of new "
+		"signals in the precision of the device (e.g. as floats)"));
+	action_native_precision_->setCheckable(true);
+	memory_label_ = new QLabel();
+	update_memory_controls();
+
+	toolbar_ = new QToolBar("Diagnostics Toolbar");
+	toolbar_->addAction(action_reset_);
+	toolbar_->addSeparator();
+	toolbar_->addWidget(frame_rate_spin_box_);
+	toolbar_->addWidget(frame_rate_label_);
+	toolbar_->addSeparator();
+	toolbar_->addWidget(memory_budget_spin_box_);
+	toolbar_->addAction(action_spill_);
+	toolbar_->addAction(action_native_precision_);
+	toolbar_->addWidget(memory_label_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void DiagnosticsView::connect_signals()
+{
+	connect(timer_, SIGNAL(timeout()), this, SLOT(on_update()));
+	connect(frame_rate_spin_box_, SIGNAL(valueChanged(int)),
+		this, SLOT(on_frame_rate_changed(int)));
+	connect(memory_budget_spin_box_, SIGNAL(valueChanged(int)),
+		this, SLOT(on_memory_budget_changed(int)));
+	connect(action_spill_, SIGNAL(toggled(bool)),
+		this, SLOT(on_action_spill_toggled(bool)));
+	connect(action_native_precision_, SIGNAL(toggled(bool)),
+		this, SLOT(on_action_native_precision_toggled(bool)));
+}
+
+void DiagnosticsView::on_update()
+{
+	const auto &devices = session().devices();
+
+	// Rebuild the tree, when a device was removed.
+	set<sv::devices::BaseDevice *> device_ptrs;
+	for (const auto &device_pair : devices)
+		device_ptrs.insert(device_pair.second.get());
+	for (const auto &item_pair : device_item_map_) {
+		if (device_ptrs.count(item_pair.first) == 0) {
+			tree_->clear();
+			device_item_map_.clear();
+			signal_item_map_.clear();
+			break;
+		}
+	}
+
+	for (const auto &device_pair : devices) {
+		auto device = device_pair.second;
+
+		QTreeWidgetItem *device_item;
+		if (device_item_map_.count(device.get()) == 0) {
+			device_item = new QTreeWidgetItem(tree_);
+			device_item->setText(NameColumn, device->short_name());
+			device_item->setExpanded(true);
+			device_item_map_[device.get()] = device_item;
+		}
+		device_item = device_item_map_[device.get()];
+
+		auto &stats = device->acquisition_stats();
+		const auto &feed_in_time = stats.feed_in_time();
+		device_item->setText(PacketRateColumn,
+			QString::number(stats.packet_rate(), 'f', 1));
+		device_item->setText(SampleRateColumn,
+			QString::number(stats.sample_rate(), 'f', 1));
+		device_item->setText(SampleCountColumn,
+			QString::number(stats.sample_count()));
+		device_item->setText(FeedInMeanColumn,
+			format_us(feed_in_time.mean()));
+		device_item->setText(FeedInP99Column,
+			format_us(feed_in_time.percentile(99)));
+		device_item->setText(FeedInMaxColumn,
+			format_us(feed_in_time.max()));
+
+		size_t device_memory_size = 0;
+		size_t device_spilled_size = 0;
+		const auto signals = device->signals();
+		for (const auto &signal : *signals) {
+			auto analog_signal =
+				dynamic_pointer_cast<sv::data::AnalogTimeSignal>(signal);
+			if (!analog_signal)
+				continue;
+
+			QTreeWidgetItem *signal_item;
+			if (signal_item_map_.count(signal.get()) == 0) {
+				signal_item = new QTreeWidgetItem(device_item);
+				signal_item->setText(NameColumn, signal->display_name());
+				signal_item_map_[signal.get()] = signal_item;
+			}
+			signal_item = signal_item_map_[signal.get()];
+
+			const auto &ui_lag = analog_signal->ui_lag();
+			signal_item->setText(SampleCountColumn,
+				QString::number(analog_signal->sample_count()));
+			signal_item->setText(UiLagP50Column,
+				format_ms(ui_lag.percentile(50)));
+			signal_item->setText(UiLagP99Column,
+				format_ms(ui_lag.percentile(99)));
+			signal_item->setText(UiLagMaxColumn, format_ms(ui_lag.max()));
+
+			size_t memory_size = analog_signal->memory_size();
+			size_t spilled_size = analog_signal->spilled_size();
+			signal_item->setText(MemoryColumn, format_mib(memory_size));
+			signal_item->setText(SpilledColumn, format_mib(spilled_size));
+			device_memory_size += memory_size;
+			device_spilled_size += spilled_size;
+		}
+
+		device_item->setText(MemoryColumn, format_mib(device_memory_size));
+		device_item->setText(SpilledColumn,
+			format_mib(device_spilled_size));
+	}
+
+	update_views_tree();
+	update_memory_controls();
+}
+
+void DiagnosticsView::update_views_tree()
+{
+	const auto &scheduler = FrameScheduler::instance();
+	frame_rate_label_->setText(tr(" actual: %1 fps, last frame: %2 ms").
+		arg(scheduler.actual_frame_rate(), 0, 'f', 1).
+		arg(scheduler.last_frame_time(), 0, 'f', 1));
+
+	// The views come and go, so the list is rebuilt every time.
+	views_tree_->clear();
+	for (const auto &stats : scheduler.client_stats()) {
+		QTreeWidgetItem *item = new QTreeWidgetItem(views_tree_);
+		item->setText(ViewNameColumn, stats.name);
+		item->setText(ViewVisibleColumn,
+			stats.visible ? tr("yes") : tr("no"));
+		item->setText(ViewUpdateCountColumn,
+			QString::number(stats.update_count));
+		item->setText(ViewSkipCountColumn,
+			QString::number(stats.skip_count));
+		item->setText(ViewUpdateMeanColumn,
+			format_us(stats.update_time->mean()));
+		item->setText(ViewUpdateP99Column,
+			format_us(stats.update_time->percentile(99)));
+		item->setText(ViewUpdateMaxColumn,
+			format_us(stats.update_time->max()));
+	}
+}
+
+void DiagnosticsView::update_memory_controls()
+{
+	const auto &memory_manager = sv::data::MemoryManager::instance();
+
+	// The settings may have been restored after the view was created.
+	if (!memory_budget_spin_box_->hasFocus()) {
+		memory_budget_spin_box_->blockSignals(true);
+		memory_budget_spin_box_->setValue(
+			(int)(memory_manager.budget() / mib));
+		memory_budget_spin_box_->blockSignals(false);
+	}
+	action_spill_->blockSignals(true);
+	action_spill_->setChecked(memory_manager.is_spill_enabled());
+	action_spill_->blockSignals(false);
+	action_native_precision_->blockSignals(true);
+	action_native_precision_->setChecked(
+		memory_manager.is_native_precision_enabled());
+	action_native_precision_->blockSignals(false);
+
+	memory_label_->setText(tr(" in use: %1 MiB, on disk: %2 MiB").
+		arg(format_mib(memory_manager.memory_size())).
+		arg(format_mib(memory_manager.spilled_size())));
+}
+
+void DiagnosticsView::on_action_reset_triggered()
+{
+	for (const auto &device_pair : session().devices())
+		device_pair.second->acquisition_stats().reset();
+	const auto signal_map = session().signal_registry()->signal_map();
+	for (const auto &signal_pair : *signal_map) {
+		auto analog_signal = dynamic_pointer_cast<sv::data::AnalogTimeSignal>(
+			signal_pair.second);
+		if (analog_signal)
+			analog_signal->ui_lag().reset();
+	}
+	FrameScheduler::instance().reset_stats();
+	on_update();
+}
+
+void DiagnosticsView::on_frame_rate_changed(int frame_rate)
+{
+	FrameScheduler::instance().set_frame_rate(frame_rate);
+}
+
+void DiagnosticsView::on_memory_budget_changed(int memory_budget)
+{
+	sv::data::MemoryManager::instance().set_budget(
+		(size_t)memory_budget * mib);
+}
+
+void DiagnosticsView::on_action_spill_toggled(bool checked)
+{
+	sv::data::MemoryManager::instance().set_spill_enabled(checked);
+}
+
+void DiagnosticsView::on_action_native_precision_toggled(bool checked)
+{
+	sv::data::MemoryManager::instance().set_native_precision_enabled(checked);
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
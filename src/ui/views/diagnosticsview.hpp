@@ -0,0 +1,105 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_DIAGNOSTICSVIEW_HPP
+#define UI_VIEWS_DIAGNOSTICSVIEW_HPP
+
+#include <map>
+
+#include <QAction>
+#include <QLabel>
+#include <QSpinBox>
+#include <QTimer>
+#include <QToolBar>
+#include <QTreeWidget>
+#include <QTreeWidgetItem>
+
+#include "src/ui/views/baseview.hpp"
+
+using std::map;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class BaseSignal;
+}
+
+namespace devices {
+class BaseDevice;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * The DiagnosticsView shows the aquisition counters of all devices (packets/s,
+ * samples/s, time spent in processing the packets) and the lag between the
+ * sample timestamps and the first display of the samples for all signals.
+ * It also shows the update counters and update times of all live views and
+ * lets the user set the frame rate of the FrameScheduler, the memory usage of
+ * all signals and the memory budget of the MemoryManager.
+ */
+class DiagnosticsView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	DiagnosticsView(Session &session, QWidget *parent = nullptr);
+
+	QString title() const override;
+
+private:
+	QAction *const action_reset_;
+	QAction *const action_spill_;
+	QAction *const action_native_precision_;
+	QToolBar *toolbar_;
+	QTreeWidget *tree_;
+	QTreeWidget *views_tree_;
+	QSpinBox *frame_rate_spin_box_;
+	QLabel *frame_rate_label_;
+	QSpinBox *memory_budget_spin_box_;
+	QLabel *memory_label_;
+	QTimer *timer_;
+
+	map<sv::devices::BaseDevice *, QTreeWidgetItem *> device_item_map_;
+	map<sv::data::BaseSignal *, QTreeWidgetItem *> signal_item_map_;
+
+	void setup_ui();
+	void setup_toolbar();
+	void connect_signals();
+	void update_views_tree();
+	void update_memory_controls();
+
+private Q_SLOTS:
+	void on_update();
+	void on_action_reset_triggered();
+	void on_frame_rate_changed(int frame_rate);
+	void on_memory_budget_changed(int memory_budget);
+	void on_action_spill_toggled(bool checked);
+	void on_action_native_precision_toggled(bool checked);
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_DIAGNOSTICSVIEW_HPP
@@ -0,0 +1,258 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstdint>
+#include <memory>
+
+#include <QVBoxLayout>
+#include <QVector>
+#include <qwt_plot.h>
+#include <qwt_plot_grid.h>
+#include <qwt_plot_histogram.h>
+#include <qwt_samples.h>
+#include <qwt_scale_engine.h>
+
+#include "histogramview.hpp"
+#include "src/session.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/histogramaccumulator.hpp"
+
+using std::make_shared;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+const size_t HistogramView::max_frame_samples;
+
+HistogramView::HistogramView(Session &session,
+		shared_ptr<sv::data::AnalogTimeSignal> signal,
+		QWidget *parent) :
+	BaseView(session, parent),
+	signal_(signal),
+	accumulator_(make_shared<sv::data::HistogramAccumulator>(signal)),
+	action_reset_(new QAction(this)),
+	action_log_scale_(new QAction(this)),
+	action_cumulative_(new QAction(this))
+{
+	id_ = "histogram:" + signal_->name();
+
+	setup_ui();
+	setup_toolbar();
+	connect_signals();
+
+	FrameScheduler::instance().add_client(this, this);
+}
+
+HistogramView::~HistogramView()
+{
+	FrameScheduler::instance().remove_client(this);
+}
+
+QString HistogramView::title() const
+{
+	return tr("Histogram") + " " + signal_->display_name();
+}
+
+void HistogramView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	plot_ = new QwtPlot();
+	plot_->setCanvasBackground(QBrush(Qt::white));
+	plot_->setAxisTitle(QwtPlot::xBottom,
+		signal_->display_name() + " [" + signal_->unit_name() + "]");
+	plot_->setAxisTitle(QwtPlot::yLeft, tr("Count"));
+	plot_->setAxisAutoScale(QwtPlot::xBottom, true);
+	plot_->setAxisAutoScale(QwtPlot::yLeft, true);
+
+	QwtPlotGrid *grid = new QwtPlotGrid();
+	grid->setPen(Qt::gray, 0.0, Qt::DotLine);
+	grid->enableX(true);
+	grid->enableY(true);
+	grid->attach(plot_);
+
+	histogram_ = new QwtPlotHistogram(signal_->display_name());
+	histogram_->setStyle(QwtPlotHistogram::Columns);
+	histogram_->setBrush(QBrush(QColor(0, 0, 255, 128)));
+	histogram_->setPen(QPen(Qt::blue, 0.0));
+	histogram_->attach(plot_);
+
+	layout->addWidget(plot_);
+	this->central_widget_->setLayout(layout);
+}
+
+void HistogramView::setup_toolbar()
+{
+	action_reset_->setText(tr("Reset histogram"));
+	action_reset_->setIcon(
+		QIcon::fromTheme("view-refresh",
+		QIcon(":/icons/view-refresh.png")));
+	connect(action_reset_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_reset_triggered()));
+
+	action_log_scale_->setText(tr("Logarithmic scale"));
+	action_log_scale_->setCheckable(true);
+	connect(action_log_scale_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_log_scale_triggered()));
+
+	action_cumulative_->setText(tr("Cumulative"));
+	action_cumulative_->setCheckable(true);
+	connect(action_cumulative_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_cumulative_triggered()));
+
+	bin_width_box_ = new QDoubleSpinBox();
+	bin_width_box_->setToolTip(tr("Bin width"));
+	bin_width_box_->setDecimals(9);
+	bin_width_box_->setRange(0., 1e9);
+	bin_width_box_->setSpecialValueText(tr("Auto"));
+	bin_width_box_->setValue(0.);
+
+	time_window_box_ = new QDoubleSpinBox();
+	time_window_box_->setToolTip(
+		tr("Only count the samples of the last seconds"));
+	time_window_box_->setDecimals(1);
+	time_window_box_->setRange(0., 86400. * 365.);
+	time_window_box_->setSuffix(" s");
+	time_window_box_->setSpecialValueText(tr("All samples"));
+	time_window_box_->setValue(0.);
+
+	info_label_ = new QLabel();
+
+	toolbar_ = new QToolBar("Histogram Toolbar");
+	toolbar_->addAction(action_reset_);
+	toolbar_->addSeparator();
+	toolbar_->addAction(action_log_scale_);
+	toolbar_->addAction(action_cumulative_);
+	toolbar_->addSeparator();
+	toolbar_->addWidget(bin_width_box_);
+	toolbar_->addWidget(time_window_box_);
+	toolbar_->addSeparator();
+	toolbar_->addWidget(info_label_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void HistogramView::connect_signals()
+{
+	// Only apply the values after editing, every change recounts the samples.
+	connect(bin_width_box_, SIGNAL(editingFinished()),
+		this, SLOT(on_bin_width_changed()));
+	connect(time_window_box_, SIGNAL(editingFinished()),
+		this, SLOT(on_time_window_changed()));
+}
+
+bool HistogramView::has_frame_update() const
+{
+	return accumulator_->has_new_samples();
+}
+
+void HistogramView::update_frame()
+{
+	// Limit the work per frame, when a long history is counted.
+	if (!accumulator_->update(max_frame_samples))
+		return;
+
+	update_histogram();
+	signal_->mark_consumed();
+}
+
+QString HistogramView::frame_client_name() const
+{
+	return title();
+}
+
+void HistogramView::update_histogram()
+{
+	const auto &counts = accumulator_->counts();
+	const double bin_width = accumulator_->bin_width();
+	const int64_t first_bin = accumulator_->first_bin();
+	const bool cumulative = action_cumulative_->isChecked();
+	// The logarithmic scale can't show the 0 base line.
+	const double baseline = action_log_scale_->isChecked() ? 0.5 : 0.;
+
+	QVector<QwtIntervalSample> samples;
+	samples.reserve((int)counts.size());
+	uint64_t sum = 0;
+	for (size_t i = 0; i < counts.size(); ++i) {
+		sum = cumulative ? sum + counts[i] : counts[i];
+		if (sum == 0)
+			continue;
+		double lower = (first_bin + (int64_t)i) * bin_width;
+		samples.append(QwtIntervalSample(
+			(double)sum, lower, lower + bin_width));
+	}
+	histogram_->setBaseline(baseline);
+	histogram_->setSamples(samples);
+	plot_->replot();
+
+	update_info();
+}
+
+void HistogramView::update_info()
+{
+	QString unit = signal_->unit_name();
+	info_label_->setText(
+		tr("n = %1, mean = %2 %3, std. dev. = %4 %3, bin = %5 %3").
+		arg(accumulator_->count()).
+		arg(accumulator_->mean(), 0, 'g', 8).
+		arg(unit).
+		arg(accumulator_->std_dev(), 0, 'g', 4).
+		arg(accumulator_->bin_width(), 0, 'g', 4));
+}
+
+void HistogramView::on_action_reset_triggered()
+{
+	accumulator_->reset();
+	update_histogram();
+}
+
+void HistogramView::on_action_log_scale_triggered()
+{
+	if (action_log_scale_->isChecked())
+		plot_->setAxisScaleEngine(QwtPlot::yLeft, new QwtLogScaleEngine());
+	else
+		plot_->setAxisScaleEngine(QwtPlot::yLeft, new QwtLinearScaleEngine());
+	plot_->setAxisAutoScale(QwtPlot::yLeft, true);
+	update_histogram();
+}
+
+void HistogramView::on_action_cumulative_triggered()
+{
+	update_histogram();
+}
+
+void HistogramView::on_bin_width_changed()
+{
+	if (bin_width_box_->value() == accumulator_->bin_width())
+		return;
+	accumulator_->set_bin_width(bin_width_box_->value());
+	update_histogram();
+}
+
+void HistogramView::on_time_window_changed()
+{
+	if (time_window_box_->value() == accumulator_->time_window())
+		return;
+	accumulator_->set_time_window(time_window_box_->value());
+	update_histogram();
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,107 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_HISTOGRAMVIEW_HPP
+#define UI_VIEWS_HISTOGRAMVIEW_HPP
+
+#include <memory>
+
+#include <QAction>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QString>
+#include <QToolBar>
+
+#include "src/ui/framescheduler.hpp"
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+
+class QwtPlot;
+class QwtPlotHistogram;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+class HistogramAccumulator;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * The HistogramView shows the distribution of the samples of a signal. The
+ * samples are counted incrementally by a HistogramAccumulator in every frame.
+ */
+class HistogramView : public BaseView, public ui::FrameClient
+{
+	Q_OBJECT
+
+public:
+	HistogramView(Session &session,
+		shared_ptr<sv::data::AnalogTimeSignal> signal,
+		QWidget *parent = nullptr);
+	~HistogramView();
+
+	QString title() const override;
+
+	bool has_frame_update() const override;
+	void update_frame() override;
+	QString frame_client_name() const override;
+
+	/** The max. number of samples counted per frame. */
+	static const size_t max_frame_samples = 1000000;
+
+private:
+	shared_ptr<sv::data::AnalogTimeSignal> signal_;
+	shared_ptr<sv::data::HistogramAccumulator> accumulator_;
+
+	QAction *const action_reset_;
+	QAction *const action_log_scale_;
+	QAction *const action_cumulative_;
+	QToolBar *toolbar_;
+	QDoubleSpinBox *bin_width_box_;
+	QDoubleSpinBox *time_window_box_;
+	QLabel *info_label_;
+	QwtPlot *plot_;
+	QwtPlotHistogram *histogram_;
+
+	void setup_ui();
+	void setup_toolbar();
+	void connect_signals();
+	void update_histogram();
+	void update_info();
+
+private Q_SLOTS:
+	void on_action_reset_triggered();
+	void on_action_log_scale_triggered();
+	void on_action_cumulative_triggered();
+	void on_bin_width_changed();
+	void on_time_window_changed();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_HISTOGRAMVIEW_HPP
@@ -33,6 +33,8 @@
 #include "src/session.hpp"
 #include "src/channels/basechannel.hpp"
 #include "src/data/analogtimesignal.hpp"
+#include "src/data/trigger.hpp"
+#include "src/data/triggerengine.hpp"
 #include "src/ui/dialogs/plotconfigdialog.hpp"
 #include "src/ui/dialogs/plotdiffmarkerdialog.hpp"
 #include "src/ui/dialogs/selectsignaldialog.hpp"
@@ -214,7 +216,6 @@ void PlotView::setup_ui()
 
 	plot_ = new widgets::plot::Plot();
 	plot_->set_update_mode(widgets::plot::PlotUpdateMode::Additive);
-	plot_->set_plot_interval(200); // 200ms
 
 	for (const auto &curve : curves_)
 		plot_->add_curve(curve);
@@ -310,6 +311,10 @@ void PlotView::update_add_marker_menu()
 
 void PlotView::connect_signals()
 {
+	// The events are emitted in the acquisition thread.
+	connect(session_.trigger_engine().get(),
+		&sv::data::TriggerEngine::triggered,
+		this, &PlotView::on_trigger_event, Qt::QueuedConnection);
 }
 
 void PlotView::init_values()
@@ -417,6 +422,25 @@ void PlotView::on_action_config_plot_triggered()
 	dlg.exec();
 }
 
+void PlotView::on_trigger_event(shared_ptr<sv::data::Trigger> trigger,
+	sv::data::TriggerEvent event)
+{
+	if (plot_type_ != PlotType::TimePlot)
+		return;
+
+	for (const auto &curve : curves_) {
+		auto time_curve = (widgets::plot::TimeCurveData *)curve;
+		if (time_curve->signal() != trigger->signal())
+			continue;
+
+		double x = event.timestamp;
+		if (time_curve->is_relative_time())
+			x -= trigger->signal()->signal_start_timestamp();
+		plot_->add_event_marker(curve, x,
+			QString("T%1").arg(event.number));
+	}
+}
+
 } // namespace views
 } // namespace ui
 } // namespace sv
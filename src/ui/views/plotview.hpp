@@ -28,6 +28,7 @@
 #include <QToolBar>
 #include <QToolButton>
 
+#include "src/data/trigger.hpp"
 #include "src/ui/views/baseview.hpp"
 
 using std::shared_ptr;
@@ -42,6 +43,7 @@ class BaseChannel;
 }
 namespace data {
 class AnalogTimeSignal;
+class Trigger;
 }
 
 namespace ui {
@@ -122,6 +124,8 @@ private Q_SLOTS:
 	void on_action_add_signal_triggered();
 	void on_action_save_triggered();
 	void on_action_config_plot_triggered();
+	void on_trigger_event(shared_ptr<sv::data::Trigger> trigger,
+		sv::data::TriggerEvent event);
 
 };
 
@@ -17,11 +17,11 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <memory>
 #include <set>
 #include <string>
 
 #include <QApplication>
-#include <QDateTime>
 #include <QVBoxLayout>
 
 #include "powerpanelview.hpp"
@@ -29,8 +29,10 @@
 #include "src/util.hpp"
 #include "src/data/analogtimesignal.hpp"
 #include "src/data/datautil.hpp"
+#include "src/data/energyaccumulator.hpp"
 #include "src/ui/widgets/monofontdisplay.hpp"
 
+using std::make_shared;
 using std::set;
 using sv::data::QuantityFlag;
 
@@ -45,16 +47,9 @@ PowerPanelView::PowerPanelView(Session &session,
 	BaseView(session, parent),
 	voltage_signal_(voltage_signal),
 	current_signal_(current_signal),
-	voltage_min_(std::numeric_limits<double>::max()),
-	voltage_max_(std::numeric_limits<double>::lowest()),
-	current_min_(std::numeric_limits<double>::max()),
-	current_max_(std::numeric_limits<double>::lowest()),
-	resistance_min_(std::numeric_limits<double>::max()),
-	resistance_max_(std::numeric_limits<double>::lowest()),
-	power_min_(std::numeric_limits<double>::max()),
-	power_max_(std::numeric_limits<double>::lowest()),
-	actual_amp_hours_(0),
-	actual_watt_hours_(0),
+	updating_(false),
+	accumulator_(make_shared<sv::data::EnergyAccumulator>(
+		voltage_signal, current_signal)),
 	action_reset_displays_(new QAction(this))
 {
 	id_ = "powerpanel:" + voltage_signal_->name() +
@@ -65,13 +60,12 @@ PowerPanelView::PowerPanelView(Session &session,
 	connect_signals();
 	reset_displays();
 
-	timer_ = new QTimer(this);
-	init_timer();
+	start_updates();
 }
 
 PowerPanelView::~PowerPanelView()
 {
-	stop_timer();
+	stop_updates();
 }
 
 QString PowerPanelView::title() const
@@ -277,107 +271,76 @@ void PowerPanelView::reset_displays()
 	watt_hour_display_->reset_value();
 }
 
-void PowerPanelView::init_timer()
+void PowerPanelView::start_updates()
 {
 	if (!voltage_signal_ && !current_signal_)
 		return;
 
-	start_time_ = QDateTime::currentMSecsSinceEpoch();
-	last_time_ = start_time_;
-
-	voltage_min_ = std::numeric_limits<double>::max();
-	voltage_max_ = std::numeric_limits<double>::lowest();
-	current_min_ = std::numeric_limits<double>::max();
-	current_max_ = std::numeric_limits<double>::lowest();
-	resistance_min_ = std::numeric_limits<double>::max();
-	resistance_max_ = std::numeric_limits<double>::lowest();
-	power_min_ = std::numeric_limits<double>::max();
-	power_max_ = std::numeric_limits<double>::lowest();
-	actual_amp_hours_ = 0;
-	actual_watt_hours_ = 0;
-
-	connect(timer_, SIGNAL(timeout()), this, SLOT(on_update()));
-	timer_->start(250);
+	accumulator_->reset();
+
+	FrameScheduler::instance().add_client(this, this);
+	updating_ = true;
 }
 
-void PowerPanelView::stop_timer()
+void PowerPanelView::stop_updates()
 {
-	if (!timer_->isActive())
+	if (!updating_)
 		return;
 
-	timer_->stop();
-	disconnect(timer_, SIGNAL(timeout()), this, SLOT(on_update()));
+	FrameScheduler::instance().remove_client(this);
+	updating_ = false;
 
 	reset_displays();
 }
 
-void PowerPanelView::on_update()
+bool PowerPanelView::has_frame_update() const
 {
-	if (voltage_signal_->sample_count() == 0)
-		return;
-
-	qint64 now = QDateTime::currentMSecsSinceEpoch();
-	double elapsed_time = (now - last_time_) / (double)3600000; // 1000 * 60 * 60 = 1h
-	last_time_ = now;
-
-	double voltage = 0.;
-	if (voltage_signal_) {
-		voltage = voltage_signal_->last_value();
-		if (voltage_min_ > voltage)
-			voltage_min_ = voltage;
-		if (voltage_max_ < voltage)
-			voltage_max_ = voltage;
-	}
+	return accumulator_->has_new_samples();
+}
 
-	double current = 0.;
-	if (current_signal_) {
-		current = current_signal_->last_value();
-		if (current_min_ > current)
-			current_min_ = current;
-		if (current_max_ < current)
-			current_max_ = current;
-	}
+void PowerPanelView::update_frame()
+{
+	on_update();
+}
 
-	double resistance = current == 0. ?
-		std::numeric_limits<double>::max() : voltage / current;
-	if (resistance_min_ > resistance)
-		resistance_min_ = resistance;
-	if (resistance_max_ < resistance)
-		resistance_max_ = resistance;
+QString PowerPanelView::frame_client_name() const
+{
+	return title();
+}
 
-	double power = voltage * current;
-	if (power_min_ > power)
-		power_min_ = power;
-	if (power_max_ < power)
-		power_max_ = power;
+void PowerPanelView::on_update()
+{
+	// Only process the samples, that were appended since the last update.
+	if (!accumulator_->update())
+		return;
 
-	actual_amp_hours_ = actual_amp_hours_ + (current * elapsed_time);
-	actual_watt_hours_ = actual_watt_hours_ + (power * elapsed_time);
+	voltage_display_->set_value(accumulator_->voltage());
+	voltage_min_display_->set_value(accumulator_->voltage_min());
+	voltage_max_display_->set_value(accumulator_->voltage_max());
 
-	voltage_display_->set_value(voltage);
-	voltage_min_display_->set_value(voltage_min_);
-	voltage_max_display_->set_value(voltage_max_);
+	current_display_->set_value(accumulator_->current());
+	current_min_display_->set_value(accumulator_->current_min());
+	current_max_display_->set_value(accumulator_->current_max());
 
-	current_display_->set_value(current);
-	current_min_display_->set_value(current_min_);
-	current_max_display_->set_value(current_max_);
+	resistance_display_->set_value(accumulator_->resistance());
+	resistance_min_display_->set_value(accumulator_->resistance_min());
+	resistance_max_display_->set_value(accumulator_->resistance_max());
 
-	resistance_display_->set_value(resistance);
-	resistance_min_display_->set_value(resistance_min_);
-	resistance_max_display_->set_value(resistance_max_);
+	power_display_->set_value(accumulator_->power());
+	power_min_display_->set_value(accumulator_->power_min());
+	power_max_display_->set_value(accumulator_->power_max());
 
-	power_display_->set_value(power);
-	power_min_display_->set_value(power_min_);
-	power_max_display_->set_value(power_max_);
+	amp_hour_display_->set_value(accumulator_->amp_hours());
+	watt_hour_display_->set_value(accumulator_->watt_hours());
 
-	amp_hour_display_->set_value(actual_amp_hours_);
-	watt_hour_display_->set_value(actual_watt_hours_);
+	voltage_signal_->mark_consumed();
+	current_signal_->mark_consumed();
 }
 
 void PowerPanelView::on_action_reset_displays_triggered()
 {
-	stop_timer();
-	init_timer();
+	stop_updates();
+	start_updates();
 }
 
 void PowerPanelView::on_digits_changed()
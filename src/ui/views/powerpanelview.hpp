@@ -23,9 +23,9 @@
 #include <memory>
 
 #include <QAction>
-#include <QTimer>
 #include <QToolBar>
 
+#include "src/ui/framescheduler.hpp"
 #include "src/ui/views/baseview.hpp"
 
 using std::shared_ptr;
@@ -36,6 +36,7 @@ class Session;
 
 namespace data {
 class AnalogTimeSignal;
+class EnergyAccumulator;
 }
 
 namespace ui {
@@ -46,7 +47,7 @@ class ValueDisplay;
 
 namespace views {
 
-class PowerPanelView : public BaseView
+class PowerPanelView : public BaseView, public ui::FrameClient
 {
 	Q_OBJECT
 
@@ -59,25 +60,18 @@ public:
 
 	QString title() const override;
 
+	bool has_frame_update() const override;
+	void update_frame() override;
+	QString frame_client_name() const override;
+
 private:
 	shared_ptr<sv::data::AnalogTimeSignal> voltage_signal_;
 	shared_ptr<sv::data::AnalogTimeSignal> current_signal_;
 
-	QTimer *timer_;
-	qint64 start_time_;
-	qint64 last_time_;
-
-	// Min/max/actual values are stored here, so they can be reseted
-	double voltage_min_;
-	double voltage_max_;
-	double current_min_;
-	double current_max_;
-	double resistance_min_;
-	double resistance_max_;
-	double power_min_;
-	double power_max_;
-	double actual_amp_hours_;
-	double actual_watt_hours_;
+	bool updating_;
+
+	// Min/max/Ah/Wh values are accumulated here, so they can be reseted
+	shared_ptr<sv::data::EnergyAccumulator> accumulator_;
 
 	QAction *const action_reset_displays_;
 	QToolBar *toolbar_;
@@ -100,8 +94,8 @@ private:
 	void setup_toolbar();
 	void connect_signals();
 	void reset_displays();
-	void init_timer();
-	void stop_timer();
+	void start_updates();
+	void stop_updates();
 
 private Q_SLOTS:
 	void on_update();
@@ -17,12 +17,22 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
-#include <fstream>
+#include <algorithm>
+#include <cassert>
+#include <clocale>
+#include <cstdlib>
+#include <cstring>
 #include <memory>
-#include <string>
+#include <set>
 #include <vector>
+#ifdef _WIN32
+#include <locale.h>
+#elif defined(__APPLE__)
+#include <xlocale.h>
+#endif
 
 #include <QAction>
+#include <QByteArray>
 #include <QCheckBox>
 #include <QDebug>
 #include <QDoubleSpinBox>
@@ -31,28 +41,26 @@
 #include <QFormLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
+#include <QItemSelectionModel>
 #include <QLabel>
-#include <QList>
 #include <QLocale>
+#include <QModelIndexList>
 #include <QSpinBox>
 #include <QString>
-#include <QStringList>
-#include <QTableWidget>
-#include <QTableWidgetItem>
-#include <QTextStream>
+#include <QTableView>
 #include <QTimer>
 #include <QToolBar>
 #include <QVBoxLayout>
 
 #include "sequenceoutputview.hpp"
 #include "src/session.hpp"
-#include "src/util.hpp"
+#include "src/data/triggerengine.hpp"
 #include "src/data/properties/doubleproperty.hpp"
 #include "src/ui/datatypes/doublespinbox.hpp"
 #include "src/ui/dialogs/generatewaveformdialog.hpp"
 
+using std::set;
 using std::shared_ptr;
-using std::string;
 using std::vector;
 
 namespace sv {
@@ -114,6 +122,241 @@ void DoubleSpinBoxDelegate::updateEditorGeometry(QWidget *editor,
 }
 
 
+SequenceModel::SequenceModel(QObject *parent) :
+	QAbstractTableModel(parent)
+{
+}
+
+int SequenceModel::rowCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return (int)values_.size();
+}
+
+int SequenceModel::columnCount(const QModelIndex &parent) const
+{
+	if (parent.isValid())
+		return 0;
+	return 2;
+}
+
+QVariant SequenceModel::data(const QModelIndex &index, int role) const
+{
+	if (!index.isValid() || index.row() >= (int)values_.size())
+		return QVariant();
+	if (role != Qt::DisplayRole && role != Qt::EditRole)
+		return QVariant();
+
+	if (index.column() == 0)
+		return values_[index.row()];
+	return delays_[index.row()];
+}
+
+bool SequenceModel::setData(const QModelIndex &index, const QVariant &value,
+	int role)
+{
+	if (!index.isValid() || index.row() >= (int)values_.size() ||
+			role != Qt::EditRole)
+		return false;
+
+	bool ok;
+	double d = value.toDouble(&ok);
+	if (!ok)
+		return false;
+
+	if (index.column() == 0)
+		values_[index.row()] = d;
+	else
+		delays_[index.row()] = d;
+	Q_EMIT dataChanged(index, index, { Qt::DisplayRole, Qt::EditRole });
+	return true;
+}
+
+QVariant SequenceModel::headerData(int section, Qt::Orientation orientation,
+	int role) const
+{
+	if (role != Qt::DisplayRole)
+		return QVariant();
+	if (orientation == Qt::Vertical)
+		return section + 1;
+
+	if (section == 0)
+		return tr("Value");
+	return tr("Delay [s]");
+}
+
+Qt::ItemFlags SequenceModel::flags(const QModelIndex &index) const
+{
+	if (!index.isValid())
+		return Qt::NoItemFlags;
+	return Qt::ItemIsSelectable | Qt::ItemIsEditable | Qt::ItemIsEnabled;
+}
+
+int SequenceModel::size() const
+{
+	return (int)values_.size();
+}
+
+double SequenceModel::value(int row) const
+{
+	return values_[row];
+}
+
+double SequenceModel::delay(int row) const
+{
+	return delays_[row];
+}
+
+void SequenceModel::insert_step(int row, double value, double delay)
+{
+	insert_steps(row, { value }, { delay });
+}
+
+void SequenceModel::insert_steps(int row,
+	const vector<double> &values, const vector<double> &delays)
+{
+	assert(values.size() == delays.size());
+	if (values.empty())
+		return;
+
+	row = std::max(0, std::min(row, (int)values_.size()));
+	beginInsertRows(QModelIndex(), row, row + (int)values.size() - 1);
+	values_.insert(values_.begin() + row, values.begin(), values.end());
+	delays_.insert(delays_.begin() + row, delays.begin(), delays.end());
+	endInsertRows();
+}
+
+void SequenceModel::remove_steps(int row, int count)
+{
+	if (row < 0 || count <= 0 || row + count > (int)values_.size())
+		return;
+
+	beginRemoveRows(QModelIndex(), row, row + count - 1);
+	values_.erase(values_.begin() + row, values_.begin() + row + count);
+	delays_.erase(delays_.begin() + row, delays_.begin() + row + count);
+	endRemoveRows();
+}
+
+void SequenceModel::clear()
+{
+	beginResetModel();
+	values_.clear();
+	delays_.clear();
+	endResetModel();
+}
+
+namespace {
+
+#ifdef _WIN32
+typedef _locale_t c_locale_t;
+#else
+typedef locale_t c_locale_t;
+#endif
+
+/**
+ * Return the C locale for parsing numbers, independent of the locale of
+ * the application. It is created once and never freed.
+ */
+c_locale_t c_locale()
+{
+#ifdef _WIN32
+	static const c_locale_t locale = _create_locale(LC_NUMERIC, "C");
+#else
+	static const c_locale_t locale = newlocale(LC_NUMERIC_MASK, "C", 0);
+#endif
+	return locale;
+}
+
+/**
+ * Parse a CSV field as double in the C locale. Surrounding white space and
+ * quotes are ignored.
+ */
+bool parse_double_field(const char *begin, const char *end, double &value)
+{
+	while (begin < end && (*begin == ' ' || *begin == '\t' || *begin == '"'))
+		++begin;
+	while (end > begin && (end[-1] == ' ' || end[-1] == '\t' ||
+			end[-1] == '\r' || end[-1] == '"'))
+		--end;
+	if (begin == end)
+		return false;
+
+	// The field isn't terminated in the mapped file, so it is copied to a
+	// terminated buffer on the stack. No number needs more characters.
+	char field[64];
+	const size_t length = end - begin;
+	if (length >= sizeof(field))
+		return false;
+	std::memcpy(field, begin, length);
+	field[length] = '\0';
+
+	char *parse_end;
+#ifdef _WIN32
+	value = _strtod_l(field, &parse_end, c_locale());
+#else
+	value = strtod_l(field, &parse_end, c_locale());
+#endif
+	return parse_end == field + length;
+}
+
+} // namespace
+
+bool SequenceModel::load_csv(const QString &file_name,
+	vector<double> &values, vector<double> &delays)
+{
+	QFile file(file_name);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+
+	// Parse the mapped file in place. If the file can't be mapped (e.g. a
+	// pipe), it is read into memory.
+	QByteArray content;
+	const char *pos = nullptr;
+	qint64 size = file.size();
+	uchar *map = size > 0 ? file.map(0, size) : nullptr;
+	if (map) {
+		pos = reinterpret_cast<const char *>(map);
+	}
+	else {
+		content = file.readAll();
+		pos = content.constData();
+		size = content.size();
+	}
+	const char *end = pos + size;
+
+	// TODO: Define CSV file format somehow/somewhere...
+	// TODO: Parse header
+	while (pos < end) {
+		const char *line_end = static_cast<const char *>(
+			std::memchr(pos, '\n', end - pos));
+		if (!line_end)
+			line_end = end;
+
+		const char *sep = static_cast<const char *>(
+			std::memchr(pos, ',', line_end - pos));
+		if (sep) {
+			const char *delay_end = static_cast<const char *>(
+				std::memchr(sep + 1, ',', line_end - sep - 1));
+			if (!delay_end)
+				delay_end = line_end;
+
+			double value;
+			double delay;
+			if (parse_double_field(pos, sep, value) &&
+					parse_double_field(sep + 1, delay_end, delay)) {
+				values.push_back(value);
+				delays.push_back(delay);
+			}
+		}
+
+		pos = line_end < end ? line_end + 1 : end;
+	}
+
+	return true;
+}
+
+
 SequenceOutputView::SequenceOutputView(Session &session,
 		shared_ptr<sv::data::properties::DoubleProperty> property,
 		QWidget *parent) :
@@ -134,6 +377,10 @@ SequenceOutputView::SequenceOutputView(Session &session,
 
 	setup_ui();
 	setup_toolbar();
+
+	connect(session_.trigger_engine().get(),
+		&sv::data::TriggerEngine::stop_sequences,
+		this, &SequenceOutputView::on_stop_sequences);
 }
 
 SequenceOutputView::~SequenceOutputView()
@@ -169,14 +416,12 @@ void SequenceOutputView::setup_ui()
 	repeat_layout->addStretch(1);
 	layout->addItem(repeat_layout);
 
-	sequence_table_ = new QTableWidget();
-	sequence_table_->setColumnCount(2);
-	QTableWidgetItem *value_header_item = new QTableWidgetItem(tr("Value"));
-	sequence_table_->setHorizontalHeaderItem(0, value_header_item);
+	sequence_model_ = new SequenceModel(this);
+	sequence_table_ = new QTableView();
+	sequence_table_->setModel(sequence_model_);
+	sequence_table_->setSelectionBehavior(QAbstractItemView::SelectRows);
 	sequence_table_->horizontalHeader()->setSectionResizeMode(
 		0, QHeaderView::Stretch);
-	QTableWidgetItem *delay_header_item = new QTableWidgetItem(tr("Delay [s]"));
-	sequence_table_->setHorizontalHeaderItem(1, delay_header_item);
 	sequence_table_->horizontalHeader()->setSectionResizeMode(
 		1, QHeaderView::Stretch);
 	sequence_table_->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOn);
@@ -261,7 +506,7 @@ void SequenceOutputView::start_timer()
 
 	sequence_pos_ = 0;
 	sequence_reperat_count_ = 0;
-	if (sequence_table_->rowCount() == 0)
+	if (sequence_model_->size() == 0)
 		return;
 
 	connect(timer_, SIGNAL(timeout()), this, SLOT(on_timer_update()));
@@ -291,17 +536,6 @@ void SequenceOutputView::stop_timer()
 	sequence_reperat_count_ = 0;
 }
 
-void SequenceOutputView::insert_row(int row, double value, double delay)
-{
-	sequence_table_->insertRow(row);
-	QTableWidgetItem *value_item = new QTableWidgetItem(value);
-	value_item->setData(0, QVariant(value));
-	sequence_table_->setItem(row, 0, value_item);
-	QTableWidgetItem *delay_item = new QTableWidgetItem(delay);
-	delay_item->setData(0, QVariant(delay));
-	sequence_table_->setItem(row, 1, delay_item);
-}
-
 void SequenceOutputView::on_timer_update()
 {
 	bool found_value = sequence_pos_ > 0 ? true : false;
@@ -309,11 +543,11 @@ void SequenceOutputView::on_timer_update()
 	double delay_ms = .0;
 	// Cycle through the row until a duration is found.
 	do {
-		if (sequence_table_->rowCount() == 0) {
+		if (sequence_model_->size() == 0) {
 			stop_timer();
 			return;
 		}
-		if (sequence_pos_ >= sequence_table_->rowCount()) {
+		if (sequence_pos_ >= sequence_model_->size()) {
 			// Jump up to the first row
 			sequence_pos_ = 0;
 			if (!found_value) {
@@ -329,12 +563,8 @@ void SequenceOutputView::on_timer_update()
 			}
 		}
 
-		QTableWidgetItem *value_item = sequence_table_->item(sequence_pos_, 0);
-		if (value_item)
-			value = value_item->data(0).toDouble();
-		QTableWidgetItem *delay_item = sequence_table_->item(sequence_pos_, 1);
-		if (delay_item)
-			delay_ms = delay_item->data(0).toDouble() * 1000;
+		value = sequence_model_->value(sequence_pos_);
+		delay_ms = sequence_model_->delay(sequence_pos_) * 1000;
 
 		sequence_table_->selectRow(sequence_pos_);
 		sequence_pos_++;
@@ -345,6 +575,12 @@ void SequenceOutputView::on_timer_update()
 	timer_->setInterval(delay_ms);
 }
 
+void SequenceOutputView::on_stop_sequences()
+{
+	if (timer_->isActive())
+		stop_timer();
+}
+
 void SequenceOutputView::on_repeat_infinite_changed()
 {
 	if (repeat_infinite_box_->isChecked())
@@ -363,23 +599,31 @@ void SequenceOutputView::on_action_run_triggered()
 
 void SequenceOutputView::on_action_add_row()
 {
-	int row = sequence_table_->currentRow() + 1;
-	insert_row(row, .0, .0);
+	int row = sequence_table_->currentIndex().row() + 1;
+	sequence_model_->insert_step(row, .0, .0);
 }
 
 void SequenceOutputView::on_action_delete_row()
 {
-	// NOTE: If the cells are empty, there is no item to be returned by
-	//       selectedItems() and selectedIndexes() is protected...
-	auto items = sequence_table_->selectedItems();
-	for (const auto &item : items) {
-		sequence_table_->removeRow(item->row());
+	set<int> rows;
+	for (const auto &index :
+			sequence_table_->selectionModel()->selectedIndexes())
+		rows.insert(index.row());
+
+	// Remove the selected rows from the bottom up, adjacent rows at once.
+	auto it = rows.rbegin();
+	while (it != rows.rend()) {
+		int last_row = *it;
+		int first_row = last_row;
+		for (++it; it != rows.rend() && *it == first_row - 1; ++it)
+			first_row = *it;
+		sequence_model_->remove_steps(first_row, last_row - first_row + 1);
 	}
 }
 
 void SequenceOutputView::on_action_delete_all()
 {
-	sequence_table_->setRowCount(0);
+	sequence_model_->clear();
 }
 
 void SequenceOutputView::on_action_load_from_file_triggered()
@@ -389,32 +633,13 @@ void SequenceOutputView::on_action_load_from_file_triggered()
 	if (file_name.length() <= 0)
 		return;
 
-	int row = 0;
-	string line;
-	std::ifstream file(file_name.toStdString());
-	if (file.is_open()) {
-		while (std::getline(file, line)) {
-			auto fields = sv::util::parse_csv_line(line);
-
-			// TODO: Define CSV file format somehow/somewhere...
-			// TODO: Parse header
-			if (fields.size() < 2)
-				continue;
-			bool ok;
-			// NOTE: QString::toDouble() to avoid locales and use the C locale
-			double value = QString::fromStdString(fields[0]).toDouble(&ok);
-			if (!ok)
-				continue;
-			// NOTE: QString::toDouble() to avoid locales and use the C locale
-			double delay = QString::fromStdString(fields[1]).toDouble(&ok);
-			if (!ok)
-				continue;
-
-			insert_row(row, value, delay);
-			row++;
-		}
+	vector<double> values;
+	vector<double> delays;
+	if (!SequenceModel::load_csv(file_name, values, delays)) {
+		qWarning() << "SequenceOutputView: Can't read file" << file_name;
+		return;
 	}
-	file.close();
+	sequence_model_->insert_steps(0, values, delays);
 }
 
 void SequenceOutputView::on_action_generate_waveform_triggered()
@@ -423,11 +648,8 @@ void SequenceOutputView::on_action_generate_waveform_triggered()
 	if (!dlg.exec())
 		return;
 
-	vector<double> sequence_values = dlg.sequence_values();
-	vector<double> sequence_delays = dlg.sequence_delays();
-	for (size_t i=0; i<sequence_values.size(); ++i) {
-		insert_row(i, sequence_values[i], sequence_delays[i]);
-	}
+	sequence_model_->insert_steps(0,
+		dlg.sequence_values(), dlg.sequence_delays());
 }
 
 } // namespace views
@@ -21,15 +21,16 @@
 #define UI_VIEWS_SEQUENCEOUTPUTVIEW_HPP
 
 #include <memory>
+#include <vector>
 
+#include <QAbstractTableModel>
 #include <QAction>
 #include <QCheckBox>
 #include <QLocale>
 #include <QSpinBox>
 #include <QString>
-#include <QStringList>
 #include <QStyledItemDelegate>
-#include <QTableWidget>
+#include <QTableView>
 #include <QTimer>
 #include <QToolBar>
 #include <QVariant>
@@ -37,6 +38,7 @@
 #include "src/ui/views/baseview.hpp"
 
 using std::shared_ptr;
+using std::vector;
 
 namespace sv {
 
@@ -78,6 +80,57 @@ private:
 
 };
 
+/**
+ * The SequenceModel holds the steps of a sequence in two plain arrays, one
+ * for the values and one for the delays. The table view only requests the
+ * visible rows, so even sequences with many steps are shown fast and without
+ * an item object for every cell.
+ */
+class SequenceModel : public QAbstractTableModel
+{
+	Q_OBJECT
+
+public:
+	SequenceModel(QObject *parent = nullptr);
+
+	int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+	int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+	QVariant data(const QModelIndex &index,
+		int role = Qt::DisplayRole) const override;
+	bool setData(const QModelIndex &index, const QVariant &value,
+		int role = Qt::EditRole) override;
+	QVariant headerData(int section, Qt::Orientation orientation,
+		int role = Qt::DisplayRole) const override;
+	Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+	int size() const;
+	double value(int row) const;
+	/** The delay of the step in seconds. */
+	double delay(int row) const;
+
+	void insert_step(int row, double value, double delay);
+	/** Insert all steps at once. */
+	void insert_steps(int row,
+		const vector<double> &values, const vector<double> &delays);
+	void remove_steps(int row, int count);
+	void clear();
+
+	/**
+	 * Read the steps from a CSV file with the value in the first and the
+	 * delay in the second column. Lines without two numbers (e.g. a header)
+	 * are skipped. The file is memory mapped and parsed in place.
+	 *
+	 * @return false, if the file can't be read.
+	 */
+	static bool load_csv(const QString &file_name,
+		vector<double> &values, vector<double> &delays);
+
+private:
+	vector<double> values_;
+	vector<double> delays_;
+
+};
+
 class SequenceOutputView : public BaseView
 {
 	Q_OBJECT
@@ -102,7 +155,8 @@ private:
 	QTimer *timer_;
 	QCheckBox *repeat_infinite_box_;
 	QSpinBox *repeat_count_box_;
-	QTableWidget *sequence_table_;
+	SequenceModel *sequence_model_;
+	QTableView *sequence_table_;
 	int sequence_pos_;
 	int sequence_reperat_count_;
 
@@ -110,11 +164,10 @@ private:
 	void setup_toolbar();
 	void start_timer();
 	void stop_timer();
-	void insert_row(int row, double value, double delay);
-	QStringList parse_csv_line(QString line);
 
 private Q_SLOTS:
 	void on_timer_update();
+	void on_stop_sequences();
 	void on_repeat_infinite_changed();
 	void on_action_run_triggered();
 	void on_action_add_row();
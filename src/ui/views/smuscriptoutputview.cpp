@@ -17,16 +17,23 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <memory>
 #include <string>
 
 #include <QAction>
 #include <QBrush>
 #include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QFileDialog>
 #include <QFontDatabase>
+#include <QMessageBox>
 #include <QPlainTextEdit>
 #include <QScrollBar>
+#include <QSpinBox>
 #include <QString>
 #include <QTextCharFormat>
+#include <QTextCursor>
 #include <QToolBar>
 #include <QVBoxLayout>
 
@@ -42,7 +49,8 @@ SmuScriptOutputView::SmuScriptOutputView(Session &session, QWidget *parent) :
 	BaseView(session, parent),
 	auto_scroll_(true),
 	action_auto_scroll_(new QAction(this)),
-	action_clear_output_(new QAction(this))
+	action_clear_output_(new QAction(this)),
+	action_log_file_(new QAction(this))
 {
 	// TODO: Not unique!
 	id_ = "smuscriptoutput:";
@@ -51,6 +59,12 @@ SmuScriptOutputView::SmuScriptOutputView(Session &session, QWidget *parent) :
 	setup_toolbar();
 }
 
+SmuScriptOutputView::~SmuScriptOutputView()
+{
+	if (log_file_)
+		log_file_->close();
+}
+
 QString SmuScriptOutputView::title() const
 {
 	return tr("SmuScript Output");
@@ -67,6 +81,9 @@ void SmuScriptOutputView::setup_ui()
 	font.setFixedPitch(true);
 	font.setPointSize(10);
 	output_edit_->setFont(font);
+	// Old lines are removed, so the layout doesn't grow without limit.
+	output_edit_->setMaximumBlockCount(default_scrollback);
+	output_edit_->setUndoRedoEnabled(false);
 
 	layout->addWidget(output_edit_);
 
@@ -91,10 +108,33 @@ void SmuScriptOutputView::setup_toolbar()
 	connect(action_clear_output_, SIGNAL(triggered(bool)),
 		this, SLOT(on_action_clear_output_triggered()));
 
+	action_log_file_->setText(tr("Log to file"));
+	action_log_file_->setIcon(
+		QIcon::fromTheme("document-save-as",
+		QIcon(":/icons/document-save-as.png")));
+	action_log_file_->setCheckable(true);
+	action_log_file_->setChecked(false);
+	connect(action_log_file_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_log_file_triggered()));
+
+	scrollback_box_ = new QSpinBox();
+	scrollback_box_->setToolTip(tr("Number of lines, that are kept"));
+	scrollback_box_->setRange(0, 10000000);
+	scrollback_box_->setSingleStep(1000);
+	scrollback_box_->setSuffix(tr(" lines"));
+	scrollback_box_->setSpecialValueText(tr("Unlimited"));
+	scrollback_box_->setValue(default_scrollback);
+	connect(scrollback_box_,
+		static_cast<void (QSpinBox::*)(int)>(&QSpinBox::valueChanged),
+		this, &SmuScriptOutputView::on_scrollback_changed);
+
 	toolbar_ = new QToolBar("SmuScript Output Toolbar");
 	toolbar_->addAction(action_auto_scroll_);
 	toolbar_->addSeparator();
 	toolbar_->addAction(action_clear_output_);
+	toolbar_->addSeparator();
+	toolbar_->addAction(action_log_file_);
+	toolbar_->addWidget(scrollback_box_);
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
 }
 
@@ -104,24 +144,54 @@ void SmuScriptOutputView::scroll_to_bottom()
 		output_edit_->verticalScrollBar()->maximum());
 }
 
-void SmuScriptOutputView::append_out_text(const std::string &text)
+void SmuScriptOutputView::append_text(const std::string &text, bool is_error)
 {
-	output_edit_->appendPlainText(QString::fromStdString(text));
+	if (text.empty())
+		return;
+
+	// The log file gets the complete output.
+	if (log_file_ &&
+			log_file_->write(text.data(), (qint64)text.size()) < 0) {
+		qWarning() << "SmuScriptOutputView: Can't write to log file" <<
+			log_file_->fileName() << log_file_->errorString();
+		log_file_.reset();
+		action_log_file_->setChecked(false);
+	}
+
+	// Skip the lines, that would be removed right away by the scrollback
+	// limit, before they are layouted.
+	size_t start = 0;
+	const int max_lines = scrollback_box_->value();
+	if (max_lines > 0) {
+		int lines = 0;
+		for (size_t pos = text.size(); pos > 0; --pos) {
+			if (text[pos - 1] == '\n' && ++lines > max_lines) {
+				start = pos;
+				break;
+			}
+		}
+	}
+
+	QTextCharFormat tcf;
+	if (is_error)
+		tcf.setForeground(QBrush(Qt::red));
+	QTextCursor cursor(output_edit_->document());
+	cursor.movePosition(QTextCursor::End);
+	cursor.insertText(QString::fromUtf8(
+		text.data() + start, (int)(text.size() - start)), tcf);
+
 	if (auto_scroll_)
 		scroll_to_bottom();
 }
 
+void SmuScriptOutputView::append_out_text(const std::string &text)
+{
+	append_text(text, false);
+}
+
 void SmuScriptOutputView::append_err_text(const std::string &text)
 {
-	QTextCharFormat tcf = output_edit_->currentCharFormat();
-	QBrush old_brush = tcf.foreground();
-	tcf.setForeground(QBrush(Qt::red));
-	output_edit_->setCurrentCharFormat(tcf);
-	output_edit_->appendPlainText(QString::fromStdString(text));
-	tcf.setForeground(old_brush);
-	output_edit_->setCurrentCharFormat(tcf);
-	if (auto_scroll_)
-		scroll_to_bottom();
+	append_text(text, true);
 }
 
 void SmuScriptOutputView::on_action_auto_scroll_triggered()
@@ -135,6 +205,37 @@ void SmuScriptOutputView::on_action_clear_output_triggered()
 	output_edit_->clear();
 }
 
+void SmuScriptOutputView::on_action_log_file_triggered()
+{
+	if (!action_log_file_->isChecked()) {
+		log_file_.reset();
+		return;
+	}
+
+	QString file_name = QFileDialog::getSaveFileName(this,
+		tr("Log SmuScript Output"), QDir::homePath(),
+		tr("Log Files (*.log);;All Files (*)"));
+	if (file_name.length() <= 0) {
+		action_log_file_->setChecked(false);
+		return;
+	}
+
+	log_file_.reset(new QFile(file_name));
+	if (!log_file_->open(QFile::WriteOnly | QFile::Append | QFile::Text)) {
+		QMessageBox::critical(this, tr("File error"),
+			tr("Could not open file \"%1\".").arg(file_name),
+			QMessageBox::Ok);
+		log_file_.reset();
+		action_log_file_->setChecked(false);
+	}
+}
+
+void SmuScriptOutputView::on_scrollback_changed(int lines)
+{
+	// 0 means no limit, like QPlainTextEdit::maximumBlockCount.
+	output_edit_->setMaximumBlockCount(lines);
+}
+
 } // namespace views
 } // namespace ui
 } // namespace sv
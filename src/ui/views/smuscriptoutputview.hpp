@@ -20,10 +20,13 @@
 #ifndef UI_VIEWS_SMUSCRIPTOUTPUTVIEW_HPP
 #define UI_VIEWS_SMUSCRIPTOUTPUTVIEW_HPP
 
+#include <memory>
 #include <string>
 
 #include <QAction>
+#include <QFile>
 #include <QPlainTextEdit>
+#include <QSpinBox>
 #include <QString>
 #include <QToolBar>
 
@@ -36,12 +39,21 @@ class Session;
 namespace ui {
 namespace views {
 
+/**
+ * Shows the output of a script. The output arrives in large pieces (see
+ * python::ScriptOutputBuffer), only the last lines (scrollback) are kept.
+ * The complete output can be written to a log file.
+ */
 class SmuScriptOutputView : public BaseView
 {
 	Q_OBJECT
 
 public:
+	/** The default number of lines, that are kept in the view. */
+	static const int default_scrollback = 10000;
+
 	SmuScriptOutputView(Session& session, QWidget* parent = nullptr);
+	~SmuScriptOutputView();
 
 	QString title() const override;
 
@@ -49,12 +61,16 @@ private:
 	bool auto_scroll_;
 	QAction *const action_auto_scroll_;
 	QAction *const action_clear_output_;
+	QAction *const action_log_file_;
+	QSpinBox *scrollback_box_;
 	QToolBar *toolbar_;
 	QPlainTextEdit *output_edit_;
+	std::unique_ptr<QFile> log_file_;
 
 	void setup_ui();
 	void setup_toolbar();
 	void scroll_to_bottom();
+	void append_text(const std::string &text, bool is_error);
 
 public Q_SLOTS:
 	void append_out_text(const std::string &text);
@@ -63,6 +79,8 @@ public Q_SLOTS:
 private Q_SLOTS:
 	void on_action_auto_scroll_triggered();
 	void on_action_clear_output_triggered();
+	void on_action_log_file_triggered();
+	void on_scrollback_changed(int lines);
 
 };
 
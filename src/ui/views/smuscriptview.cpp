@@ -36,6 +36,9 @@
 
 #include "smuscriptview.hpp"
 #include "src/session.hpp"
+#ifdef ENABLE_SCRIPTHOST
+#include "src/python/scripthostprocess.hpp"
+#endif
 #include "src/python/smuscriptrunner.hpp"
 #include "src/ui/views/baseview.hpp"
 
@@ -56,6 +59,12 @@ SmuScriptView::SmuScriptView(Session &session, string script_file_name,
 	text_changed_(false),
 	started_from_here_(false)
 {
+#ifdef ENABLE_SCRIPTHOST
+	action_run_in_host_ = new QAction(this);
+	script_host_process_ = new python::ScriptHostProcess(session_, this);
+	running_in_host_ = false;
+#endif
+
 	// TODO: Not unique!
 	id_ = "smuscript:";
 
@@ -74,6 +83,13 @@ QString SmuScriptView::title() const
 	}
 }
 
+#ifdef ENABLE_SCRIPTHOST
+python::ScriptHostProcess *SmuScriptView::script_host_process() const
+{
+	return script_host_process_;
+}
+#endif
+
 bool SmuScriptView::ask_to_save(const QString &title)
 {
 	if (!text_changed_)
@@ -156,12 +172,32 @@ void SmuScriptView::setup_toolbar()
 	if (session_.smu_script_runner()->is_running())
 		action_run_->setDisabled(true);
 
+#ifdef ENABLE_SCRIPTHOST
+	// A script in a separate process can't block the GUI or crash SmuView,
+	// and several of them can run at the same time.
+	action_run_in_host_->setText(tr("Run in a separate process"));
+	action_run_in_host_->setIconText(tr("Separate process"));
+	action_run_in_host_->setToolTip(tr("Run the script in its own process "
+		"with the smuview_host module instead of the smuview module"));
+	action_run_in_host_->setCheckable(true);
+	action_run_in_host_->setChecked(false);
+	connect(action_run_in_host_, &QAction::toggled, this, [this](bool checked) {
+		// Only the scripts in the SmuView process block each other.
+		if (!started_from_here_)
+			action_run_->setDisabled(
+				!checked && session_.smu_script_runner()->is_running());
+	});
+#endif
+
 	toolbar_ = new QToolBar("SmuScript Toolbar");
 	toolbar_->addAction(action_open_);
 	toolbar_->addAction(action_save_);
 	toolbar_->addAction(action_save_as_);
 	toolbar_->addSeparator();
 	toolbar_->addAction(action_run_);
+#ifdef ENABLE_SCRIPTHOST
+	toolbar_->addAction(action_run_in_host_);
+#endif
 	this->addToolBar(Qt::TopToolBarArea, toolbar_);
 }
 
@@ -174,6 +210,11 @@ void SmuScriptView::connect_signals()
 		this, &SmuScriptView::on_script_started);
 	connect(session_.smu_script_runner().get(), &python::SmuScriptRunner::script_finished,
 		this, &SmuScriptView::on_script_finished);
+
+#ifdef ENABLE_SCRIPTHOST
+	connect(script_host_process_, &python::ScriptHostProcess::script_finished,
+		this, &SmuScriptView::on_host_script_finished);
+#endif
 }
 
 bool SmuScriptView::save(QString file_name)
@@ -266,9 +307,28 @@ void SmuScriptView::on_action_run_triggered()
 			QIcon(":/icons/media-playback-stop.png")));
 
 		started_from_here_ = true;
+#ifdef ENABLE_SCRIPTHOST
+		if (action_run_in_host_->isChecked()) {
+			running_in_host_ = true;
+			action_run_in_host_->setDisabled(true);
+			script_host_process_->run(script_file_name_);
+			// The script host could not be started.
+			if (running_in_host_ && !script_host_process_->is_running())
+				on_host_script_finished();
+			return;
+		}
+#endif
 		session_.smu_script_runner()->run(script_file_name_);
 	}
 	else {
+#ifdef ENABLE_SCRIPTHOST
+		// The button is reset, when the script host has finished.
+		if (running_in_host_) {
+			action_run_->setDisabled(true);
+			script_host_process_->stop();
+			return;
+		}
+#endif
 		action_run_->setText(tr("Run"));
 		action_run_->setIconText(tr("Run"));
 		action_run_->setIcon(
@@ -280,8 +340,26 @@ void SmuScriptView::on_action_run_triggered()
 	}
 }
 
+void SmuScriptView::reset_action_run()
+{
+	action_run_->setText(tr("Run"));
+	action_run_->setIconText(tr("Run"));
+	action_run_->setIcon(
+		QIcon::fromTheme("media-playback-start",
+		QIcon(":/icons/media-playback-start.png")));
+	action_run_->setChecked(false);
+	started_from_here_ = false;
+}
+
 void SmuScriptView::on_script_started()
 {
+#ifdef ENABLE_SCRIPTHOST
+	// The script host doesn't use the SmuScriptRunner.
+	if (running_in_host_)
+		return;
+	if (action_run_in_host_->isChecked() && !started_from_here_)
+		return;
+#endif
 	if (started_from_here_)
 		Q_EMIT script_started();
 	else
@@ -290,21 +368,33 @@ void SmuScriptView::on_script_started()
 
 void SmuScriptView::on_script_finished()
 {
+#ifdef ENABLE_SCRIPTHOST
+	if (running_in_host_)
+		return;
+#endif
 	if (started_from_here_) {
-		action_run_->setText(tr("Run"));
-		action_run_->setIconText(tr("Run"));
-		action_run_->setIcon(
-			QIcon::fromTheme("media-playback-start",
-			QIcon(":/icons/media-playback-start.png")));
-		action_run_->setChecked(false);
-		started_from_here_ = false;
-
+		reset_action_run();
 		Q_EMIT script_finished();
 	}
 	else
 		action_run_->setDisabled(false);
 }
 
+#ifdef ENABLE_SCRIPTHOST
+void SmuScriptView::on_host_script_finished()
+{
+	if (!running_in_host_)
+		return;
+
+	running_in_host_ = false;
+	action_run_in_host_->setDisabled(false);
+	reset_action_run();
+	// Another script could have been started in the SmuView process.
+	action_run_->setDisabled(!action_run_in_host_->isChecked() &&
+		session_.smu_script_runner()->is_running());
+}
+#endif
+
 } // namespace views
 } // namespace ui
 } // namespace sv
@@ -35,6 +35,10 @@ namespace sv {
 
 class Session;
 
+namespace python {
+class ScriptHostProcess;
+}
+
 namespace ui {
 namespace views {
 
@@ -48,6 +52,13 @@ public:
 
 	QString title() const override;
 	bool ask_to_save(const QString &title);
+#ifdef ENABLE_SCRIPTHOST
+	/**
+	 * Return the script host process of this view, that runs the script,
+	 * when "Run in a separate process" is checked.
+	 */
+	python::ScriptHostProcess *script_host_process() const;
+#endif
 
 private:
 	string script_file_name_;
@@ -59,11 +70,18 @@ private:
 	QCodeEditor *editor_;
 	bool text_changed_;
 	bool started_from_here_;
+#ifdef ENABLE_SCRIPTHOST
+	QAction *action_run_in_host_;
+	python::ScriptHostProcess *script_host_process_;
+	/** The script of this view is running in the script host. */
+	bool running_in_host_;
+#endif
 
 	void setup_ui();
 	void setup_toolbar();
 	void connect_signals();
 	bool save(QString file_name);
+	void reset_action_run();
 
 private Q_SLOTS:
 	void on_action_open_triggered();
@@ -73,6 +91,9 @@ private Q_SLOTS:
 	void on_text_changed();
 	void on_script_started();
 	void on_script_finished();
+#ifdef ENABLE_SCRIPTHOST
+	void on_host_script_finished();
+#endif
 
 Q_SIGNALS:
 	void file_name_changed(const QString &file_name);
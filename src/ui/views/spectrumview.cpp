@@ -0,0 +1,242 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <memory>
+
+#include <QVBoxLayout>
+#include <qwt_plot.h>
+#include <qwt_plot_curve.h>
+#include <qwt_plot_grid.h>
+#include <qwt_scale_engine.h>
+
+#include "spectrumview.hpp"
+#include "src/session.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/spectrumanalyzer.hpp"
+
+using std::make_shared;
+using sv::data::SpectrumAnalyzer;
+using sv::data::SpectrumAveraging;
+using sv::data::SpectrumWindow;
+
+namespace sv {
+namespace ui {
+namespace views {
+
+namespace {
+
+/** Lower bound of the magnitudes for the logarithmic axis. */
+const double min_magnitude = 1e-12;
+
+}
+
+SpectrumView::SpectrumView(Session &session,
+		shared_ptr<sv::data::AnalogTimeSignal> signal,
+		QWidget *parent) :
+	BaseView(session, parent),
+	signal_(signal),
+	analyzer_(make_shared<SpectrumAnalyzer>(signal)),
+	action_reset_(new QAction(this))
+{
+	id_ = "spectrum:" + signal_->name();
+
+	setup_ui();
+	setup_toolbar();
+	connect_signals();
+
+	analyzer_->start();
+	FrameScheduler::instance().add_client(this, this);
+}
+
+SpectrumView::~SpectrumView()
+{
+	FrameScheduler::instance().remove_client(this);
+	analyzer_->stop();
+}
+
+QString SpectrumView::title() const
+{
+	return tr("Spectrum") + " " + signal_->display_name();
+}
+
+shared_ptr<sv::data::SpectrumAnalyzer> SpectrumView::analyzer() const
+{
+	return analyzer_;
+}
+
+void SpectrumView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+
+	plot_ = new QwtPlot();
+	plot_->setCanvasBackground(QBrush(Qt::white));
+	plot_->setAxisTitle(QwtPlot::xBottom, tr("Frequency [Hz]"));
+	plot_->setAxisTitle(QwtPlot::yLeft,
+		tr("Amplitude") + " [" + signal_->unit_name() + "]");
+	plot_->setAxisScaleEngine(QwtPlot::yLeft, new QwtLogScaleEngine());
+	plot_->setAxisAutoScale(QwtPlot::xBottom, true);
+	plot_->setAxisAutoScale(QwtPlot::yLeft, true);
+
+	QwtPlotGrid *grid = new QwtPlotGrid();
+	grid->setPen(Qt::gray, 0.0, Qt::DotLine);
+	grid->enableX(true);
+	grid->enableY(true);
+	grid->enableYMin(true);
+	grid->attach(plot_);
+
+	curve_ = new QwtPlotCurve(signal_->display_name());
+	curve_->setPen(Qt::blue, 1.0);
+	curve_->setRenderHint(QwtPlotItem::RenderAntialiased, true);
+	curve_->setPaintAttribute(QwtPlotCurve::FilterPoints, true);
+	curve_->attach(plot_);
+
+	layout->addWidget(plot_);
+	this->central_widget_->setLayout(layout);
+}
+
+void SpectrumView::setup_toolbar()
+{
+	action_reset_->setText(tr("Reset spectrum"));
+	action_reset_->setIcon(
+		QIcon::fromTheme("view-refresh",
+		QIcon(":/icons/view-refresh.png")));
+	connect(action_reset_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_reset_triggered()));
+
+	window_box_ = new QComboBox();
+	window_box_->setToolTip(tr("Window function"));
+	for (const auto &window_pair : sv::data::spectrum_window_name_map) {
+		window_box_->addItem(window_pair.second,
+			QVariant((int)window_pair.first));
+	}
+	window_box_->setCurrentIndex(
+		window_box_->findData(QVariant((int)analyzer_->window())));
+
+	fft_size_box_ = new QComboBox();
+	fft_size_box_->setToolTip(tr("Number of samples per FFT frame"));
+	for (size_t size = 256; size <= 65536; size <<= 1) {
+		fft_size_box_->addItem(
+			QString::number(size), QVariant((qulonglong)size));
+	}
+	fft_size_box_->setCurrentIndex(fft_size_box_->findData(
+		QVariant((qulonglong)analyzer_->fft_size())));
+
+	averaging_box_ = new QComboBox();
+	averaging_box_->setToolTip(tr("Combine the spectra of the frames"));
+	for (const auto &averaging_pair : sv::data::spectrum_averaging_name_map) {
+		averaging_box_->addItem(averaging_pair.second,
+			QVariant((int)averaging_pair.first));
+	}
+	averaging_box_->setCurrentIndex(
+		averaging_box_->findData(QVariant((int)analyzer_->averaging())));
+
+	info_label_ = new QLabel();
+
+	toolbar_ = new QToolBar("Spectrum Toolbar");
+	toolbar_->addAction(action_reset_);
+	toolbar_->addSeparator();
+	toolbar_->addWidget(window_box_);
+	toolbar_->addWidget(fft_size_box_);
+	toolbar_->addWidget(averaging_box_);
+	toolbar_->addSeparator();
+	toolbar_->addWidget(info_label_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void SpectrumView::connect_signals()
+{
+	connect(window_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_window_changed()));
+	connect(fft_size_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_fft_size_changed()));
+	connect(averaging_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_averaging_changed()));
+}
+
+void SpectrumView::update_info()
+{
+	double interval = analyzer_->sample_interval();
+	if (interval <= 0.) {
+		info_label_->setText("");
+		return;
+	}
+
+	double samplerate = 1. / interval;
+	double resolution = samplerate / analyzer_->fft_size();
+	info_label_->setText(
+		tr("fs = %1 Hz, RBW = %2 Hz, %3 frames").
+		arg(samplerate, 0, 'g', 6).
+		arg(resolution, 0, 'g', 4).
+		arg(analyzer_->frame_count()));
+}
+
+bool SpectrumView::has_frame_update() const
+{
+	return analyzer_->has_new_spectrum();
+}
+
+void SpectrumView::update_frame()
+{
+	analyzer_->spectrum(frequencies_, magnitudes_);
+
+	// Skip the DC bin, it would compress the logarithmic axis.
+	size_t first = frequencies_.size() > 1 ? 1 : 0;
+	for (size_t i = first; i < magnitudes_.size(); ++i)
+		magnitudes_[i] = std::max(magnitudes_[i], min_magnitude);
+	curve_->setSamples(frequencies_.data() + first, magnitudes_.data() + first,
+		(int)(frequencies_.size() - first));
+	plot_->replot();
+
+	update_info();
+	signal_->mark_consumed();
+}
+
+QString SpectrumView::frame_client_name() const
+{
+	return title();
+}
+
+void SpectrumView::on_action_reset_triggered()
+{
+	analyzer_->reset();
+}
+
+void SpectrumView::on_window_changed()
+{
+	analyzer_->set_window(
+		(SpectrumWindow)window_box_->currentData().toInt());
+}
+
+void SpectrumView::on_fft_size_changed()
+{
+	analyzer_->set_fft_size(
+		(size_t)fft_size_box_->currentData().toULongLong());
+}
+
+void SpectrumView::on_averaging_changed()
+{
+	analyzer_->set_averaging(
+		(SpectrumAveraging)averaging_box_->currentData().toInt(),
+		analyzer_->average_count());
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
@@ -0,0 +1,108 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_SPECTRUMVIEW_HPP
+#define UI_VIEWS_SPECTRUMVIEW_HPP
+
+#include <memory>
+#include <vector>
+
+#include <QAction>
+#include <QComboBox>
+#include <QLabel>
+#include <QString>
+#include <QToolBar>
+
+#include "src/ui/framescheduler.hpp"
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+class QwtPlot;
+class QwtPlotCurve;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+class SpectrumAnalyzer;
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * The SpectrumView shows the amplitude spectrum of an analog time signal.
+ * The spectrum is calculated by a SpectrumAnalyzer on a worker thread, the
+ * view only fetches and renders the finished spectrum in update_frame().
+ */
+class SpectrumView : public BaseView, public ui::FrameClient
+{
+	Q_OBJECT
+
+public:
+	SpectrumView(Session &session,
+		shared_ptr<sv::data::AnalogTimeSignal> signal,
+		QWidget *parent = nullptr);
+	~SpectrumView();
+
+	QString title() const override;
+
+	bool has_frame_update() const override;
+	void update_frame() override;
+	QString frame_client_name() const override;
+
+	shared_ptr<sv::data::SpectrumAnalyzer> analyzer() const;
+
+private:
+	shared_ptr<sv::data::AnalogTimeSignal> signal_;
+	shared_ptr<sv::data::SpectrumAnalyzer> analyzer_;
+	vector<double> frequencies_;
+	vector<double> magnitudes_;
+
+	QAction *const action_reset_;
+	QToolBar *toolbar_;
+	QComboBox *window_box_;
+	QComboBox *fft_size_box_;
+	QComboBox *averaging_box_;
+	QLabel *info_label_;
+	QwtPlot *plot_;
+	QwtPlotCurve *curve_;
+
+	void setup_ui();
+	void setup_toolbar();
+	void connect_signals();
+	void update_info();
+
+private Q_SLOTS:
+	void on_action_reset_triggered();
+	void on_window_changed();
+	void on_fft_size_changed();
+	void on_averaging_changed();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_SPECTRUMVIEW_HPP
@@ -0,0 +1,329 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cassert>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include <QAction>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QFormLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QMessageBox>
+#include <QRegExp>
+#include <QSpinBox>
+#include <QString>
+#include <QStringList>
+#include <QToolBar>
+#include <QVariant>
+#include <QVBoxLayout>
+
+#include "sweepview.hpp"
+#include "src/session.hpp"
+#include "src/data/analogtimesignal.hpp"
+#include "src/data/datautil.hpp"
+#include "src/data/sweep.hpp"
+#include "src/data/properties/doubleproperty.hpp"
+#include "src/devices/configurable.hpp"
+#include "src/devices/userdevice.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+Q_DECLARE_METATYPE(sv::data::SweepType)
+
+namespace sv {
+namespace ui {
+namespace views {
+
+SweepView::SweepView(Session &session,
+		shared_ptr<sv::data::properties::DoubleProperty> property,
+		const vector<shared_ptr<sv::data::AnalogTimeSignal>> &signals,
+		QWidget *parent) :
+	BaseView(session, parent),
+	property_(property),
+	action_run_(new QAction(this))
+{
+	assert(property_);
+	id_ = "sweep:" + property_->configurable()->name() +
+		":" + property_->name();
+	for (const auto &signal : signals)
+		id_ += ":" + signal->name();
+
+	sweep_ = std::make_shared<sv::data::Sweep>(session_, property_, signals);
+
+	setup_ui();
+	setup_toolbar();
+	connect_signals();
+}
+
+SweepView::~SweepView()
+{
+	disconnect(sweep_.get(), nullptr, this, nullptr);
+	sweep_->stop();
+}
+
+QString SweepView::title() const
+{
+	return tr("Sweep") + " " + property_->display_name();
+}
+
+void SweepView::setup_ui()
+{
+	QVBoxLayout *layout = new QVBoxLayout();
+	QFormLayout *form_layout = new QFormLayout();
+
+	type_box_ = new QComboBox();
+	for (const auto &type_name_pair : sv::data::sweep_type_name_map) {
+		type_box_->addItem(
+			type_name_pair.second, QVariant::fromValue(type_name_pair.first));
+	}
+	form_layout->addRow(tr("Type"), type_box_);
+
+	QString unit = sv::data::datautil::format_unit(property_->unit());
+	start_box_ = new QDoubleSpinBox();
+	start_box_->setDecimals(property_->decimal_places());
+	start_box_->setRange(property_->min(), property_->max());
+	start_box_->setSingleStep(property_->step());
+	start_box_->setSuffix(" " + unit);
+	start_box_->setValue(property_->min());
+	form_layout->addRow(tr("Start"), start_box_);
+
+	stop_box_ = new QDoubleSpinBox();
+	stop_box_->setDecimals(property_->decimal_places());
+	stop_box_->setRange(property_->min(), property_->max());
+	stop_box_->setSingleStep(property_->step());
+	stop_box_->setSuffix(" " + unit);
+	stop_box_->setValue(property_->max());
+	form_layout->addRow(tr("Stop"), stop_box_);
+
+	step_count_box_ = new QSpinBox();
+	step_count_box_->setRange(1, 1000000);
+	step_count_box_->setValue(11);
+	form_layout->addRow(tr("Steps"), step_count_box_);
+
+	list_edit_ = new QLineEdit();
+	list_edit_->setPlaceholderText(tr("e.g. 1, 1.5, 2.2, 3.3"));
+	form_layout->addRow(tr("List"), list_edit_);
+
+	settle_delay_box_ = new QDoubleSpinBox();
+	settle_delay_box_->setDecimals(3);
+	settle_delay_box_->setRange(0, 3600);
+	settle_delay_box_->setSingleStep(0.1);
+	settle_delay_box_->setSuffix(" s");
+	settle_delay_box_->setValue(0.1);
+	form_layout->addRow(tr("Settle delay"), settle_delay_box_);
+
+	settle_samples_box_ = new QSpinBox();
+	settle_samples_box_->setRange(1, 10000);
+	settle_samples_box_->setValue(3);
+	form_layout->addRow(tr("Settle samples"), settle_samples_box_);
+
+	settle_tolerance_box_ = new QDoubleSpinBox();
+	settle_tolerance_box_->setDecimals(6);
+	settle_tolerance_box_->setRange(0, 1000000);
+	settle_tolerance_box_->setSpecialValueText(tr("Off"));
+	settle_tolerance_box_->setValue(0);
+	form_layout->addRow(tr("Settle tolerance"), settle_tolerance_box_);
+
+	timeout_box_ = new QDoubleSpinBox();
+	timeout_box_->setDecimals(1);
+	timeout_box_->setRange(0, 86400);
+	timeout_box_->setSuffix(" s");
+	timeout_box_->setSpecialValueText(tr("None"));
+	timeout_box_->setValue(10);
+	form_layout->addRow(tr("Timeout"), timeout_box_);
+
+	layout->addItem(form_layout);
+
+	status_label_ = new QLabel();
+	layout->addWidget(status_label_);
+	layout->addStretch(1);
+
+	this->central_widget_->setLayout(layout);
+
+	on_type_changed();
+}
+
+void SweepView::setup_toolbar()
+{
+	action_run_->setText(tr("Run sweep"));
+	action_run_->setIcon(
+		QIcon::fromTheme("media-playback-start",
+		QIcon(":/icons/media-playback-start.png")));
+	action_run_->setCheckable(true);
+	action_run_->setChecked(false);
+	connect(action_run_, SIGNAL(triggered(bool)),
+		this, SLOT(on_action_run_triggered()));
+
+	toolbar_ = new QToolBar("Sweep Toolbar");
+	toolbar_->addAction(action_run_);
+	this->addToolBar(Qt::TopToolBarArea, toolbar_);
+}
+
+void SweepView::connect_signals()
+{
+	connect(type_box_, SIGNAL(currentIndexChanged(int)),
+		this, SLOT(on_type_changed()));
+
+	connect(sweep_.get(), &sv::data::Sweep::started,
+		this, &SweepView::on_sweep_started);
+	connect(sweep_.get(), &sv::data::Sweep::step_finished,
+		this, &SweepView::on_sweep_step_finished);
+	connect(sweep_.get(), &sv::data::Sweep::finished,
+		this, &SweepView::on_sweep_finished);
+}
+
+void SweepView::set_controls_enabled(bool enabled)
+{
+	type_box_->setEnabled(enabled);
+	settle_delay_box_->setEnabled(enabled);
+	settle_samples_box_->setEnabled(enabled);
+	settle_tolerance_box_->setEnabled(enabled);
+	timeout_box_->setEnabled(enabled);
+	if (enabled) {
+		on_type_changed();
+	}
+	else {
+		start_box_->setEnabled(false);
+		stop_box_->setEnabled(false);
+		step_count_box_->setEnabled(false);
+		list_edit_->setEnabled(false);
+	}
+}
+
+bool SweepView::apply_settings()
+{
+	auto type = type_box_->currentData().value<sv::data::SweepType>();
+	vector<double> steps;
+	if (type == sv::data::SweepType::List) {
+		QStringList items = list_edit_->text().split(
+			QRegExp("[,;\\s]+"), QString::SkipEmptyParts);
+		for (const auto &item : items) {
+			bool ok;
+			double value = item.toDouble(&ok);
+			if (!ok) {
+				QMessageBox::warning(this, tr("Invalid sweep"),
+					tr("\"%1\" is not a valid number.").arg(item),
+					QMessageBox::Ok);
+				return false;
+			}
+			steps.push_back(value);
+		}
+		if (steps.empty()) {
+			QMessageBox::warning(this, tr("Invalid sweep"),
+				tr("The list of steps is empty."), QMessageBox::Ok);
+			return false;
+		}
+	}
+	else {
+		try {
+			steps = sv::data::Sweep::generate_steps(type,
+				start_box_->value(), stop_box_->value(),
+				(size_t)step_count_box_->value());
+		}
+		catch (const std::invalid_argument &e) {
+			QMessageBox::warning(this, tr("Invalid sweep"),
+				QString::fromStdString(e.what()), QMessageBox::Ok);
+			return false;
+		}
+	}
+
+	sweep_->set_steps(steps);
+	sweep_->set_settle(settle_delay_box_->value(),
+		(size_t)settle_samples_box_->value(), settle_tolerance_box_->value(),
+		timeout_box_->value());
+	return true;
+}
+
+void SweepView::on_type_changed()
+{
+	bool is_list = type_box_->currentData().value<sv::data::SweepType>() ==
+		sv::data::SweepType::List;
+	start_box_->setEnabled(!is_list);
+	stop_box_->setEnabled(!is_list);
+	step_count_box_->setEnabled(!is_list);
+	list_edit_->setEnabled(is_list);
+}
+
+void SweepView::on_action_run_triggered()
+{
+	if (!action_run_->isChecked()) {
+		sweep_->stop();
+		return;
+	}
+
+	if (!apply_settings()) {
+		action_run_->setChecked(false);
+		return;
+	}
+	sweep_->start();
+}
+
+void SweepView::on_sweep_started()
+{
+	set_controls_enabled(false);
+	status_label_->setText(tr("Step %1 of %2").
+		arg(1).arg(sweep_->steps().size()));
+
+	action_run_->setText(tr("Stop"));
+	action_run_->setIcon(
+		QIcon::fromTheme("media-playback-stop",
+		QIcon(":/icons/media-playback-stop.png")));
+	action_run_->setChecked(true);
+}
+
+void SweepView::on_sweep_step_finished(size_t index, double value,
+	bool settled)
+{
+	(void)value;
+	(void)settled;
+
+	size_t step_count = sweep_->steps().size();
+	size_t step = index + 2 <= step_count ? index + 2 : step_count;
+	status_label_->setText(tr("Step %1 of %2, %3 not settled").
+		arg(step).arg(step_count).arg(sweep_->unsettled_count()));
+}
+
+void SweepView::on_sweep_finished()
+{
+	set_controls_enabled(true);
+	QString text = tr("Finished after %1 of %2 steps, %3 not settled").
+		arg(sweep_->step_index() + 1).arg(sweep_->steps().size()).
+		arg(sweep_->unsettled_count());
+	if (sweep_->result_device()) {
+		text += "\n" + tr("Results in device %1").arg(
+			sweep_->result_device()->display_name(
+				session_.device_manager()));
+	}
+	status_label_->setText(text);
+
+	action_run_->setText(tr("Run sweep"));
+	action_run_->setIcon(
+		QIcon::fromTheme("media-playback-start",
+		QIcon(":/icons/media-playback-start.png")));
+	action_run_->setChecked(false);
+}
+
+} // namespace views
+} // namespace ui
+} // namespace sv
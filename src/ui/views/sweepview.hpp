@@ -0,0 +1,106 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_VIEWS_SWEEPVIEW_HPP
+#define UI_VIEWS_SWEEPVIEW_HPP
+
+#include <memory>
+#include <vector>
+
+#include <QAction>
+#include <QComboBox>
+#include <QDoubleSpinBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QSpinBox>
+#include <QToolBar>
+
+#include "src/ui/views/baseview.hpp"
+
+using std::shared_ptr;
+using std::vector;
+
+namespace sv {
+
+class Session;
+
+namespace data {
+class AnalogTimeSignal;
+class Sweep;
+namespace properties {
+class DoubleProperty;
+}
+}
+
+namespace ui {
+namespace views {
+
+/**
+ * The SweepView sets up and runs a Sweep of a double property, e.g. the
+ * output voltage of a power supply, with the given measurement signals.
+ */
+class SweepView : public BaseView
+{
+	Q_OBJECT
+
+public:
+	SweepView(Session& session,
+		shared_ptr<sv::data::properties::DoubleProperty> property,
+		const vector<shared_ptr<sv::data::AnalogTimeSignal>> &signals,
+		QWidget* parent = nullptr);
+	~SweepView();
+
+	QString title() const override;
+
+private:
+	void setup_ui();
+	void setup_toolbar();
+	void connect_signals();
+	void set_controls_enabled(bool enabled);
+	bool apply_settings();
+
+	shared_ptr<sv::data::properties::DoubleProperty> property_;
+	shared_ptr<sv::data::Sweep> sweep_;
+	QAction *const action_run_;
+	QToolBar *toolbar_;
+	QComboBox *type_box_;
+	QDoubleSpinBox *start_box_;
+	QDoubleSpinBox *stop_box_;
+	QSpinBox *step_count_box_;
+	QLineEdit *list_edit_;
+	QDoubleSpinBox *settle_delay_box_;
+	QSpinBox *settle_samples_box_;
+	QDoubleSpinBox *settle_tolerance_box_;
+	QDoubleSpinBox *timeout_box_;
+	QLabel *status_label_;
+
+private Q_SLOTS:
+	void on_type_changed();
+	void on_action_run_triggered();
+	void on_sweep_started();
+	void on_sweep_step_finished(size_t index, double value, bool settled);
+	void on_sweep_finished();
+
+};
+
+} // namespace views
+} // namespace ui
+} // namespace sv
+
+#endif // UI_VIEWS_SWEEPVIEW_HPP
@@ -51,6 +51,8 @@ ValuePanelView::ValuePanelView(Session &session,
 	unit_suffix_(""),
 	value_min_(std::numeric_limits<double>::max()),
 	value_max_(std::numeric_limits<double>::lowest()),
+	updating_(false),
+	updated_sample_count_(0),
 	action_reset_display_(new QAction(this))
 {
 	assert(channel_);
@@ -81,8 +83,7 @@ ValuePanelView::ValuePanelView(Session &session,
 	connect(channel_.get(), SIGNAL(signal_changed(shared_ptr<sv::data::BaseSignal>)),
 		this, SLOT(on_signal_changed()));
 
-	timer_ = new QTimer(this);
-	init_timer();
+	start_updates();
 }
 
 ValuePanelView::ValuePanelView(Session& session,
@@ -95,6 +96,8 @@ ValuePanelView::ValuePanelView(Session& session,
 	unit_suffix_(""),
 	value_min_(std::numeric_limits<double>::max()),
 	value_max_(std::numeric_limits<double>::lowest()),
+	updating_(false),
+	updated_sample_count_(0),
 	action_reset_display_(new QAction(this))
 {
 	assert(signal_);
@@ -110,13 +113,12 @@ ValuePanelView::ValuePanelView(Session& session,
 	connect_signals_displays();
 	reset_display();
 
-	timer_ = new QTimer(this);
-	init_timer();
+	start_updates();
 }
 
 ValuePanelView::~ValuePanelView()
 {
-	stop_timer();
+	stop_updates();
 }
 
 QString ValuePanelView::title() const
@@ -235,30 +237,47 @@ void ValuePanelView::reset_display()
 	value_display_->reset_value();
 }
 
-void ValuePanelView::init_timer()
+void ValuePanelView::start_updates()
 {
 	value_min_ = std::numeric_limits<double>::max();
 	value_max_ = std::numeric_limits<double>::lowest();
+	updated_sample_count_ = 0;
 
-	connect(timer_, SIGNAL(timeout()), this, SLOT(on_update()));
-	timer_->start(250);
+	FrameScheduler::instance().add_client(this, this);
+	updating_ = true;
 }
 
-void ValuePanelView::stop_timer()
+void ValuePanelView::stop_updates()
 {
-	if (!timer_->isActive())
+	if (!updating_)
 		return;
 
-	timer_->stop();
-	disconnect(timer_, SIGNAL(timeout()), this, SLOT(on_update()));
+	FrameScheduler::instance().remove_client(this);
+	updating_ = false;
 
 	reset_display();
 }
 
+bool ValuePanelView::has_frame_update() const
+{
+	return signal_ && signal_->sample_count() != updated_sample_count_;
+}
+
+void ValuePanelView::update_frame()
+{
+	on_update();
+}
+
+QString ValuePanelView::frame_client_name() const
+{
+	return title();
+}
+
 void ValuePanelView::on_update()
 {
 	if (!signal_ || signal_->sample_count() == 0)
 		return;
+	updated_sample_count_ = signal_->sample_count();
 
 	double value = 0;
 	if (signal_) {
@@ -272,6 +291,8 @@ void ValuePanelView::on_update()
 	value_display_->set_value(value);
 	value_min_display_->set_value(value_min_);
 	value_max_display_->set_value(value_max_);
+
+	signal_->mark_consumed();
 }
 
 void ValuePanelView::on_signal_changed()
@@ -284,6 +305,8 @@ void ValuePanelView::on_signal_changed()
 
 	signal_ = dynamic_pointer_cast<sv::data::AnalogTimeSignal>(
 		channel_->actual_signal());
+	// The sample count of the old signal says nothing about the new one.
+	updated_sample_count_ = 0;
 	if (!signal_)
 		return;
 
@@ -316,8 +339,8 @@ void ValuePanelView::on_signal_changed()
 
 void ValuePanelView::on_action_reset_display_triggered()
 {
-	stop_timer();
-	init_timer();
+	stop_updates();
+	start_updates();
 }
 
 } // namespace views
@@ -25,10 +25,10 @@
 
 #include <QAction>
 #include <QString>
-#include <QTimer>
 #include <QToolBar>
 
 #include "src/data/datautil.hpp"
+#include "src/ui/framescheduler.hpp"
 #include "src/ui/views/baseview.hpp"
 
 using std::set;
@@ -53,7 +53,7 @@ class ValueDisplay;
 
 namespace views {
 
-class ValuePanelView : public BaseView
+class ValuePanelView : public BaseView, public ui::FrameClient
 {
 	Q_OBJECT
 
@@ -70,6 +70,10 @@ public:
 
 	QString title() const override;
 
+	bool has_frame_update() const override;
+	void update_frame() override;
+	QString frame_client_name() const override;
+
 private:
 	shared_ptr<channels::BaseChannel> channel_;
 	shared_ptr<sv::data::AnalogTimeSignal> signal_;
@@ -81,11 +85,11 @@ private:
 	int digits_;
 	int decimal_places_;
 
-	QTimer *timer_;
-
 	// Min/max/actual values are stored here, so they can be reseted
 	double value_min_;
 	double value_max_;
+	bool updating_;
+	size_t updated_sample_count_;
 
 	QAction *const action_reset_display_;
 	QToolBar *toolbar_;
@@ -99,8 +103,8 @@ private:
 	void connect_signals_displays();
 	void disconnect_signals_displays();
 	void reset_display();
-	void init_timer();
-	void stop_timer();
+	void start_updates();
+	void stop_updates();
 
 private Q_SLOTS:
 	void on_update();
@@ -60,6 +60,11 @@ public:
 	virtual size_t size() const = 0;
 	virtual QRectF boundingRect() const = 0;
 
+	/**
+	 * Mark the samples of the signal(s) as consumed by the UI.
+	 */
+	virtual void mark_consumed() const = 0;
+
 	virtual QPointF closest_point(const QPointF &pos, double *dist) const = 0;
 	virtual QString name() const = 0;
 	virtual sv::data::Quantity x_quantity() const = 0;
@@ -0,0 +1,265 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <vector>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QRgb>
+#include <qwt_plot_item.h>
+#include <qwt_scale_map.h>
+
+#include "densityrasteritem.hpp"
+#include "src/ui/widgets/plot/basecurvedata.hpp"
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+namespace {
+
+/** The number of colors of the color map, without the empty pixels. */
+const int color_count = 255;
+
+/**
+ * Return true, if the map has the same zoom as the old map, i.e. it only
+ * differs by a (panning) shift of the paint device coordinates.
+ */
+bool is_same_zoom(const QwtScaleMap &map, const QwtScaleMap &old_map)
+{
+	const double old_dist = old_map.p2() - old_map.p1();
+	const double dist =
+		map.transform(old_map.s2()) - map.transform(old_map.s1());
+	return std::fabs(dist - old_dist) <= 1e-9 * std::fabs(old_dist);
+}
+
+QRgb interpolate(const QColor &color1, const QColor &color2, double ratio)
+{
+	QColor color = QColor::fromRgbF(
+		color1.redF() + (color2.redF() - color1.redF()) * ratio,
+		color1.greenF() + (color2.greenF() - color1.greenF()) * ratio,
+		color1.blueF() + (color2.blueF() - color1.blueF()) * ratio,
+		color1.alphaF() + (color2.alphaF() - color1.alphaF()) * ratio);
+	return qPremultiply(color.rgba());
+}
+
+}
+
+DensityRasterItem::DensityRasterItem(BaseCurveData *curve_data) :
+	QwtPlotItem(),
+	curve_data_(curve_data),
+	raster_width_(0),
+	raster_height_(0),
+	margin_x_(0),
+	margin_y_(0),
+	shift_x_(0),
+	shift_y_(0),
+	max_count_(0),
+	counted_points_(0),
+	raster_valid_(false),
+	image_valid_(false)
+{
+	assert(curve_data_);
+
+	setItemAttribute(QwtPlotItem::Legend, false);
+	setItemAttribute(QwtPlotItem::AutoScale, false);
+	// Like the curves, everything else will be painted ontop.
+	setZ(1);
+
+	set_color(curve_data_->color());
+}
+
+int DensityRasterItem::rtti() const
+{
+	return QwtPlotItem::Rtti_PlotUserItem;
+}
+
+void DensityRasterItem::set_color(const QColor &color)
+{
+	// Sparse pixels are translucent, the densest pixels fade to white.
+	QColor sparse_color(color);
+	sparse_color.setAlpha(96);
+	const double white_ratio = 0.6;
+
+	color_table_.resize(color_count + 1);
+	color_table_[0] = qRgba(0, 0, 0, 0);
+	for (int i = 1; i <= color_count; ++i) {
+		double ratio = (i - 1) / (double)(color_count - 1);
+		if (ratio < white_ratio)
+			color_table_[i] = interpolate(sparse_color, color,
+				ratio / white_ratio);
+		else
+			color_table_[i] = interpolate(color, Qt::white,
+				(ratio - white_ratio) / (1. - white_ratio));
+	}
+	image_valid_ = false;
+	itemChanged();
+}
+
+uint32_t DensityRasterItem::max_count() const
+{
+	return max_count_;
+}
+
+bool DensityRasterItem::update() const
+{
+	if (!raster_valid_)
+		return false;
+
+	const size_t num_points = curve_data_->size();
+	// The curve has been cleared, start again.
+	if (num_points < counted_points_) {
+		rebuild(x_map_, y_map_, raster_rect_);
+		return true;
+	}
+	if (num_points == counted_points_)
+		return false;
+
+	count_points(counted_points_, num_points);
+	return true;
+}
+
+void DensityRasterItem::draw(QPainter *painter, const QwtScaleMap &x_map,
+	const QwtScaleMap &y_map, const QRectF &canvas_rect) const
+{
+	const QRect raster_rect = canvas_rect.toAlignedRect();
+	if (raster_rect.isEmpty())
+		return;
+
+	// Panning only shifts the visible part of the raster. The raster is
+	// only rebuilt, when zooming, resizing or panning beyond the margins.
+	bool rebuild_raster = !raster_valid_ || raster_rect != raster_rect_ ||
+		!is_same_zoom(x_map, x_map_) || !is_same_zoom(y_map, y_map_);
+	if (!rebuild_raster) {
+		const int shift_x = (int)std::lround(
+			x_map.transform(x_map_.s1()) - x_map_.p1());
+		const int shift_y = (int)std::lround(
+			y_map.transform(y_map_.s1()) - y_map_.p1());
+		if (std::abs(shift_x) > margin_x_ || std::abs(shift_y) > margin_y_) {
+			rebuild_raster = true;
+		}
+		else if (shift_x != shift_x_ || shift_y != shift_y_) {
+			shift_x_ = shift_x;
+			shift_y_ = shift_y;
+			image_valid_ = false;
+		}
+	}
+
+	if (rebuild_raster)
+		rebuild(x_map, y_map, raster_rect);
+	else
+		update();
+
+	if (!image_valid_)
+		render_image();
+	painter->drawImage(raster_rect.topLeft(), image_);
+}
+
+void DensityRasterItem::rebuild(const QwtScaleMap &x_map,
+	const QwtScaleMap &y_map, const QRect &raster_rect) const
+{
+	x_map_ = x_map;
+	y_map_ = y_map;
+	raster_rect_ = raster_rect;
+	// The raster has a margin of half a canvas on every side for panning.
+	margin_x_ = raster_rect.width() / 2;
+	margin_y_ = raster_rect.height() / 2;
+	raster_width_ = raster_rect.width() + 2 * margin_x_;
+	raster_height_ = raster_rect.height() + 2 * margin_y_;
+	shift_x_ = 0;
+	shift_y_ = 0;
+	counts_.assign((size_t)raster_width_ * (size_t)raster_height_, 0);
+	max_count_ = 0;
+	counted_points_ = 0;
+	raster_valid_ = true;
+
+	count_points(0, curve_data_->size());
+}
+
+void DensityRasterItem::count_points(size_t from, size_t to) const
+{
+	const int width = raster_width_;
+	const int height = raster_height_;
+	const double left = raster_rect_.left() - margin_x_;
+	const double top = raster_rect_.top() - margin_y_;
+
+	for (size_t i = from; i < to; ++i) {
+		const QPointF point = curve_data_->sample(i);
+		const double x = std::floor(x_map_.transform(point.x()) - left);
+		const double y = std::floor(y_map_.transform(point.y()) - top);
+		// Also filters NaN
+		if (!(x >= 0. && x < width && y >= 0. && y < height))
+			continue;
+
+		uint32_t &count = counts_[(size_t)y * width + (size_t)x];
+		if (count < std::numeric_limits<uint32_t>::max())
+			++count;
+		max_count_ = std::max(max_count_, count);
+	}
+	counted_points_ = to;
+	image_valid_ = false;
+}
+
+void DensityRasterItem::render_image() const
+{
+	const int width = raster_rect_.width();
+	const int height = raster_rect_.height();
+	if (image_.width() != width || image_.height() != height)
+		image_ = QImage(width, height, QImage::Format_ARGB32_Premultiplied);
+
+	// The counts are mapped logarithmically, otherwise a few dense pixels
+	// would hide everything else. The max. count of the whole raster is
+	// used, so the colors don't change while panning.
+	const double scale = max_count_ > 0 ?
+		(color_count - 1) / std::log1p((double)max_count_) : 0.;
+	const int offset_x = margin_x_ - shift_x_;
+	const int offset_y = margin_y_ - shift_y_;
+	for (int y = 0; y < height; ++y) {
+		const uint32_t *counts = counts_.data() +
+			(size_t)(y + offset_y) * raster_width_ + offset_x;
+		QRgb *line = reinterpret_cast<QRgb *>(image_.scanLine(y));
+		for (int x = 0; x < width; ++x) {
+			if (counts[x] == 0) {
+				line[x] = color_table_[0];
+				continue;
+			}
+			line[x] = color_table_[
+				1 + (int)(std::log1p((double)counts[x]) * scale)];
+		}
+	}
+	image_valid_ = true;
+}
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
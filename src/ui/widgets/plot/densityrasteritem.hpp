@@ -0,0 +1,114 @@
+/*
+ * This file is part of the SmuView project.
+ *
+ * Copyright (C) 2020 Frank Stettner <frank-stettner@gmx.net>
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UI_WIDGETS_PLOT_DENSITYRASTERITEM_HPP
+#define UI_WIDGETS_PLOT_DENSITYRASTERITEM_HPP
+
+#include <cstdint>
+#include <vector>
+
+#include <QColor>
+#include <QImage>
+#include <QPainter>
+#include <QRect>
+#include <QRectF>
+#include <QRgb>
+#include <qwt_plot_item.h>
+#include <qwt_scale_map.h>
+
+using std::vector;
+
+namespace sv {
+namespace ui {
+namespace widgets {
+namespace plot {
+
+class BaseCurveData;
+
+/**
+ * The DensityRasterItem paints the points of a curve as a density image.
+ *
+ * The points are counted in a raster with one cell per canvas pixel and a
+ * margin of half a canvas on every side. New points are added incrementally
+ * with update(). Panning only shifts the visible part of the raster, the
+ * raster is only rebuilt from all points, when zooming, resizing or panning
+ * beyond the margin. Painting the item colour-maps the
+ * counts, so the painting costs are bounded by the canvas size and not by the
+ * number of points.
+ */
+class DensityRasterItem : public QwtPlotItem
+{
+
+public:
+	DensityRasterItem(BaseCurveData *curve_data);
+
+	int rtti() const override;
+	void draw(QPainter *painter, const QwtScaleMap &x_map,
+		const QwtScaleMap &y_map, const QRectF &canvas_rect) const override;
+
+	/**
+	 * Count the points of the curve, that were appended since the last
+	 * update, in the raster.
+	 *
+	 * @return true if points have been counted.
+	 */
+	bool update() const;
+
+	/** Set the color of the densest pixels. */
+	void set_color(const QColor &color);
+
+	/** Return the number of points in the densest pixel. */
+	uint32_t max_count() const;
+
+private:
+	void rebuild(const QwtScaleMap &x_map, const QwtScaleMap &y_map,
+		const QRect &raster_rect) const;
+	void count_points(size_t from, size_t to) const;
+	void render_image() const;
+
+	BaseCurveData *curve_data_;
+	vector<QRgb> color_table_;
+
+	// The raster is (re)built while painting, which is const in Qwt.
+	mutable QwtScaleMap x_map_;
+	mutable QwtScaleMap y_map_;
+	/** The canvas rect, when the raster was built. */
+	mutable QRect raster_rect_;
+	mutable int raster_width_;
+	mutable int raster_height_;
+	mutable int margin_x_;
+	mutable int margin_y_;
+	/** The panning offset of the canvas to the raster in pixels. */
+	mutable int shift_x_;
+	mutable int shift_y_;
+	mutable vector<uint32_t> counts_;
+	mutable uint32_t max_count_;
+	mutable size_t counted_points_;
+	mutable bool raster_valid_;
+	mutable bool image_valid_;
+	mutable QImage image_;
+
+};
+
+} // namespace plot
+} // namespace widgets
+} // namespace ui
+} // namespace sv
+
+#endif // UI_WIDGETS_PLOT_DENSITYRASTERITEM_HPP
@@ -18,20 +18,27 @@
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <utility>
 
+#include <QApplication>
 #include <QBoxLayout>
 #include <QDebug>
 #include <QEvent>
 #include <QHBoxLayout>
+#include <QPainter>
 #include <QPen>
 #include <QPoint>
 #include <QPointF>
 #include <QPushButton>
+#include <QRect>
 #include <QRectF>
+#include <QRegion>
 #include <QSize>
+#include <QStringList>
+#include <QtMath>
 #include <QVBoxLayout>
 #include <qwt_scale_widget.h>
 #include <qwt_curve_fitter.h>
@@ -55,6 +62,7 @@
 #include "src/ui/dialogs/plotcurveconfigdialog.hpp"
 #include "src/ui/widgets/plot/axislocklabel.hpp"
 #include "src/ui/widgets/plot/basecurvedata.hpp"
+#include "src/ui/widgets/plot/densityrasteritem.hpp"
 #include "src/ui/widgets/plot/plotmagnifier.hpp"
 #include "src/ui/widgets/plot/plotscalepicker.hpp"
 
@@ -124,15 +132,17 @@ private:
 };
 
 Plot::Plot(QWidget *parent) : QwtPlot(parent),
-	plot_interval_(200),
-	timer_id_(-1),
 	time_span_(120.),
 	add_time_(30.),
+	xy_render_mode_(XYRenderMode::Curve),
 	active_marker_(nullptr),
 	markers_label_(nullptr),
 	markers_label_alignment_(Qt::AlignBottom | Qt::AlignHCenter),
 	marker_select_picker_(nullptr),
-	marker_move_picker_(nullptr)
+	marker_move_picker_(nullptr),
+	replot_pending_(false),
+	scroll_cache_enabled_(true),
+	cache_valid_(false)
 {
 	this->setAutoReplot(false);
 	this->setCanvas(new Canvas());
@@ -190,13 +200,19 @@ Plot::~Plot()
 
 void Plot::start()
 {
-	timer_id_ = startTimer(plot_interval_);
+	ui::FrameScheduler::instance().add_client(this, this);
 }
 
 void Plot::stop()
 {
 	//qWarning() << "Plot::stop() for " << curve_data_->name();
-	killTimer(timer_id_);
+	ui::FrameScheduler::instance().remove_client(this);
+}
+
+void Plot::update_plot()
+{
+	update_intervals();
+	update_curves();
 }
 
 void Plot::replot()
@@ -206,10 +222,212 @@ void Plot::replot()
 	for (const auto &curve_data : curve_datas_) {
 		painted_points_map_[curve_data] = 0;
 	}
+	cache_valid_ = false;
+	replot_pending_ = false;
 
 	QwtPlot::replot();
 }
 
+void Plot::drawCanvas(QPainter *painter)
+{
+	if (!use_scroll_cache()) {
+		QwtPlot::drawCanvas(painter);
+		return;
+	}
+
+	if (!cache_valid_ ||
+			cache_.size() != canvas()->size() * canvas()->devicePixelRatioF())
+		render_cache();
+	painter->drawPixmap(0, 0, cache_);
+}
+
+void Plot::set_scroll_cache_enabled(bool enabled)
+{
+	scroll_cache_enabled_ = enabled;
+	if (!enabled)
+		cache_ = QPixmap();
+	replot();
+}
+
+bool Plot::use_scroll_cache() const
+{
+	if (!scroll_cache_enabled_ || update_mode_ != PlotUpdateMode::Rolling)
+		return false;
+
+	for (const auto &curve_data : curve_datas_) {
+		if (curve_data->curve_type() != CurveType::TimeCurve)
+			return false;
+	}
+	return true;
+}
+
+void Plot::render_cache()
+{
+	const qreal dpr = canvas()->devicePixelRatioF();
+	if (cache_.size() != canvas()->size() * dpr) {
+		cache_ = QPixmap(canvas()->size() * dpr);
+		cache_.setDevicePixelRatio(dpr);
+	}
+	// The background (incl. the rounded border) is painted by the canvas.
+	cache_.fill(Qt::transparent);
+
+	// The curves are painted with all samples, that are available now.
+	for (const auto &curve_data : curve_datas_) {
+		painted_points_map_[curve_data] = curve_data->size();
+	}
+
+	QPainter painter(&cache_);
+	QwtPlot::drawCanvas(&painter);
+	cache_valid_ = true;
+}
+
+bool Plot::scroll_cache(const QwtInterval &old_x_interval)
+{
+	// The markers label has a fixed position and can't be scrolled.
+	if (!use_scroll_cache() || !cache_valid_ || markers_label_)
+		return false;
+
+	// Update the scales and the layout without painting the canvas.
+	updateAxes();
+	QApplication::sendPostedEvents(this, QEvent::LayoutRequest);
+	if (cache_.size() != canvas()->size() * canvas()->devicePixelRatioF())
+		return false;
+
+	const QwtInterval x_interval = axisInterval(QwtPlot::xBottom);
+	if (!qFuzzyCompare(x_interval.width(), old_x_interval.width()))
+		return false;
+
+	// Only scroll to the left, when the x axis advances.
+	const QwtScaleMap x_map = canvasMap(QwtPlot::xBottom);
+	const QRect canvas_rect = canvas()->contentsRect();
+	const int dx = qRound(x_map.transform(old_x_interval.minValue()) -
+		x_map.transform(x_interval.minValue()));
+	if (dx >= 0 || -dx >= canvas_rect.width())
+		return false;
+
+	const qreal dpr = cache_.devicePixelRatio();
+	const QRect device_rect(canvas_rect.topLeft() * dpr,
+		canvas_rect.size() * dpr);
+	cache_.scroll(qRound(dx * dpr), 0, device_rect);
+
+	// Paint the background items (grid, markers) into the exposed strip.
+	const QRect strip(canvas_rect.right() + dx + 1, canvas_rect.top(),
+		-dx, canvas_rect.height());
+	QwtScaleMap maps[axisCnt];
+	for (int axis_id = 0; axis_id < axisCnt; ++axis_id)
+		maps[axis_id] = canvasMap(axis_id);
+
+	QPainter painter(&cache_);
+	painter.setCompositionMode(QPainter::CompositionMode_Source);
+	painter.fillRect(strip, Qt::transparent);
+	painter.setCompositionMode(QPainter::CompositionMode_SourceOver);
+	painter.setClipRect(strip);
+	for (const auto &item : itemList()) {
+		if (!item->isVisible() || item->rtti() == QwtPlotItem::Rtti_PlotCurve)
+			continue;
+		painter.setRenderHint(QPainter::Antialiasing,
+			item->testRenderHint(QwtPlotItem::RenderAntialiased));
+		item->draw(&painter, maps[item->xAxis()], maps[item->yAxis()],
+			canvas_rect);
+	}
+	painter.end();
+
+	// Paint the samples in the exposed strip, starting with the last sample
+	// before the strip, to connect the curve.
+	const double strip_start = x_map.invTransform(strip.left() - 1);
+	for (const auto &curve_data : curve_datas_) {
+		const size_t num_points = curve_data->size();
+		if (num_points == 0)
+			continue;
+
+		size_t low = 0;
+		size_t high = num_points;
+		while (low < high) {
+			size_t mid = low + (high - low) / 2;
+			if (curve_data->sample(mid).x() < strip_start)
+				low = mid + 1;
+			else
+				high = mid;
+		}
+		if (low > 0)
+			--low;
+
+		paint_cached_curve(curve_data, low, num_points - 1, strip);
+		painted_points_map_[curve_data] = num_points;
+		curve_data->mark_consumed();
+	}
+
+	canvas()->repaint();
+	return true;
+}
+
+QRect Plot::paint_cached_curve(plot::BaseCurveData *curve_data,
+	size_t from, size_t to, const QRect &clip_rect)
+{
+	QwtPlotCurve *plot_curve = plot_curve_map_[curve_data];
+	if (!plot_curve->isVisible() || from >= to)
+		return QRect();
+
+	const QwtScaleMap x_map = canvasMap(plot_curve->xAxis());
+	const QwtScaleMap y_map = canvasMap(plot_curve->yAxis());
+	const QRectF canvas_rect = canvas()->contentsRect();
+
+	QPainter painter(&cache_);
+	painter.setClipRect(clip_rect);
+	painter.setRenderHint(QPainter::Antialiasing,
+		plot_curve->testRenderHint(QwtPlotItem::RenderAntialiased));
+	plot_curve->drawSeries(&painter, x_map, y_map, canvas_rect, from, to);
+
+	const QRectF br = qwtBoundingRect(*plot_curve->data(), from, to);
+	const int margin = qCeil(plot_curve->pen().widthF()) + 1;
+	return QwtScaleMap::transform(x_map, y_map, br).toAlignedRect().
+		adjusted(-margin, -margin, margin, margin).intersected(clip_rect);
+}
+
+void Plot::set_xy_render_mode(XYRenderMode xy_render_mode)
+{
+	xy_render_mode_ = xy_render_mode;
+	for (const auto &curve_data : curve_datas_)
+		update_density_item(curve_data);
+	replot();
+}
+
+void Plot::update_density_item(plot::BaseCurveData *curve_data)
+{
+	QwtPlotCurve *plot_curve = plot_curve_map_[curve_data];
+	const bool density = xy_render_mode_ == XYRenderMode::Density &&
+		curve_data->curve_type() == CurveType::XYCurve;
+
+	auto density_item_it = density_item_map_.find(curve_data);
+	if (density && density_item_it == density_item_map_.end()) {
+		DensityRasterItem *density_item = new DensityRasterItem(curve_data);
+		density_item->setAxes(plot_curve->xAxis(), plot_curve->yAxis());
+		density_item->set_color(plot_curve->pen().color());
+		density_item->attach(this);
+		density_item_map_.insert(make_pair(curve_data, density_item));
+	}
+	else if (!density && density_item_it != density_item_map_.end()) {
+		density_item_it->second->detach();
+		delete density_item_it->second;
+		density_item_map_.erase(density_item_it);
+	}
+
+	// The curve is kept for the legend and the markers, but not painted.
+	plot_curve->setVisible(!density);
+}
+
+double Plot::align_to_pixels(double time_delta) const
+{
+	const QwtScaleMap x_map = canvasMap(QwtPlot::xBottom);
+	if (x_map.sDist() == 0. || x_map.pDist() == 0.)
+		return time_delta;
+
+	const double pixels_per_unit = std::fabs(x_map.pDist() / x_map.sDist());
+	const double pixels =
+		std::max(1., std::round(time_delta * pixels_per_unit));
+	return pixels / pixels_per_unit;
+}
+
 bool Plot::add_curve(widgets::plot::BaseCurveData *curve_data)
 {
 	assert(curve_data);
@@ -261,6 +479,8 @@ bool Plot::add_curve(widgets::plot::BaseCurveData *curve_data)
 
 	painted_points_map_.insert(make_pair(curve_data, 0));
 
+	update_density_item(curve_data);
+
 	QwtPlot::replot();
 
 	return true;
@@ -566,6 +786,45 @@ void Plot::add_diff_marker(QwtPlotMarker *marker1, QwtPlotMarker *marker2)
 	replot();
 }
 
+void Plot::add_event_marker(plot::BaseCurveData *curve_data, double x,
+	const QString &label)
+{
+	assert(curve_data);
+
+	if (!plot_curve_map_.count(curve_data))
+		return;
+	QwtPlotCurve *plot_curve = plot_curve_map_[curve_data];
+
+	QwtPlotMarker *marker = new QwtPlotMarker(label);
+	marker->setLineStyle(QwtPlotMarker::VLine);
+	marker->setLinePen(plot_curve->pen().color(), 1.0, Qt::DashDotLine);
+	marker->setXAxis(plot_curve->xAxis());
+	marker->setYAxis(plot_curve->yAxis());
+	marker->setXValue(x);
+	// Event markers will be painted ontop of curves but below the markers.
+	marker->setZ(1.5);
+
+	QwtText marker_label = QwtText(label);
+	marker_label.setColor(plot_curve->pen().color());
+	marker->setLabel(marker_label);
+	marker->setLabelAlignment(Qt::AlignTop | Qt::AlignRight);
+	marker->setLabelOrientation(Qt::Vertical);
+	marker->attach(this);
+
+	event_markers_.push_back(marker);
+	while (event_markers_.size() > max_event_markers) {
+		QwtPlotMarker *old_marker = event_markers_.front();
+		event_markers_.pop_front();
+		old_marker->detach();
+		delete old_marker;
+	}
+
+	// Markers are not painted by the direct painter nor the scroll cache,
+	// so the next frame of the FrameScheduler replots the whole plot. This
+	// way a chattering trigger costs at most one replot per frame.
+	replot_pending_ = true;
+}
+
 // TODO: implement remove marker call
 void Plot::remove_marker()
 {
@@ -648,16 +907,57 @@ void Plot::on_legend_clicked(const QVariant &item_info, int index)
 	if (plot_item) {
 		QwtPlotCurve *plot_curve = (QwtPlotCurve *)plot_item;
 		ui::dialogs::PlotCurveConfigDialog dlg(plot_curve);
-		dlg.exec();
+		if (!dlg.exec())
+			return;
+
+		// Apply a new curve color to the density image.
+		for (const auto &density_item_pair : density_item_map_) {
+			if (plot_curve_map_[density_item_pair.first] == plot_curve)
+				density_item_pair.second->set_color(plot_curve->pen().color());
+		}
+		replot();
 	}
 }
 
 void Plot::update_curves()
 {
+	if (use_scroll_cache()) {
+		// Nothing painted yet, render_cache() will paint all samples.
+		if (!cache_valid_)
+			return;
+
+		QRect dirty_rect;
+		for (const auto &curve_data : curve_datas_) {
+			const size_t painted_points = painted_points_map_[curve_data];
+			const size_t num_points = curve_data->size();
+			if (num_points <= painted_points)
+				continue;
+
+			dirty_rect |= paint_cached_curve(curve_data,
+				painted_points > 0 ? painted_points - 1 : 0, num_points - 1,
+				canvas()->contentsRect());
+			painted_points_map_[curve_data] = num_points;
+			curve_data->mark_consumed();
+		}
+		if (!dirty_rect.isEmpty())
+			canvas()->repaint(dirty_rect);
+		return;
+	}
+
+	bool density_changed = false;
 	for (const auto &curve_data : curve_datas_) {
 		const size_t painted_points = painted_points_map_[curve_data];
 		const size_t num_points = curve_data->size();
-		if (num_points > painted_points) {
+		if (num_points > painted_points &&
+				density_item_map_.count(curve_data)) {
+			// Only the new points are counted, the density image is painted
+			// with the canvas.
+			if (density_item_map_[curve_data]->update())
+				density_changed = true;
+			painted_points_map_[curve_data] = num_points;
+			curve_data->mark_consumed();
+		}
+		else if (num_points > painted_points) {
 			QwtPlotCurve *plot_curve = plot_curve_map_[curve_data];
 			QwtPlotDirectPainter *direct_painter =
 				plot_direct_painter_map_[curve_data];
@@ -687,25 +987,35 @@ void Plot::update_curves()
 				painted_points - 1, num_points - 1);
 
 			painted_points_map_[curve_data] = num_points;
+			curve_data->mark_consumed();
 		}
 
 		//replot();
 	}
+
+	if (density_changed)
+		canvas()->update();
 }
 
 void Plot::update_intervals()
 {
-	bool intervals_changed = false;
+	const QwtInterval old_x_interval = this->axisInterval(QwtPlot::xBottom);
+	bool x_interval_changed = false;
+	bool y_interval_changed = false;
 
 	for (const auto &curve_data : curve_datas_) {
 		if (update_x_interval(curve_data))
-			intervals_changed = true;
+			x_interval_changed = true;
 		if (update_y_interval(curve_data))
-			intervals_changed = true;
+			y_interval_changed = true;
 	}
 
-	if (intervals_changed)
-		replot();
+	if (!x_interval_changed && !y_interval_changed)
+		return;
+	// When only the x axis has advanced, the cached canvas is just scrolled.
+	if (!y_interval_changed && scroll_cache(old_x_interval))
+		return;
+	replot();
 }
 
 bool Plot::update_x_interval(plot::BaseCurveData *curve_data)
@@ -767,6 +1077,8 @@ bool Plot::update_x_interval(plot::BaseCurveData *curve_data)
 
 		if (boundaries.right() > max+time_span_)
 			min = boundaries.right();
+		else if (use_scroll_cache())
+			min += align_to_pixels(add_time_);
 		else
 			min += add_time_;
 		max = min + time_span_;
@@ -920,15 +1232,32 @@ void Plot::update_markers_label()
 	markers_label_->setText(text);
 }
 
-void Plot::timerEvent(QTimerEvent *event)
+bool Plot::has_frame_update() const
 {
-	if (event->timerId() == timer_id_) {
-		update_intervals();
-		update_curves();
-		return;
+	if (replot_pending_)
+		return true;
+	for (const auto &curve_data : curve_datas_) {
+		auto painted_points_it = painted_points_map_.find(curve_data);
+		if (painted_points_it == painted_points_map_.end() ||
+				curve_data->size() != painted_points_it->second)
+			return true;
 	}
+	return false;
+}
 
-	QwtPlot::timerEvent(event);
+void Plot::update_frame()
+{
+	update_plot();
+	if (replot_pending_)
+		replot();
+}
+
+QString Plot::frame_client_name() const
+{
+	QStringList curve_names;
+	for (const auto &curve_data : curve_datas_)
+		curve_names << curve_data->name();
+	return tr("Plot") + " " + curve_names.join(", ");
 }
 
 void Plot::resizeEvent(QResizeEvent *event)
@@ -21,9 +21,12 @@
 #ifndef UI_WIDGETS_PLOT_PLOT_HPP
 #define UI_WIDGETS_PLOT_PLOT_HPP
 
+#include <deque>
 #include <map>
 #include <vector>
 
+#include <QPixmap>
+#include <QRect>
 #include <QVariant>
 
 #include <qwt_interval.h>
@@ -37,6 +40,9 @@
 #include <qwt_system_clock.h>
 #include <qwt_text.h>
 
+#include "src/ui/framescheduler.hpp"
+
+using std::deque;
 using std::map;
 using std::pair;
 using std::vector;
@@ -47,6 +53,7 @@ namespace widgets {
 namespace plot {
 
 class BaseCurveData;
+class DensityRasterItem;
 class PlotMagnifier;
 
 enum class AxisBoundary {
@@ -70,22 +77,36 @@ static plot_update_mode_name_map_t plot_update_mode_name_map = {
 	{ sv::ui::widgets::plot::PlotUpdateMode::Oscilloscope, QString("Oscilloscope") },
 };
 
-class Plot : public QwtPlot
+enum class XYRenderMode {
+	Curve = 0,
+	Density
+};
+
+typedef map<XYRenderMode, QString> xy_render_mode_name_map_t;
+static xy_render_mode_name_map_t xy_render_mode_name_map = {
+	{ sv::ui::widgets::plot::XYRenderMode::Curve, QString("Curve") },
+	{ sv::ui::widgets::plot::XYRenderMode::Density, QString("Density") },
+};
+
+class Plot : public QwtPlot, public ui::FrameClient
 {
 	Q_OBJECT
 
 public:
+	/** The max. number of event markers in the plot. */
+	static const size_t max_event_markers = 100;
+
 	Plot(QWidget *parent = nullptr);
 	virtual ~Plot();
 
 	virtual void replot() override;
+	virtual void drawCanvas(QPainter *painter) override;
 	virtual bool eventFilter(QObject * object, QEvent *event) override;
 	bool add_curve(plot::BaseCurveData *curve_data);
 	vector<plot::BaseCurveData *> curve_datas() { return curve_datas_; }
 	bool is_axis_locked(int axis_id, AxisBoundary axis_boundary) { return axis_lock_map_[axis_id][axis_boundary]; }
 	void set_axis_locked(int axis_id, AxisBoundary axis_boundary, bool locked);
 	void set_all_axis_locked(bool locked);
-	void set_plot_interval(int plot_interval) { plot_interval_ = plot_interval; }
 	void set_update_mode(PlotUpdateMode update_mode) { update_mode_ = update_mode; }
 	PlotUpdateMode update_mode() const { return update_mode_; };
 	void set_time_span(double time_span);
@@ -95,10 +116,23 @@ public:
 	map<QwtPlotMarker *, plot::BaseCurveData *> markers() { return marker_map_; }
 	void set_markers_label_alignment(int alignment);
 	int markers_label_alignment() { return markers_label_alignment_; }
+	void set_scroll_cache_enabled(bool enabled);
+	/**
+	 * Set the render mode of the xy curves. In the density mode the points
+	 * are painted as a density image instead of connected lines.
+	 */
+	void set_xy_render_mode(XYRenderMode xy_render_mode);
+	XYRenderMode xy_render_mode() const { return xy_render_mode_; }
+
+	bool has_frame_update() const override;
+	void update_frame() override;
+	QString frame_client_name() const override;
+	bool scroll_cache_enabled() const { return scroll_cache_enabled_; }
 
 public Q_SLOTS:
 	void start();
 	void stop();
+	void update_plot();
 	int init_x_axis(plot::BaseCurveData *curve_data);
 	int init_y_axis(plot::BaseCurveData *curve_data);
 	void add_axis_icons(const int axis_id);
@@ -107,6 +141,12 @@ public Q_SLOTS:
 	void add_marker(plot::BaseCurveData *curve_data);
 	void add_diff_marker(QwtPlotMarker *marker1, QwtPlotMarker *marker2);
 	void remove_marker();
+	/**
+	 * Add a vertical marker for an event (e.g. a trigger event) at x. Only
+	 * the last max_event_markers event markers are kept.
+	 */
+	void add_event_marker(plot::BaseCurveData *curve_data, double x,
+		const QString &label);
 	void on_marker_selected(const QPointF mouse_pos);
 	void on_marker_moved(const QPointF mouse_pos);
 	void on_legend_clicked(const QVariant &item_info, int index);
@@ -117,7 +157,6 @@ Q_SIGNALS:
 protected:
 	virtual void showEvent(QShowEvent *) override;
 	virtual void resizeEvent(QResizeEvent *) override;
-	virtual void timerEvent(QTimerEvent *) override;
 
 private:
 	void update_curves();
@@ -126,18 +165,32 @@ private:
 	bool update_y_interval(plot::BaseCurveData *curve_data);
 	void update_markers_label();
 
+	/**
+	 * The scroll cache is used in the rolling mode: The canvas content is
+	 * kept in cache_ and shifted, when the x axis advances. Only the newly
+	 * exposed strip and the new samples are painted. The cache is rendered
+	 * completely on replot(), e.g. after zooming, panning or resizing.
+	 */
+	bool use_scroll_cache() const;
+	void render_cache();
+	bool scroll_cache(const QwtInterval &old_x_interval);
+	QRect paint_cached_curve(plot::BaseCurveData *curve_data, size_t from,
+		size_t to, const QRect &clip_rect);
+	double align_to_pixels(double time_delta) const;
+	void update_density_item(plot::BaseCurveData *curve_data);
+
 	vector<plot::BaseCurveData *> curve_datas_;
 	map<plot::BaseCurveData *, QwtPlotCurve *> plot_curve_map_;
 	map<plot::BaseCurveData *, QwtPlotDirectPainter *> plot_direct_painter_map_;
 	map<plot::BaseCurveData *, int> y_axis_id_map_;
 	map<plot::BaseCurveData *, size_t> painted_points_map_;
+	map<plot::BaseCurveData *, DensityRasterItem *> density_item_map_;
 
 	map<int, map<AxisBoundary, bool>> axis_lock_map_; // map<axis_id, map<AxisBoundary, locked>>
-	int plot_interval_;
-	int timer_id_;
 	PlotUpdateMode update_mode_;
 	double time_span_;
 	double add_time_;
+	XYRenderMode xy_render_mode_;
 
 	QwtPlotPanner *plot_panner_;
 	PlotMagnifier *plot_magnifier_;
@@ -150,6 +203,13 @@ private:
 	int markers_label_alignment_;
 	QwtPlotPicker *marker_select_picker_;
 	QwtPlotPicker *marker_move_picker_;
+	deque<QwtPlotMarker *> event_markers_;
+	/** Set, when the next frame must replot the whole plot (event markers). */
+	bool replot_pending_;
+
+	bool scroll_cache_enabled_;
+	bool cache_valid_;
+	QPixmap cache_;
 
 };
 
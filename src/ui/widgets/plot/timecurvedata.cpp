@@ -72,6 +72,11 @@ size_t TimeCurveData::size() const
 	return signal_->sample_count();
 }
 
+void TimeCurveData::mark_consumed() const
+{
+	signal_->mark_consumed();
+}
+
 QRectF TimeCurveData::boundingRect() const
 {
 	/*
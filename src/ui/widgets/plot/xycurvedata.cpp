@@ -85,6 +85,12 @@ size_t XYCurveData::size() const
 	return x_data_->size();
 }
 
+void XYCurveData::mark_consumed() const
+{
+	x_t_signal_->mark_consumed();
+	y_t_signal_->mark_consumed();
+}
+
 QRectF XYCurveData::boundingRect() const
 {
 	// top left, bottom right
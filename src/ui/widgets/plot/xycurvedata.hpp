@@ -63,6 +63,7 @@ public:
 
 	QPointF sample(size_t i) const override;
 	size_t size() const override;
+	void mark_consumed() const override;
 	QRectF boundingRect() const override;
 
 	QPointF closest_point(const QPointF &pos, double *dist) const override;